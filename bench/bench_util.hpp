@@ -0,0 +1,91 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sched.h>
+
+namespace concurrency::bench {
+
+typedef std::chrono::steady_clock bench_clock;
+
+inline double elapsed_ns(bench_clock::time_point start, bench_clock::time_point end)
+{ return std::chrono::duration<double, std::nano>(end - start).count(); }
+
+/*nearest-rank percentile of sorted samples, p in [0, 100]*/
+inline double percentile(const std::vector<double>& sorted, double p) {
+    if(sorted.empty())
+        return 0;
+    std::size_t rank = static_cast<std::size_t>(p / 100 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+/*
+ * Prints one JSON object per line:
+ * {"benchmark":..,"impl":..,"threads":..,"unit":..,"samples":..,"min":..,"p50":..,"p90":..,"p99":..,"max":..,"mean":..}
+ */
+inline void report(
+    const std::string& benchmark,
+    const std::string& impl,
+    int threads,
+    std::vector<double> samples,
+    const char* unit = "ns/op"
+) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for(std::size_t i = 0; i < samples.size(); ++i)
+        sum += samples[i];
+
+    std::cout
+        << "{\"benchmark\":\"" << benchmark << "\""
+        << ",\"impl\":\"" << impl << "\""
+        << ",\"threads\":" << threads
+        << ",\"unit\":\"" << unit << "\""
+        << ",\"samples\":" << samples.size()
+        << ",\"min\":" << percentile(samples, 0)
+        << ",\"p50\":" << percentile(samples, 50)
+        << ",\"p90\":" << percentile(samples, 90)
+        << ",\"p99\":" << percentile(samples, 99)
+        << ",\"max\":" << percentile(samples, 100)
+        << ",\"mean\":" << (samples.empty() ? 0 : sum / samples.size())
+        << "}" << std::endl;
+}
+
+/*benchmark is run when no filter is given or its name contains one of filters*/
+inline bool selected(int argc, char* argv[], const char* benchmark) {
+    if(argc < 2)
+        return true;
+    for(int i = 1; i < argc; ++i)
+        if(std::strstr(benchmark, argv[i]))
+            return true;
+    return false;
+}
+
+/*releases all participating threads at once, so they start contending together*/
+class start_gate {
+
+public:
+    explicit start_gate(int participants): m_arrived(0), m_participants(participants) {}
+
+    void arrive_and_wait() {
+        m_arrived.fetch_add(1, std::memory_order_acq_rel);
+        /*yield rather than spin, participants may outnumber cpus*/
+        while(m_arrived.load(std::memory_order_acquire) < m_participants)
+            sched_yield();
+    }
+
+private:
+    std::atomic<int> m_arrived;
+    const int m_participants;
+
+}; // class start_gate
+
+} // namespace concurrency::bench
+
+#endif
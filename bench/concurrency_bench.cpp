@@ -0,0 +1,1193 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <shared_mutex>
+#include <stack>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "thread.hpp"
+#include "mutex.hpp"
+#include "futex_mutex.hpp"
+#include "shared_mutex.hpp"
+#include "big_reader_mutex.hpp"
+#include "spin_lock.hpp"
+#include "queue_lock.hpp"
+#include "condition_variable.hpp"
+#include "semaphore.hpp"
+#include "barrier.hpp"
+#include "spsc_queue.hpp"
+#include "channel.hpp"
+#include "lock_free_stack.hpp"
+#include "lock_free_queue.hpp"
+#include "concurrent_hash_map.hpp"
+#include "future.hpp"
+#include "parallel.hpp"
+#include "timer_service.hpp"
+#include "sharded_counter.hpp"
+
+#include "bench_util.hpp"
+
+/*
+ * Microbenchmarks of library primitives, each next to its std:: equivalent.
+ * Usage: concurrency_bench [benchmark name substring...]
+ * Output: JSON object per line (see bench_util.hpp).
+ */
+
+namespace {
+
+using namespace concurrency::bench;
+
+struct concurrency_primitives {
+    typedef concurrency::mutex mutex_type;
+    typedef concurrency::condition_variable cond_var_type;
+    typedef concurrency::unique_lock<mutex_type> unique_lock_type;
+    typedef concurrency::thread thread_type;
+
+    static const char* name() { return "concurrency"; }
+};
+
+struct futex_primitives {
+    typedef concurrency::futex_mutex mutex_type;
+    typedef concurrency::condition_variable_any cond_var_type;
+    typedef concurrency::unique_lock<mutex_type> unique_lock_type;
+    typedef concurrency::thread thread_type;
+
+    static const char* name() { return "concurrency_futex"; }
+};
+
+struct std_primitives {
+    typedef std::mutex mutex_type;
+    typedef std::condition_variable cond_var_type;
+    typedef std::unique_lock<mutex_type> unique_lock_type;
+    typedef std::thread thread_type;
+
+    static const char* name() { return "std"; }
+};
+
+/*user-space spinning locks, name() is specialized for each benchmarked lock*/
+template<typename Lock>
+struct spin_primitives {
+    typedef Lock mutex_type;
+    typedef concurrency::unique_lock<mutex_type> unique_lock_type;
+    typedef concurrency::thread thread_type;
+
+    static const char* name();
+};
+
+template<> const char* spin_primitives<concurrency::ttas_lock<concurrency::backoff_none>>::name() { return "ttas_none"; }
+template<> const char* spin_primitives<concurrency::ttas_lock<concurrency::backoff_pause>>::name() { return "ttas_pause"; }
+template<> const char* spin_primitives<concurrency::ttas_lock<concurrency::backoff_exponential>>::name() { return "ttas_exponential"; }
+template<> const char* spin_primitives<concurrency::ticket_lock<concurrency::backoff_none>>::name() { return "ticket_none"; }
+template<> const char* spin_primitives<concurrency::ticket_lock<concurrency::backoff_pause>>::name() { return "ticket_pause"; }
+template<> const char* spin_primitives<concurrency::ticket_lock<concurrency::backoff_exponential>>::name() { return "ticket_exponential"; }
+template<> const char* spin_primitives<concurrency::mcs_lock<concurrency::backoff_none>>::name() { return "mcs_none"; }
+template<> const char* spin_primitives<concurrency::mcs_lock<concurrency::backoff_pause>>::name() { return "mcs_pause"; }
+template<> const char* spin_primitives<concurrency::mcs_lock<concurrency::backoff_exponential>>::name() { return "mcs_exponential"; }
+template<> const char* spin_primitives<concurrency::clh_lock<concurrency::backoff_none>>::name() { return "clh_none"; }
+template<> const char* spin_primitives<concurrency::clh_lock<concurrency::backoff_pause>>::name() { return "clh_pause"; }
+template<> const char* spin_primitives<concurrency::clh_lock<concurrency::backoff_exponential>>::name() { return "clh_exponential"; }
+
+/*uncontended lock/unlock pair, samples are ns per pair*/
+template<typename Prims>
+void bench_uncontended(int samples_num, int iterations) {
+    typename Prims::mutex_type mut;
+    std::vector<double> samples;
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        bench_clock::time_point start = bench_clock::now();
+        for(int i = 0; i < iterations; ++i) {
+            mut.lock();
+            mut.unlock();
+        }
+        samples.push_back(elapsed_ns(start, bench_clock::now()) / iterations);
+    }
+
+    report("uncontended_lock_unlock", Prims::name(), 1, samples);
+}
+
+volatile long shared_val = 0;
+
+/*incr_func of main.cpp*/
+template<typename Prims>
+void incr_func(typename Prims::mutex_type* mut, start_gate* gate, int amount) {
+    gate->arrive_and_wait();
+
+    int tmp;
+    while (amount-- > 0) {
+        typename Prims::unique_lock_type locker(*mut);
+        // some redundant work
+        tmp = shared_val + 1;
+        tmp--;
+        shared_val = tmp + 1;
+    }
+}
+
+/*N threads incrementing under one mutex, samples are ns per increment (wall clock / total increments)*/
+template<typename Prims>
+void bench_contended_increment(
+    int samples_num, int threads_num, int iterations,
+    const char* benchmark = "contended_increment"
+) {
+    std::vector<double> samples;
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        typename Prims::mutex_type mut;
+        start_gate gate(threads_num + 1);
+        std::vector<typename Prims::thread_type> workers;
+
+        for(int i = 0; i < threads_num; ++i)
+            workers.push_back(typename Prims::thread_type(incr_func<Prims>, &mut, &gate, iterations));
+
+        gate.arrive_and_wait();
+        bench_clock::time_point start = bench_clock::now();
+        for(int i = 0; i < threads_num; ++i)
+            workers[i].join();
+        samples.push_back(elapsed_ns(start, bench_clock::now()) / (threads_num * iterations));
+    }
+
+    report(benchmark, Prims::name(), threads_num, samples);
+}
+
+/*every backoff policy of lock kind, next to kernel-assisted mutexes*/
+template<template<typename> class Lock>
+void bench_spin_lock_kind(int threads_num, int iterations) {
+    using namespace concurrency;
+    bench_contended_increment<spin_primitives<Lock<backoff_none>>>(10, threads_num, iterations, "spin_lock_increment");
+    bench_contended_increment<spin_primitives<Lock<backoff_pause>>>(10, threads_num, iterations, "spin_lock_increment");
+    bench_contended_increment<spin_primitives<Lock<backoff_exponential>>>(10, threads_num, iterations, "spin_lock_increment");
+}
+
+/*two threads passing turn back and forth, samples are ns per round trip*/
+template<typename Prims>
+void bench_ping_pong(int round_trips) {
+    typename Prims::mutex_type mut;
+    typename Prims::cond_var_type cond_var;
+    int turn = 0; /*even - ping, odd - pong*/
+
+    typename Prims::thread_type pong([&mut, &cond_var, &turn, round_trips] () {
+        typename Prims::unique_lock_type locker(mut);
+        for(int i = 0; i < round_trips; ++i) {
+            cond_var.wait(locker, [&turn] () { return turn % 2 == 1; });
+            ++turn;
+            cond_var.notify_one();
+        }
+    });
+
+    std::vector<double> samples;
+    samples.reserve(round_trips);
+    {
+        typename Prims::unique_lock_type locker(mut);
+        for(int i = 0; i < round_trips; ++i) {
+            bench_clock::time_point start = bench_clock::now();
+            ++turn;
+            cond_var.notify_one();
+            cond_var.wait(locker, [&turn] () { return turn % 2 == 0; });
+            samples.push_back(elapsed_ns(start, bench_clock::now()));
+        }
+    }
+    pong.join();
+
+    report("cv_ping_pong_round_trip", Prims::name(), 2, samples, "ns");
+}
+
+/*same handoff as bench_ping_pong with pair of binary semaphores, samples are ns per round trip*/
+void bench_semaphore_ping_pong(int round_trips) {
+    concurrency::binary_semaphore ping(0);
+    concurrency::binary_semaphore pong(0);
+
+    concurrency::thread ponger([&ping, &pong, round_trips] () {
+        for(int i = 0; i < round_trips; ++i) {
+            ping.acquire();
+            pong.release();
+        }
+    });
+
+    std::vector<double> samples;
+    samples.reserve(round_trips);
+    for(int i = 0; i < round_trips; ++i) {
+        bench_clock::time_point start = bench_clock::now();
+        ping.release();
+        pong.acquire();
+        samples.push_back(elapsed_ns(start, bench_clock::now()));
+    }
+    ponger.join();
+
+    report("semaphore_ping_pong_round_trip", "concurrency", 2, samples, "ns");
+}
+
+/*one notify_all wakes every waiter, samples are ns until last waiter has acknowledged*/
+template<typename Prims>
+void bench_notify_all_fan_out(int waiters_num, int rounds) {
+    typename Prims::mutex_type mut;
+    typename Prims::cond_var_type wake_cv;
+    typename Prims::cond_var_type ack_cv;
+    int generation = 0;
+    int acked = 0;
+
+    std::vector<typename Prims::thread_type> waiters;
+    for(int w = 0; w < waiters_num; ++w)
+        waiters.push_back(typename Prims::thread_type(
+            [&mut, &wake_cv, &ack_cv, &generation, &acked, waiters_num, rounds] () {
+                typename Prims::unique_lock_type locker(mut);
+                for(int round = 1; round <= rounds; ++round) {
+                    wake_cv.wait(locker, [&generation, round] () { return generation >= round; });
+                    if(++acked == waiters_num)
+                        ack_cv.notify_one();
+                }
+            }
+        ));
+
+    std::vector<double> samples;
+    samples.reserve(rounds);
+    for(int round = 1; round <= rounds; ++round) {
+        typename Prims::unique_lock_type locker(mut);
+        /*previous round fully acknowledged, so every waiter is blocked again (or about to)*/
+        bench_clock::time_point start = bench_clock::now();
+        acked = 0;
+        generation = round;
+        wake_cv.notify_all();
+        ack_cv.wait(locker, [&acked, waiters_num] () { return acked == waiters_num; });
+        samples.push_back(elapsed_ns(start, bench_clock::now()));
+    }
+
+    for(int w = 0; w < waiters_num; ++w)
+        waiters[w].join();
+
+    report("notify_all_fan_out", Prims::name(), waiters_num + 1, samples, "ns");
+}
+
+/*N threads passing barrier phase after phase, samples are ns per phase*/
+void bench_barrier_phases(concurrency::barrier_mode mode, int threads_num, int phases) {
+    concurrency::barrier sync_point(threads_num + 1, mode);
+    std::vector<concurrency::thread> threads;
+    for(int t = 0; t < threads_num; ++t)
+        threads.push_back(concurrency::thread([&sync_point, phases] () {
+            for(int phase = 0; phase < phases; ++phase)
+                sync_point.arrive_and_wait();
+        }));
+
+    /*main thread takes part, so it can time every phase*/
+    std::vector<double> samples;
+    samples.reserve(phases);
+    for(int phase = 0; phase < phases; ++phase) {
+        bench_clock::time_point start = bench_clock::now();
+        sync_point.arrive_and_wait();
+        samples.push_back(elapsed_ns(start, bench_clock::now()));
+    }
+
+    for(int t = 0; t < threads_num; ++t)
+        threads[t].join();
+
+    report(
+        "barrier_phase",
+        mode == concurrency::barrier_mode::central ? "concurrency_central" : "concurrency_combining_tree",
+        threads_num + 1, samples, "ns"
+    );
+}
+
+void spawned_routine(int* out)
+{ *out += 1; }
+
+/*create and join thread running trivial function, samples are ns per spawn+join*/
+template<typename Prims>
+void bench_spawn_join(int spawns) {
+    int out = 0;
+    std::vector<double> samples;
+    samples.reserve(spawns);
+
+    for(int i = 0; i < spawns; ++i) {
+        bench_clock::time_point start = bench_clock::now();
+        typename Prims::thread_type tr(spawned_routine, &out);
+        tr.join();
+        samples.push_back(elapsed_ns(start, bench_clock::now()));
+    }
+
+    report("thread_spawn_join", Prims::name(), 1, samples, "ns");
+}
+
+/*lookup table guarded by readers-writer lock, readers take shared lock*/
+struct concurrency_shared_table {
+    typedef concurrency::shared_mutex mutex_type;
+    typedef concurrency::shared_lock<mutex_type> read_lock_type;
+    typedef concurrency::lock_guard<mutex_type> write_lock_type;
+
+    static const char* name() { return "concurrency_shared_mutex"; }
+};
+
+struct std_shared_table {
+    typedef std::shared_mutex mutex_type;
+    typedef std::shared_lock<mutex_type> read_lock_type;
+    typedef std::lock_guard<mutex_type> write_lock_type;
+
+    static const char* name() { return "std_shared_mutex"; }
+};
+
+struct big_reader_table {
+    typedef concurrency::big_reader_mutex mutex_type;
+    typedef concurrency::shared_lock<mutex_type> read_lock_type;
+    typedef concurrency::lock_guard<mutex_type> write_lock_type;
+
+    static const char* name() { return "concurrency_big_reader_mutex"; }
+};
+
+/*baseline: readers serialize on exclusive mutex*/
+struct exclusive_table {
+    typedef concurrency::mutex mutex_type;
+    typedef concurrency::lock_guard<mutex_type> read_lock_type;
+    typedef concurrency::lock_guard<mutex_type> write_lock_type;
+
+    static const char* name() { return "concurrency_mutex"; }
+};
+
+template<typename Table>
+void lookup_func(
+    typename Table::mutex_type* mut,
+    std::map<int, int>* table,
+    start_gate* gate,
+    int lookups,
+    int write_every,
+    long* out
+) {
+    const int keys = static_cast<int>(table->size());
+    long sum = 0;
+    gate->arrive_and_wait();
+
+    for(int i = 0; i < lookups; ++i) {
+        if(write_every && i % write_every == 0) {
+            typename Table::write_lock_type locker(*mut);
+            (*table)[i % keys] += 1;
+        } else {
+            typename Table::read_lock_type locker(*mut);
+            sum += table->find((i * 7) % keys)->second;
+        }
+    }
+    *out = sum;
+}
+
+/*
+ * N threads looking up std::map under one lock; write_every = 0 is read-only.
+ * Samples are ns per lookup (wall clock / total lookups), falling with threads when reads scale.
+ */
+template<typename Table>
+void bench_read_mostly(int samples_num, int threads_num, int lookups, int write_every) {
+    std::map<int, int> table;
+    for(int key = 0; key < 1024; ++key)
+        table[key] = key;
+
+    std::vector<double> samples;
+    std::vector<long> sums(threads_num);
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        typename Table::mutex_type mut;
+        start_gate gate(threads_num + 1);
+        std::vector<concurrency::thread> workers;
+
+        for(int i = 0; i < threads_num; ++i)
+            workers.push_back(concurrency::thread(
+                lookup_func<Table>, &mut, &table, &gate, lookups, write_every, &sums[i]
+            ));
+
+        gate.arrive_and_wait();
+        bench_clock::time_point start = bench_clock::now();
+        for(int i = 0; i < threads_num; ++i)
+            workers[i].join();
+        samples.push_back(elapsed_ns(start, bench_clock::now()) / (threads_num * lookups));
+    }
+
+    report(write_every ? "read_mostly_lookup" : "read_only_lookup", Table::name(), threads_num, samples);
+}
+
+/*
+ * One producer passes messages to one consumer, batch = 1 uses single element push/pop.
+ * Samples are millions of messages per second.
+ */
+template<concurrency::spsc_mode Mode>
+void bench_spsc_transfer(int samples_num, long messages, std::size_t batch) {
+    typedef concurrency::spsc_queue<long, 1024, Mode> queue_type;
+    std::vector<double> samples;
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        std::unique_ptr<queue_type> queue(new queue_type());
+        long sum = 0;
+
+        bench_clock::time_point start = bench_clock::now();
+        concurrency::thread consumer([&queue, &sum, messages, batch] () {
+            std::vector<long> buf(batch);
+            for(long received = 0; received < messages; ) {
+                if(batch == 1) {
+                    long msg = 0;
+                    queue->pop(msg);
+                    sum += msg;
+                    ++received;
+                    continue;
+                }
+                const std::size_t popped = queue->pop_bulk(buf.begin(), batch);
+                for(std::size_t i = 0; i < popped; ++i)
+                    sum += buf[i];
+                received += popped;
+            }
+        });
+
+        std::vector<long> buf(batch);
+        for(long sent = 0; sent < messages; ) {
+            if(batch == 1) {
+                queue->push(sent++);
+                continue;
+            }
+            const std::size_t count = std::min<long>(batch, messages - sent);
+            for(std::size_t i = 0; i < count; ++i)
+                buf[i] = sent + i;
+            queue->push_bulk(buf.begin(), count);
+            sent += count;
+        }
+        consumer.join();
+        samples.push_back(messages / elapsed_ns(start, bench_clock::now()) * 1'000);
+    }
+
+    std::string impl = Mode == concurrency::spsc_mode::blocking ? "spsc_blocking" : "spsc_polling";
+    if(batch != 1)
+        impl += "_batch" + std::to_string(batch);
+    report("spsc_transfer", impl, 2, samples, "Mmsg/s");
+}
+
+/*baseline: std::queue guarded by mutex, consumer waits on condition_variable*/
+void bench_locked_queue_transfer(int samples_num, long messages) {
+    std::vector<double> samples;
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        concurrency::mutex mut;
+        concurrency::condition_variable cond_var;
+        std::queue<long> queue;
+        long sum = 0;
+
+        bench_clock::time_point start = bench_clock::now();
+        concurrency::thread consumer([&mut, &cond_var, &queue, &sum, messages] () {
+            for(long received = 0; received < messages; ++received) {
+                concurrency::unique_lock<concurrency::mutex> locker(mut);
+                cond_var.wait(locker, [&queue] () { return !queue.empty(); });
+                sum += queue.front();
+                queue.pop();
+            }
+        });
+
+        for(long sent = 0; sent < messages; ++sent) {
+            concurrency::lock_guard<concurrency::mutex> locker(mut);
+            queue.push(sent);
+            cond_var.notify_one();
+        }
+        consumer.join();
+        samples.push_back(messages / elapsed_ns(start, bench_clock::now()) * 1'000);
+    }
+
+    report("spsc_transfer", "mutex_cv_queue", 2, samples, "Mmsg/s");
+}
+
+/*
+ * threads_num / 2 producers pass messages to as many consumers through one channel,
+ * batch = 1 uses single element send/receive. Samples are millions of messages per second.
+ */
+void bench_channel_transfer(int samples_num, int threads_num, long messages, std::size_t batch) {
+    const int producers = threads_num / 2;
+    const int consumers = threads_num - producers;
+    const long per_producer = messages / producers;
+    std::vector<double> samples;
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        concurrency::channel<long> chan(1024);
+        std::vector<long> sums(consumers);
+        start_gate gate(threads_num + 1);
+        std::vector<concurrency::thread> receivers, senders;
+
+        for(int c = 0; c < consumers; ++c)
+            receivers.push_back(concurrency::thread([&chan, &sums, &gate, c, batch] () {
+                std::vector<long> buf(batch);
+                gate.arrive_and_wait();
+                for(;;) {
+                    const std::size_t received = chan.receive_bulk(buf.begin(), batch);
+                    if(received == 0)
+                        break;
+                    for(std::size_t i = 0; i < received; ++i)
+                        sums[c] += buf[i];
+                }
+            }));
+
+        for(int p = 0; p < producers; ++p)
+            senders.push_back(concurrency::thread([&chan, &gate, per_producer, batch] () {
+                std::vector<long> buf(batch);
+                gate.arrive_and_wait();
+                for(long sent = 0; sent < per_producer; ) {
+                    const std::size_t count = std::min<long>(batch, per_producer - sent);
+                    for(std::size_t i = 0; i < count; ++i)
+                        buf[i] = sent + i;
+                    if(batch == 1)
+                        chan.send(buf[0]);
+                    else
+                        chan.send_bulk(buf.begin(), count);
+                    sent += count;
+                }
+            }));
+
+        gate.arrive_and_wait();
+        bench_clock::time_point start = bench_clock::now();
+        for(int p = 0; p < producers; ++p)
+            senders[p].join();
+        chan.close();
+        for(int c = 0; c < consumers; ++c)
+            receivers[c].join();
+        samples.push_back(producers * per_producer / elapsed_ns(start, bench_clock::now()) * 1'000);
+    }
+
+    report("mpmc_transfer", batch == 1 ? "channel" : "channel_batch" + std::to_string(batch), threads_num, samples, "Mmsg/s");
+}
+
+/*baseline: bounded std::deque guarded by mutex, with condition_variable per direction*/
+void bench_locked_deque_transfer(int samples_num, int threads_num, long messages) {
+    typedef concurrency::unique_lock<concurrency::mutex> lock_type;
+    const std::size_t capacity = 1024;
+    const int producers = threads_num / 2;
+    const int consumers = threads_num - producers;
+    const long per_producer = messages / producers;
+    std::vector<double> samples;
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        concurrency::mutex mut;
+        concurrency::condition_variable not_full, not_empty;
+        std::deque<long> queue;
+        bool closed = false;
+        std::vector<long> sums(consumers);
+        start_gate gate(threads_num + 1);
+        std::vector<concurrency::thread> receivers, senders;
+
+        for(int c = 0; c < consumers; ++c)
+            receivers.push_back(concurrency::thread([&, c] () {
+                gate.arrive_and_wait();
+                for(;;) {
+                    lock_type locker(mut);
+                    not_empty.wait(locker, [&] () { return !queue.empty() || closed; });
+                    if(queue.empty())
+                        break;
+                    sums[c] += queue.front();
+                    queue.pop_front();
+                    not_full.notify_one();
+                }
+            }));
+
+        for(int p = 0; p < producers; ++p)
+            senders.push_back(concurrency::thread([&] () {
+                gate.arrive_and_wait();
+                for(long sent = 0; sent < per_producer; ++sent) {
+                    lock_type locker(mut);
+                    not_full.wait(locker, [&] () { return queue.size() < capacity; });
+                    queue.push_back(sent);
+                    not_empty.notify_one();
+                }
+            }));
+
+        gate.arrive_and_wait();
+        bench_clock::time_point start = bench_clock::now();
+        for(int p = 0; p < producers; ++p)
+            senders[p].join();
+        {
+            lock_type locker(mut);
+            closed = true;
+        }
+        not_empty.notify_all();
+        for(int c = 0; c < consumers; ++c)
+            receivers[c].join();
+        samples.push_back(producers * per_producer / elapsed_ns(start, bench_clock::now()) * 1'000);
+    }
+
+    report("mpmc_transfer", "mutex_cv_deque", threads_num, samples, "Mmsg/s");
+}
+
+/*
+ * Other thread fulfils promise per round, main thread blocks in get();
+ * samples are ns from creation of promise until value is received.
+ */
+template<typename Promise>
+void bench_future_round_trip(const char* impl, int round_trips) {
+    std::vector<double> samples;
+    samples.reserve(round_trips);
+
+    concurrency::binary_semaphore go(0);
+    Promise* current = nullptr;
+    concurrency::thread producer([&go, &current, round_trips] () {
+        for(int i = 0; i < round_trips; ++i) {
+            go.acquire();
+            current->set_value(i);
+        }
+    });
+
+    for(int i = 0; i < round_trips; ++i) {
+        bench_clock::time_point start = bench_clock::now();
+        Promise prom;
+        auto fut = prom.get_future();
+        current = &prom;
+        go.release();
+        fut.get();
+        samples.push_back(elapsed_ns(start, bench_clock::now()));
+    }
+    producer.join();
+
+    report("future_round_trip", impl, 2, samples, "ns");
+}
+
+/*chain of inline then() continuations run by set_value, samples are ns per stage*/
+void bench_future_then_chain(int samples_num, int stages) {
+    std::vector<double> samples;
+    samples.reserve(samples_num);
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        concurrency::promise<long> prom;
+        concurrency::future<long> fut = prom.get_future();
+        for(int i = 0; i < stages; ++i)
+            fut = fut.then([] (concurrency::future<long> prev) { return prev.get() + 1; });
+
+        bench_clock::time_point start = bench_clock::now();
+        prom.set_value(0);
+        const long result = fut.get();
+        samples.push_back(elapsed_ns(start, bench_clock::now()) / stages);
+        if(result != stages)
+            std::cerr << "future_then_chain: wrong result " << result << std::endl;
+    }
+
+    report("future_then_chain", "concurrency", 1, samples, "ns/stage");
+}
+
+/*std container behind one mutex, baseline of lock-free stack and queue*/
+template<typename Container>
+class locked_container {
+
+public:
+    void push(long val) {
+        concurrency::lock_guard<concurrency::mutex> lock(m_mutex);
+        m_container.push(val);
+    }
+
+    bool try_pop(long& val) {
+        concurrency::lock_guard<concurrency::mutex> lock(m_mutex);
+        if(m_container.empty())
+            return false;
+        val = front(m_container);
+        m_container.pop();
+        return true;
+    }
+
+private:
+    static long front(const std::stack<long>& container)
+    { return container.top(); }
+
+    static long front(const std::queue<long>& container)
+    { return container.front(); }
+
+    concurrency::mutex m_mutex;
+    Container m_container;
+
+}; // class locked_container
+
+/*
+ * Every thread pushes and then pops, so container stays short and head (and tail) is contended;
+ * pops include reclamation of nodes.
+ */
+template<typename Container>
+void bench_push_pop_pairs(const char* name, const char* impl, int samples_num, int threads_num, int pairs) {
+    std::vector<double> samples;
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        Container container;
+        start_gate gate(threads_num + 1);
+        std::vector<concurrency::thread> threads;
+
+        for(int t = 0; t < threads_num; ++t)
+            threads.push_back(concurrency::thread([&container, &gate, pairs] () {
+                long val;
+                gate.arrive_and_wait();
+                for(int i = 0; i < pairs; ++i) {
+                    container.push(i);
+                    container.try_pop(val);
+                }
+            }));
+
+        gate.arrive_and_wait();
+        bench_clock::time_point start = bench_clock::now();
+        for(int t = 0; t < threads_num; ++t)
+            threads[t].join();
+        samples.push_back(static_cast<double>(threads_num) * pairs / elapsed_ns(start, bench_clock::now()) * 1'000);
+    }
+
+    report(name, impl, threads_num, samples, "Mpairs/s");
+}
+
+/*std::unordered_map behind one mutex, baseline of concurrent_hash_map*/
+class locked_hash_map {
+
+public:
+    bool find(long key, long& val) {
+        concurrency::lock_guard<concurrency::mutex> lock(m_mutex);
+        std::unordered_map<long, long>::const_iterator it = m_map.find(key);
+        if(it == m_map.end())
+            return false;
+        val = it->second;
+        return true;
+    }
+
+    template<typename Updater>
+    bool upsert(long key, Updater updater, long val) {
+        concurrency::lock_guard<concurrency::mutex> lock(m_mutex);
+        std::pair<std::unordered_map<long, long>::iterator, bool> res = m_map.emplace(key, val);
+        if(!res.second)
+            updater(res.first->second);
+        return res.second;
+    }
+
+private:
+    concurrency::mutex m_mutex;
+    std::unordered_map<long, long> m_map;
+
+}; // class locked_hash_map
+
+/*
+ * Threads look up and update keys of 64k-key map, write_percent of operations are upserts.
+ * Samples are million operations per second over all threads.
+ */
+template<typename Map>
+void bench_hash_map_mix(const char* impl, int samples_num, int threads_num, int ops, int write_percent) {
+    const long keys = 65'536;
+    std::vector<double> samples;
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        Map map;
+        for(long key = 0; key < keys; ++key)
+            map.upsert(key, [] (long&) {}, key);
+
+        start_gate gate(threads_num + 1);
+        std::vector<concurrency::thread> threads;
+        std::vector<long> sums(threads_num);
+        for(int t = 0; t < threads_num; ++t)
+            threads.push_back(concurrency::thread([&map, &gate, &sums, t, ops, write_percent, keys] () {
+                /*xorshift, so key choice costs next to nothing*/
+                unsigned long seed = 88172645463325252ul + t;
+                long val;
+                gate.arrive_and_wait();
+                for(int i = 0; i < ops; ++i) {
+                    seed ^= seed << 13;
+                    seed ^= seed >> 7;
+                    seed ^= seed << 17;
+                    const long key = static_cast<long>(seed % keys);
+                    if(static_cast<int>(seed >> 40) % 100 < write_percent)
+                        map.upsert(key, [] (long& count) { ++count; }, 0);
+                    else if(map.find(key, val))
+                        sums[t] += val;
+                }
+            }));
+
+        gate.arrive_and_wait();
+        bench_clock::time_point start = bench_clock::now();
+        for(int t = 0; t < threads_num; ++t)
+            threads[t].join();
+        samples.push_back(static_cast<double>(threads_num) * ops / elapsed_ns(start, bench_clock::now()) * 1'000);
+    }
+
+    report(write_percent == 10 ? "hash_map_90_10" : "hash_map_50_50", impl, threads_num, samples, "Mops/s");
+}
+
+/*few dozen dependent multiplications, so that iterations are not memory bound*/
+inline long mix_value(long val) {
+    unsigned long x = static_cast<unsigned long>(val) | 1;
+    for(int i = 0; i < 32; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    return static_cast<long>(x >> 1);
+}
+
+/*samples are ms per call; prepare() runs before every call and is not timed*/
+template<typename Prepare, typename Run>
+void bench_algorithm(const char* name, const std::string& impl, int threads_num, int samples_num, Prepare prepare, Run run) {
+    std::vector<double> samples;
+    for(int sample = 0; sample < samples_num; ++sample) {
+        prepare();
+        bench_clock::time_point start = bench_clock::now();
+        run();
+        samples.push_back(elapsed_ns(start, bench_clock::now()) / 1'000'000);
+    }
+    report(name, impl, threads_num, samples, "ms");
+}
+
+/*
+ * Parallel algorithms on pool of threads_num workers (plus calling thread, which helps while waiting)
+ * over 4M elements; threads_num = 0 runs sequential std:: counterparts.
+ */
+void bench_parallel_algorithms(int threads_num, int samples_num) {
+    const std::size_t size = 4'000'000;
+    std::vector<long> input(size);
+    std::mt19937_64 rng(1);
+    for(std::size_t i = 0; i < size; ++i)
+        input[i] = static_cast<long>(rng() >> 1);
+
+    std::vector<long> output(size);
+    std::vector<long> sorted;
+    long sink = 0;
+    auto nothing = [] () {};
+    auto reset_output = [&output, &input] () { output = input; };
+    auto reset_sorted = [&sorted, &input] () { sorted = input; };
+
+    if(threads_num == 0) {
+        bench_algorithm("parallel_for", "std_for_each", 1, samples_num, reset_output, [&output] () {
+            std::for_each(output.begin(), output.end(), [] (long& val) { val = mix_value(val); });
+        });
+        bench_algorithm("parallel_reduce", "std_accumulate", 1, samples_num, nothing, [&input, &sink] () {
+            sink += std::accumulate(input.begin(), input.end(), 0L);
+        });
+        bench_algorithm("parallel_transform", "std_transform", 1, samples_num, nothing, [&input, &output] () {
+            std::transform(input.begin(), input.end(), output.begin(), [] (long val) { return val / 3; });
+        });
+        bench_algorithm("parallel_scan", "std_inclusive_scan", 1, samples_num, nothing, [&input, &output] () {
+            std::inclusive_scan(input.begin(), input.end(), output.begin());
+        });
+        bench_algorithm("parallel_sort", "std_stable_sort", 1, samples_num, reset_sorted, [&sorted] () {
+            std::stable_sort(sorted.begin(), sorted.end());
+        });
+    } else {
+        concurrency::work_stealing_pool pool(threads_num);
+        bench_algorithm("parallel_for", "concurrency", threads_num, samples_num, reset_output, [&pool, &output] () {
+            concurrency::parallel_for(pool, output.begin(), output.end(), [] (long& val) { val = mix_value(val); });
+        });
+        bench_algorithm("parallel_reduce", "concurrency", threads_num, samples_num, nothing, [&pool, &input, &sink] () {
+            sink += concurrency::parallel_reduce(pool, input.begin(), input.end(), 0L, std::plus<long>());
+        });
+        bench_algorithm("parallel_transform", "concurrency", threads_num, samples_num, nothing, [&pool, &input, &output] () {
+            concurrency::parallel_transform(pool, input.begin(), input.end(), output.begin(), [] (long val) { return val / 3; });
+        });
+        bench_algorithm("parallel_scan", "concurrency", threads_num, samples_num, nothing, [&pool, &input, &output] () {
+            concurrency::parallel_scan(pool, input.begin(), input.end(), output.begin(), std::plus<long>());
+        });
+        bench_algorithm("parallel_sort", "concurrency", threads_num, samples_num, reset_sorted, [&pool, &sorted] () {
+            concurrency::parallel_sort(pool, sorted.begin(), sorted.end(), std::less<long>());
+        });
+    }
+
+    if(sink == 42)
+        std::cerr << "parallel_reduce: unlikely sum" << std::endl;
+}
+
+/*usual timer queue: ordered map under one mutex, handle is map iterator*/
+class locked_timer_queue {
+
+public:
+    typedef std::multimap<std::chrono::steady_clock::time_point, std::function<void()> >::iterator handle;
+
+    template<typename Callable>
+    handle schedule_after(std::chrono::steady_clock::duration delay, Callable callb) {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        return m_timers.emplace(std::chrono::steady_clock::now() + delay, std::move(callb));
+    }
+
+    void cancel(handle timer) {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_timers.erase(timer);
+    }
+
+private:
+    std::mutex m_mutex;
+    std::multimap<std::chrono::steady_clock::time_point, std::function<void()> > m_timers;
+
+}; // class locked_timer_queue
+
+inline bool cancel_timer(concurrency::timer_service&, concurrency::timer_handle& timer)
+{ return timer.cancel(); }
+
+inline bool cancel_timer(locked_timer_queue& queue, locked_timer_queue::handle& timer) {
+    queue.cancel(timer);
+    return true;
+}
+
+/*every thread arms its timers (1s..1min ahead), then cancels all of them; Mops/s of arm and cancel*/
+template<typename Service, typename Handle>
+void bench_timer_arm_cancel(const char* impl, int samples_num, int threads_num, int timers_per_thread) {
+    std::vector<double> samples;
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        Service service;
+        start_gate gate(threads_num + 1);
+        std::vector<concurrency::thread> threads;
+        for(int t = 0; t < threads_num; ++t)
+            threads.push_back(concurrency::thread([&service, &gate, t, timers_per_thread] () {
+                std::vector<Handle> handles;
+                handles.reserve(timers_per_thread);
+                unsigned long seed = 88172645463325252ul + t;
+                gate.arrive_and_wait();
+                for(int i = 0; i < timers_per_thread; ++i) {
+                    seed ^= seed << 13;
+                    seed ^= seed >> 7;
+                    seed ^= seed << 17;
+                    handles.push_back(service.schedule_after(
+                        std::chrono::milliseconds(1'000 + seed % 59'000), [] () {}
+                    ));
+                }
+                for(int i = 0; i < timers_per_thread; ++i)
+                    cancel_timer(service, handles[i]);
+            }));
+
+        gate.arrive_and_wait();
+        bench_clock::time_point start = bench_clock::now();
+        for(int t = 0; t < threads_num; ++t)
+            threads[t].join();
+        samples.push_back(2.0 * threads_num * timers_per_thread / elapsed_ns(start, bench_clock::now()) * 1'000);
+    }
+
+    report("timer_arm_cancel", impl, threads_num, samples, "Mops/s");
+}
+
+/*timers spread over one second all fire; samples are delays past deadline in us*/
+void bench_timer_lateness(int timers_num) {
+    std::vector<double> samples(timers_num);
+    std::atomic<int> fired(0);
+    {
+        concurrency::timer_service service;
+        const std::chrono::steady_clock::time_point base = std::chrono::steady_clock::now();
+        for(int i = 0; i < timers_num; ++i) {
+            const std::chrono::steady_clock::time_point deadline =
+                base + std::chrono::microseconds(100'000 + 1'000'000L * i / timers_num);
+            service.schedule_at(deadline, [&samples, &fired, deadline, i] () {
+                samples[i] = elapsed_ns(deadline, std::chrono::steady_clock::now()) / 1'000;
+                ++fired;
+            });
+        }
+        while(fired < timers_num)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    report("timer_lateness", "timer_service", 1, samples, "us");
+}
+
+/*counter of main.cpp: every increment under one mutex*/
+class locked_counter {
+
+public:
+    locked_counter(): m_value(0) {}
+
+    void increment() {
+        concurrency::lock_guard<concurrency::mutex> locker(m_mutex);
+        ++m_value;
+    }
+
+private:
+    concurrency::mutex m_mutex;
+    long m_value;
+
+}; // class locked_counter
+
+/*single shared atomic, every increment bounces the same line*/
+class atomic_counter {
+
+public:
+    atomic_counter(): m_value(0) {}
+
+    void increment()
+    { m_value.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    std::atomic<long> m_value;
+
+}; // class atomic_counter
+
+/*threads only increment (metrics pattern), samples are total Mops/s*/
+template<typename Counter>
+void bench_counter_increment(const char* impl, int samples_num, int threads_num, int iterations) {
+    std::vector<double> samples;
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        Counter counter;
+        start_gate gate(threads_num + 1);
+        std::vector<concurrency::thread> threads;
+        for(int t = 0; t < threads_num; ++t)
+            threads.push_back(concurrency::thread([&counter, &gate, iterations] () {
+                gate.arrive_and_wait();
+                for(int i = 0; i < iterations; ++i)
+                    counter.increment();
+            }));
+
+        gate.arrive_and_wait();
+        bench_clock::time_point start = bench_clock::now();
+        for(int t = 0; t < threads_num; ++t)
+            threads[t].join();
+        samples.push_back(static_cast<double>(threads_num) * iterations / elapsed_ns(start, bench_clock::now()) * 1'000);
+    }
+
+    report("counter_increment", impl, threads_num, samples, "Mops/s");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if(selected(argc, argv, "uncontended_lock_unlock")) {
+        bench_uncontended<concurrency_primitives>(50, 1'000'000);
+        bench_uncontended<futex_primitives>(50, 1'000'000);
+        bench_uncontended<std_primitives>(50, 1'000'000);
+    }
+
+    if(selected(argc, argv, "contended_increment")) {
+        for(int threads_num = 2; threads_num <= 16; threads_num *= 2) {
+            bench_contended_increment<concurrency_primitives>(10, threads_num, 1'000'000 / threads_num);
+            bench_contended_increment<futex_primitives>(10, threads_num, 1'000'000 / threads_num);
+            bench_contended_increment<std_primitives>(10, threads_num, 1'000'000 / threads_num);
+        }
+    }
+
+    /*
+     * Spinning waiters hold their cpu, so threads are capped by cores: once lock holder or
+     * next in FIFO order is preempted, every waiter stalls for whole time slices.
+     */
+    if(selected(argc, argv, "spin_lock_increment")) {
+        const int cores = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+        for(int threads_num = 1; threads_num <= cores; threads_num *= 2) {
+            const int iterations = 1'000'000 / threads_num;
+            bench_spin_lock_kind<concurrency::ttas_lock>(threads_num, iterations);
+            bench_spin_lock_kind<concurrency::ticket_lock>(threads_num, iterations);
+            bench_spin_lock_kind<concurrency::mcs_lock>(threads_num, iterations);
+            bench_spin_lock_kind<concurrency::clh_lock>(threads_num, iterations);
+            bench_contended_increment<concurrency_primitives>(10, threads_num, iterations, "spin_lock_increment");
+            bench_contended_increment<futex_primitives>(10, threads_num, iterations, "spin_lock_increment");
+        }
+    }
+
+    if(selected(argc, argv, "cv_ping_pong_round_trip")) {
+        bench_ping_pong<concurrency_primitives>(50'000);
+        bench_ping_pong<futex_primitives>(50'000);
+        bench_ping_pong<std_primitives>(50'000);
+    }
+
+    if(selected(argc, argv, "semaphore_ping_pong_round_trip"))
+        bench_semaphore_ping_pong(50'000);
+
+    if(selected(argc, argv, "notify_all_fan_out")) {
+        for(int waiters_num = 4; waiters_num <= 64; waiters_num *= 4) {
+            bench_notify_all_fan_out<concurrency_primitives>(waiters_num, 2'000);
+            bench_notify_all_fan_out<futex_primitives>(waiters_num, 2'000);
+            bench_notify_all_fan_out<std_primitives>(waiters_num, 2'000);
+        }
+    }
+
+    if(selected(argc, argv, "spsc_transfer")) {
+        bench_spsc_transfer<concurrency::spsc_mode::polling>(10, 10'000'000, 1);
+        bench_spsc_transfer<concurrency::spsc_mode::polling>(10, 10'000'000, 64);
+        bench_spsc_transfer<concurrency::spsc_mode::blocking>(10, 10'000'000, 1);
+        bench_spsc_transfer<concurrency::spsc_mode::blocking>(10, 10'000'000, 64);
+        bench_locked_queue_transfer(10, 1'000'000);
+    }
+
+    if(selected(argc, argv, "mpmc_transfer")) {
+        for(int threads_num = 4; threads_num <= 64; threads_num *= 4) {
+            bench_channel_transfer(10, threads_num, 1'000'000, 1);
+            bench_channel_transfer(10, threads_num, 1'000'000, 32);
+            bench_locked_deque_transfer(10, threads_num, 1'000'000);
+        }
+    }
+
+    if(selected(argc, argv, "future_round_trip")) {
+        bench_future_round_trip<concurrency::promise<int> >("concurrency", 50'000);
+        bench_future_round_trip<std::promise<int> >("std", 50'000);
+    }
+
+    if(selected(argc, argv, "future_then_chain"))
+        bench_future_then_chain(50, 10'000);
+
+    if(selected(argc, argv, "lock_free_stack")) {
+        for(int threads_num : {1, 4, 16, 64}) {
+            const int pairs = 400'000 / threads_num;
+            bench_push_pop_pairs<concurrency::lock_free_stack<long, concurrency::reclamation::hazard_pointers> >(
+                "lock_free_stack", "hazard_pointers", 10, threads_num, pairs);
+            bench_push_pop_pairs<concurrency::lock_free_stack<long, concurrency::reclamation::epoch> >(
+                "lock_free_stack", "epoch", 10, threads_num, pairs);
+            bench_push_pop_pairs<locked_container<std::stack<long> > >(
+                "lock_free_stack", "mutex_std_stack", 10, threads_num, pairs);
+        }
+    }
+
+    if(selected(argc, argv, "lock_free_queue")) {
+        for(int threads_num : {1, 4, 16, 64}) {
+            const int pairs = 400'000 / threads_num;
+            bench_push_pop_pairs<concurrency::lock_free_queue<long, concurrency::reclamation::hazard_pointers> >(
+                "lock_free_queue", "hazard_pointers", 10, threads_num, pairs);
+            bench_push_pop_pairs<concurrency::lock_free_queue<long, concurrency::reclamation::epoch> >(
+                "lock_free_queue", "epoch", 10, threads_num, pairs);
+            bench_push_pop_pairs<locked_container<std::queue<long> > >(
+                "lock_free_queue", "mutex_std_queue", 10, threads_num, pairs);
+        }
+    }
+
+    for(int write_percent : {10, 50}) {
+        if(!selected(argc, argv, write_percent == 10 ? "hash_map_90_10" : "hash_map_50_50"))
+            continue;
+        for(int threads_num : {1, 4, 16, 64}) {
+            const int ops = 1'600'000 / threads_num;
+            bench_hash_map_mix<concurrency::concurrent_hash_map<long, long> >("concurrent_hash_map", 10, threads_num, ops, write_percent);
+            bench_hash_map_mix<locked_hash_map>("mutex_unordered_map", 10, threads_num, ops, write_percent);
+        }
+    }
+
+    if(selected(argc, argv, "parallel_for") || selected(argc, argv, "parallel_reduce") ||
+        selected(argc, argv, "parallel_transform") || selected(argc, argv, "parallel_scan") ||
+        selected(argc, argv, "parallel_sort")) {
+        for(int threads_num : {0, 1, 2, 4, 8, 16})
+            bench_parallel_algorithms(threads_num, 10);
+    }
+
+    if(selected(argc, argv, "timer_arm_cancel")) {
+        for(int threads_num = 1; threads_num <= 8; threads_num *= 2) {
+            bench_timer_arm_cancel<concurrency::timer_service, concurrency::timer_handle>(
+                "timer_service", 5, threads_num, 1'000'000 / threads_num);
+            bench_timer_arm_cancel<locked_timer_queue, locked_timer_queue::handle>(
+                "mutex_multimap", 5, threads_num, 1'000'000 / threads_num);
+        }
+    }
+
+    if(selected(argc, argv, "timer_lateness"))
+        bench_timer_lateness(1'000'000);
+
+    if(selected(argc, argv, "counter_increment")) {
+        for(int threads_num = 1; threads_num <= 64; threads_num *= 2) {
+            bench_counter_increment<locked_counter>("mutex", 5, threads_num, 2'000'000 / threads_num);
+            bench_counter_increment<atomic_counter>("atomic", 5, threads_num, 2'000'000 / threads_num);
+            bench_counter_increment<concurrency::sharded_counter<long> >("sharded_counter", 5, threads_num, 2'000'000 / threads_num);
+        }
+    }
+
+    if(selected(argc, argv, "barrier_phase")) {
+        for(int threads_num = 4; threads_num <= 64; threads_num *= 4) {
+            bench_barrier_phases(concurrency::barrier_mode::central, threads_num - 1, 2'000);
+            bench_barrier_phases(concurrency::barrier_mode::combining_tree, threads_num - 1, 2'000);
+        }
+    }
+
+    if(selected(argc, argv, "thread_spawn_join")) {
+        bench_spawn_join<concurrency_primitives>(20'000);
+        bench_spawn_join<std_primitives>(20'000);
+    }
+
+    /*write_every = 0 - readers only, 100 - one write per 100 lookups*/
+    for(int write_every : {0, 100}) {
+        if(!selected(argc, argv, write_every ? "read_mostly_lookup" : "read_only_lookup"))
+            continue;
+        for(int threads_num : {1, 8, 32, 64}) {
+            const int lookups = 1'600'000 / threads_num;
+            bench_read_mostly<concurrency_shared_table>(10, threads_num, lookups, write_every);
+            bench_read_mostly<big_reader_table>(10, threads_num, lookups, write_every);
+            bench_read_mostly<std_shared_table>(10, threads_num, lookups, write_every);
+            bench_read_mostly<exclusive_table>(10, threads_num, lookups, write_every);
+        }
+    }
+}
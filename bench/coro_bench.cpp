@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+
+#include "thread.hpp"
+#include "mutex.hpp"
+#include "work_stealing_pool.hpp"
+#include "task.hpp"
+#include "async_mutex.hpp"
+
+#include "bench_util.hpp"
+
+/*
+ * Many concurrent request flows, each taking shared lock for every step and
+ * giving up cpu between steps: coroutines on work_stealing_pool with async_mutex
+ * against thread per flow with mutex.
+ * Usage: coro_bench [benchmark name substring...]
+ * Output: JSON object per line (see bench_util.hpp), samples are ns per step of flow.
+ */
+
+namespace {
+
+using namespace concurrency::bench;
+
+concurrency::task<void> coroutine_flow(
+    concurrency::work_stealing_pool& pool, concurrency::async_mutex& mut, long* counter, int steps
+) {
+    co_await concurrency::schedule(pool);
+    for(int i = 0; i < steps; ++i) {
+        {
+            concurrency::async_lock_guard guard = co_await mut.scoped_lock();
+            ++*counter;
+        }
+        co_await concurrency::schedule(pool);
+    }
+}
+
+void bench_coroutine_flows(int samples_num, int flows, int steps) {
+    const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    concurrency::work_stealing_pool pool(cores);
+    std::vector<double> samples;
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        concurrency::async_mutex mut;
+        long counter = 0;
+        std::vector<concurrency::future<void> > results;
+        results.reserve(flows);
+
+        bench_clock::time_point start = bench_clock::now();
+        for(int i = 0; i < flows; ++i)
+            results.push_back(concurrency::spawn(pool, coroutine_flow(pool, mut, &counter, steps)));
+        concurrency::when_all(results.begin(), results.end()).get();
+        samples.push_back(elapsed_ns(start, bench_clock::now()) / (static_cast<double>(flows) * steps));
+
+        if(counter != static_cast<long>(flows) * steps)
+            std::cerr << "coroutine_flows: wrong counter " << counter << std::endl;
+    }
+
+    report("request_flows", "coroutine_async_mutex", flows, samples, "ns/step");
+}
+
+void bench_thread_flows(int samples_num, int flows, int steps) {
+    std::vector<double> samples;
+
+    for(int sample = 0; sample < samples_num; ++sample) {
+        concurrency::mutex mut;
+        long counter = 0;
+        start_gate gate(flows + 1);
+        std::vector<concurrency::thread> threads;
+        threads.reserve(flows);
+
+        for(int i = 0; i < flows; ++i)
+            threads.emplace_back([&mut, &counter, &gate, steps] () {
+                gate.arrive_and_wait();
+                for(int step = 0; step < steps; ++step) {
+                    {
+                        concurrency::lock_guard<concurrency::mutex> locker(mut);
+                        ++counter;
+                    }
+                    sched_yield();
+                }
+            });
+
+        bench_clock::time_point start = bench_clock::now();
+        gate.arrive_and_wait();
+        for(std::size_t i = 0; i < threads.size(); ++i)
+            threads[i].join();
+        samples.push_back(elapsed_ns(start, bench_clock::now()) / (static_cast<double>(flows) * steps));
+
+        if(counter != static_cast<long>(flows) * steps)
+            std::cerr << "thread_flows: wrong counter " << counter << std::endl;
+    }
+
+    report("request_flows", "thread_mutex", flows, samples, "ns/step");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if(selected(argc, argv, "request_flows")) {
+        for(int flows : {100, 1'000, 10'000}) {
+            const int steps = 1'000'000 / flows;
+            bench_coroutine_flows(5, flows, steps);
+            /*thread per flow stops being practical well before tens of thousands*/
+            if(flows <= 1'000)
+                bench_thread_flows(5, flows, steps);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include "thread.hpp"
+#include "mutex.hpp"
+#include "futex_mutex.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock;
+
+volatile long val = 0;
+
+template<typename Mutex_T>
+void incr_func(Mutex_T* mut, int amount) {
+    int tmp;
+    while (amount-- > 0) {
+        concurrency::lock_guard<Mutex_T> locker(*mut);
+        // some redundant work
+        tmp = val + 1;
+        tmp--;
+        val = tmp + 1;
+    }
+}
+
+template<typename Mutex_T>
+double uncontended_ns_per_op(int iterations) {
+    Mutex_T mut;
+
+    bench_clock::time_point start = bench_clock::now();
+    incr_func(&mut, iterations);
+    bench_clock::time_point end = bench_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+template<typename Mutex_T>
+double contended_ns_per_op(int threads_num, int iterations) {
+    Mutex_T mut;
+    std::vector<concurrency::thread> workers;
+
+    bench_clock::time_point start = bench_clock::now();
+    for(int i = 0; i < threads_num; ++i)
+        workers.push_back(concurrency::thread(incr_func<Mutex_T>, &mut, iterations));
+    for(int i = 0; i < threads_num; ++i)
+        workers[i].join();
+    bench_clock::time_point end = bench_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / (threads_num * iterations);
+}
+
+template<typename Mutex_T>
+void report(const char* name, int iterations) {
+    std::cout << name << "\tuncontended " << uncontended_ns_per_op<Mutex_T>(iterations) << " ns/op";
+    for(int threads_num = 2; threads_num <= 8; threads_num *= 2)
+        std::cout << "\t" << threads_num << " threads "
+            << contended_ns_per_op<Mutex_T>(threads_num, iterations / threads_num) << " ns/op";
+    std::cout << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int iterations = 2'000'000;
+
+    report<concurrency::mutex>("mutex      ", iterations);
+    report<concurrency::futex_mutex>("futex_mutex", iterations);
+    report<std::mutex>("std::mutex ", iterations);
+}
@@ -0,0 +1,66 @@
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "thread.hpp"
+#include "mutex.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock;
+
+long val = 0;
+concurrency::mutex val_mutex;
+
+/*small task, as in incr_func of main.cpp*/
+void small_task(int amount) {
+    while (amount-- > 0) {
+        concurrency::lock_guard<concurrency::mutex> locker(val_mutex);
+        ++val;
+    }
+}
+
+double pool_tasks_per_sec(unsigned int threads_num, int tasks_num, int amount) {
+    concurrency::thread_pool pool(threads_num);
+
+    bench_clock::time_point start = bench_clock::now();
+    for(int i = 0; i < tasks_num; ++i)
+        pool.submit(small_task, amount);
+    pool.wait_idle();
+    bench_clock::time_point end = bench_clock::now();
+
+    return tasks_num / std::chrono::duration<double>(end - start).count();
+}
+
+/*at most threads_num threads alive at once, each runs single task*/
+double thread_per_task_tasks_per_sec(unsigned int threads_num, int tasks_num, int amount) {
+    std::vector<concurrency::thread> workers;
+    workers.reserve(threads_num);
+
+    bench_clock::time_point start = bench_clock::now();
+    for(int i = 0; i < tasks_num; i += threads_num) {
+        for(int j = 0; j < static_cast<int>(threads_num) && i + j < tasks_num; ++j)
+            workers.push_back(concurrency::thread(small_task, amount));
+        for(unsigned int j = 0; j < workers.size(); ++j)
+            workers[j].join();
+        workers.clear();
+    }
+    bench_clock::time_point end = bench_clock::now();
+
+    return tasks_num / std::chrono::duration<double>(end - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int tasks_num = 100'000;
+    const int amount = 10;
+
+    for(unsigned int threads_num = 1; threads_num <= 8; threads_num *= 2) {
+        std::cout << threads_num << " threads"
+            << "\tthread_pool " << pool_tasks_per_sec(threads_num, tasks_num, amount) << " tasks/s"
+            << "\tthread per task " << thread_per_task_tasks_per_sec(threads_num, tasks_num, amount) << " tasks/s"
+            << std::endl;
+    }
+}
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "thread.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock;
+
+typedef std::array<char, 4096> large_payload;
+
+void take_small(int* out, int val)
+{ *out = val; }
+
+void take_large(int* out, large_payload payload)
+{ *out = payload[0]; }
+
+void take_buffer(int* out, std::unique_ptr<std::vector<char>> buffer)
+{ *out = (*buffer)[0]; }
+
+/*spawn+join latency percentiles in microseconds*/
+template<typename Spawn>
+void report(const char* name, int iterations, Spawn spawn) {
+    std::vector<double> latencies;
+    latencies.reserve(iterations);
+
+    for(int i = 0; i < iterations; ++i) {
+        bench_clock::time_point start = bench_clock::now();
+        spawn();
+        bench_clock::time_point end = bench_clock::now();
+        latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << name
+        << "\tp50 " << latencies[iterations / 2] << " us"
+        << "\tp99 " << latencies[iterations * 99 / 100] << " us"
+        << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int iterations = 20'000;
+    int out = 0;
+    large_payload payload = large_payload();
+
+    report("concurrency::thread small args ", iterations, [&out] () {
+        concurrency::thread tr(take_small, &out, 1);
+        tr.join();
+    });
+    report("std::thread small args         ", iterations, [&out] () {
+        std::thread tr(take_small, &out, 1);
+        tr.join();
+    });
+
+    report("concurrency::thread 4KB arg    ", iterations, [&out, &payload] () {
+        concurrency::thread tr(take_large, &out, payload);
+        tr.join();
+    });
+    report("std::thread 4KB arg            ", iterations, [&out, &payload] () {
+        std::thread tr(take_large, &out, payload);
+        tr.join();
+    });
+
+    report("concurrency::thread move-only  ", iterations, [&out] () {
+        concurrency::thread tr(take_buffer, &out, std::unique_ptr<std::vector<char>>(new std::vector<char>(64)));
+        tr.join();
+    });
+    report("std::thread move-only          ", iterations, [&out] () {
+        std::thread tr(take_buffer, &out, std::unique_ptr<std::vector<char>>(new std::vector<char>(64)));
+        tr.join();
+    });
+}
@@ -0,0 +1,87 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+#include "thread.hpp"
+#include "thread_pool.hpp"
+#include "work_stealing_pool.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock bench_clock;
+
+/*below cutoff recursion runs sequentially, as fork/join code usually does*/
+const int sequential_cutoff = 18;
+
+long fib(int n) {
+    return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+long fork_join_fib(concurrency::work_stealing_pool* pool, int n) {
+    if(n < sequential_cutoff)
+        return fib(n);
+
+    std::atomic<bool> forked_done(false);
+    long forked_result = 0;
+    pool->submit([pool, n, &forked_result, &forked_done] () {
+        forked_result = fork_join_fib(pool, n - 1);
+        forked_done.store(true, std::memory_order_release);
+    });
+
+    long result = fork_join_fib(pool, n - 2);
+    pool->run_until([&forked_done] () { return forked_done.load(std::memory_order_acquire); });
+    return result + forked_result;
+}
+
+double fork_join_seconds(unsigned int threads_num, int n) {
+    concurrency::work_stealing_pool pool(threads_num);
+    long result = 0;
+
+    bench_clock::time_point start = bench_clock::now();
+    pool.submit([&pool, &result, n] () { result = fork_join_fib(&pool, n); });
+    pool.wait_idle();
+    bench_clock::time_point end = bench_clock::now();
+
+    if(result != fib(n))
+        std::cerr << "fork_join_fib: wrong result" << std::endl;
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/*tasks spawned from tasks: per-worker deques against single shared queue*/
+template<typename Pool_T>
+double spawn_tasks_per_sec(unsigned int threads_num, int tasks_num) {
+    Pool_T pool(threads_num);
+    std::atomic<long> sum(0);
+
+    bench_clock::time_point start = bench_clock::now();
+    for(unsigned int i = 0; i < threads_num; ++i)
+        pool.submit([&pool, &sum, tasks_num, threads_num] () {
+            for(unsigned int j = 0; j < tasks_num / threads_num; ++j)
+                pool.submit([&sum] () { sum.fetch_add(1, std::memory_order_relaxed); });
+        });
+    pool.wait_idle();
+    bench_clock::time_point end = bench_clock::now();
+
+    return tasks_num / std::chrono::duration<double>(end - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int fib_n = 38;
+    const int tasks_num = 1'000'000;
+
+    bench_clock::time_point start = bench_clock::now();
+    fib(fib_n);
+    const double sequential = std::chrono::duration<double>(bench_clock::now() - start).count();
+    std::cout << "fib(" << fib_n << ") sequential " << sequential << " s" << std::endl;
+
+    for(unsigned int threads_num = 1; threads_num <= 16; threads_num *= 2) {
+        const double parallel = fork_join_seconds(threads_num, fib_n);
+        std::cout << threads_num << " threads"
+            << "\tfork/join " << parallel << " s (speedup " << sequential / parallel << ")"
+            << "\twork_stealing_pool " << spawn_tasks_per_sec<concurrency::work_stealing_pool>(threads_num, tasks_num) << " tasks/s"
+            << "\tthread_pool " << spawn_tasks_per_sec<concurrency::thread_pool>(threads_num, tasks_num) << " tasks/s"
+            << std::endl;
+    }
+}
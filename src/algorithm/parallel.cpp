@@ -0,0 +1,12 @@
+#include "parallel.hpp"
+
+#include <thread>
+
+namespace concurrency {
+
+work_stealing_pool& default_parallel_pool() {
+    static work_stealing_pool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+} // namespace concurrency
@@ -0,0 +1,427 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "work_stealing_pool.hpp"
+
+namespace concurrency {
+
+/*
+ * Pool of hardware_concurrency workers used by algorithms called without pool,
+ * created on first use and joined at program exit.
+ */
+work_stealing_pool&
+default_parallel_pool();
+
+namespace detail {
+
+/*
+ * Tasks forked by one algorithm call (or one level of it) and first exception they threw.
+ * Waiting thread runs pool's tasks meanwhile, so algorithms may be called from pool's tasks too.
+ */
+class fork_join {
+
+public:
+    explicit fork_join(work_stealing_pool& pool):
+        m_pool(pool),
+        m_pending(0),
+        m_failed(false)
+    {}
+
+    fork_join(const fork_join& other) = delete;
+    fork_join& operator=(const fork_join& other) = delete;
+
+    /*forked tasks may refer to state of caller, they are finished before it is destroyed*/
+    ~fork_join()
+    { wait(); }
+
+    work_stealing_pool&
+    pool() const
+    { return m_pool; }
+
+    bool failed() const
+    { return m_failed.load(std::memory_order_relaxed); }
+
+    template<typename Callable>
+    void fork(Callable callb) {
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+        try {
+            m_pool.submit([this, callb] () {
+                run(callb);
+                m_pending.fetch_sub(1, std::memory_order_release);
+            });
+        } catch(...) {
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+    }
+
+    /*runs callb on calling thread, exception is kept as if it came from forked task*/
+    template<typename Callable>
+    void run(const Callable& callb) noexcept {
+        if(failed())
+            return;
+        try {
+            callb();
+        } catch(...) {
+            if(!m_failed.exchange(true, std::memory_order_relaxed))
+                m_error = std::current_exception();
+        }
+    }
+
+    void wait()
+    { m_pool.run_until([this] () { return m_pending.load(std::memory_order_acquire) == 0; }); }
+
+    /*waits for forked tasks, rethrows first exception*/
+    void join() {
+        wait();
+        if(m_error)
+            std::rethrow_exception(m_error);
+    }
+
+private:
+    work_stealing_pool& m_pool;
+    std::atomic<long> m_pending;
+    std::atomic<bool> m_failed;
+    std::exception_ptr m_error;
+
+}; // class fork_join
+
+/*
+ * Smallest range worth forking: keeps number of tasks within few dozens per worker
+ * even when idle workers steal everything at once.
+ */
+inline std::size_t min_split(const work_stealing_pool& pool, std::size_t size)
+{ return std::max<std::size_t>(1, size / (std::max(1u, pool.size()) * 64)); }
+
+/*
+ * Lazy binary splitting: body(begin, end) runs on consecutive pieces of range, and before each piece
+ * half of what is left is forked if deque of running worker is empty (earlier half was stolen
+ * or there was none). Pieces grow from 1 up to split limit, so checks cost little for cheap
+ * iterations while expensive ones are still handed out one by one.
+ */
+template<typename Body>
+void for_each_piece(fork_join& job, std::size_t begin, std::size_t end, std::size_t split, const Body& body) {
+    std::size_t piece = 1;
+    while(begin < end && !job.failed()) {
+        if(end - begin >= 2 * split && job.pool().local_queue_empty()) {
+            const std::size_t middle = begin + (end - begin) / 2;
+            job.fork([&job, middle, end, split, &body] () { for_each_piece(job, middle, end, split, body); });
+            end = middle;
+            continue;
+        }
+
+        const std::size_t stop = begin + std::min(piece, end - begin);
+        body(begin, stop);
+        begin = stop;
+        piece = std::min(piece * 2, split);
+    }
+}
+
+template<typename Body>
+void parallel_pieces(work_stealing_pool& pool, std::size_t size, const Body& body) {
+    fork_join job(pool);
+    job.run([&job, &pool, size, &body] () { for_each_piece(job, 0, size, min_split(pool, size), body); });
+    job.join();
+}
+
+/*
+ * Same splitting, piece(begin, end) returns partial result. Forked halves are combined in order
+ * of their ranges, so combine has to be associative only.
+ */
+template<typename T, typename Piece, typename Combine>
+T reduce_pieces(work_stealing_pool& pool, std::size_t begin, std::size_t end, std::size_t split, const Piece& piece_of, const Combine& combine) {
+    /*results of forked halves, rightmost first; joined before they go away*/
+    std::deque<std::optional<T> > forked;
+    fork_join children(pool);
+
+    std::optional<T> acc;
+    std::size_t piece = 1;
+    while(begin < end) {
+        if(end - begin >= 2 * split && pool.local_queue_empty()) {
+            const std::size_t middle = begin + (end - begin) / 2;
+            std::optional<T>& result = forked.emplace_back();
+            children.fork([&pool, &result, middle, end, split, &piece_of, &combine] () {
+                result.emplace(reduce_pieces<T>(pool, middle, end, split, piece_of, combine));
+            });
+            end = middle;
+            continue;
+        }
+
+        const std::size_t stop = begin + std::min(piece, end - begin);
+        if(acc)
+            acc.emplace(combine(std::move(*acc), piece_of(begin, stop)));
+        else
+            acc.emplace(piece_of(begin, stop));
+        begin = stop;
+        piece = std::min(piece * 2, split);
+    }
+
+    children.join();
+    for(typename std::deque<std::optional<T> >::reverse_iterator it = forked.rbegin(); it != forked.rend(); ++it)
+        acc.emplace(combine(std::move(*acc), std::move(**it)));
+    return std::move(*acc);
+}
+
+template<typename Iterator>
+void require_random_access() {
+    static_assert(
+        std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value,
+        "parallel algorithms require random access iterators"
+    );
+}
+
+} // namespace detail
+
+/*
+ * Calls f(i) for every index of [first, last), or f(*it) for every element of iterator range,
+ * on workers of pool and on calling thread; returns when all calls are done.
+ * First exception thrown by f is rethrown, remaining calls may then be skipped.
+ */
+template<typename IndexOrIterator, typename Function>
+void parallel_for(work_stealing_pool& pool, IndexOrIterator first, IndexOrIterator last, Function f) {
+    if(!(first < last))
+        return;
+
+    if constexpr(std::is_integral<IndexOrIterator>::value) {
+        detail::parallel_pieces(pool, static_cast<std::size_t>(last - first), [first, &f] (std::size_t begin, std::size_t end) {
+            for(std::size_t i = begin; i < end; ++i)
+                f(static_cast<IndexOrIterator>(first + i));
+        });
+    }
+    else {
+        detail::require_random_access<IndexOrIterator>();
+        detail::parallel_pieces(pool, static_cast<std::size_t>(last - first), [first, &f] (std::size_t begin, std::size_t end) {
+            for(IndexOrIterator it = first + begin; it != first + end; ++it)
+                f(*it);
+        });
+    }
+}
+
+template<typename IndexOrIterator, typename Function>
+void parallel_for(IndexOrIterator first, IndexOrIterator last, Function f)
+{ parallel_for(default_parallel_pool(), first, last, f); }
+
+/*
+ * init combined with all elements by op in unspecified grouping, but in order of elements:
+ * op has to be associative, not commutative.
+ */
+template<typename RandomIt, typename T, typename BinaryOp>
+T parallel_reduce(work_stealing_pool& pool, RandomIt first, RandomIt last, T init, BinaryOp op) {
+    detail::require_random_access<RandomIt>();
+    if(first == last)
+        return init;
+
+    const std::size_t size = last - first;
+    T total = detail::reduce_pieces<T>(pool, 0, size, detail::min_split(pool, size),
+        [first, &op] (std::size_t begin, std::size_t end) {
+            T acc = first[begin];
+            for(std::size_t i = begin + 1; i < end; ++i)
+                acc = op(std::move(acc), first[i]);
+            return acc;
+        },
+        op
+    );
+    return op(std::move(init), std::move(total));
+}
+
+template<typename RandomIt, typename T, typename BinaryOp>
+T parallel_reduce(RandomIt first, RandomIt last, T init, BinaryOp op)
+{ return parallel_reduce(default_parallel_pool(), first, last, std::move(init), op); }
+
+template<typename RandomIt, typename T>
+T parallel_reduce(RandomIt first, RandomIt last, T init)
+{ return parallel_reduce(default_parallel_pool(), first, last, std::move(init), std::plus<T>()); }
+
+/*d_first[i] = op(first[i]), output range may be input range*/
+template<typename RandomIt, typename OutputIt, typename UnaryOp>
+OutputIt parallel_transform(work_stealing_pool& pool, RandomIt first, RandomIt last, OutputIt d_first, UnaryOp op) {
+    detail::require_random_access<RandomIt>();
+    detail::require_random_access<OutputIt>();
+
+    const std::size_t size = last - first;
+    detail::parallel_pieces(pool, size, [first, d_first, &op] (std::size_t begin, std::size_t end) {
+        for(std::size_t i = begin; i < end; ++i)
+            d_first[i] = op(first[i]);
+    });
+    return d_first + size;
+}
+
+template<typename RandomIt, typename OutputIt, typename UnaryOp>
+OutputIt parallel_transform(RandomIt first, RandomIt last, OutputIt d_first, UnaryOp op)
+{ return parallel_transform(default_parallel_pool(), first, last, d_first, op); }
+
+/*
+ * Inclusive scan: d_first[i] = first[0] op ... op first[i], op has to be associative.
+ * Two passes over blocks: sums of blocks, their prefix on calling thread, then scan of every block
+ * starting from prefix of blocks before it. Output range may be input range.
+ */
+template<typename RandomIt, typename OutputIt, typename BinaryOp>
+OutputIt parallel_scan(work_stealing_pool& pool, RandomIt first, RandomIt last, OutputIt d_first, BinaryOp op) {
+    detail::require_random_access<RandomIt>();
+    detail::require_random_access<OutputIt>();
+    typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+
+    const std::size_t size = last - first;
+    if(size == 0)
+        return d_first;
+
+    /*few blocks per worker, so that blocks are balanced by splitting too*/
+    const std::size_t block = std::max<std::size_t>(1024, size / (std::max(1u, pool.size()) * 8));
+    const std::size_t blocks = (size + block - 1) / block;
+
+    std::vector<std::optional<value_type> > prefix(blocks);
+    parallel_for(pool, std::size_t(1), blocks, [first, size, block, &op, &prefix] (std::size_t b) {
+        /*sum of block b - 1 is prefix of block b*/
+        const std::size_t end = std::min(size, b * block);
+        value_type acc = first[(b - 1) * block];
+        for(std::size_t i = (b - 1) * block + 1; i < end; ++i)
+            acc = op(std::move(acc), first[i]);
+        prefix[b].emplace(std::move(acc));
+    });
+    for(std::size_t b = 2; b < blocks; ++b)
+        prefix[b].emplace(op(*prefix[b - 1], std::move(*prefix[b])));
+
+    parallel_for(pool, std::size_t(0), blocks, [first, d_first, size, block, &op, &prefix] (std::size_t b) {
+        const std::size_t begin = b * block;
+        const std::size_t end = std::min(size, begin + block);
+        value_type acc = prefix[b] ? op(*prefix[b], first[begin]) : value_type(first[begin]);
+        d_first[begin] = acc;
+        for(std::size_t i = begin + 1; i < end; ++i) {
+            acc = op(std::move(acc), first[i]);
+            d_first[i] = acc;
+        }
+    });
+    return d_first + size;
+}
+
+template<typename RandomIt, typename OutputIt, typename BinaryOp>
+OutputIt parallel_scan(RandomIt first, RandomIt last, OutputIt d_first, BinaryOp op)
+{ return parallel_scan(default_parallel_pool(), first, last, d_first, op); }
+
+template<typename RandomIt, typename OutputIt>
+OutputIt parallel_scan(RandomIt first, RandomIt last, OutputIt d_first) {
+    typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+    return parallel_scan(default_parallel_pool(), first, last, d_first, std::plus<value_type>());
+}
+
+namespace detail {
+
+/*ranges below this are merged or sorted sequentially*/
+const std::size_t sequential_sort_size = 2048;
+
+/*
+ * Stable merge of sorted [first1, last1) and [first2, last2) (elements of first range go first
+ * on ties) moved to out. Middle element of longer range splits both ranges in two merges,
+ * one forked when somebody can take it.
+ */
+template<typename It, typename OutIt, typename Compare>
+void parallel_merge(work_stealing_pool& pool, It first1, It last1, It first2, It last2, OutIt out, const Compare& comp) {
+    const std::size_t size1 = last1 - first1;
+    const std::size_t size2 = last2 - first2;
+    if(size1 + size2 <= sequential_sort_size || !pool.local_queue_empty()) {
+        std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1),
+            std::make_move_iterator(first2), std::make_move_iterator(last2), out, comp);
+        return;
+    }
+
+    It mid1, mid2;
+    if(size1 >= size2) {
+        mid1 = first1 + size1 / 2;
+        mid2 = std::lower_bound(first2, last2, *mid1, comp);
+    }
+    else {
+        mid2 = first2 + size2 / 2;
+        mid1 = std::upper_bound(first1, last1, *mid2, comp);
+    }
+
+    fork_join job(pool);
+    job.fork([&pool, first1, mid1, first2, mid2, out, &comp] () {
+        parallel_merge(pool, first1, mid1, first2, mid2, out, comp);
+    });
+    OutIt out_right = out + ((mid1 - first1) + (mid2 - first2));
+    job.run([&pool, mid1, last1, mid2, last2, out_right, &comp] () {
+        parallel_merge(pool, mid1, last1, mid2, last2, out_right, comp);
+    });
+    job.join();
+}
+
+/*
+ * Sorts elements of [src, src + size) stably; result ends up in src when to_src is set,
+ * otherwise in dst. Halves are sorted into the other range and merged back,
+ * so every level moves elements only once.
+ */
+template<typename SrcIt, typename DstIt, typename Compare>
+void merge_sort(work_stealing_pool& pool, SrcIt src, DstIt dst, std::size_t size, bool to_src, const Compare& comp) {
+    if(size <= sequential_sort_size || !pool.local_queue_empty()) {
+        std::stable_sort(src, src + size, comp);
+        if(!to_src)
+            std::move(src, src + size, dst);
+        return;
+    }
+
+    const std::size_t half = size / 2;
+    {
+        fork_join job(pool);
+        job.fork([&pool, src, dst, half, to_src, &comp] () {
+            merge_sort(pool, src, dst, half, !to_src, comp);
+        });
+        job.run([&pool, src, dst, half, size, to_src, &comp] () {
+            merge_sort(pool, src + half, dst + half, size - half, !to_src, comp);
+        });
+        job.join();
+    }
+
+    if(to_src)
+        parallel_merge(pool, dst, dst + half, dst + half, dst + size, src, comp);
+    else
+        parallel_merge(pool, src, src + half, src + half, src + size, dst, comp);
+}
+
+} // namespace detail
+
+/*
+ * Stable parallel merge sort. Needs buffer of distance(first, last) elements,
+ * elements only have to be move constructible and move assignable.
+ * If comp throws, order of elements is unspecified.
+ */
+template<typename RandomIt, typename Compare>
+void parallel_sort(work_stealing_pool& pool, RandomIt first, RandomIt last, Compare comp) {
+    detail::require_random_access<RandomIt>();
+    typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+
+    const std::size_t size = last - first;
+    if(size <= detail::sequential_sort_size) {
+        std::stable_sort(first, last, comp);
+        return;
+    }
+
+    /*elements are moved to buffer, moved-from ones in range serve as second half of ping-pong*/
+    std::vector<value_type> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+    detail::merge_sort(pool, buffer.begin(), first, size, false, comp);
+}
+
+template<typename RandomIt, typename Compare>
+void parallel_sort(RandomIt first, RandomIt last, Compare comp)
+{ parallel_sort(default_parallel_pool(), first, last, comp); }
+
+template<typename RandomIt>
+void parallel_sort(RandomIt first, RandomIt last) {
+    typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+    parallel_sort(default_parallel_pool(), first, last, std::less<value_type>());
+}
+
+} // namespace concurrency
+
+#endif
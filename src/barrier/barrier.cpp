@@ -0,0 +1,194 @@
+#include "barrier.hpp"
+
+#include <stdexcept>
+
+#include "futex.h"
+
+namespace concurrency {
+
+static const int max_spin_count = 100;
+static const int tree_fan_in = 4;
+
+static unsigned next_thread_index() {
+    static std::atomic<unsigned> s_next_index(0);
+    return s_next_index.fetch_add(1, std::memory_order_relaxed);
+}
+
+barrier::barrier(std::ptrdiff_t expected, barrier_mode mode):
+    barrier(expected, completion_type([] () {}), mode)
+{}
+
+barrier::barrier(std::ptrdiff_t expected, completion_type completion, barrier_mode mode):
+    m_mode(mode),
+    m_completion(completion),
+    m_expected(0),
+    m_dropped(0),
+    m_remaining(0),
+    m_nodes(),
+    m_leaves_num(0),
+    m_phase(0),
+    m_sleepers(0)
+{
+    if(expected < 0 || expected > max())
+        throw std::invalid_argument("barrier: expected count is out of [0, max] range");
+
+    m_expected = static_cast<int>(expected);
+    m_remaining.store(m_expected, std::memory_order_relaxed);
+    if(m_mode == barrier_mode::combining_tree)
+        build_tree();
+}
+
+barrier::arrival_token barrier::arrive(std::ptrdiff_t update) {
+    if(update <= 0 || update > max())
+        throw std::invalid_argument("barrier: arrive: update must be positive");
+
+    /*phase cannot complete before this arrival, so it is read first*/
+    arrival_token token(m_phase.load(std::memory_order_acquire));
+
+    if(m_mode == barrier_mode::central)
+        arrive_central(static_cast<int>(update));
+    else
+        arrive_tree(static_cast<int>(update));
+
+    return token;
+}
+
+void barrier::wait(arrival_token&& token) const {
+    for(int spins = 0; spins < max_spin_count; ++spins) {
+        if(m_phase.load(std::memory_order_acquire) != token.m_phase)
+            return;
+        util::cpu_relax();
+    }
+
+    /*sleepers increment and phase load pair with phase increment and sleepers load in complete_phase*/
+    m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+    while(m_phase.load(std::memory_order_seq_cst) == token.m_phase)
+        util::futex_wait(&m_phase, token.m_phase);
+    m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void barrier::arrive_and_drop() {
+    /*published to completing thread by arrival itself*/
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    arrive(1);
+}
+
+void barrier::build_tree() {
+    std::vector<int> level_sizes;
+    int level_size = (m_expected + tree_fan_in - 1) / tree_fan_in;
+    if(level_size < 1)
+        level_size = 1;
+    level_sizes.push_back(level_size);
+    while(level_size > 1) {
+        level_size = (level_size + tree_fan_in - 1) / tree_fan_in;
+        level_sizes.push_back(level_size);
+    }
+
+    int nodes_num = 0;
+    for(std::size_t level = 0; level < level_sizes.size(); ++level)
+        nodes_num += level_sizes[level];
+
+    m_nodes = std::vector<tree_node>(nodes_num);
+    m_leaves_num = level_sizes[0];
+
+    /*levels are laid out leaves first, so parent always has greater index than its children*/
+    int offset = 0;
+    for(std::size_t level = 0; level < level_sizes.size(); ++level) {
+        const int next_offset = offset + level_sizes[level];
+        const bool is_top = (level + 1 == level_sizes.size());
+        for(int i = 0; i < level_sizes[level]; ++i)
+            m_nodes[offset + i].m_parent = is_top ? -1 : next_offset + i / tree_fan_in;
+        offset = next_offset;
+    }
+
+    assign_capacities();
+}
+
+void barrier::assign_capacities() {
+    for(std::size_t i = 0; i < m_nodes.size(); ++i) {
+        m_nodes[i].m_capacity = 0;
+        m_nodes[i].m_arrived.store(0, std::memory_order_relaxed);
+    }
+
+    for(int i = 0; i < m_leaves_num; ++i)
+        m_nodes[i].m_capacity = m_expected / m_leaves_num + (i < m_expected % m_leaves_num ? 1 : 0);
+
+    /*children are finalized before their parent is reached; leaves emptied by drops are skipped*/
+    for(std::size_t i = 0; i < m_nodes.size(); ++i)
+        if(m_nodes[i].m_capacity > 0 && m_nodes[i].m_parent != -1)
+            ++m_nodes[m_nodes[i].m_parent].m_capacity;
+}
+
+void barrier::arrive_central(int update) {
+    const int remaining = m_remaining.fetch_sub(update, std::memory_order_acq_rel) - update;
+    if(remaining == 0)
+        complete_phase();
+    else if(remaining < 0)
+        throw std::runtime_error("barrier: arrive: more arrivals than expected in phase");
+}
+
+void barrier::arrive_tree(int update) {
+    static thread_local const unsigned t_index = next_thread_index();
+
+    for(int seat_num = 0; seat_num < update; ++seat_num) {
+        int node_idx = static_cast<int>(t_index % m_leaves_num);
+
+        /*take free seat in own leaf, or in next ones if it is full*/
+        for(int probed = 0; ; ++probed) {
+            tree_node& node = m_nodes[node_idx];
+            /*capacity may be reassigned by completing thread as soon as our seat is taken*/
+            const int capacity = node.m_capacity;
+            /*
+             * test before fetch_add, so as not to bounce lines of full leaves;
+             * test may be stale, so second round relies on fetch_add only
+             */
+            if(probed >= m_leaves_num || node.m_arrived.load(std::memory_order_relaxed) < capacity) {
+                const int seat = node.m_arrived.fetch_add(1, std::memory_order_acq_rel);
+                if(seat < capacity) {
+                    if(seat + 1 == capacity)
+                        climb_tree(node.m_parent);
+                    break;
+                }
+            }
+
+            if(probed + 1 == 2 * m_leaves_num)
+                throw std::runtime_error("barrier: arrive: more arrivals than expected in phase");
+            node_idx = (node_idx + 1) % m_leaves_num;
+        }
+    }
+}
+
+void barrier::climb_tree(int node_idx) {
+    /*only last arrival to node goes up*/
+    while(node_idx != -1) {
+        tree_node& node = m_nodes[node_idx];
+        const int capacity = node.m_capacity;
+        if(node.m_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 != capacity)
+            return;
+        node_idx = node.m_parent;
+    }
+
+    complete_phase();
+}
+
+void barrier::complete_phase() {
+    /*every other arrival of this phase happens before, and nobody touches counters until phase flips*/
+    m_completion();
+
+    const int dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+    m_expected -= dropped;
+
+    if(m_mode == barrier_mode::central)
+        m_remaining.store(m_expected, std::memory_order_relaxed);
+    else if(dropped)
+        assign_capacities();
+    else
+        for(std::size_t i = 0; i < m_nodes.size(); ++i)
+            m_nodes[i].m_arrived.store(0, std::memory_order_relaxed);
+
+    m_phase.fetch_add(1, std::memory_order_seq_cst);
+    if(m_sleepers.load(std::memory_order_seq_cst) != 0)
+        util::futex_wake_all(&m_phase);
+}
+
+} // namespace concurrency
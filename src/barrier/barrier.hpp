@@ -0,0 +1,109 @@
+#ifndef BARRIER_H
+#define BARRIER_H
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+#include "function.hpp"
+
+namespace concurrency {
+
+/*
+ * How arrivals are counted:
+ * central - one shared counter, cheapest for few threads;
+ * combining_tree - arrivals are spread over small padded counters combined up a tree,
+ *   only last arrival of each node climbs higher, so no cache line is hit by all threads.
+ */
+enum class barrier_mode { central, combining_tree };
+
+/*
+ * Reusable barrier: each phase completes when expected number of arrivals is reached,
+ * completion function is run by last arriving thread, then all waiters are released.
+ * Waiters watch phase number (generalized sense flag), which last arrival reverses.
+ */
+class barrier {
+
+public:
+    typedef func::function<void()> completion_type;
+
+    class arrival_token {
+    public:
+        arrival_token(arrival_token&& other) = default;
+        arrival_token& operator=(arrival_token&& other) = default;
+
+    private:
+        friend class barrier;
+
+        explicit arrival_token(int phase): m_phase(phase) {}
+
+        int m_phase;
+    }; // class arrival_token
+
+    explicit
+    barrier(std::ptrdiff_t expected, barrier_mode mode = barrier_mode::central);
+
+    barrier(std::ptrdiff_t expected, completion_type completion, barrier_mode mode = barrier_mode::central);
+
+    barrier(const barrier& other) = delete;
+    barrier& operator=(const barrier& other) = delete;
+
+    static constexpr std::ptrdiff_t
+    max()
+    { return INT_MAX; }
+
+    /*arrival of update participants to current phase*/
+    arrival_token arrive(std::ptrdiff_t update = 1);
+
+    /*block until phase of token is completed*/
+    void wait(arrival_token&& token) const;
+
+    void arrive_and_wait()
+    { wait(arrive()); }
+
+    /*arrive and decrement expected count of subsequent phases*/
+    void arrive_and_drop();
+
+    barrier_mode
+    mode() const
+    { return m_mode; }
+
+private:
+    struct alignas(64) tree_node {
+        std::atomic<int> m_arrived;
+        int m_capacity; /*arrivals completing node (participants for leaf, non-empty children otherwise)*/
+        int m_parent; /*-1 for root*/
+    };
+
+    void build_tree();
+    void assign_capacities();
+
+    void arrive_central(int update);
+    void arrive_tree(int update);
+    void climb_tree(int node_idx);
+
+    void complete_phase();
+
+    const barrier_mode m_mode;
+    completion_type m_completion;
+
+    /*expected arrivals per phase, changed only by completing thread*/
+    int m_expected;
+    std::atomic<int> m_dropped;
+
+    /*central mode: arrivals left in current phase*/
+    alignas(64) std::atomic<int> m_remaining;
+
+    /*combining_tree mode: leaves are first m_leaves_num nodes, root is last*/
+    std::vector<tree_node> m_nodes;
+    int m_leaves_num;
+
+    alignas(64) mutable std::atomic<int> m_phase;
+    mutable std::atomic<int> m_sleepers;
+
+}; // class barrier
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,46 @@
+#include "latch.hpp"
+
+#include <stdexcept>
+
+#include "futex.h"
+
+namespace concurrency {
+
+static const int max_spin_count = 100;
+
+latch::latch(std::ptrdiff_t expected):
+    m_count(0)
+{
+    if(expected < 0 || expected > max())
+        throw std::invalid_argument("latch: expected count is out of [0, max] range");
+    m_count.store(static_cast<int>(expected), std::memory_order_relaxed);
+}
+
+void latch::count_down(std::ptrdiff_t update) {
+    int count = m_count.load(std::memory_order_relaxed);
+    do {
+        if(update < 0 || update > count)
+            throw std::invalid_argument("latch: count_down: update is negative or exceeds counter");
+    } while(!m_count.compare_exchange_weak(
+        count, count - static_cast<int>(update),
+        std::memory_order_release, std::memory_order_relaxed
+    ));
+
+    /*latch is single-use, so waking everyone happens at most once*/
+    if(update > 0 && count == update)
+        util::futex_wake_all(&m_count);
+}
+
+void latch::wait() const {
+    for(int spins = 0; spins < max_spin_count; ++spins) {
+        if(try_wait())
+            return;
+        util::cpu_relax();
+    }
+
+    int count;
+    while((count = m_count.load(std::memory_order_acquire)) != 0)
+        util::futex_wait(&m_count, count);
+}
+
+} // namespace concurrency
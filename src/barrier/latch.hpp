@@ -0,0 +1,48 @@
+#ifndef LATCH_H
+#define LATCH_H
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+
+namespace concurrency {
+
+/*
+ * Single-use downward counter, threads block until it reaches zero.
+ * Counter is futex word, so waiting does not involve any mutex.
+ */
+class latch {
+
+public:
+    explicit
+    latch(std::ptrdiff_t expected);
+
+    latch(const latch& other) = delete;
+    latch& operator=(const latch& other) = delete;
+
+    static constexpr std::ptrdiff_t
+    max()
+    { return INT_MAX; }
+
+    /*update must not exceed current counter*/
+    void count_down(std::ptrdiff_t update = 1);
+
+    bool
+    try_wait() const
+    { return m_count.load(std::memory_order_acquire) == 0; }
+
+    void wait() const;
+
+    void arrive_and_wait(std::ptrdiff_t update = 1) {
+        count_down(update);
+        wait();
+    }
+
+private:
+    mutable std::atomic<int> m_count;
+
+}; // class latch
+
+} // namespace concurrency
+
+#endif
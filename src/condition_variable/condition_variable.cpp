@@ -3,6 +3,7 @@
 #include <stdexcept>
 
 #include "util.h"
+#include "trace.hpp"
 
 namespace concurrency {
 
@@ -29,16 +30,20 @@ static std::string make_cond_var_err_msg(const std::string& prefix, int err_num)
 condition_variable::condition_variable():
     m_cond_var()
 {
-    /*TODO: consider making it static object*/
     util::try_call<int> check_call(__FUNCTION__, make_cond_var_err_msg);
     pthread_condattr_t cond_attr;
-    int err_num = 0;
 
     check_call(
         pthread_condattr_init(&cond_attr),
         0 /*valid val*/
     );
-    
+
+    /*timed waits are measured against monotonic clock, unaffected by system time changes*/
+    check_call(
+        pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC),
+        0 /*valid val*/
+    );
+
     check_call(
         pthread_cond_init(&m_cond_var, &cond_attr),
         0 /*valid val*/
@@ -53,6 +58,7 @@ condition_variable::~condition_variable() {
 
 void condition_variable::notify_one() {
     util::try_call<int> check_call(__FUNCTION__, make_cond_var_err_msg);
+    CONCURRENCY_TRACE(cv_notify_one, this);
     check_call(
         pthread_cond_signal(&m_cond_var),
         0 /*valid val*/
@@ -61,6 +67,7 @@ void condition_variable::notify_one() {
 
 void condition_variable::notify_all() {
     util::try_call<int> check_call(__FUNCTION__, make_cond_var_err_msg);
+    CONCURRENCY_TRACE(cv_notify_all, this);
     check_call(
         pthread_cond_broadcast(&m_cond_var),
         0 /*valid val*/
@@ -71,7 +78,11 @@ void condition_variable::wait(unique_lock<mutex>& locker) {
     util::try_call<int> check_call(__FUNCTION__, make_cond_var_err_msg);
     mutex::native_handle_type* native_mutex = locker.mutex()->native_handle();
     /*unlock wrapper*/
-    // locker.fake_unlock();
+#ifdef CONCURRENCY_MUTEX_PROFILING
+    locker.mutex()->profile_suspend_hold();
+#endif
+    CONCURRENCY_TRACE(lock_released, static_cast<mutex_interface*>(locker.mutex()));
+    CONCURRENCY_TRACE(cv_wait, this);
     
     check_call(
         pthread_cond_wait(&m_cond_var, native_mutex),
@@ -79,7 +90,40 @@ void condition_variable::wait(unique_lock<mutex>& locker) {
     );
     
     // meeting postcondition of wait
-    // locker.fake_lock();
+    CONCURRENCY_TRACE(cv_wake, this);
+    CONCURRENCY_TRACE(lock_acquired, static_cast<mutex_interface*>(locker.mutex()));
+#ifdef CONCURRENCY_MUTEX_PROFILING
+    locker.mutex()->profile_resume_hold();
+#endif
+}
+
+cv_status condition_variable::wait_until_monotonic(
+    unique_lock<mutex>& locker,
+    const timespec& abs_time
+) {
+    util::try_call<int> check_call(__FUNCTION__, make_cond_var_err_msg);
+    mutex::native_handle_type* native_mutex = locker.mutex()->native_handle();
+
+#ifdef CONCURRENCY_MUTEX_PROFILING
+    locker.mutex()->profile_suspend_hold();
+#endif
+    CONCURRENCY_TRACE(lock_released, static_cast<mutex_interface*>(locker.mutex()));
+    CONCURRENCY_TRACE(cv_wait, this);
+    int err_num = pthread_cond_timedwait(&m_cond_var, native_mutex, &abs_time);
+    CONCURRENCY_TRACE(cv_wake, this);
+    CONCURRENCY_TRACE(lock_acquired, static_cast<mutex_interface*>(locker.mutex()));
+#ifdef CONCURRENCY_MUTEX_PROFILING
+    locker.mutex()->profile_resume_hold();
+#endif
+    if(err_num == ETIMEDOUT)
+        return cv_status::timeout;
+
+    check_call(
+        err_num,
+        0 /*valid val*/
+    );
+
+    return cv_status::no_timeout;
 }
 
 } // namespace concurrency
\ No newline at end of file
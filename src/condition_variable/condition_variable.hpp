@@ -2,10 +2,16 @@
 #define CONDITION_VAR_H
 
 #include <pthread.h>
+#include <chrono>
+
 #include "mutex.hpp"
+#include "stop_token.hpp"
+#include "timespec.h"
 
 namespace concurrency {
 
+enum class cv_status { no_timeout, timeout };
+
 class condition_variable {
 
 public:
@@ -30,14 +36,235 @@ public:
             wait(lock);
     }
 
+    template<typename Clock, typename Duration>
+    cv_status wait_until(
+        unique_lock<mutex>& lock,
+        const std::chrono::time_point<Clock, Duration>& abs_time
+    ) {
+        if(wait_until_monotonic(lock, util::to_monotonic_timespec(abs_time)) == cv_status::no_timeout)
+            return cv_status::no_timeout;
+        /*Clock may be adjusted while waiting, its own reading is authoritative*/
+        return Clock::now() < abs_time ? cv_status::no_timeout : cv_status::timeout;
+    }
+
+    template<typename Clock, typename Duration, typename Predicate>
+    bool wait_until(
+        unique_lock<mutex>& lock,
+        const std::chrono::time_point<Clock, Duration>& abs_time,
+        Predicate stop_waiting
+    ) {
+        while(!stop_waiting())
+            if(wait_until(lock, abs_time) == cv_status::timeout)
+                return stop_waiting();
+        return true;
+    }
+
+    template<typename Rep, typename Period>
+    cv_status wait_for(
+        unique_lock<mutex>& lock,
+        const std::chrono::duration<Rep, Period>& rel_time
+    ) { return wait_until(lock, util::deadline_after(rel_time)); }
+
+    template<typename Rep, typename Period, typename Predicate>
+    bool wait_for(
+        unique_lock<mutex>& lock,
+        const std::chrono::duration<Rep, Period>& rel_time,
+        Predicate stop_waiting
+    ) { return wait_until(lock, util::deadline_after(rel_time), stop_waiting); }
+
     native_type* native_handle()
     { return &m_cond_var; }
 
 private:
+    /*abs_time is measured against CLOCK_MONOTONIC (clock of condition variable)*/
+    cv_status wait_until_monotonic(unique_lock<mutex>& lock, const timespec& abs_time);
+
     native_type m_cond_var;
 
 }; // class condition_variable
 
+/*
+ * Condition variable working with any lockable type (e.g. futex_mutex).
+ * Implemented on top of internal mutex and condition_variable.
+ */
+class condition_variable_any {
+
+public:
+    condition_variable_any() {}
+
+    condition_variable_any(const condition_variable_any& other) = delete;
+    condition_variable_any& operator=(const condition_variable_any& other) = delete;
+
+    void notify_one() {
+        lock_guard<mutex> locker(m_mutex);
+        m_cond_var.notify_one();
+    }
+
+    void notify_all() {
+        lock_guard<mutex> locker(m_mutex);
+        m_cond_var.notify_all();
+    }
+
+    template<typename Lock>
+    void wait(Lock& lock) {
+        /*internal mutex is locked before user lock is released, so no notification is lost*/
+        m_mutex.lock();
+        lock.unlock();
+
+        relocker<Lock> user_relocker(lock);
+        {
+            unique_lock<mutex> internal_locker(m_mutex, adopt_lock);
+            m_cond_var.wait(internal_locker);
+        } /*internal mutex must be released before user lock is reacquired*/
+    }
+
+    template<typename Lock, typename Predicate>
+    void wait(Lock& lock, Predicate stop_waiting) {
+        while(!stop_waiting())
+            wait(lock);
+    }
+
+    template<typename Lock, typename Clock, typename Duration>
+    cv_status wait_until(Lock& lock, const std::chrono::time_point<Clock, Duration>& abs_time) {
+        m_mutex.lock();
+        lock.unlock();
+
+        relocker<Lock> user_relocker(lock);
+        {
+            unique_lock<mutex> internal_locker(m_mutex, adopt_lock);
+            return m_cond_var.wait_until(internal_locker, abs_time);
+        }
+    }
+
+    template<typename Lock, typename Clock, typename Duration, typename Predicate>
+    bool wait_until(
+        Lock& lock,
+        const std::chrono::time_point<Clock, Duration>& abs_time,
+        Predicate stop_waiting
+    ) {
+        while(!stop_waiting())
+            if(wait_until(lock, abs_time) == cv_status::timeout)
+                return stop_waiting();
+        return true;
+    }
+
+    template<typename Lock, typename Rep, typename Period>
+    cv_status wait_for(Lock& lock, const std::chrono::duration<Rep, Period>& rel_time)
+    { return wait_until(lock, util::deadline_after(rel_time)); }
+
+    template<typename Lock, typename Rep, typename Period, typename Predicate>
+    bool wait_for(
+        Lock& lock,
+        const std::chrono::duration<Rep, Period>& rel_time,
+        Predicate stop_waiting
+    ) { return wait_until(lock, util::deadline_after(rel_time), stop_waiting); }
+
+    /*
+     * Interruptible waits: return as soon as stop is requested on token.
+     * Result is value of stop_waiting() at the moment of return.
+     */
+    template<typename Lock, typename Predicate>
+    bool wait(Lock& lock, stop_token token, Predicate stop_waiting) {
+        stop_callback<stop_notifier> notifier(token, stop_notifier(this));
+        while(!stop_waiting()) {
+            if(token.stop_requested())
+                return false;
+            wait_unless_stopped(lock, token);
+        }
+        return true;
+    }
+
+    template<typename Lock, typename Clock, typename Duration, typename Predicate>
+    bool wait_until(
+        Lock& lock,
+        stop_token token,
+        const std::chrono::time_point<Clock, Duration>& abs_time,
+        Predicate stop_waiting
+    ) {
+        stop_callback<stop_notifier> notifier(token, stop_notifier(this));
+        while(!stop_waiting()) {
+            if(token.stop_requested())
+                return false;
+            if(wait_until_unless_stopped(lock, token, abs_time) == cv_status::timeout)
+                return stop_waiting();
+        }
+        return true;
+    }
+
+    template<typename Lock, typename Rep, typename Period, typename Predicate>
+    bool wait_for(
+        Lock& lock,
+        stop_token token,
+        const std::chrono::duration<Rep, Period>& rel_time,
+        Predicate stop_waiting
+    ) { return wait_until(lock, std::move(token), util::deadline_after(rel_time), stop_waiting); }
+
+private:
+    /*wakes up waiters on stop request*/
+    struct stop_notifier {
+        explicit stop_notifier(condition_variable_any* cond_var): m_cond_var(cond_var) {}
+        void operator()() { m_cond_var->notify_all(); }
+
+        condition_variable_any* m_cond_var;
+    };
+
+    /*
+     * Stop request is checked under internal mutex, which stop_notifier also takes,
+     * so request made after the check always finds waiter blocked on m_cond_var.
+     */
+    template<typename Lock>
+    void wait_unless_stopped(Lock& lock, const stop_token& token) {
+        m_mutex.lock();
+        if(token.stop_requested()) {
+            m_mutex.unlock();
+            return;
+        }
+        lock.unlock();
+
+        relocker<Lock> user_relocker(lock);
+        {
+            unique_lock<mutex> internal_locker(m_mutex, adopt_lock);
+            m_cond_var.wait(internal_locker);
+        }
+    }
+
+    template<typename Lock, typename Clock, typename Duration>
+    cv_status wait_until_unless_stopped(
+        Lock& lock,
+        const stop_token& token,
+        const std::chrono::time_point<Clock, Duration>& abs_time
+    ) {
+        m_mutex.lock();
+        if(token.stop_requested()) {
+            m_mutex.unlock();
+            return cv_status::no_timeout;
+        }
+        lock.unlock();
+
+        relocker<Lock> user_relocker(lock);
+        {
+            unique_lock<mutex> internal_locker(m_mutex, adopt_lock);
+            return m_cond_var.wait_until(internal_locker, abs_time);
+        }
+    }
+
+    /*reacquires user lock on scope exit (even if wait throws)*/
+    template<typename Lock>
+    struct relocker {
+        explicit relocker(Lock& lock): m_lock(lock) {}
+        ~relocker() { m_lock.lock(); }
+
+        relocker(const relocker& other) = delete;
+        relocker& operator=(const relocker& other) = delete;
+
+        Lock& m_lock;
+    };
+
+    mutex m_mutex;
+    condition_variable m_cond_var;
+
+}; // class condition_variable_any
+
 } // namespace concurrency
 
 #endif
\ No newline at end of file
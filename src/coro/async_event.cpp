@@ -0,0 +1,34 @@
+#include "async_event.hpp"
+
+namespace concurrency {
+
+bool async_event::awaiter::await_suspend(std::coroutine_handle<> awaiting) noexcept {
+    m_awaiting = awaiting;
+
+    void* state = m_event.m_state.load(std::memory_order_acquire);
+    do {
+        if(state == m_event.set_marker())
+            return false;
+        m_next = static_cast<awaiter*>(state);
+    } while(!m_event.m_state.compare_exchange_weak(
+        state, static_cast<void*>(this),
+        std::memory_order_release, std::memory_order_acquire
+    ));
+    return true;
+}
+
+void async_event::set() {
+    void* state = m_state.exchange(set_marker(), std::memory_order_acq_rel);
+    if(state == set_marker())
+        return;
+
+    /*resumed coroutine may destroy its awaiter*/
+    awaiter* waiter = static_cast<awaiter*>(state);
+    while(waiter) {
+        awaiter* next = waiter->m_next;
+        waiter->m_awaiting.resume();
+        waiter = next;
+    }
+}
+
+} // namespace concurrency
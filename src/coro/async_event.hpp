@@ -0,0 +1,79 @@
+#ifndef ASYNC_EVENT_H
+#define ASYNC_EVENT_H
+
+#ifndef __cpp_impl_coroutine
+#error "async_event.hpp requires C++20 coroutines, configure with -DCONCURRENCY_COROUTINES=ON"
+#endif
+
+#include <atomic>
+#include <coroutine>
+
+namespace concurrency {
+
+/*
+ * Manual-reset event for coroutines: co_await event suspends until set() is called.
+ * State word is "set" marker or head of stack of suspended waiters,
+ * set() takes whole stack and resumes waiters on calling thread.
+ */
+class async_event {
+
+public:
+    class awaiter {
+
+    public:
+        explicit awaiter(const async_event& event) noexcept: m_event(event), m_next(nullptr) {}
+
+        bool await_ready() const noexcept
+        { return m_event.is_set(); }
+
+        /*false - event was set meanwhile, caller continues right away*/
+        bool
+        await_suspend(std::coroutine_handle<> awaiting) noexcept;
+
+        void await_resume() noexcept {}
+
+    private:
+        const async_event& m_event;
+        awaiter* m_next;
+        std::coroutine_handle<> m_awaiting;
+
+        friend class async_event;
+
+    }; // class awaiter
+
+    explicit async_event(bool initially_set = false) noexcept:
+        m_state(initially_set ? set_marker() : nullptr)
+    {}
+
+    async_event(const async_event& other) = delete;
+    async_event& operator=(const async_event& other) = delete;
+
+    bool is_set() const noexcept
+    { return m_state.load(std::memory_order_acquire) == set_marker(); }
+
+    /*resumes all waiters on calling thread*/
+    void
+    set();
+
+    /*no effect on event which is not set*/
+    void reset() noexcept {
+        void* expected = set_marker();
+        m_state.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed);
+    }
+
+    awaiter operator co_await() const noexcept
+    { return awaiter(*this); }
+
+private:
+    /*own address marks set event, it can not be address of any waiter*/
+    void* set_marker() const noexcept
+    { return const_cast<async_event*>(this); }
+
+    /*set_marker(), nullptr (not set, no waiters) or last suspended awaiter*/
+    mutable std::atomic<void*> m_state;
+
+}; // class async_event
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,81 @@
+#include "async_mutex.hpp"
+
+namespace concurrency {
+
+bool async_mutex::lock_awaiter::await_suspend(std::coroutine_handle<> awaiting) noexcept {
+    m_awaiting = awaiting;
+
+    std::uintptr_t state = m_mutex.m_state.load(std::memory_order_relaxed);
+    for(;;) {
+        if(state == not_locked) {
+            if(m_mutex.m_state.compare_exchange_weak(
+                state, locked_no_waiters,
+                std::memory_order_acquire, std::memory_order_relaxed
+            ))
+                return false;
+            continue;
+        }
+
+        /*push onto stack of new waiters, owner will pick it up on unlock*/
+        m_next = reinterpret_cast<lock_awaiter*>(state);
+        if(m_mutex.m_state.compare_exchange_weak(
+            state, reinterpret_cast<std::uintptr_t>(this),
+            std::memory_order_release, std::memory_order_relaxed
+        ))
+            return true;
+    }
+}
+
+void async_mutex::unlock() {
+    lock_awaiter* next = m_waiters;
+    if(!next) {
+        std::uintptr_t state = locked_no_waiters;
+        if(m_state.compare_exchange_strong(
+            state, not_locked,
+            std::memory_order_release, std::memory_order_relaxed
+        ))
+            return;
+
+        /*take new waiters, reversing them into arrival order*/
+        state = m_state.exchange(locked_no_waiters, std::memory_order_acquire);
+        lock_awaiter* waiter = reinterpret_cast<lock_awaiter*>(state);
+        while(waiter) {
+            lock_awaiter* older = waiter->m_next;
+            waiter->m_next = next;
+            next = waiter;
+            waiter = older;
+        }
+    }
+
+    /*lock passes to next waiter without being released*/
+    m_waiters = next->m_next;
+    hand_over(next);
+}
+
+void async_mutex::hand_over(lock_awaiter* next) {
+    /*waiters given lock on this thread, but not resumed yet, of all mutexes*/
+    static thread_local lock_awaiter* t_head = nullptr;
+    static thread_local lock_awaiter* t_tail = nullptr;
+    static thread_local bool t_resuming = false;
+
+    next->m_next = nullptr;
+    if(t_tail)
+        t_tail->m_next = next;
+    else
+        t_head = next;
+    t_tail = next;
+    if(t_resuming)
+        return;
+
+    t_resuming = true;
+    while(lock_awaiter* waiter = t_head) {
+        t_head = waiter->m_next;
+        if(!t_head)
+            t_tail = nullptr;
+        /*awaiter lives in frame of resumed coroutine, it is not touched afterwards*/
+        waiter->m_awaiting.resume();
+    }
+    t_resuming = false;
+}
+
+} // namespace concurrency
@@ -0,0 +1,129 @@
+#ifndef ASYNC_MUTEX_H
+#define ASYNC_MUTEX_H
+
+#ifndef __cpp_impl_coroutine
+#error "async_mutex.hpp requires C++20 coroutines, configure with -DCONCURRENCY_COROUTINES=ON"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <utility>
+
+namespace concurrency {
+
+class async_mutex;
+
+/*owns lock of async_mutex taken by co_await mutex.scoped_lock()*/
+class async_lock_guard {
+
+public:
+    explicit async_lock_guard(async_mutex& mut) noexcept: m_mutex(&mut) {}
+
+    async_lock_guard(async_lock_guard&& other) noexcept:
+        m_mutex(std::exchange(other.m_mutex, nullptr))
+    {}
+
+    async_lock_guard(const async_lock_guard& other) = delete;
+    async_lock_guard& operator=(const async_lock_guard& other) = delete;
+    async_lock_guard& operator=(async_lock_guard&& other) = delete;
+
+    ~async_lock_guard();
+
+private:
+    async_mutex* m_mutex;
+
+}; // class async_lock_guard
+
+/*
+ * Mutex for coroutines: co_await lock() suspends caller instead of blocking its thread.
+ * State word is either "not locked", "locked" or head of stack of newly arrived waiters;
+ * owner moves that stack into its private FIFO list, so waiters get lock in arrival order.
+ * unlock() hands lock over to next waiter and resumes it on unlocking thread; unlock() called
+ * by coroutine which is being resumed so only queues its successor for outermost unlock() to resume,
+ * so that long chain of handovers runs in loop instead of growing stack.
+ */
+class async_mutex {
+
+public:
+    class lock_awaiter {
+
+    public:
+        explicit lock_awaiter(async_mutex& mut) noexcept: m_mutex(mut), m_next(nullptr) {}
+
+        bool await_ready() noexcept
+        { return m_mutex.try_lock(); }
+
+        /*false - lock was taken meanwhile, caller continues right away*/
+        bool
+        await_suspend(std::coroutine_handle<> awaiting) noexcept;
+
+        void await_resume() noexcept {}
+
+    protected:
+        async_mutex& m_mutex;
+
+    private:
+        lock_awaiter* m_next;
+        std::coroutine_handle<> m_awaiting;
+
+        friend class async_mutex;
+
+    }; // class lock_awaiter
+
+    class scoped_lock_awaiter: public lock_awaiter {
+
+    public:
+        using lock_awaiter::lock_awaiter;
+
+        [[nodiscard]] async_lock_guard await_resume() noexcept
+        { return async_lock_guard(m_mutex); }
+
+    }; // class scoped_lock_awaiter
+
+    async_mutex() noexcept: m_state(not_locked), m_waiters(nullptr) {}
+
+    async_mutex(const async_mutex& other) = delete;
+    async_mutex& operator=(const async_mutex& other) = delete;
+
+    bool try_lock() noexcept {
+        std::uintptr_t expected = not_locked;
+        return m_state.compare_exchange_strong(
+            expected, locked_no_waiters,
+            std::memory_order_acquire, std::memory_order_relaxed
+        );
+    }
+
+    /*co_await mut.lock(), unlock() must follow*/
+    [[nodiscard]] lock_awaiter lock() noexcept
+    { return lock_awaiter(*this); }
+
+    /*co_await mut.scoped_lock() gives guard unlocking at end of scope*/
+    [[nodiscard]] scoped_lock_awaiter scoped_lock() noexcept
+    { return scoped_lock_awaiter(*this); }
+
+    /*resumes next waiter, if any, on calling thread (after current resumption, if inside one)*/
+    void
+    unlock();
+
+private:
+    static void hand_over(lock_awaiter* next);
+
+    static const std::uintptr_t not_locked = 1;
+    static const std::uintptr_t locked_no_waiters = 0;
+
+    /*not_locked, locked_no_waiters or pointer to last arrived lock_awaiter*/
+    std::atomic<std::uintptr_t> m_state;
+    /*waiters in arrival order, touched only by owner*/
+    lock_awaiter* m_waiters;
+
+}; // class async_mutex
+
+inline async_lock_guard::~async_lock_guard() {
+    if(m_mutex)
+        m_mutex->unlock();
+}
+
+} // namespace concurrency
+
+#endif
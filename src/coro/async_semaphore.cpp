@@ -0,0 +1,57 @@
+#include "async_semaphore.hpp"
+
+namespace concurrency {
+
+async_semaphore::async_semaphore(std::ptrdiff_t desired):
+    m_count(desired), m_head(nullptr), m_tail(nullptr)
+{
+    if(desired < 0)
+        throw std::invalid_argument("async_semaphore: initial count is negative");
+}
+
+bool async_semaphore::acquire_awaiter::await_suspend(std::coroutine_handle<> awaiting) {
+    m_awaiting = awaiting;
+
+    lock_guard<mutex> locker(m_semaphore.m_mutex);
+    /*permits are added only under mutex, so none can appear after this check*/
+    if(m_semaphore.try_acquire())
+        return false;
+
+    if(m_semaphore.m_tail)
+        m_semaphore.m_tail->m_next = this;
+    else
+        m_semaphore.m_head = this;
+    m_semaphore.m_tail = this;
+    return true;
+}
+
+void async_semaphore::release(std::ptrdiff_t update) {
+    if(update < 0)
+        throw std::invalid_argument("async_semaphore::release: update is negative");
+
+    acquire_awaiter* woken = nullptr;
+    {
+        lock_guard<mutex> locker(m_mutex);
+        /*permits go to waiters first, rest is added to counter*/
+        acquire_awaiter** woken_tail = &woken;
+        for(; update > 0 && m_head; --update) {
+            *woken_tail = m_head;
+            woken_tail = &m_head->m_next;
+            m_head = m_head->m_next;
+        }
+        *woken_tail = nullptr;
+        if(!m_head)
+            m_tail = nullptr;
+        if(update > 0)
+            m_count.fetch_add(update, std::memory_order_release);
+    }
+
+    /*resumed coroutine may destroy its awaiter*/
+    while(woken) {
+        acquire_awaiter* next = woken->m_next;
+        woken->m_awaiting.resume();
+        woken = next;
+    }
+}
+
+} // namespace concurrency
@@ -0,0 +1,85 @@
+#ifndef ASYNC_SEMAPHORE_H
+#define ASYNC_SEMAPHORE_H
+
+#ifndef __cpp_impl_coroutine
+#error "async_semaphore.hpp requires C++20 coroutines, configure with -DCONCURRENCY_COROUTINES=ON"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <stdexcept>
+
+#include "mutex.hpp"
+
+namespace concurrency {
+
+/*
+ * Counting semaphore for coroutines: co_await acquire() suspends while there are no permits.
+ * Free permits are taken with single CAS; waiters queue in FIFO order under mutex,
+ * release() hands permits directly to them and resumes them on releasing thread.
+ * While anyone waits, counter stays at zero, so newcomers can not overtake waiters.
+ */
+class async_semaphore {
+
+public:
+    class acquire_awaiter {
+
+    public:
+        explicit acquire_awaiter(async_semaphore& sem) noexcept: m_semaphore(sem), m_next(nullptr) {}
+
+        bool await_ready() noexcept
+        { return m_semaphore.try_acquire(); }
+
+        /*false - permit was taken meanwhile, caller continues right away*/
+        bool
+        await_suspend(std::coroutine_handle<> awaiting);
+
+        void await_resume() noexcept {}
+
+    private:
+        async_semaphore& m_semaphore;
+        acquire_awaiter* m_next;
+        std::coroutine_handle<> m_awaiting;
+
+        friend class async_semaphore;
+
+    }; // class acquire_awaiter
+
+    explicit
+    async_semaphore(std::ptrdiff_t desired);
+
+    async_semaphore(const async_semaphore& other) = delete;
+    async_semaphore& operator=(const async_semaphore& other) = delete;
+
+    bool try_acquire() noexcept {
+        std::ptrdiff_t count = m_count.load(std::memory_order_relaxed);
+        while(count > 0)
+            if(m_count.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        return false;
+    }
+
+    /*co_await sem.acquire()*/
+    [[nodiscard]] acquire_awaiter acquire() noexcept
+    { return acquire_awaiter(*this); }
+
+    /*resumes up to update waiters on calling thread*/
+    void
+    release(std::ptrdiff_t update = 1);
+
+    /*approximate: permits not taken by anyone*/
+    std::ptrdiff_t available() const noexcept
+    { return m_count.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::ptrdiff_t> m_count;
+    mutex m_mutex;
+    acquire_awaiter* m_head;
+    acquire_awaiter* m_tail;
+
+}; // class async_semaphore
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,271 @@
+#ifndef TASK_H
+#define TASK_H
+
+#ifndef __cpp_impl_coroutine
+#error "task.hpp requires C++20 coroutines, configure with -DCONCURRENCY_COROUTINES=ON"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include "future.hpp"
+
+namespace concurrency {
+
+template<typename T = void> class task;
+
+namespace detail {
+
+class task_promise_base {
+
+public:
+    /*
+     * Whichever of task and its awaiter comes second continues awaiter: task finished
+     * synchronously lets awaiter go on without suspending, so long chains of such tasks
+     * do not grow stack even where compiler does not turn resumption into tail call.
+     */
+    struct final_awaiter {
+        bool await_ready() noexcept
+        { return false; }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            task_promise_base& promise = handle.promise();
+            if(promise.m_finished_or_suspended.exchange(true, std::memory_order_acq_rel))
+                promise.m_continuation.resume();
+        }
+
+        void await_resume() noexcept {}
+    }; // struct final_awaiter
+
+    task_promise_base() noexcept: m_finished_or_suspended(false) {}
+
+    /*task is lazy, it starts when awaited*/
+    std::suspend_always initial_suspend() noexcept
+    { return {}; }
+
+    final_awaiter final_suspend() noexcept
+    { return {}; }
+
+    void unhandled_exception() noexcept
+    { m_exception = std::current_exception(); }
+
+    /*starts task, false - it has already finished and awaiter must not suspend*/
+    template<typename Promise>
+    bool start(std::coroutine_handle<Promise> handle, std::coroutine_handle<> awaiting) noexcept {
+        m_continuation = awaiting;
+        handle.resume();
+        return !m_finished_or_suspended.exchange(true, std::memory_order_acq_rel);
+    }
+
+protected:
+    void rethrow_if_failed() const {
+        if(m_exception)
+            std::rethrow_exception(m_exception);
+    }
+
+private:
+    std::coroutine_handle<> m_continuation;
+    std::atomic<bool> m_finished_or_suspended;
+    std::exception_ptr m_exception;
+
+}; // class task_promise_base
+
+template<typename T>
+class task_promise: public task_promise_base {
+
+public:
+    task<T>
+    get_return_object() noexcept;
+
+    template<typename U>
+    void return_value(U&& value)
+    { m_value.emplace(std::forward<U>(value)); }
+
+    T result() {
+        this->rethrow_if_failed();
+        return std::move(*m_value);
+    }
+
+private:
+    std::optional<T> m_value;
+
+}; // class task_promise
+
+template<>
+class task_promise<void>: public task_promise_base {
+
+public:
+    task<void>
+    get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void result()
+    { rethrow_if_failed(); }
+
+}; // class task_promise<void>
+
+} // namespace detail
+
+/*
+ * Lazily started coroutine producing T.
+ * Task runs on thread which awaits it until its first suspension, afterwards
+ * on thread which resumes it (executor worker, thread unlocking async_mutex, ...).
+ * Owned by single task object, frame is destroyed together with it.
+ */
+template<typename T>
+class [[nodiscard]] task {
+
+public:
+    typedef detail::task_promise<T> promise_type;
+
+    task() noexcept: m_handle(nullptr) {}
+
+    explicit task(std::coroutine_handle<promise_type> handle) noexcept: m_handle(handle) {}
+
+    task(task&& other) noexcept: m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+    task& operator=(task&& other) noexcept {
+        task(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    task(const task& other) = delete;
+    task& operator=(const task& other) = delete;
+
+    ~task() {
+        if(m_handle)
+            m_handle.destroy();
+    }
+
+    void swap(task& other) noexcept
+    { std::swap(m_handle, other.m_handle); }
+
+    bool valid() const noexcept
+    { return static_cast<bool>(m_handle); }
+
+    /*co_await std::move(t): starts task, resumes awaiter with its result*/
+    auto operator co_await() && noexcept {
+        struct awaiter {
+            bool await_ready() noexcept
+            { return m_handle.done(); }
+
+            bool await_suspend(std::coroutine_handle<> awaiting) noexcept
+            { return m_handle.promise().start(m_handle, awaiting); }
+
+            T await_resume()
+            { return m_handle.promise().result(); }
+
+            std::coroutine_handle<promise_type> m_handle;
+        }; // struct awaiter
+
+        return awaiter{m_handle};
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+
+}; // class task
+
+namespace detail {
+
+template<typename T>
+task<T> task_promise<T>::get_return_object() noexcept
+{ return task<T>(std::coroutine_handle<task_promise>::from_promise(*this)); }
+
+inline task<void> task_promise<void>::get_return_object() noexcept
+{ return task<void>(std::coroutine_handle<task_promise>::from_promise(*this)); }
+
+/*fire-and-forget coroutine, frame frees itself when body ends*/
+struct detached_task {
+    struct promise_type {
+        detached_task get_return_object() noexcept
+        { return {}; }
+
+        std::suspend_never initial_suspend() noexcept
+        { return {}; }
+
+        std::suspend_never final_suspend() noexcept
+        { return {}; }
+
+        void return_void() noexcept {}
+
+        /*body catches everything itself*/
+        void unhandled_exception() noexcept
+        { std::terminate(); }
+    }; // struct promise_type
+}; // struct detached_task
+
+template<typename Executor>
+class schedule_awaiter {
+
+public:
+    explicit schedule_awaiter(Executor& executor) noexcept: m_executor(&executor) {}
+
+    bool await_ready() noexcept
+    { return false; }
+
+    /*coroutine may be resumed (and finished) by worker before submit returns*/
+    void await_suspend(std::coroutine_handle<> handle)
+    { m_executor->submit([handle] () { handle.resume(); }); }
+
+    void await_resume() noexcept {}
+
+private:
+    Executor* m_executor;
+
+}; // class schedule_awaiter
+
+template<typename T, typename Executor>
+detached_task run_task(Executor& executor, task<T> work, promise<T> result) {
+    try {
+        co_await schedule_awaiter<Executor>(executor);
+        if constexpr(std::is_void<T>::value) {
+            co_await std::move(work);
+            result.set_value();
+        }
+        else
+            result.set_value(co_await std::move(work));
+    }
+    catch(...) {
+        result.set_exception(std::current_exception());
+    }
+}
+
+} // namespace detail
+
+/*
+ * co_await schedule(executor): continues coroutine on executor,
+ * any object with submit(callable), e.g. thread_pool or work_stealing_pool.
+ */
+template<typename Executor>
+detail::schedule_awaiter<Executor> schedule(Executor& executor) noexcept
+{ return detail::schedule_awaiter<Executor>(executor); }
+
+/*
+ * Starts task on executor, its result (or exception) is delivered through future,
+ * so it can be continued with then() or combined with when_all.
+ * Executor must outlive task.
+ */
+template<typename T, typename Executor>
+future<T> spawn(Executor& executor, task<T> work) {
+    promise<T> result;
+    future<T> fut = result.get_future();
+    detail::run_task(executor, std::move(work), std::move(result));
+    return fut;
+}
+
+/*runs task on calling thread until its first suspension, then blocks until it is finished*/
+template<typename T>
+T sync_wait(task<T> work) {
+    detail::inline_executor executor;
+    return spawn(executor, std::move(work)).get();
+}
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,320 @@
+#ifndef SHARDED_COUNTER_H
+#define SHARDED_COUNTER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "cache_padded.hpp"
+
+namespace concurrency {
+
+namespace detail {
+
+inline unsigned round_up_shards(unsigned val) {
+    unsigned res = 1;
+    while(res < val)
+        res <<= 1;
+    return res;
+}
+
+/*0 - one shard per online cpu, rounded up to power of two*/
+inline unsigned shards_for(unsigned shards_num) {
+    if(shards_num == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        shards_num = (cpus > 0) ? static_cast<unsigned>(cpus) : 1;
+    }
+    return round_up_shards(shards_num);
+}
+
+/*
+ * Shard is picked per thread: consecutive threads get consecutive shards, so up to
+ * shards_num threads never share a line. Threads beyond that share shards, which is still correct,
+ * as shards are updated with atomic read-modify-write.
+ */
+inline unsigned current_shard_index() {
+    static std::atomic<unsigned> s_next_index(0);
+    static thread_local const unsigned t_index = s_next_index.fetch_add(1, std::memory_order_relaxed);
+    return t_index;
+}
+
+/*fetch_add for floating point types comes only with C++20*/
+template<typename T>
+inline void relaxed_add(std::atomic<T>& target, T delta) {
+    if constexpr(std::is_integral<T>::value)
+        target.fetch_add(delta, std::memory_order_relaxed);
+    else {
+        T current = target.load(std::memory_order_relaxed);
+        while(!target.compare_exchange_weak(current, current + delta, std::memory_order_relaxed))
+            ;
+    }
+}
+
+/*one cache-line-padded atomic per shard*/
+template<typename T>
+class shards {
+
+public:
+    shards(unsigned shards_num, T initial):
+        m_mask(shards_for(shards_num) - 1),
+        m_shards(new cache_padded<std::atomic<T> >[m_mask + 1])
+    {
+        for(unsigned i = 0; i <= m_mask; ++i)
+            m_shards[i]->store(initial, std::memory_order_relaxed);
+    }
+
+    std::atomic<T>& local()
+    { return *m_shards[current_shard_index() & m_mask]; }
+
+    std::atomic<T>& operator[](unsigned index)
+    { return *m_shards[index]; }
+
+    const std::atomic<T>& operator[](unsigned index) const
+    { return *m_shards[index]; }
+
+    unsigned size() const
+    { return m_mask + 1; }
+
+private:
+    const unsigned m_mask;
+    std::unique_ptr<cache_padded<std::atomic<T> >[]> m_shards;
+
+}; // class shards
+
+} // namespace detail
+
+/*
+ * Counter for many writers and rare readers.
+ * Every thread adds to its own cache-line-padded shard with relaxed atomic add,
+ * so writers on different cores do not bounce a shared line; load() sums all shards.
+ * Value read while others add is some value the counter had in between (no snapshot across shards).
+ * T may be integral or floating point.
+ */
+template<typename T = long>
+class sharded_counter {
+
+public:
+    typedef T value_type;
+
+    /*shards_num is rounded up to power of two, 0 - one shard per online cpu*/
+    explicit
+    sharded_counter(unsigned shards_num = 0): m_shards(shards_num, T()) {}
+
+    sharded_counter(const sharded_counter& other) = delete;
+    sharded_counter& operator=(const sharded_counter& other) = delete;
+
+    void add(T delta)
+    { detail::relaxed_add(m_shards.local(), delta); }
+
+    void increment()
+    { add(T(1)); }
+
+    void decrement()
+    { add(T(-1)); }
+
+    T load() const {
+        T total = T();
+        for(unsigned i = 0; i < m_shards.size(); ++i)
+            total += m_shards[i].load(std::memory_order_relaxed);
+        return total;
+    }
+
+    /*zero counter, returns value taken out; concurrent adds land either in result or in new value*/
+    T reset() {
+        T total = T();
+        for(unsigned i = 0; i < m_shards.size(); ++i)
+            total += m_shards[i].exchange(T(), std::memory_order_relaxed);
+        return total;
+    }
+
+    unsigned shards_num() const
+    { return m_shards.size(); }
+
+private:
+    detail::shards<T> m_shards;
+
+}; // class sharded_counter
+
+/*sum of samples, e.g. bytes or seconds spent: counter which is added to rather than incremented*/
+template<typename T = double>
+using sharded_sum = sharded_counter<T>;
+
+/*
+ * Smallest (Compare = std::less) or largest (std::greater) value seen.
+ * Shard is written only when value improves on it, so steady state is read-only for writers.
+ */
+template<typename T, typename Compare>
+class sharded_extremum {
+
+public:
+    typedef T value_type;
+
+    /*identity is returned while nothing was recorded*/
+    explicit
+    sharded_extremum(T identity, unsigned shards_num = 0):
+        m_shards(shards_num, identity),
+        m_identity(identity)
+    {}
+
+    sharded_extremum(const sharded_extremum& other) = delete;
+    sharded_extremum& operator=(const sharded_extremum& other) = delete;
+
+    void update(T val) {
+        std::atomic<T>& shard = m_shards.local();
+        T current = shard.load(std::memory_order_relaxed);
+        while(Compare()(val, current))
+            if(shard.compare_exchange_weak(current, val, std::memory_order_relaxed))
+                return;
+    }
+
+    T load() const {
+        T best = m_identity;
+        for(unsigned i = 0; i < m_shards.size(); ++i) {
+            const T val = m_shards[i].load(std::memory_order_relaxed);
+            if(Compare()(val, best))
+                best = val;
+        }
+        return best;
+    }
+
+    /*back to identity, returns extremum taken out*/
+    T reset() {
+        T best = m_identity;
+        for(unsigned i = 0; i < m_shards.size(); ++i) {
+            const T val = m_shards[i].exchange(m_identity, std::memory_order_relaxed);
+            if(Compare()(val, best))
+                best = val;
+        }
+        return best;
+    }
+
+    unsigned shards_num() const
+    { return m_shards.size(); }
+
+private:
+    detail::shards<T> m_shards;
+    const T m_identity;
+
+}; // class sharded_extremum
+
+template<typename T>
+class sharded_min: public sharded_extremum<T, std::less<T> > {
+
+public:
+    explicit
+    sharded_min(unsigned shards_num = 0):
+        sharded_extremum<T, std::less<T> >(std::numeric_limits<T>::max(), shards_num)
+    {}
+
+}; // class sharded_min
+
+template<typename T>
+class sharded_max: public sharded_extremum<T, std::greater<T> > {
+
+public:
+    explicit
+    sharded_max(unsigned shards_num = 0):
+        sharded_extremum<T, std::greater<T> >(std::numeric_limits<T>::lowest(), shards_num)
+    {}
+
+}; // class sharded_max
+
+/*
+ * Counts of samples per bucket, e.g. latencies. Bucket i holds samples in (bounds[i - 1], bounds[i]],
+ * last bucket (index bounds.size()) holds samples above all bounds.
+ * Every shard keeps its own row of counts on separate cache lines; counts() sums rows.
+ */
+template<typename T = double>
+class sharded_histogram {
+
+public:
+    typedef T value_type;
+
+    /*bounds must be strictly increasing*/
+    explicit
+    sharded_histogram(std::vector<T> bounds, unsigned shards_num = 0):
+        m_bounds(std::move(bounds)),
+        m_lines_per_shard((m_bounds.size() + 1 + counts_per_line - 1) / counts_per_line),
+        m_mask(detail::shards_for(shards_num) - 1)
+    {
+        for(std::size_t i = 1; i < m_bounds.size(); ++i)
+            if(!(m_bounds[i - 1] < m_bounds[i]))
+                throw std::invalid_argument("sharded_histogram: bounds must be strictly increasing");
+
+        m_lines.reset(new counts_line[(m_mask + 1) * m_lines_per_shard]);
+        for(std::size_t line = 0; line < (m_mask + 1) * m_lines_per_shard; ++line)
+            for(std::size_t i = 0; i < counts_per_line; ++i)
+                m_lines[line].m_counts[i].store(0, std::memory_order_relaxed);
+    }
+
+    sharded_histogram(const sharded_histogram& other) = delete;
+    sharded_histogram& operator=(const sharded_histogram& other) = delete;
+
+    void record(T val) {
+        const std::size_t bucket = std::lower_bound(m_bounds.begin(), m_bounds.end(), val) - m_bounds.begin();
+        count_of(detail::current_shard_index() & m_mask, bucket).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /*bounds.size() + 1 counts*/
+    std::vector<std::uint64_t> counts() const {
+        std::vector<std::uint64_t> total(buckets_num(), 0);
+        for(unsigned shard = 0; shard <= m_mask; ++shard)
+            for(std::size_t bucket = 0; bucket < total.size(); ++bucket)
+                total[bucket] += count_of(shard, bucket).load(std::memory_order_relaxed);
+        return total;
+    }
+
+    std::uint64_t count() const {
+        std::vector<std::uint64_t> total = counts();
+        return std::accumulate(total.begin(), total.end(), std::uint64_t(0));
+    }
+
+    /*zero all buckets, returns counts taken out*/
+    std::vector<std::uint64_t> reset() {
+        std::vector<std::uint64_t> total(buckets_num(), 0);
+        for(unsigned shard = 0; shard <= m_mask; ++shard)
+            for(std::size_t bucket = 0; bucket < total.size(); ++bucket)
+                total[bucket] += count_of(shard, bucket).exchange(0, std::memory_order_relaxed);
+        return total;
+    }
+
+    const std::vector<T>& bounds() const
+    { return m_bounds; }
+
+    std::size_t buckets_num() const
+    { return m_bounds.size() + 1; }
+
+    unsigned shards_num() const
+    { return m_mask + 1; }
+
+private:
+    static const std::size_t counts_per_line = cache_line_size / sizeof(std::atomic<std::uint64_t>);
+
+    struct alignas(cache_line_size) counts_line {
+        std::atomic<std::uint64_t> m_counts[counts_per_line];
+    };
+
+    std::atomic<std::uint64_t>& count_of(unsigned shard, std::size_t bucket) const {
+        return m_lines[shard * m_lines_per_shard + bucket / counts_per_line].m_counts[bucket % counts_per_line];
+    }
+
+    const std::vector<T> m_bounds;
+    const std::size_t m_lines_per_shard;
+    const unsigned m_mask;
+    std::unique_ptr<counts_line[]> m_lines;
+
+}; // class sharded_histogram
+
+} // namespace concurrency
+
+#endif
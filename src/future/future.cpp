@@ -0,0 +1,79 @@
+#include "future.hpp"
+
+#include <cerrno>
+
+#include "futex.h"
+
+namespace concurrency::detail {
+
+/*marks continuation list of completed state, nodes attached later run at once*/
+static continuation_node s_completed(nullptr);
+
+void shared_state_base::wait() {
+    for(;;) {
+        int state = m_state.load(std::memory_order_acquire);
+        if(state == ready)
+            return;
+        /*tell completing thread that someone sleeps*/
+        if(state == not_ready && !m_state.compare_exchange_weak(state, not_ready_waited, std::memory_order_relaxed))
+            continue;
+        util::futex_wait(&m_state, not_ready_waited);
+    }
+}
+
+bool shared_state_base::wait_until_monotonic(const timespec& abs_time) {
+    for(;;) {
+        int state = m_state.load(std::memory_order_acquire);
+        if(state == ready)
+            return true;
+        if(state == not_ready && !m_state.compare_exchange_weak(state, not_ready_waited, std::memory_order_relaxed))
+            continue;
+        if(util::futex_wait_until(&m_state, not_ready_waited, abs_time) == -1 && errno == ETIMEDOUT)
+            return is_ready();
+    }
+}
+
+void shared_state_base::complete() {
+    /*
+     * Once ready flag is raised, consumer may drop last reference while producer is still here,
+     * so list is closed before; taken nodes hold references of their own.
+     */
+    continuation_node* node = m_continuations.exchange(&s_completed, std::memory_order_acq_rel);
+
+    /*result is written before ready flag, kernel is entered only if someone sleeps*/
+    if(m_state.exchange(ready, std::memory_order_acq_rel) == not_ready_waited)
+        util::futex_wake_all(&m_state);
+
+    /*list is pushed at head, run continuations in order of attaching*/
+    continuation_node* ordered = nullptr;
+    while(node) {
+        continuation_node* next = node->m_next;
+        node->m_next = ordered;
+        ordered = node;
+        node = next;
+    }
+    while(ordered) {
+        /*node may be freed by its routine*/
+        continuation_node* next = ordered->m_next;
+        ordered->m_run(ordered);
+        ordered = next;
+    }
+}
+
+void shared_state_base::attach(continuation_node* node) {
+    continuation_node* head = m_continuations.load(std::memory_order_acquire);
+    do {
+        if(head == &s_completed) {
+            /*completing thread may not have raised ready flag yet*/
+            wait();
+            node->m_run(node);
+            return;
+        }
+        node->m_next = head;
+    } while(!m_continuations.compare_exchange_weak(
+        head, node,
+        std::memory_order_release, std::memory_order_acquire
+    ));
+}
+
+} // namespace concurrency::detail
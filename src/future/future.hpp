@@ -0,0 +1,852 @@
+#ifndef FUTURE_H
+#define FUTURE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ctime>
+
+#include "timespec.h"
+
+namespace concurrency {
+
+enum class future_status {
+    ready,
+    timeout
+};
+
+template<typename T> class future;
+template<typename T> class shared_future;
+
+namespace detail {
+
+/*callback attached to shared state, run once by thread which completes it*/
+struct continuation_node {
+    typedef void (*routine_type)(continuation_node*);
+
+    explicit continuation_node(routine_type run):
+        m_run(run), m_next(nullptr)
+    {}
+
+    routine_type m_run;
+    continuation_node* m_next;
+};
+
+/*
+ * Part of shared state independent of value type.
+ * Ready flag is futex word: readers check it with single acquire load
+ * and enter kernel only while result is missing.
+ * Continuations are kept in lock-free intrusive list, closed by completion.
+ */
+class shared_state_base {
+
+public:
+    explicit shared_state_base(int refs):
+        m_state(not_ready), m_refs(refs),
+        m_satisfied(false), m_retrieved(false),
+        m_continuations(nullptr)
+    {}
+
+    shared_state_base(const shared_state_base& other) = delete;
+    shared_state_base& operator=(const shared_state_base& other) = delete;
+
+    virtual ~shared_state_base() {}
+
+    void add_ref()
+    { m_refs.fetch_add(1, std::memory_order_relaxed); }
+
+    void release() {
+        if(m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    bool is_ready() const
+    { return m_state.load(std::memory_order_acquire) == ready; }
+
+    void
+    wait();
+
+    /*false on timeout*/
+    bool
+    wait_until_monotonic(const timespec& abs_time);
+
+    /*producer side: only first caller may set result*/
+    bool claim()
+    { return !m_satisfied.exchange(true, std::memory_order_relaxed); }
+
+    /*consumer side: only first caller may take future*/
+    bool retrieve()
+    { return !m_retrieved.exchange(true, std::memory_order_relaxed); }
+
+    /*publishes result: wakes waiters, then runs continuations on calling thread*/
+    void
+    complete();
+
+    void complete_with(std::exception_ptr error) {
+        m_exception = error;
+        complete();
+    }
+
+    /*runs node right away if state is already completed*/
+    void
+    attach(continuation_node* node);
+
+    void rethrow_if_failed() const {
+        if(m_exception)
+            std::rethrow_exception(m_exception);
+    }
+
+protected:
+    bool failed() const
+    { return static_cast<bool>(m_exception); }
+
+private:
+    enum { not_ready, not_ready_waited, ready };
+
+    std::atomic<int> m_state;
+    std::atomic<int> m_refs;
+    std::atomic<bool> m_satisfied;
+    std::atomic<bool> m_retrieved;
+    std::atomic<continuation_node*> m_continuations;
+    std::exception_ptr m_exception;
+
+}; // class shared_state_base
+
+/*value is stored inline, so state, value and (in derived states) callable take one allocation*/
+template<typename T>
+class shared_state: public shared_state_base {
+
+public:
+    typedef const T& const_reference;
+
+    explicit shared_state(int refs): shared_state_base(refs) {}
+
+    ~shared_state() {
+        if(is_ready() && !failed())
+            value().~T();
+    }
+
+    /*value must be constructed before complete()*/
+    template<typename ...Args>
+    void construct(Args&& ...args)
+    { new (m_storage) T(std::forward<Args>(args)...); }
+
+    T move_value()
+    { return std::move(value()); }
+
+    const T& get_value()
+    { return value(); }
+
+private:
+    T& value()
+    { return *std::launder(reinterpret_cast<T*>(m_storage)); }
+
+    alignas(T) unsigned char m_storage[sizeof(T)];
+
+}; // class shared_state
+
+template<>
+class shared_state<void>: public shared_state_base {
+
+public:
+    typedef void const_reference;
+
+    explicit shared_state(int refs): shared_state_base(refs) {}
+
+    void construct() {}
+
+    void move_value() {}
+
+    void get_value() {}
+
+}; // class shared_state<void>
+
+/*owning pointer to shared state, one reference per instance*/
+template<typename State>
+class state_ptr {
+
+public:
+    state_ptr() noexcept: m_ptr(nullptr) {}
+
+    /*takes over reference owned by caller*/
+    explicit state_ptr(State* ptr) noexcept: m_ptr(ptr) {}
+
+    state_ptr(const state_ptr& other) noexcept: m_ptr(other.m_ptr) {
+        if(m_ptr)
+            m_ptr->add_ref();
+    }
+
+    state_ptr(state_ptr&& other) noexcept: m_ptr(other.m_ptr)
+    { other.m_ptr = nullptr; }
+
+    state_ptr& operator=(state_ptr other) noexcept {
+        std::swap(m_ptr, other.m_ptr);
+        return *this;
+    }
+
+    ~state_ptr() {
+        if(m_ptr)
+            m_ptr->release();
+    }
+
+    State*
+    get() const
+    { return m_ptr; }
+
+    State* operator->() const
+    { return m_ptr; }
+
+    explicit operator bool() const
+    { return m_ptr != nullptr; }
+
+private:
+    State* m_ptr;
+
+}; // class state_ptr
+
+/*lets producers build futures from states and combinators reach states of futures*/
+struct state_access {
+    template<typename T>
+    static future<T> make_future(shared_state<T>* state)
+    { return future<T>(state_ptr<shared_state<T> >(state)); }
+
+    template<typename Future>
+    static shared_state_base* state_of(const Future& fut)
+    { return fut.m_state.get(); }
+};
+
+/*invokes callable and stores its result or exception in state, never throws*/
+template<typename R, typename Callable, typename ...Args>
+void fulfil(shared_state<R>* state, Callable& callb, Args&& ...args) noexcept {
+    try {
+        if constexpr(std::is_void<R>::value) {
+            std::invoke(callb, std::forward<Args>(args)...);
+            state->construct();
+        }
+        else
+            state->construct(std::invoke(callb, std::forward<Args>(args)...));
+    }
+    catch(...) {
+        state->complete_with(std::current_exception());
+        return;
+    }
+    state->complete();
+}
+
+/*executor of then() without one: continuation runs on thread completing antecedent*/
+struct inline_executor {
+    template<typename Callable>
+    void submit(Callable callb)
+    { callb(); }
+}; // struct inline_executor
+
+/*
+ * State of future returned by then(): also continuation attached to antecedent.
+ * Holds antecedent future, so antecedent state lives until callable gets it.
+ */
+template<typename R, typename Antecedent, typename Callable, typename Executor>
+class continuation_state: public shared_state<R>, public continuation_node {
+
+public:
+    /*one reference for resulting future, one until continuation has run*/
+    template<typename C>
+    continuation_state(Antecedent&& antecedent, C&& callb, Executor* executor):
+        shared_state<R>(2), continuation_node(run),
+        m_antecedent(std::move(antecedent)),
+        m_callable(std::forward<C>(callb)),
+        m_executor(executor)
+    {}
+
+    void start()
+    { state_access::state_of(m_antecedent)->attach(this); }
+
+private:
+    static void run(continuation_node* node) {
+        continuation_state* self = static_cast<continuation_state*>(node);
+        dispatch(self, self->m_executor);
+    }
+
+    static void dispatch(continuation_state* self, inline_executor*)
+    { self->execute(); }
+
+    template<typename E>
+    static void dispatch(continuation_state* self, E* executor) {
+        try {
+            executor->submit([self] () { self->execute(); });
+        }
+        catch(...) {
+            /*executor refused task (e.g. it is shut down)*/
+            self->complete_with(std::current_exception());
+            self->release();
+        }
+    }
+
+    void execute() {
+        fulfil<R>(this, m_callable, std::move(m_antecedent));
+        this->release();
+    }
+
+    Antecedent m_antecedent;
+    Callable m_callable;
+    Executor* m_executor;
+
+}; // class continuation_state
+
+template<typename Antecedent, typename Callable>
+using continuation_result_t = typename std::invoke_result<std::decay_t<Callable>&, Antecedent>::type;
+
+template<typename R, typename Antecedent, typename Callable, typename Executor>
+future<R> make_continuation(Antecedent&& antecedent, Callable&& callb, Executor* executor) {
+    typedef continuation_state<R, Antecedent, std::decay_t<Callable>, Executor> state_type;
+
+    state_type* state = new state_type(std::move(antecedent), std::forward<Callable>(callb), executor);
+    future<R> result = state_access::make_future<R>(state);
+    state->start();
+    return result;
+}
+
+/*wait functions common to future and shared_future*/
+template<typename T>
+class basic_future {
+
+public:
+    bool valid() const noexcept
+    { return static_cast<bool>(m_state); }
+
+    /*single atomic load, never blocks*/
+    bool is_ready() const
+    { return checked_state()->is_ready(); }
+
+    void wait() const
+    { checked_state()->wait(); }
+
+    template<typename Rep, typename Period>
+    future_status wait_for(const std::chrono::duration<Rep, Period>& rel_time) const
+    { return wait_until(util::deadline_after(rel_time)); }
+
+    template<typename Clock, typename Duration>
+    future_status wait_until(const std::chrono::time_point<Clock, Duration>& abs_time) const {
+        shared_state<T>* state = checked_state();
+        if(state->is_ready() || state->wait_until_monotonic(util::to_monotonic_timespec(abs_time)))
+            return future_status::ready;
+        return future_status::timeout;
+    }
+
+protected:
+    basic_future() noexcept {}
+
+    explicit basic_future(state_ptr<shared_state<T> > state) noexcept:
+        m_state(std::move(state))
+    {}
+
+    shared_state<T>* checked_state() const {
+        if(!m_state)
+            throw std::runtime_error("future: no shared state");
+        return m_state.get();
+    }
+
+    state_ptr<shared_state<T> > m_state;
+
+    friend struct state_access;
+
+}; // class basic_future
+
+} // namespace detail
+
+/*
+ * Result of asynchronous operation, received once.
+ * get() on completed future is single acquire load plus move of value.
+ * then() attaches continuation taking this future, future becomes invalid.
+ * Continuation runs on thread completing this future (or on calling thread,
+ * if it is already completed), or is submitted to given executor:
+ * any object with submit(callable), e.g. thread_pool or work_stealing_pool.
+ */
+template<typename T>
+class future: public detail::basic_future<T> {
+
+    typedef detail::basic_future<T> base_type;
+
+public:
+    typedef T value_type;
+
+    future() noexcept {}
+
+    future(future&& other) noexcept = default;
+    future& operator=(future&& other) noexcept = default;
+
+    future(const future& other) = delete;
+    future& operator=(const future& other) = delete;
+
+    /*waits for result, rethrows stored exception; future becomes invalid*/
+    T get() {
+        this->checked_state();
+        detail::state_ptr<detail::shared_state<T> > state(std::move(this->m_state));
+
+        state->wait();
+        state->rethrow_if_failed();
+        return state->move_value();
+    }
+
+    shared_future<T> share() noexcept
+    { return shared_future<T>(std::move(*this)); }
+
+    template<typename Callable>
+    future<detail::continuation_result_t<future, Callable> > then(Callable&& callb) {
+        return then_on<detail::inline_executor>(nullptr, std::forward<Callable>(callb));
+    }
+
+    template<typename Executor, typename Callable>
+    future<detail::continuation_result_t<future, Callable> > then(Executor& executor, Callable&& callb) {
+        return then_on<Executor>(&executor, std::forward<Callable>(callb));
+    }
+
+private:
+    explicit future(detail::state_ptr<detail::shared_state<T> > state) noexcept:
+        base_type(std::move(state))
+    {}
+
+    template<typename Executor, typename Callable>
+    future<detail::continuation_result_t<future, Callable> > then_on(Executor* executor, Callable&& callb) {
+        this->checked_state();
+        return detail::make_continuation<detail::continuation_result_t<future, Callable> >(
+            std::move(*this), std::forward<Callable>(callb), executor
+        );
+    }
+
+    friend class shared_future<T>;
+    friend struct detail::state_access;
+
+}; // class future
+
+/*copyable future, every copy may get() the same result*/
+template<typename T>
+class shared_future: public detail::basic_future<T> {
+
+    typedef detail::basic_future<T> base_type;
+
+public:
+    typedef T value_type;
+
+    shared_future() noexcept {}
+
+    shared_future(future<T>&& other) noexcept:
+        base_type(std::move(other.m_state))
+    {}
+
+    /*waits for result, rethrows stored exception*/
+    typename detail::shared_state<T>::const_reference get() const {
+        detail::shared_state<T>* state = this->checked_state();
+
+        state->wait();
+        state->rethrow_if_failed();
+        return state->get_value();
+    }
+
+    /*continuation gets copy of this shared_future*/
+    template<typename Callable>
+    future<detail::continuation_result_t<shared_future, Callable> > then(Callable&& callb) const {
+        return then_on<detail::inline_executor>(nullptr, std::forward<Callable>(callb));
+    }
+
+    template<typename Executor, typename Callable>
+    future<detail::continuation_result_t<shared_future, Callable> > then(Executor& executor, Callable&& callb) const {
+        return then_on<Executor>(&executor, std::forward<Callable>(callb));
+    }
+
+private:
+    template<typename Executor, typename Callable>
+    future<detail::continuation_result_t<shared_future, Callable> > then_on(Executor* executor, Callable&& callb) const {
+        this->checked_state();
+        return detail::make_continuation<detail::continuation_result_t<shared_future, Callable> >(
+            shared_future(*this), std::forward<Callable>(callb), executor
+        );
+    }
+
+}; // class shared_future
+
+/*
+ * Producer side of future.
+ * Destroying promise without result stores broken promise exception.
+ */
+template<typename T>
+class promise {
+
+public:
+    promise():
+        m_state(new detail::shared_state<T>(1))
+    {}
+
+    promise(promise&& other) noexcept = default;
+
+    promise& operator=(promise&& other) noexcept {
+        promise(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    promise(const promise& other) = delete;
+    promise& operator=(const promise& other) = delete;
+
+    ~promise() {
+        if(m_state && m_state->claim())
+            m_state->complete_with(std::make_exception_ptr(std::runtime_error("promise: broken promise")));
+    }
+
+    void swap(promise& other) noexcept
+    { std::swap(m_state, other.m_state); }
+
+    future<T> get_future() {
+        if(!checked_state()->retrieve())
+            throw std::runtime_error("promise::get_future: future already retrieved");
+        m_state->add_ref();
+        return detail::state_access::make_future<T>(m_state.get());
+    }
+
+    /*no arguments for promise<void>*/
+    template<typename ...Args>
+    void set_value(Args&& ...args) {
+        if(!checked_state()->claim())
+            throw std::runtime_error("promise::set_value: result already set");
+
+        try {
+            m_state->construct(std::forward<Args>(args)...);
+        }
+        catch(...) {
+            m_state->complete_with(std::current_exception());
+            throw;
+        }
+        m_state->complete();
+    }
+
+    void set_exception(std::exception_ptr error) {
+        if(!checked_state()->claim())
+            throw std::runtime_error("promise::set_exception: result already set");
+        m_state->complete_with(error);
+    }
+
+private:
+    detail::shared_state<T>* checked_state() const {
+        if(!m_state)
+            throw std::runtime_error("promise: no shared state");
+        return m_state.get();
+    }
+
+    detail::state_ptr<detail::shared_state<T> > m_state;
+
+}; // class promise
+
+namespace detail {
+
+template<typename R, typename ...Args>
+class task_state_base: public shared_state<R> {
+
+public:
+    task_state_base(): shared_state<R>(1) {}
+
+    virtual void
+    invoke(Args&& ...args) = 0;
+
+}; // class task_state_base
+
+template<typename R, typename Callable, typename ...Args>
+class task_state: public task_state_base<R, Args...> {
+
+public:
+    template<typename C>
+    explicit task_state(C&& callb): m_callable(std::forward<C>(callb)) {}
+
+    void invoke(Args&& ...args) override
+    { fulfil<R>(this, m_callable, std::forward<Args>(args)...); }
+
+private:
+    Callable m_callable;
+
+}; // class task_state
+
+} // namespace detail
+
+template<typename Signature> class packaged_task;
+
+/*
+ * Callable wrapper storing its result in future, can be run once.
+ * Callable is kept in the same allocation as shared state.
+ */
+template<typename R, typename ...Args>
+class packaged_task<R(Args...)> {
+
+public:
+    packaged_task() noexcept {}
+
+    template<
+        typename Callable,
+        typename = std::enable_if_t<!std::is_same<std::decay_t<Callable>, packaged_task>::value>
+    >
+    explicit packaged_task(Callable&& callb):
+        m_state(new detail::task_state<R, std::decay_t<Callable>, Args...>(std::forward<Callable>(callb)))
+    {}
+
+    packaged_task(packaged_task&& other) noexcept = default;
+
+    packaged_task& operator=(packaged_task&& other) noexcept {
+        packaged_task(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    packaged_task(const packaged_task& other) = delete;
+    packaged_task& operator=(const packaged_task& other) = delete;
+
+    ~packaged_task() {
+        if(m_state && m_state->claim())
+            m_state->complete_with(std::make_exception_ptr(std::runtime_error("promise: broken promise")));
+    }
+
+    void swap(packaged_task& other) noexcept
+    { std::swap(m_state, other.m_state); }
+
+    bool valid() const noexcept
+    { return static_cast<bool>(m_state); }
+
+    future<R> get_future() {
+        if(!checked_state()->retrieve())
+            throw std::runtime_error("packaged_task::get_future: future already retrieved");
+        m_state->add_ref();
+        return detail::state_access::make_future<R>(m_state.get());
+    }
+
+    /*exception of callable is stored in future, not thrown*/
+    void operator()(Args ...args) {
+        if(!checked_state()->claim())
+            throw std::runtime_error("packaged_task: task already invoked");
+        m_state->invoke(std::forward<Args>(args)...);
+    }
+
+private:
+    detail::task_state_base<R, Args...>* checked_state() const {
+        if(!m_state)
+            throw std::runtime_error("packaged_task: no shared state");
+        return m_state.get();
+    }
+
+    detail::state_ptr<detail::task_state_base<R, Args...> > m_state;
+
+}; // class packaged_task
+
+template<typename Sequence>
+struct when_any_result {
+    std::size_t index;  /*first completed input, -1 for empty input*/
+    Sequence futures;
+}; // struct when_any_result
+
+namespace detail {
+
+template<typename Future>
+Future take_input(future<typename Future::value_type>& fut)
+{ return std::move(fut); }
+
+template<typename Future>
+Future take_input(const shared_future<typename Future::value_type>& fut)
+{ return fut; }
+
+template<typename Future>
+void collect_state(const Future& fut, std::vector<shared_state_base*>& states) {
+    shared_state_base* state = state_access::state_of(fut);
+    if(!state)
+        throw std::invalid_argument("when_all/when_any: input future has no shared state");
+    states.push_back(state);
+}
+
+template<typename Future>
+void collect_states(const std::vector<Future>& futures, std::vector<shared_state_base*>& states) {
+    for(std::size_t i = 0; i < futures.size(); ++i)
+        collect_state(futures[i], states);
+}
+
+template<typename ...Futures>
+void collect_states(const std::tuple<Futures...>& futures, std::vector<shared_state_base*>& states) {
+    std::apply([&states] (const Futures& ...fut) { (collect_state(fut, states), ...); }, futures);
+}
+
+/*
+ * Shared state of when_all/when_any: inputs are kept here until result is formed,
+ * every input gets continuation node holding references to its state and to this one.
+ */
+template<typename Result, typename Sequence, bool Any>
+class combinator_state: public shared_state<Result> {
+
+public:
+    explicit combinator_state(Sequence&& futures):
+        shared_state<Result>(1),
+        m_futures(std::move(futures)),
+        m_done(false)
+    {
+        std::vector<shared_state_base*> states;
+        collect_states(m_futures, states);
+
+        m_nodes.reserve(states.size());
+        for(std::size_t i = 0; i < states.size(); ++i)
+            m_nodes.push_back(input_node(this, i, states[i]));
+        m_pending.store(states.size(), std::memory_order_relaxed);
+    }
+
+    void start() {
+        if(m_nodes.empty()) {
+            finish(static_cast<std::size_t>(-1));
+            return;
+        }
+
+        /*first completion may move inputs away, so references are taken before any attach*/
+        for(std::size_t i = 0; i < m_nodes.size(); ++i) {
+            m_nodes[i].m_input->add_ref();
+            this->add_ref();
+        }
+        for(std::size_t i = 0; i < m_nodes.size(); ++i)
+            m_nodes[i].m_input->attach(&m_nodes[i]);
+    }
+
+private:
+    struct input_node: continuation_node {
+        input_node(combinator_state* owner, std::size_t index, shared_state_base* input):
+            continuation_node(run), m_owner(owner), m_index(index), m_input(input)
+        {}
+
+        static void run(continuation_node* node) {
+            input_node* self = static_cast<input_node*>(node);
+            /*node lives in owner, which may go away with last release*/
+            combinator_state* owner = self->m_owner;
+            shared_state_base* input = self->m_input;
+
+            owner->input_ready(self->m_index);
+            input->release();
+            owner->release();
+        }
+
+        combinator_state* m_owner;
+        std::size_t m_index;
+        shared_state_base* m_input;
+    }; // struct input_node
+
+    void input_ready(std::size_t index) {
+        if(Any) {
+            if(!m_done.exchange(true, std::memory_order_acq_rel))
+                finish(index);
+        }
+        else if(m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            finish(index);
+    }
+
+    void finish(std::size_t index) {
+        try {
+            construct_result(index, std::integral_constant<bool, Any>());
+        }
+        catch(...) {
+            this->complete_with(std::current_exception());
+            return;
+        }
+        this->complete();
+    }
+
+    void construct_result(std::size_t, std::false_type)
+    { this->construct(std::move(m_futures)); }
+
+    void construct_result(std::size_t index, std::true_type)
+    { this->construct(Result{index, std::move(m_futures)}); }
+
+    Sequence m_futures;
+    std::vector<input_node> m_nodes;
+    std::atomic<std::size_t> m_pending;
+    std::atomic<bool> m_done;
+
+}; // class combinator_state
+
+template<typename Result, bool Any, typename Sequence>
+future<Result> make_combinator(Sequence&& futures) {
+    typedef combinator_state<Result, Sequence, Any> state_type;
+
+    state_type* state = new state_type(std::move(futures));
+    future<Result> result = state_access::make_future<Result>(state);
+    state->start();
+    return result;
+}
+
+} // namespace detail
+
+/*
+ * Future completed when every input is completed (with value or exception).
+ * future inputs are moved from, shared_future inputs are copied.
+ */
+template<typename InputIt>
+future<std::vector<typename std::iterator_traits<InputIt>::value_type> >
+when_all(InputIt first, InputIt last) {
+    typedef typename std::iterator_traits<InputIt>::value_type future_type;
+    typedef std::vector<future_type> sequence_type;
+
+    sequence_type futures;
+    for(; first != last; ++first)
+        futures.push_back(detail::take_input<future_type>(*first));
+    return detail::make_combinator<sequence_type, false>(std::move(futures));
+}
+
+template<typename ...Futures>
+future<std::tuple<std::decay_t<Futures>...> >
+when_all(Futures&& ...inputs) {
+    typedef std::tuple<std::decay_t<Futures>...> sequence_type;
+
+    sequence_type futures(detail::take_input<std::decay_t<Futures> >(inputs)...);
+    return detail::make_combinator<sequence_type, false>(std::move(futures));
+}
+
+/*future completed when first of inputs is completed, result tells which one*/
+template<typename InputIt>
+future<when_any_result<std::vector<typename std::iterator_traits<InputIt>::value_type> > >
+when_any(InputIt first, InputIt last) {
+    typedef typename std::iterator_traits<InputIt>::value_type future_type;
+    typedef std::vector<future_type> sequence_type;
+
+    sequence_type futures;
+    for(; first != last; ++first)
+        futures.push_back(detail::take_input<future_type>(*first));
+    return detail::make_combinator<when_any_result<sequence_type>, true>(std::move(futures));
+}
+
+template<typename ...Futures>
+future<when_any_result<std::tuple<std::decay_t<Futures>...> > >
+when_any(Futures&& ...inputs) {
+    typedef std::tuple<std::decay_t<Futures>...> sequence_type;
+
+    sequence_type futures(detail::take_input<std::decay_t<Futures> >(inputs)...);
+    return detail::make_combinator<when_any_result<sequence_type>, true>(std::move(futures));
+}
+
+/*already completed future*/
+template<typename T>
+future<std::decay_t<T> > make_ready_future(T&& value) {
+    promise<std::decay_t<T> > prom;
+    prom.set_value(std::forward<T>(value));
+    return prom.get_future();
+}
+
+inline future<void> make_ready_future() {
+    promise<void> prom;
+    prom.set_value();
+    return prom.get_future();
+}
+
+template<typename T>
+future<T> make_exceptional_future(std::exception_ptr error) {
+    promise<T> prom;
+    prom.set_exception(error);
+    return prom.get_future();
+}
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,497 @@
+#ifndef CONCURRENT_HASH_MAP_H
+#define CONCURRENT_HASH_MAP_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "mutex.hpp"
+#include "spin_lock.hpp"
+#include "epoch.hpp"
+
+namespace concurrency {
+
+/*
+ * Hash map for many readers and writers.
+ * Open addressing over cache-line buckets of 7 slots; slot holds pointer to immutable node
+ * (key and value), bucket keeps one-byte hash tag per slot, so probe compares keys only on tag match,
+ * and count of keys which probed past it while it was full, so probe ends at first bucket without them.
+ *
+ * Writers lock one of striped mutexes chosen by hash of key, readers take no lock: they walk
+ * buckets under epoch_guard and validate version of stripe, retrying if writer of same stripe ran meanwhile.
+ * Nodes are never changed once published: update builds new node and swaps pointer,
+ * replaced and erased nodes are reclaimed by epoch-based reclamation.
+ *
+ * Growing table gets successor of twice the size; nodes are moved to it in chunks of buckets
+ * by writers which pass by, so no operation waits for whole table to be copied.
+ * Until move is finished, lookups look at old table first and then at its successor.
+ */
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key> >
+class concurrent_hash_map {
+
+public:
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef Hash hasher;
+    typedef KeyEqual key_equal;
+
+    /*capacity - number of elements to hold without growing, stripes is rounded up to power of two*/
+    explicit
+    concurrent_hash_map(std::size_t capacity = 64, std::size_t stripes = 64, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual()):
+        m_hash(hash),
+        m_equal(equal),
+        m_table(new table(buckets_for(capacity))),
+        m_stripes(nullptr),
+        m_stripe_mask(round_up_pow2(stripes) - 1),
+        m_size(0)
+    {
+        if(stripes == 0) {
+            delete m_table.load(std::memory_order_relaxed);
+            throw std::invalid_argument("concurrent_hash_map: zero stripes");
+        }
+        m_stripes.reset(new stripe[m_stripe_mask + 1]);
+    }
+
+    concurrent_hash_map(const concurrent_hash_map& other) = delete;
+    concurrent_hash_map& operator=(const concurrent_hash_map& other) = delete;
+
+    /*no other thread may use map any more*/
+    ~concurrent_hash_map() {
+        table* t = m_table.load(std::memory_order_relaxed);
+        while(t) {
+            for(std::size_t i = 0; i <= t->m_mask; ++i)
+                for(unsigned slot = 0; slot < bucket_slots; ++slot) {
+                    node* n = t->m_buckets[i].m_slots[slot].load(std::memory_order_relaxed);
+                    if(n && n != moved())
+                        delete n;
+                }
+            table* next = t->m_next.load(std::memory_order_relaxed);
+            delete t;
+            t = next;
+        }
+    }
+
+    /*copies value of key to out, false if key is absent*/
+    bool find(const Key& key, T& out) const {
+        const std::size_t hash = hash_of(key);
+        epoch_guard guard;
+        const node* found = lookup(hash, key);
+        if(!found)
+            return false;
+        out = found->m_value;
+        return true;
+    }
+
+    bool contains(const Key& key) const {
+        const std::size_t hash = hash_of(key);
+        epoch_guard guard;
+        return lookup(hash, key) != nullptr;
+    }
+
+    /*false if key is already present, map is not changed then*/
+    bool insert(const Key& key, const T& value)
+    { return emplace(key, value); }
+
+    bool insert(const Key& key, T&& value)
+    { return emplace(key, std::move(value)); }
+
+    /*value is constructed from args before stripe is locked, and dropped if key is present*/
+    template<typename ...Args>
+    bool emplace(const Key& key, Args&& ...args) {
+        const std::size_t hash = hash_of(key);
+        std::unique_ptr<node> fresh(new node(hash, key, std::forward<Args>(args)...));
+
+        epoch_guard guard;
+        bool inserted = false;
+        {
+            stripe_writer writer(stripe_of(hash));
+            table* t = writable_table(hash, key);
+            if(!locate(t, hash, key).m_node) {
+                publish(t, fresh.release());
+                inserted = true;
+            }
+        }
+        help_move();
+        return inserted;
+    }
+
+    /*false if key is absent*/
+    bool erase(const Key& key) {
+        const std::size_t hash = hash_of(key);
+
+        epoch_guard guard;
+        bool erased = false;
+        {
+            stripe_writer writer(stripe_of(hash));
+            table* t = writable_table(hash, key);
+            position pos = locate(t, hash, key);
+            if(pos.m_node) {
+                unlink(t, pos);
+                epoch_retire(pos.m_node);
+                erased = true;
+            }
+        }
+        help_move();
+        return erased;
+    }
+
+    /*
+     * Inserts value if key is absent (returns true), otherwise calls updater(T&)
+     * on copy of present value, which then replaces it at once (returns false):
+     * concurrent readers see either old or updated value, never partially updated one.
+     * Updaters of keys of one stripe run one at a time, so they must not touch the map.
+     */
+    template<typename Updater>
+    bool upsert(const Key& key, Updater updater, const T& value) {
+        const std::size_t hash = hash_of(key);
+
+        epoch_guard guard;
+        bool inserted = false;
+        {
+            stripe_writer writer(stripe_of(hash));
+            table* t = writable_table(hash, key);
+            position pos = locate(t, hash, key);
+            if(pos.m_node) {
+                std::unique_ptr<node> updated(new node(hash, key, pos.m_node->m_value));
+                updater(updated->m_value);
+                pos.m_bucket->m_slots[pos.m_slot].store(updated.release(), std::memory_order_release);
+                epoch_retire(pos.m_node);
+            }
+            else {
+                publish(t, new node(hash, key, value));
+                inserted = true;
+            }
+        }
+        help_move();
+        return inserted;
+    }
+
+    /*approximate under concurrent use*/
+    std::size_t size() const
+    { return m_size.load(std::memory_order_relaxed); }
+
+    bool empty() const
+    { return size() == 0; }
+
+    /*buckets of newest table, grows before move to it is finished*/
+    std::size_t bucket_count() const {
+        epoch_guard guard;
+        table* t = m_table.load(std::memory_order_acquire);
+        while(table* next = t->m_next.load(std::memory_order_acquire))
+            t = next;
+        return t->m_mask + 1;
+    }
+
+private:
+    static const unsigned bucket_slots = 7;
+    static const std::size_t move_chunk = 16; /*buckets moved by one writer at once*/
+    static const unsigned overflow_shift = 56;
+    static const std::uint64_t overflow_max = 0xFF;
+
+    struct node {
+        template<typename ...Args>
+        node(std::size_t hash, const Key& key, Args&& ...args):
+            m_hash(hash), m_key(key), m_value(std::forward<Args>(args)...)
+        {}
+
+        const std::size_t m_hash;
+        const Key m_key;
+        T m_value;
+    }; // struct node
+
+    struct alignas(64) bucket {
+        bucket(): m_meta(0) {
+            for(unsigned slot = 0; slot < bucket_slots; ++slot)
+                m_slots[slot].store(nullptr, std::memory_order_relaxed);
+        }
+
+        /*tag of slot i in byte i (0 - no tag), overflow count in highest byte*/
+        std::atomic<std::uint64_t> m_meta;
+        std::atomic<node*> m_slots[bucket_slots];
+    }; // struct bucket
+
+    struct table {
+        explicit table(std::size_t buckets_num):
+            m_buckets(new bucket[buckets_num]),
+            m_mask(buckets_num - 1),
+            m_count(0),
+            m_next(nullptr),
+            m_claimed_chunks(0),
+            m_moved_chunks(0)
+        {}
+
+        ~table()
+        { delete[] m_buckets; }
+
+        std::size_t chunks() const
+        { return (m_mask + move_chunk) / move_chunk; }
+
+        /*successor is created at 3/4 load*/
+        bool overloaded() const
+        { return m_count.load(std::memory_order_relaxed) * 4 > (m_mask + 1) * bucket_slots * 3; }
+
+        bucket* m_buckets;
+        const std::size_t m_mask;
+        std::atomic<std::size_t> m_count;
+        std::atomic<table*> m_next;
+        std::atomic<std::size_t> m_claimed_chunks;
+        std::atomic<std::size_t> m_moved_chunks;
+    }; // struct table
+
+    /*version is odd while writer holds mutex*/
+    struct alignas(64) stripe {
+        stripe(): m_version(0) {}
+
+        mutex m_mutex;
+        std::atomic<std::uint64_t> m_version;
+    }; // struct stripe
+
+    class stripe_writer {
+
+    public:
+        explicit stripe_writer(stripe& owned): m_stripe(owned) {
+            m_stripe.m_mutex.lock();
+            m_stripe.m_version.store(m_stripe.m_version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            /*readers which see any change made under lock see odd version too*/
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        stripe_writer(const stripe_writer& other) = delete;
+        stripe_writer& operator=(const stripe_writer& other) = delete;
+
+        ~stripe_writer() {
+            m_stripe.m_version.store(m_stripe.m_version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            m_stripe.m_mutex.unlock();
+        }
+
+    private:
+        stripe& m_stripe;
+
+    }; // class stripe_writer
+
+    struct position {
+        bucket* m_bucket;
+        unsigned m_slot;
+        std::size_t m_distance; /*buckets from home bucket*/
+        node* m_node;           /*nullptr - key not found*/
+    }; // struct position
+
+    /*marks slot whose node (if any) went to successor table*/
+    static node* moved() noexcept {
+        static char marker;
+        return reinterpret_cast<node*>(&marker);
+    }
+
+    static std::size_t round_up_pow2(std::size_t capacity) {
+        std::size_t pow2 = 1;
+        while(pow2 < capacity)
+            pow2 <<= 1;
+        return pow2;
+    }
+
+    static std::size_t buckets_for(std::size_t capacity)
+    { return round_up_pow2((capacity * 4 / 3 + bucket_slots - 1) / bucket_slots); }
+
+    static std::uint64_t tag_of(std::size_t hash) noexcept
+    { return (static_cast<std::uint64_t>(hash) >> 56) | 0x80; }
+
+    static std::uint64_t tag_at(std::uint64_t meta, unsigned slot) noexcept
+    { return (meta >> (8 * slot)) & 0xFF; }
+
+    /*user hash is mixed, std::hash of integers is identity*/
+    std::size_t hash_of(const Key& key) const {
+        const std::uint64_t mixed = static_cast<std::uint64_t>(m_hash(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(mixed ^ (mixed >> 32));
+    }
+
+    stripe& stripe_of(std::size_t hash) const
+    { return m_stripes[(static_cast<std::uint64_t>(hash) >> 32) & m_stripe_mask]; }
+
+    static void add_overflow(bucket& b) {
+        std::uint64_t meta = b.m_meta.load(std::memory_order_relaxed);
+        while((meta >> overflow_shift) != overflow_max &&
+            !b.m_meta.compare_exchange_weak(meta, meta + (std::uint64_t(1) << overflow_shift), std::memory_order_release))
+            ;
+    }
+
+    /*saturated count stays, lookups then only probe further*/
+    static void remove_overflow(bucket& b) {
+        std::uint64_t meta = b.m_meta.load(std::memory_order_relaxed);
+        while((meta >> overflow_shift) != overflow_max &&
+            !b.m_meta.compare_exchange_weak(meta, meta - (std::uint64_t(1) << overflow_shift), std::memory_order_release))
+            ;
+    }
+
+    /*slots moved to successor are skipped, their nodes are found there*/
+    position locate(table* t, std::size_t hash, const Key& key) const {
+        const std::uint64_t tag = tag_of(hash);
+        for(std::size_t distance = 0; distance <= t->m_mask; ++distance) {
+            bucket& b = t->m_buckets[(hash + distance) & t->m_mask];
+            const std::uint64_t meta = b.m_meta.load(std::memory_order_acquire);
+            for(unsigned slot = 0; slot < bucket_slots; ++slot) {
+                if(tag_at(meta, slot) != tag)
+                    continue;
+                node* n = b.m_slots[slot].load(std::memory_order_acquire);
+                if(n && n != moved() && n->m_hash == hash && m_equal(n->m_key, key))
+                    return position{&b, slot, distance, n};
+            }
+            if((meta >> overflow_shift) == 0)
+                break;
+        }
+        return position{nullptr, 0, 0, nullptr};
+    }
+
+    /*caller is inside epoch_guard*/
+    const node* lookup(std::size_t hash, const Key& key) const {
+        const stripe& owner = stripe_of(hash);
+        backoff_exponential backoff;
+        for(;;) {
+            const std::uint64_t version = owner.m_version.load(std::memory_order_acquire);
+            if((version & 1) == 0) {
+                const node* found = nullptr;
+                for(table* t = m_table.load(std::memory_order_acquire); t && !found; t = t->m_next.load(std::memory_order_acquire))
+                    found = locate(t, hash, key).m_node;
+                if(owner.m_version.load(std::memory_order_acquire) == version)
+                    return found;
+            }
+            backoff.pause();
+        }
+    }
+
+    table* successor(table* t) {
+        table* next = t->m_next.load(std::memory_order_acquire);
+        if(next)
+            return next;
+
+        table* fresh = new table(2 * (t->m_mask + 1));
+        if(t->m_next.compare_exchange_strong(next, fresh, std::memory_order_acq_rel))
+            return fresh;
+        delete fresh;
+        return next;
+    }
+
+    /*false - t is full or being moved, caller holds stripe of n*/
+    bool try_place(table* t, node* n) {
+        const std::uint64_t tag = tag_of(n->m_hash);
+        for(std::size_t distance = 0; distance <= t->m_mask; ++distance) {
+            bucket& b = t->m_buckets[(n->m_hash + distance) & t->m_mask];
+            for(unsigned slot = 0; slot < bucket_slots; ++slot) {
+                node* current = b.m_slots[slot].load(std::memory_order_relaxed);
+                if(current == nullptr &&
+                    b.m_slots[slot].compare_exchange_strong(current, n, std::memory_order_acq_rel)) {
+                    b.m_meta.fetch_or(tag << (8 * slot), std::memory_order_release);
+                    t->m_count.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+                if(current == moved())
+                    return false;
+            }
+            add_overflow(b);
+        }
+        return false;
+    }
+
+    /*n goes to t or to first successor which takes it*/
+    void place(table* t, node* n) {
+        while(!try_place(t, n))
+            t = successor(t);
+    }
+
+    void publish(table* t, node* n) {
+        place(t, n);
+        m_size.fetch_add(1, std::memory_order_relaxed);
+        if(t->overloaded())
+            successor(t);
+    }
+
+    /*caller holds stripe of node at pos*/
+    void unlink(table* t, const position& pos) {
+        pos.m_bucket->m_meta.fetch_and(~(std::uint64_t(0xFF) << (8 * pos.m_slot)), std::memory_order_release);
+        for(std::size_t distance = 0; distance < pos.m_distance; ++distance)
+            remove_overflow(t->m_buckets[(pos.m_node->m_hash + distance) & t->m_mask]);
+        pos.m_bucket->m_slots[pos.m_slot].store(nullptr, std::memory_order_release);
+        t->m_count.fetch_sub(1, std::memory_order_relaxed);
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /*
+     * Newest table, with key moved to it from older ones.
+     * Caller holds stripe of key, so no one else moves or changes it meanwhile.
+     */
+    table* writable_table(std::size_t hash, const Key& key) {
+        table* t = m_table.load(std::memory_order_acquire);
+        while(table* next = t->m_next.load(std::memory_order_acquire)) {
+            position pos = locate(t, hash, key);
+            if(pos.m_node) {
+                place(next, pos.m_node);
+                pos.m_bucket->m_slots[pos.m_slot].store(moved(), std::memory_order_release);
+            }
+            t = next;
+        }
+        return t;
+    }
+
+    /*slot ends up moved, node it held (if any) is placed to successor first*/
+    void move_slot(table* t, bucket& b, unsigned slot) {
+        table* next = t->m_next.load(std::memory_order_acquire);
+        for(;;) {
+            node* n = b.m_slots[slot].load(std::memory_order_acquire);
+            if(n == moved())
+                return;
+            if(n == nullptr) {
+                if(b.m_slots[slot].compare_exchange_strong(n, moved(), std::memory_order_acq_rel))
+                    return;
+                continue;
+            }
+
+            stripe_writer writer(stripe_of(n->m_hash));
+            if(b.m_slots[slot].load(std::memory_order_acquire) == n) {
+                place(next, n);
+                b.m_slots[slot].store(moved(), std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    /*
+     * Moves one chunk of current table if it is being moved, last mover installs successor.
+     * Caller is inside epoch_guard and holds no stripe, moving locks stripes of moved nodes.
+     */
+    void help_move() {
+        table* t = m_table.load(std::memory_order_acquire);
+        if(!t->m_next.load(std::memory_order_acquire))
+            return;
+
+        const std::size_t chunks = t->chunks();
+        const std::size_t chunk = t->m_claimed_chunks.fetch_add(1, std::memory_order_relaxed);
+        if(chunk >= chunks)
+            return;
+
+        const std::size_t end = std::min((chunk + 1) * move_chunk, t->m_mask + 1);
+        for(std::size_t i = chunk * move_chunk; i < end; ++i)
+            for(unsigned slot = 0; slot < bucket_slots; ++slot)
+                move_slot(t, t->m_buckets[i], slot);
+
+        if(t->m_moved_chunks.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks) {
+            m_table.store(t->m_next.load(std::memory_order_relaxed), std::memory_order_release);
+            epoch_retire(t);
+        }
+    }
+
+    Hash m_hash;
+    KeyEqual m_equal;
+    alignas(64) std::atomic<table*> m_table;
+    std::unique_ptr<stripe[]> m_stripes;
+    const std::size_t m_stripe_mask;
+    alignas(64) std::atomic<std::size_t> m_size;
+
+}; // class concurrent_hash_map
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,104 @@
+#include "big_reader_mutex.hpp"
+
+#include <unistd.h>
+
+namespace concurrency {
+
+static const int drain_spin_count = 100;
+
+static unsigned round_up_pow2(unsigned val) {
+    unsigned res = 1;
+    while(res < val)
+        res <<= 1;
+    return res;
+}
+
+big_reader_mutex::big_reader_mutex(unsigned slots_num):
+    m_slots(nullptr), m_slots_mask(0), m_writer(no_writer), m_writer_mutex()
+{
+    if(slots_num == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        slots_num = (cpus > 0) ? static_cast<unsigned>(cpus) : 1;
+    }
+    slots_num = round_up_pow2(slots_num);
+
+    m_slots = new reader_slot[slots_num];
+    for(unsigned i = 0; i < slots_num; ++i)
+        m_slots[i].m_readers.store(0, std::memory_order_relaxed);
+    m_slots_mask = slots_num - 1;
+}
+
+big_reader_mutex::~big_reader_mutex() {
+    delete[] m_slots;
+}
+
+unsigned big_reader_mutex::next_thread_index() {
+    static std::atomic<unsigned> s_next_index(0);
+    return s_next_index.fetch_add(1, std::memory_order_relaxed);
+}
+
+void big_reader_mutex::lock() {
+    m_writer_mutex.lock();
+    m_writer.store(writer_active, std::memory_order_seq_cst);
+
+    /*readers that got in before flag was raised leave eventually, new ones back off*/
+    for(unsigned i = 0; i <= m_slots_mask; ++i)
+        wait_drained(m_slots[i]);
+}
+
+bool big_reader_mutex::try_lock() {
+    if(!m_writer_mutex.try_lock())
+        return false;
+    m_writer.store(writer_active, std::memory_order_seq_cst);
+
+    for(unsigned i = 0; i <= m_slots_mask; ++i)
+        if(m_slots[i].m_readers.load(std::memory_order_seq_cst) != 0) {
+            /*let back off readers in again*/
+            unlock();
+            return false;
+        }
+
+    return true;
+}
+
+void big_reader_mutex::unlock() {
+    if(m_writer.exchange(no_writer, std::memory_order_release) == writer_with_waiters)
+        util::futex_wake_all(&m_writer);
+    m_writer_mutex.unlock();
+}
+
+void big_reader_mutex::lock_shared_slow(reader_slot& slot) {
+    do {
+        /*back off, so that writer can drain the slot*/
+        leave_slot(slot);
+
+        int state = m_writer.load(std::memory_order_relaxed);
+        while(state != no_writer) {
+            /*mark that there are parked readers, so unlock knows to wake them up*/
+            if(state == writer_active && !m_writer.compare_exchange_weak(
+                state, writer_with_waiters, std::memory_order_relaxed
+            ))
+                continue;
+
+            util::futex_wait(&m_writer, writer_with_waiters);
+            state = m_writer.load(std::memory_order_relaxed);
+        }
+
+        slot.m_readers.fetch_add(1, std::memory_order_seq_cst);
+    } while(m_writer.load(std::memory_order_seq_cst) != no_writer);
+}
+
+void big_reader_mutex::wait_drained(reader_slot& slot) {
+    /*readers hold lock briefly, spin a bit before sleeping*/
+    for(int spins = 0; spins < drain_spin_count; ++spins) {
+        if(slot.m_readers.load(std::memory_order_seq_cst) == 0)
+            return;
+        util::cpu_relax();
+    }
+
+    int readers;
+    while((readers = slot.m_readers.load(std::memory_order_seq_cst)) != 0)
+        util::futex_wait(&slot.m_readers, readers);
+}
+
+} // namespace concurrency
@@ -0,0 +1,110 @@
+#ifndef BIG_READER_MUTEX_H
+#define BIG_READER_MUTEX_H
+
+#include <atomic>
+
+#include "futex_mutex.hpp"
+#include "futex.h"
+
+namespace concurrency {
+
+/*
+ * Reader-biased ("big reader") lock for data that is almost never written.
+ * Each reader only touches its own cache-line-padded slot counter, so readers on
+ * different cores do not share any written cache line.
+ * Writer raises flag, which turns away new readers, and waits until every slot drains,
+ * so writes are expensive: cost grows with number of slots.
+ * Satisfies lock/unlock and lock_shared/unlock_shared surfaces, so it can be used
+ * with lock_guard, unique_lock and shared_lock.
+ */
+class big_reader_mutex {
+
+public:
+    /*slots_num is rounded up to power of two, 0 - one slot per online cpu*/
+    explicit
+    big_reader_mutex(unsigned slots_num = 0);
+
+    big_reader_mutex(const big_reader_mutex& other) = delete;
+    big_reader_mutex& operator=(const big_reader_mutex& other) = delete;
+
+    ~big_reader_mutex();
+
+    /*exclusive ownership*/
+    void lock();
+
+    bool try_lock();
+
+    void unlock();
+
+    /*shared ownership*/
+    void lock_shared() {
+        reader_slot& slot = current_slot();
+        slot.m_readers.fetch_add(1, std::memory_order_seq_cst);
+        /*slot increment and flag load pair with flag store and slot loads in lock()*/
+        if(m_writer.load(std::memory_order_seq_cst) == no_writer)
+            return;
+
+        lock_shared_slow(slot);
+    }
+
+    bool try_lock_shared() {
+        reader_slot& slot = current_slot();
+        slot.m_readers.fetch_add(1, std::memory_order_seq_cst);
+        if(m_writer.load(std::memory_order_seq_cst) == no_writer)
+            return true;
+
+        leave_slot(slot);
+        return false;
+    }
+
+    void unlock_shared()
+    { leave_slot(current_slot()); }
+
+    unsigned
+    slots_num() const
+    { return m_slots_mask + 1; }
+
+private:
+    struct alignas(64) reader_slot {
+        std::atomic<int> m_readers;
+    };
+
+    enum writer_state {
+        no_writer = 0,
+        writer_active = 1,
+        writer_with_waiters = 2 /*readers may be parked on m_writer*/
+    };
+
+    /*
+     * Slot is picked per thread rather than per cpu: thread may migrate between
+     * lock_shared and unlock_shared, and has to decrement the same slot it incremented.
+     */
+    static unsigned next_thread_index();
+
+    reader_slot& current_slot() {
+        static thread_local const unsigned t_index = next_thread_index();
+        return m_slots[t_index & m_slots_mask];
+    }
+
+    void leave_slot(reader_slot& slot) {
+        /*last reader of slot lets draining writer go on*/
+        if(slot.m_readers.fetch_sub(1, std::memory_order_seq_cst) == 1
+            && m_writer.load(std::memory_order_seq_cst) != no_writer)
+            util::futex_wake(&slot.m_readers, 1);
+    }
+
+    void lock_shared_slow(reader_slot& slot);
+    void wait_drained(reader_slot& slot);
+
+    reader_slot* m_slots;
+    unsigned m_slots_mask;
+    std::atomic<int> m_writer;
+
+    /*serializes writers, kept off the line readers poll*/
+    alignas(64) futex_mutex m_writer_mutex;
+
+}; // class big_reader_mutex
+
+} // namespace concurrency
+
+#endif
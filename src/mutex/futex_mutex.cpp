@@ -0,0 +1,43 @@
+#include "futex_mutex.hpp"
+
+#include "futex.h"
+
+namespace concurrency {
+
+static const int max_spin_count = 100;
+
+void futex_mutex::lock_slow() {
+    /*spin for a while, lock holder is likely to release it soon*/
+    const int estimate = m_spin_estimate.load(std::memory_order_relaxed);
+    const int spin_limit =
+        (estimate * 2 + 10 < max_spin_count) ? estimate * 2 + 10 : max_spin_count;
+
+    for(int spins = 0; spins < spin_limit; ++spins) {
+        /*test before test-and-set, so as not to bounce cache line*/
+        if(m_state.load(std::memory_order_relaxed) == unlocked && try_lock()) {
+            m_spin_estimate.store(
+                estimate + (spins - estimate) / 8,
+                std::memory_order_relaxed
+            );
+            return;
+        }
+        util::cpu_relax();
+    }
+    m_spin_estimate.store(
+        estimate + (spin_limit - estimate) / 8,
+        std::memory_order_relaxed
+    );
+
+    /*park: mark mutex as contended, so unlocker knows there is someone to wake up*/
+    int state = m_state.exchange(contended, std::memory_order_acquire);
+    while(state != unlocked) {
+        util::futex_wait(&m_state, contended);
+        state = m_state.exchange(contended, std::memory_order_acquire);
+    }
+}
+
+void futex_mutex::unlock_slow() {
+    util::futex_wake(&m_state, 1);
+}
+
+} // namespace concurrency
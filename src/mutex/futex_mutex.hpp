@@ -0,0 +1,72 @@
+#ifndef FUTEX_MUTEX_H
+#define FUTEX_MUTEX_H
+
+#include <atomic>
+
+namespace concurrency {
+
+/*
+ * Mutex built on single 32-bit futex word.
+ * Uncontended lock/unlock are single atomic operations done inline,
+ * kernel is entered only when thread has to sleep or there are sleepers to wake up.
+ * Satisfies same lock/try_lock/unlock surface as mutex, so it can be used with
+ * lock_guard, unique_lock and condition_variable_any.
+ */
+class futex_mutex {
+
+public:
+    typedef std::atomic<int> native_handle_type;
+
+    futex_mutex(): m_state(unlocked), m_spin_estimate(0) {}
+
+    futex_mutex(const futex_mutex& other) = delete;
+    futex_mutex& operator=(const futex_mutex& other) = delete;
+
+    void lock() {
+        int expected = unlocked;
+        if(m_state.compare_exchange_strong(
+            expected, locked,
+            std::memory_order_acquire, std::memory_order_relaxed
+        ))
+            return;
+
+        lock_slow();
+    }
+
+    bool try_lock() {
+        int expected = unlocked;
+        return m_state.compare_exchange_strong(
+            expected, locked,
+            std::memory_order_acquire, std::memory_order_relaxed
+        );
+    }
+
+    void unlock() {
+        /*no syscall unless someone is sleeping on the mutex*/
+        if(m_state.exchange(unlocked, std::memory_order_release) == contended)
+            unlock_slow();
+    }
+
+    native_handle_type*
+    native_handle()
+    { return &m_state; }
+
+private:
+    enum state {
+        unlocked = 0,
+        locked = 1, /*locked, no waiters*/
+        contended = 2 /*locked, possibly there are waiters*/
+    };
+
+    void lock_slow();
+    void unlock_slow();
+
+    native_handle_type m_state;
+    /*running average of spins it took to acquire lock (as in PTHREAD_MUTEX_ADAPTIVE_NP)*/
+    std::atomic<int> m_spin_estimate;
+
+}; // class futex_mutex
+
+} // namespace concurrency
+
+#endif
@@ -2,6 +2,12 @@
 #include <pthread.h>
 #include <stdexcept>
 
+#include "trace.hpp"
+
+#ifdef CONCURRENCY_MUTEX_PROFILING
+#include "mutex_profile.hpp"
+#endif
+
 namespace concurrency {
 
 static std::string make_mutex_lock_err_msg(std::string prefix, int err_num) {
@@ -65,13 +71,64 @@ mutex_interface::~mutex_interface() {
     pthread_mutex_destroy(&m_handle);
 }
 
+#ifdef CONCURRENCY_MUTEX_PROFILING
+static std::uint64_t profile_now_ns() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<std::uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec;
+}
+
+void mutex_interface::set_name(const char* name) {
+    m_stats = mutex_registry::instance().stats_for(name);
+}
+
+void mutex_interface::profile_acquired(bool contended, std::uint64_t wait_ns) {
+    /*recursive locking: hold is measured from outermost lock*/
+    if(m_lock_depth++ != 0)
+        return;
+    m_stats->record_acquisition(contended, wait_ns);
+    m_locked_at_ns = profile_now_ns();
+}
+
+void mutex_interface::profile_released() {
+    if(--m_lock_depth != 0)
+        return;
+    m_stats->record_hold(profile_now_ns() - m_locked_at_ns);
+}
+
+void mutex_interface::profile_suspend_hold() {
+    if(m_stats)
+        m_stats->record_hold(profile_now_ns() - m_locked_at_ns);
+}
+
+void mutex_interface::profile_resume_hold() {
+    if(m_stats)
+        m_locked_at_ns = profile_now_ns();
+}
+#endif
+
 void mutex_interface::lock() {
     int err_num = 0;
+    CONCURRENCY_TRACE(lock_wait, this);
+#ifdef CONCURRENCY_MUTEX_PROFILING
+    /*failed try_lock marks acquisition as contended*/
+    if(m_stats && pthread_mutex_trylock(&m_handle) == 0) {
+        profile_acquired(false, 0);
+        CONCURRENCY_TRACE(lock_acquired, this);
+        return;
+    }
+    const std::uint64_t wait_start = m_stats ? profile_now_ns() : 0;
+#endif
     err_num = pthread_mutex_lock(&m_handle);
     if(err_num != 0) {
         std::string err_msg = make_mutex_lock_err_msg("mutex_interface::lock: pthread_mutex_lock: ", err_num);
         throw std::runtime_error(err_msg);
     }
+    CONCURRENCY_TRACE(lock_acquired, this);
+#ifdef CONCURRENCY_MUTEX_PROFILING
+    if(m_stats)
+        profile_acquired(true, profile_now_ns() - wait_start);
+#endif
 }
 
 bool mutex_interface::try_lock() {
@@ -85,11 +142,52 @@ bool mutex_interface::try_lock() {
         throw std::runtime_error(err_msg);
     }
 
+    CONCURRENCY_TRACE(lock_acquired, this);
+#ifdef CONCURRENCY_MUTEX_PROFILING
+    if(m_stats)
+        profile_acquired(false, 0);
+#endif
     return !err_num; /*return non zero*/
 }
 
+bool mutex_interface::try_lock_until_monotonic(const timespec& abs_time) {
+    int err_num = 0;
+    CONCURRENCY_TRACE(lock_wait, this);
+#ifdef CONCURRENCY_MUTEX_PROFILING
+    if(m_stats && pthread_mutex_trylock(&m_handle) == 0) {
+        profile_acquired(false, 0);
+        CONCURRENCY_TRACE(lock_acquired, this);
+        return true;
+    }
+    const std::uint64_t wait_start = m_stats ? profile_now_ns() : 0;
+#endif
+    err_num = pthread_mutex_clocklock(&m_handle, CLOCK_MONOTONIC, &abs_time);
+    if(err_num != 0) {
+        if(err_num == ETIMEDOUT) { /*mutex was not unlocked before abs_time*/
+            CONCURRENCY_TRACE(lock_timeout, this);
+            return false;
+        }
+
+        std::string err_msg = make_mutex_lock_err_msg("mutex_interface::try_lock_until: pthread_mutex_clocklock: ", err_num);
+        throw std::runtime_error(err_msg);
+    }
+
+    CONCURRENCY_TRACE(lock_acquired, this);
+#ifdef CONCURRENCY_MUTEX_PROFILING
+    if(m_stats)
+        profile_acquired(true, profile_now_ns() - wait_start);
+#endif
+    return true;
+}
+
 void mutex_interface::unlock() {
     int err_num = 0;
+    /*recorded while still holding mutex, so that holds of different threads do not overlap*/
+    CONCURRENCY_TRACE(lock_released, this);
+#ifdef CONCURRENCY_MUTEX_PROFILING
+    if(m_stats)
+        profile_released();
+#endif
     err_num = pthread_mutex_unlock(&m_handle);
     if(err_num != 0) {
         std::string err_msg = make_mutex_lock_err_msg("mutex_interface::unlock: pthread_mutex_unlock: ", err_num);
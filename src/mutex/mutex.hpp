@@ -3,15 +3,27 @@
 
 #include <pthread.h>
 #include <stdexcept>
+#include <chrono>
+#include <cstdint>
+
+#include "timespec.h"
 
 namespace concurrency {
 
+#ifdef CONCURRENCY_MUTEX_PROFILING
+namespace detail { struct mutex_stats; }
+#endif
+
 class mutex_interface {
 
 public:
     typedef pthread_mutex_t native_handle_type;
 
+#ifdef CONCURRENCY_MUTEX_PROFILING
+    mutex_interface(): m_handle(), m_stats(nullptr), m_locked_at_ns(0), m_lock_depth(0) {}
+#else
     mutex_interface(): m_handle() {}
+#endif
 
     mutex_interface(const mutex_interface& other) = delete;
     mutex_interface& operator=(const mutex_interface& other) = delete;
@@ -28,9 +40,39 @@ public:
     native_handle()
     { return &m_handle; }
 
+    /*
+     * Registers mutex in mutex_registry under given name (see mutex_profile.hpp),
+     * to be called before mutex is first locked.
+     * No-op unless built with CONCURRENCY_MUTEX_PROFILING.
+     */
+#ifdef CONCURRENCY_MUTEX_PROFILING
+    void set_name(const char* name);
+#else
+    void set_name(const char* /*name*/) {}
+#endif
+
 protected:
+    /*abs_time is measured against CLOCK_MONOTONIC*/
+    bool try_lock_until_monotonic(const timespec& abs_time);
+
     native_handle_type m_handle;
 
+#ifdef CONCURRENCY_MUTEX_PROFILING
+private:
+    /*condition_variable releases and reacquires native mutex while waiting*/
+    friend class condition_variable;
+
+    void profile_acquired(bool contended, std::uint64_t wait_ns);
+    void profile_released();
+    void profile_suspend_hold();
+    void profile_resume_hold();
+
+    detail::mutex_stats* m_stats; /*nullptr - not named, not profiled*/
+    /*written only by lock holder*/
+    std::uint64_t m_locked_at_ns;
+    unsigned m_lock_depth;
+#endif
+
 }; // class mutex_interface 
 
 class mutex: public mutex_interface {
@@ -49,6 +91,38 @@ public:
     recursive_mutex& operator=(const recursive_mutex& other) = delete;
 }; // class recursive_mutex
 
+class timed_mutex: public mutex {
+public:
+    timed_mutex() {}
+
+    timed_mutex(const timed_mutex& other) = delete;
+    timed_mutex& operator=(const timed_mutex& other) = delete;
+
+    template<typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period>& rel_time)
+    { return try_lock_until(util::deadline_after(rel_time)); }
+
+    template<typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration>& abs_time)
+    { return try_lock_until_monotonic(util::to_monotonic_timespec(abs_time)); }
+}; // class timed_mutex
+
+class recursive_timed_mutex: public recursive_mutex {
+public:
+    recursive_timed_mutex() {}
+
+    recursive_timed_mutex(const recursive_timed_mutex& other) = delete;
+    recursive_timed_mutex& operator=(const recursive_timed_mutex& other) = delete;
+
+    template<typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period>& rel_time)
+    { return try_lock_until(util::deadline_after(rel_time)); }
+
+    template<typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration>& abs_time)
+    { return try_lock_until_monotonic(util::to_monotonic_timespec(abs_time)); }
+}; // class recursive_timed_mutex
+
 // Helper classes for unique_lock
 // explicit defer_lock_t() = default;
 struct defer_lock_t {};
@@ -82,6 +156,18 @@ public:
     /*calling thread already locked mutex*/
     unique_lock(mutex_type& mut, adopt_lock_t): m_mutex_ptr(&mut), m_owns(true) {}
 
+    /*try to lock for given duration (timed mutexes only)*/
+    template<typename Rep, typename Period>
+    unique_lock(mutex_type& mut, const std::chrono::duration<Rep, Period>& rel_time):
+        m_mutex_ptr(&mut), m_owns(false)
+    { m_owns = m_mutex_ptr->try_lock_for(rel_time); }
+
+    /*try to lock until given time point (timed mutexes only)*/
+    template<typename Clock, typename Duration>
+    unique_lock(mutex_type& mut, const std::chrono::time_point<Clock, Duration>& abs_time):
+        m_mutex_ptr(&mut), m_owns(false)
+    { m_owns = m_mutex_ptr->try_lock_until(abs_time); }
+
     unique_lock(const unique_lock& other) = delete;
     unique_lock& operator=(const unique_lock& other) = delete;
 
@@ -92,9 +178,9 @@ public:
 
     void lock() {
         if(!m_mutex_ptr)
-            std::runtime_error("unique_lock: lock: not owning any mutex");
+            throw std::runtime_error("unique_lock: lock: not owning any mutex");
         if(m_owns)
-            std::runtime_error("unique_lock: lock: recursive lock");
+            throw std::runtime_error("unique_lock: lock: recursive lock");
         
         m_mutex_ptr->lock();
         m_owns = true;
@@ -102,16 +188,36 @@ public:
 
     bool try_lock() {
         if(!m_mutex_ptr)
-            std::runtime_error("unique_lock: lock: not owning any mutex");
+            throw std::runtime_error("unique_lock: lock: not owning any mutex");
         if(m_owns)
-            std::runtime_error("unique_lock: lock: recursive lock");
+            throw std::runtime_error("unique_lock: lock: recursive lock");
         
         return m_owns = m_mutex_ptr->try_lock();
     }
 
+    template<typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period>& rel_time) {
+        if(!m_mutex_ptr)
+            throw std::runtime_error("unique_lock: try_lock_for: not owning any mutex");
+        if(m_owns)
+            throw std::runtime_error("unique_lock: try_lock_for: recursive lock");
+
+        return m_owns = m_mutex_ptr->try_lock_for(rel_time);
+    }
+
+    template<typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration>& abs_time) {
+        if(!m_mutex_ptr)
+            throw std::runtime_error("unique_lock: try_lock_until: not owning any mutex");
+        if(m_owns)
+            throw std::runtime_error("unique_lock: try_lock_until: recursive lock");
+
+        return m_owns = m_mutex_ptr->try_lock_until(abs_time);
+    }
+
     void unlock() {
         if(!m_owns)
-            std::runtime_error("unique_lock: unlock: not owning lock to unlock it");
+            throw std::runtime_error("unique_lock: unlock: not owning lock to unlock it");
         else if(m_mutex_ptr) {
             m_mutex_ptr->unlock();
             m_owns = false;
@@ -0,0 +1,144 @@
+#include "mutex_profile.hpp"
+
+namespace concurrency {
+
+namespace detail {
+
+mutex_stats::mutex_stats() {
+    reset();
+}
+
+void mutex_stats::record_acquisition(bool contended, std::uint64_t wait_ns) {
+    m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if(!contended)
+        return;
+
+    m_contended.fetch_add(1, std::memory_order_relaxed);
+    m_total_wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+    std::uint64_t max_wait = m_max_wait_ns.load(std::memory_order_relaxed);
+    while(max_wait < wait_ns && !m_max_wait_ns.compare_exchange_weak(
+        max_wait, wait_ns, std::memory_order_relaxed
+    ))
+        ;
+}
+
+void mutex_stats::record_hold(std::uint64_t hold_ns) {
+    m_total_hold_ns.fetch_add(hold_ns, std::memory_order_relaxed);
+
+    int bucket = 63 - __builtin_clzll(hold_ns | 1);
+    if(bucket >= hold_buckets)
+        bucket = hold_buckets - 1;
+    m_hold_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void mutex_stats::reset() {
+    m_acquisitions.store(0, std::memory_order_relaxed);
+    m_contended.store(0, std::memory_order_relaxed);
+    m_total_wait_ns.store(0, std::memory_order_relaxed);
+    m_max_wait_ns.store(0, std::memory_order_relaxed);
+    m_total_hold_ns.store(0, std::memory_order_relaxed);
+    for(int i = 0; i < hold_buckets; ++i)
+        m_hold_histogram[i].store(0, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+static std::string json_escape(const std::string& str) {
+    std::string res;
+    for(std::size_t i = 0; i < str.size(); ++i) {
+        const char ch = str[i];
+        if(ch == '"' || ch == '\\')
+            res += '\\';
+        if(static_cast<unsigned char>(ch) < 0x20)
+            res += ' ';
+        else
+            res += ch;
+    }
+    return res;
+}
+
+mutex_registry& mutex_registry::instance() {
+    /*never destroyed, so that mutexes outliving static destruction can still record*/
+    static mutex_registry* s_instance = new mutex_registry();
+    return *s_instance;
+}
+
+detail::mutex_stats* mutex_registry::stats_for(const char* name) {
+    lock_guard<mutex> locker(m_mutex);
+    std::unique_ptr<detail::mutex_stats>& stats = m_stats[name];
+    if(!stats)
+        stats.reset(new detail::mutex_stats());
+    return stats.get();
+}
+
+std::vector<mutex_stats_snapshot> mutex_registry::snapshot() const {
+    std::vector<mutex_stats_snapshot> res;
+    lock_guard<mutex> locker(m_mutex);
+
+    for(auto it = m_stats.begin(); it != m_stats.end(); ++it) {
+        const detail::mutex_stats& stats = *it->second;
+        mutex_stats_snapshot snap;
+        snap.name = it->first;
+        snap.acquisitions = stats.m_acquisitions.load(std::memory_order_relaxed);
+        snap.contended = stats.m_contended.load(std::memory_order_relaxed);
+        snap.total_wait_ns = stats.m_total_wait_ns.load(std::memory_order_relaxed);
+        snap.max_wait_ns = stats.m_max_wait_ns.load(std::memory_order_relaxed);
+        snap.total_hold_ns = stats.m_total_hold_ns.load(std::memory_order_relaxed);
+        for(int i = 0; i < detail::mutex_stats::hold_buckets; ++i)
+            snap.hold_histogram.push_back(stats.m_hold_histogram[i].load(std::memory_order_relaxed));
+        res.push_back(snap);
+    }
+
+    return res;
+}
+
+void mutex_registry::reset() {
+    lock_guard<mutex> locker(m_mutex);
+    for(auto it = m_stats.begin(); it != m_stats.end(); ++it)
+        it->second->reset();
+}
+
+void mutex_registry::dump_text(std::ostream& out) const {
+    std::vector<mutex_stats_snapshot> snaps = snapshot();
+
+    for(std::size_t i = 0; i < snaps.size(); ++i) {
+        const mutex_stats_snapshot& snap = snaps[i];
+        out << snap.name << ": "
+            << "acquisitions " << snap.acquisitions
+            << ", contended " << snap.contended
+            << ", wait total " << snap.total_wait_ns << " ns"
+            << ", wait max " << snap.max_wait_ns << " ns"
+            << ", hold total " << snap.total_hold_ns << " ns\n";
+
+        for(int bucket = 0; bucket < detail::mutex_stats::hold_buckets; ++bucket) {
+            if(snap.hold_histogram[bucket] == 0)
+                continue;
+            out << "    hold >= " << (std::uint64_t(1) << bucket) << " ns: "
+                << snap.hold_histogram[bucket] << "\n";
+        }
+    }
+}
+
+void mutex_registry::dump_json(std::ostream& out) const {
+    std::vector<mutex_stats_snapshot> snaps = snapshot();
+
+    out << "{\"mutexes\":[";
+    for(std::size_t i = 0; i < snaps.size(); ++i) {
+        const mutex_stats_snapshot& snap = snaps[i];
+        if(i != 0)
+            out << ",";
+        out << "{\"name\":\"" << json_escape(snap.name) << "\""
+            << ",\"acquisitions\":" << snap.acquisitions
+            << ",\"contended\":" << snap.contended
+            << ",\"total_wait_ns\":" << snap.total_wait_ns
+            << ",\"max_wait_ns\":" << snap.max_wait_ns
+            << ",\"total_hold_ns\":" << snap.total_hold_ns
+            << ",\"hold_histogram_log2_ns\":[";
+        for(int bucket = 0; bucket < detail::mutex_stats::hold_buckets; ++bucket)
+            out << (bucket ? "," : "") << snap.hold_histogram[bucket];
+        out << "]}";
+    }
+    out << "]}" << std::endl;
+}
+
+} // namespace concurrency
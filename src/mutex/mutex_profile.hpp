@@ -0,0 +1,85 @@
+#ifndef MUTEX_PROFILE_H
+#define MUTEX_PROFILE_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "mutex.hpp"
+
+/*
+ * Contention profiling of named mutexes (mutex_interface::set_name).
+ * Statistics are collected only when library is built with CONCURRENCY_MUTEX_PROFILING
+ * (cmake option of same name), otherwise mutex carries no extra state and registry stays empty.
+ * Mutexes sharing name share statistics, e.g. per-shard mutexes of one table.
+ */
+
+namespace concurrency {
+
+namespace detail {
+
+struct mutex_stats {
+    /*bucket i counts hold times in [2^i, 2^(i+1)) ns, last bucket is open-ended*/
+    static const int hold_buckets = 32;
+
+    mutex_stats();
+
+    void record_acquisition(bool contended, std::uint64_t wait_ns);
+    void record_hold(std::uint64_t hold_ns);
+    void reset();
+
+    std::atomic<std::uint64_t> m_acquisitions;
+    std::atomic<std::uint64_t> m_contended;
+    std::atomic<std::uint64_t> m_total_wait_ns;
+    std::atomic<std::uint64_t> m_max_wait_ns;
+    std::atomic<std::uint64_t> m_total_hold_ns;
+    std::atomic<std::uint64_t> m_hold_histogram[hold_buckets];
+}; // struct mutex_stats
+
+} // namespace detail
+
+struct mutex_stats_snapshot {
+    std::string name;
+    std::uint64_t acquisitions;
+    std::uint64_t contended; /*try_lock failed first, so thread had to wait*/
+    std::uint64_t total_wait_ns;
+    std::uint64_t max_wait_ns;
+    std::uint64_t total_hold_ns;
+    std::vector<std::uint64_t> hold_histogram; /*see detail::mutex_stats::hold_buckets*/
+}; // struct mutex_stats_snapshot
+
+class mutex_registry {
+
+public:
+    static mutex_registry& instance();
+
+    mutex_registry(const mutex_registry& other) = delete;
+    mutex_registry& operator=(const mutex_registry& other) = delete;
+
+    /*statistics record of given name, created on first request*/
+    detail::mutex_stats* stats_for(const char* name);
+
+    /*sorted by name*/
+    std::vector<mutex_stats_snapshot> snapshot() const;
+
+    void reset();
+
+    void dump_text(std::ostream& out) const;
+    void dump_json(std::ostream& out) const;
+
+private:
+    mutex_registry() {}
+
+    mutable mutex m_mutex;
+    /*records are never freed, mutexes keep raw pointers to them*/
+    std::map<std::string, std::unique_ptr<detail::mutex_stats>> m_stats;
+
+}; // class mutex_registry
+
+} // namespace concurrency
+
+#endif
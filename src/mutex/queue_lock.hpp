@@ -0,0 +1,279 @@
+#ifndef QUEUE_LOCK_H
+#define QUEUE_LOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+#include "spin_lock.hpp"
+#include "futex.h"
+
+namespace concurrency {
+
+namespace detail {
+
+/*
+ * Queue nodes of calling thread. Queue locks keep lock/unlock surface, so node
+ * of current acquisition is taken from here and remembered by lock itself.
+ * Bounds number of queue locks (of one kind) held by thread at once.
+ */
+template<typename Node>
+class queue_node_pool {
+
+public:
+    static const int capacity = 16;
+
+    queue_node_pool(): m_used(0) {
+        for(int i = 0; i < capacity; ++i)
+            m_nodes[i] = nullptr;
+    }
+
+    queue_node_pool(const queue_node_pool& other) = delete;
+    queue_node_pool& operator=(const queue_node_pool& other) = delete;
+
+    ~queue_node_pool() {
+        for(int i = 0; i < capacity; ++i)
+            delete m_nodes[i];
+    }
+
+    static queue_node_pool&
+    this_thread_pool() {
+        static thread_local queue_node_pool t_pool;
+        return t_pool;
+    }
+
+    Node* acquire(int& slot) {
+        if(m_used == (1u << capacity) - 1)
+            throw std::runtime_error("queue lock: too many queue locks held by thread");
+
+        slot = __builtin_ctz(~m_used);
+        m_used |= 1u << slot;
+        if(!m_nodes[slot])
+            m_nodes[slot] = new Node();
+        return m_nodes[slot];
+    }
+
+    /*node may be swapped for other one (CLH takes over its predecessor node)*/
+    void release(int slot, Node* node) {
+        m_nodes[slot] = node;
+        m_used &= ~(1u << slot);
+    }
+
+private:
+    Node* m_nodes[capacity];
+    unsigned m_used;
+
+}; // class queue_node_pool
+
+struct alignas(64) mcs_node {
+    mcs_node(): m_next(nullptr), m_locked(false) {}
+
+    std::atomic<mcs_node*> m_next;
+    std::atomic<bool> m_locked;
+}; // struct mcs_node
+
+struct alignas(64) clh_node {
+    clh_node(): m_locked(false) {}
+
+    std::atomic<bool> m_locked;
+}; // struct clh_node
+
+} // namespace detail
+
+/*
+ * MCS lock: FIFO fair, every waiter spins on flag in its own node,
+ * and releasing thread writes only to node of its successor.
+ */
+template<typename Backoff = backoff_exponential>
+class mcs_lock {
+
+public:
+    mcs_lock(): m_tail(nullptr), m_holder(nullptr), m_holder_slot(0) {}
+
+    mcs_lock(const mcs_lock& other) = delete;
+    mcs_lock& operator=(const mcs_lock& other) = delete;
+
+    void lock() {
+        int slot;
+        detail::mcs_node* node = node_pool::this_thread_pool().acquire(slot);
+        node->m_next.store(nullptr, std::memory_order_relaxed);
+        node->m_locked.store(true, std::memory_order_relaxed);
+
+        detail::mcs_node* pred = m_tail.exchange(node, std::memory_order_acq_rel);
+        if(pred) {
+            pred->m_next.store(node, std::memory_order_release);
+
+            Backoff backoff;
+            while(node->m_locked.load(std::memory_order_acquire))
+                backoff.pause();
+        }
+
+        m_holder = node;
+        m_holder_slot = slot;
+    }
+
+    bool try_lock() {
+        int slot;
+        detail::mcs_node* node = node_pool::this_thread_pool().acquire(slot);
+        node->m_next.store(nullptr, std::memory_order_relaxed);
+
+        detail::mcs_node* expected = nullptr;
+        /*release: successor reading tail must see m_next reset, as with exchange in lock()*/
+        if(!m_tail.compare_exchange_strong(
+            expected, node,
+            std::memory_order_acq_rel, std::memory_order_relaxed
+        )) {
+            node_pool::this_thread_pool().release(slot, node);
+            return false;
+        }
+
+        m_holder = node;
+        m_holder_slot = slot;
+        return true;
+    }
+
+    void unlock() {
+        detail::mcs_node* node = m_holder;
+        const int slot = m_holder_slot;
+
+        detail::mcs_node* succ = node->m_next.load(std::memory_order_acquire);
+        if(!succ) {
+            detail::mcs_node* expected = node;
+            if(m_tail.compare_exchange_strong(
+                expected, nullptr,
+                std::memory_order_release, std::memory_order_relaxed
+            )) {
+                node_pool::this_thread_pool().release(slot, node);
+                return;
+            }
+
+            /*successor has swapped tail, but not yet linked itself*/
+            while(!(succ = node->m_next.load(std::memory_order_acquire)))
+                util::cpu_relax();
+        }
+
+        succ->m_locked.store(false, std::memory_order_release);
+        node_pool::this_thread_pool().release(slot, node);
+    }
+
+private:
+    typedef detail::queue_node_pool<detail::mcs_node> node_pool;
+
+    std::atomic<detail::mcs_node*> m_tail;
+    /*written and read only by lock holder*/
+    detail::mcs_node* m_holder;
+    int m_holder_slot;
+
+}; // class mcs_lock
+
+/*
+ * CLH lock: FIFO fair, every waiter spins on flag in node of its predecessor.
+ * Releasing thread leaves its node to successor and takes predecessor node over.
+ * Released node left at tail (no successor) is marked in low bit of tail pointer,
+ * so try_lock succeeds by single CAS and never touches node it does not own:
+ * node which was tail a moment ago may already be freed with pool of exited thread.
+ */
+template<typename Backoff = backoff_exponential>
+class clh_lock {
+
+public:
+    clh_lock(): m_tail(released(new detail::clh_node())), m_holder(nullptr), m_holder_pred(nullptr), m_holder_slot(0) {}
+
+    clh_lock(const clh_lock& other) = delete;
+    clh_lock& operator=(const clh_lock& other) = delete;
+
+    ~clh_lock() {
+        /*last released node is owned by nobody but lock*/
+        delete node_of(m_tail.load(std::memory_order_relaxed));
+    }
+
+    void lock() {
+        int slot;
+        detail::clh_node* node = node_pool::this_thread_pool().acquire(slot);
+        node->m_locked.store(true, std::memory_order_relaxed);
+
+        /*predecessor node stays in queue until this thread takes it over*/
+        const std::uintptr_t pred = m_tail.exchange(linked(node), std::memory_order_acq_rel);
+        if(!(pred & released_bit))
+            wait_for(node_of(pred));
+
+        m_holder = node;
+        m_holder_pred = node_of(pred);
+        m_holder_slot = slot;
+    }
+
+    bool try_lock() {
+        std::uintptr_t pred = m_tail.load(std::memory_order_relaxed);
+        if(!(pred & released_bit))
+            return false;
+
+        int slot;
+        detail::clh_node* node = node_pool::this_thread_pool().acquire(slot);
+        node->m_locked.store(true, std::memory_order_relaxed);
+        /*if address was recycled meanwhile, it is released tail again, so success is still right*/
+        /*release: successor reading tail must see m_locked set, as with exchange in lock()*/
+        if(!m_tail.compare_exchange_strong(
+            pred, linked(node),
+            std::memory_order_acq_rel, std::memory_order_relaxed
+        )) {
+            node_pool::this_thread_pool().release(slot, node);
+            return false;
+        }
+
+        m_holder = node;
+        m_holder_pred = node_of(pred);
+        m_holder_slot = slot;
+        return true;
+    }
+
+    void unlock() {
+        detail::clh_node* node = m_holder;
+        detail::clh_node* pred = m_holder_pred;
+        const int slot = m_holder_slot;
+
+        /*
+         * No successor: node is marked released and belongs to lock from now on.
+         * Otherwise successor spins on m_locked; node cannot be recycled before flag is cleared,
+         * so tail equal to node in CAS above always means this acquisition.
+         */
+        std::uintptr_t expected = linked(node);
+        if(!m_tail.compare_exchange_strong(
+            expected, released(node),
+            std::memory_order_release, std::memory_order_relaxed
+        ))
+            node->m_locked.store(false, std::memory_order_release);
+        node_pool::this_thread_pool().release(slot, pred);
+    }
+
+private:
+    typedef detail::queue_node_pool<detail::clh_node> node_pool;
+
+    /*nodes are 64-byte aligned, low bit of their address is free*/
+    static const std::uintptr_t released_bit = 1;
+
+    static std::uintptr_t linked(detail::clh_node* node)
+    { return reinterpret_cast<std::uintptr_t>(node); }
+
+    static std::uintptr_t released(detail::clh_node* node)
+    { return reinterpret_cast<std::uintptr_t>(node) | released_bit; }
+
+    static detail::clh_node* node_of(std::uintptr_t tail)
+    { return reinterpret_cast<detail::clh_node*>(tail & ~released_bit); }
+
+    static void wait_for(detail::clh_node* pred) {
+        Backoff backoff;
+        while(pred->m_locked.load(std::memory_order_acquire))
+            backoff.pause();
+    }
+
+    std::atomic<std::uintptr_t> m_tail;
+    /*written and read only by lock holder*/
+    detail::clh_node* m_holder;
+    detail::clh_node* m_holder_pred;
+    int m_holder_slot;
+
+}; // class clh_lock
+
+} // namespace concurrency
+
+#endif
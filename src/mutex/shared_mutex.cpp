@@ -0,0 +1,157 @@
+#include "shared_mutex.hpp"
+
+#include <pthread.h>
+#include <stdexcept>
+
+#include "util.h"
+
+namespace concurrency {
+
+static std::string make_rwlock_err_msg(const std::string& prefix, int err_num) {
+    std::string err_msg(prefix);
+
+    switch(err_num) {
+        case EAGAIN:
+            err_msg +=
+                "the system lacked necessary resources or max number of read locks has been exceeded";
+            break;
+        case ENOMEM:
+            err_msg += "insufficient memory exists to initialize rwlock";
+            break;
+        case EPERM:
+            err_msg += "caller does not have the privilege to perform the operation";
+            break;
+        case EDEADLK:
+            err_msg += "deadlock condition was detected or current thread already owns rwlock for writing";
+            break;
+        case EINVAL:
+            err_msg += "invalid argument";
+            break;
+        default:
+            err_msg += "error code: " + std::to_string(err_num);
+            break;
+    }
+
+    return err_msg;
+}
+
+shared_mutex::shared_mutex(rwlock_preference preference):
+    m_handle()
+{
+    util::try_call<int> check_call("shared_mutex::shared_mutex: ", make_rwlock_err_msg);
+    pthread_rwlockattr_t rwlock_attr;
+
+    check_call(
+        pthread_rwlockattr_init(&rwlock_attr),
+        0 /*valid val*/
+    );
+
+    /*glibc honours writer preference only for non-recursive kind*/
+    check_call(
+        pthread_rwlockattr_setkind_np(
+            &rwlock_attr,
+            preference == rwlock_preference::prefer_writer
+                ? PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP
+                : PTHREAD_RWLOCK_PREFER_READER_NP
+        ),
+        0 /*valid val*/
+    );
+
+    check_call(
+        pthread_rwlock_init(&m_handle, &rwlock_attr),
+        0 /*valid val*/
+    );
+
+    pthread_rwlockattr_destroy(&rwlock_attr);
+}
+
+shared_mutex::~shared_mutex() {
+    /*no need to check for error code*/
+    pthread_rwlock_destroy(&m_handle);
+}
+
+void shared_mutex::lock() {
+    util::try_call<int> check_call("shared_mutex::lock: pthread_rwlock_wrlock: ", make_rwlock_err_msg);
+    check_call(
+        pthread_rwlock_wrlock(&m_handle),
+        0 /*valid val*/
+    );
+}
+
+bool shared_mutex::try_lock() {
+    util::try_call<int> check_call("shared_mutex::try_lock: pthread_rwlock_trywrlock: ", make_rwlock_err_msg);
+    int err_num = pthread_rwlock_trywrlock(&m_handle);
+    if(err_num == EBUSY) /*rwlock is held by readers or writer*/
+        return false;
+
+    check_call(
+        err_num,
+        0 /*valid val*/
+    );
+    return true;
+}
+
+void shared_mutex::unlock() {
+    util::try_call<int> check_call("shared_mutex::unlock: pthread_rwlock_unlock: ", make_rwlock_err_msg);
+    check_call(
+        pthread_rwlock_unlock(&m_handle),
+        0 /*valid val*/
+    );
+}
+
+void shared_mutex::lock_shared() {
+    util::try_call<int> check_call("shared_mutex::lock_shared: pthread_rwlock_rdlock: ", make_rwlock_err_msg);
+    check_call(
+        pthread_rwlock_rdlock(&m_handle),
+        0 /*valid val*/
+    );
+}
+
+bool shared_mutex::try_lock_shared() {
+    util::try_call<int> check_call("shared_mutex::try_lock_shared: pthread_rwlock_tryrdlock: ", make_rwlock_err_msg);
+    int err_num = pthread_rwlock_tryrdlock(&m_handle);
+    if(err_num == EBUSY) /*rwlock is held by writer or writers are waiting*/
+        return false;
+
+    check_call(
+        err_num,
+        0 /*valid val*/
+    );
+    return true;
+}
+
+void shared_mutex::unlock_shared() {
+    util::try_call<int> check_call("shared_mutex::unlock_shared: pthread_rwlock_unlock: ", make_rwlock_err_msg);
+    check_call(
+        pthread_rwlock_unlock(&m_handle),
+        0 /*valid val*/
+    );
+}
+
+bool shared_mutex::try_lock_until_monotonic(const timespec& abs_time) {
+    util::try_call<int> check_call("shared_mutex::try_lock_until: pthread_rwlock_clockwrlock: ", make_rwlock_err_msg);
+    int err_num = pthread_rwlock_clockwrlock(&m_handle, CLOCK_MONOTONIC, &abs_time);
+    if(err_num == ETIMEDOUT)
+        return false;
+
+    check_call(
+        err_num,
+        0 /*valid val*/
+    );
+    return true;
+}
+
+bool shared_mutex::try_lock_shared_until_monotonic(const timespec& abs_time) {
+    util::try_call<int> check_call("shared_mutex::try_lock_shared_until: pthread_rwlock_clockrdlock: ", make_rwlock_err_msg);
+    int err_num = pthread_rwlock_clockrdlock(&m_handle, CLOCK_MONOTONIC, &abs_time);
+    if(err_num == ETIMEDOUT)
+        return false;
+
+    check_call(
+        err_num,
+        0 /*valid val*/
+    );
+    return true;
+}
+
+} // namespace concurrency
@@ -0,0 +1,207 @@
+#ifndef SHARED_MUTEX_H
+#define SHARED_MUTEX_H
+
+#include <pthread.h>
+#include <stdexcept>
+#include <chrono>
+
+#include "mutex.hpp"
+#include "timespec.h"
+
+namespace concurrency {
+
+/*
+ * Which side is admitted first when both readers and writers wait.
+ * prefer_writer blocks new readers while writer waits, so writers cannot starve.
+ */
+enum class rwlock_preference { prefer_reader, prefer_writer };
+
+/*Reader-writer mutex on top of pthread_rwlock_t*/
+class shared_mutex {
+
+public:
+    typedef pthread_rwlock_t native_handle_type;
+
+    explicit
+    shared_mutex(rwlock_preference preference = rwlock_preference::prefer_writer);
+
+    shared_mutex(const shared_mutex& other) = delete;
+    shared_mutex& operator=(const shared_mutex& other) = delete;
+
+    ~shared_mutex();
+
+    /*exclusive ownership*/
+    void lock();
+
+    bool try_lock();
+
+    void unlock();
+
+    /*shared ownership*/
+    void lock_shared();
+
+    bool try_lock_shared();
+
+    void unlock_shared();
+
+    native_handle_type*
+    native_handle()
+    { return &m_handle; }
+
+protected:
+    /*abs_time is measured against CLOCK_MONOTONIC*/
+    bool try_lock_until_monotonic(const timespec& abs_time);
+    bool try_lock_shared_until_monotonic(const timespec& abs_time);
+
+    native_handle_type m_handle;
+
+}; // class shared_mutex
+
+class shared_timed_mutex: public shared_mutex {
+public:
+    explicit
+    shared_timed_mutex(rwlock_preference preference = rwlock_preference::prefer_writer):
+        shared_mutex(preference)
+    {}
+
+    shared_timed_mutex(const shared_timed_mutex& other) = delete;
+    shared_timed_mutex& operator=(const shared_timed_mutex& other) = delete;
+
+    template<typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period>& rel_time)
+    { return try_lock_until(util::deadline_after(rel_time)); }
+
+    template<typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration>& abs_time)
+    { return try_lock_until_monotonic(util::to_monotonic_timespec(abs_time)); }
+
+    template<typename Rep, typename Period>
+    bool try_lock_shared_for(const std::chrono::duration<Rep, Period>& rel_time)
+    { return try_lock_shared_until(util::deadline_after(rel_time)); }
+
+    template<typename Clock, typename Duration>
+    bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration>& abs_time)
+    { return try_lock_shared_until_monotonic(util::to_monotonic_timespec(abs_time)); }
+}; // class shared_timed_mutex
+
+/*Counterpart of unique_lock, acquiring shared ownership*/
+template<typename Mutex_T>
+class shared_lock {
+
+public:
+    typedef Mutex_T mutex_type;
+
+    shared_lock(): m_mutex_ptr(nullptr), m_owns(false) {}
+
+    explicit
+    shared_lock(mutex_type& mut): m_mutex_ptr(&mut), m_owns(false) {
+        lock();
+    }
+
+    /*do not lock*/
+    shared_lock(mutex_type& mut, defer_lock_t): m_mutex_ptr(&mut), m_owns(false) {}
+
+    /*try to lock*/
+    shared_lock(mutex_type& mut, try_to_lock_t): m_mutex_ptr(&mut), m_owns(false)
+    { m_owns = m_mutex_ptr->try_lock_shared(); }
+
+    /*calling thread already holds shared lock*/
+    shared_lock(mutex_type& mut, adopt_lock_t): m_mutex_ptr(&mut), m_owns(true) {}
+
+    /*try to lock for given duration (timed mutexes only)*/
+    template<typename Rep, typename Period>
+    shared_lock(mutex_type& mut, const std::chrono::duration<Rep, Period>& rel_time):
+        m_mutex_ptr(&mut), m_owns(false)
+    { m_owns = m_mutex_ptr->try_lock_shared_for(rel_time); }
+
+    /*try to lock until given time point (timed mutexes only)*/
+    template<typename Clock, typename Duration>
+    shared_lock(mutex_type& mut, const std::chrono::time_point<Clock, Duration>& abs_time):
+        m_mutex_ptr(&mut), m_owns(false)
+    { m_owns = m_mutex_ptr->try_lock_shared_until(abs_time); }
+
+    shared_lock(const shared_lock& other) = delete;
+    shared_lock& operator=(const shared_lock& other) = delete;
+
+    ~shared_lock() {
+        if(m_mutex_ptr && m_owns)
+            unlock();
+    }
+
+    void lock() {
+        if(!m_mutex_ptr)
+            throw std::runtime_error("shared_lock: lock: not owning any mutex");
+        if(m_owns)
+            throw std::runtime_error("shared_lock: lock: recursive lock");
+
+        m_mutex_ptr->lock_shared();
+        m_owns = true;
+    }
+
+    bool try_lock() {
+        if(!m_mutex_ptr)
+            throw std::runtime_error("shared_lock: try_lock: not owning any mutex");
+        if(m_owns)
+            throw std::runtime_error("shared_lock: try_lock: recursive lock");
+
+        return m_owns = m_mutex_ptr->try_lock_shared();
+    }
+
+    template<typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period>& rel_time) {
+        if(!m_mutex_ptr)
+            throw std::runtime_error("shared_lock: try_lock_for: not owning any mutex");
+        if(m_owns)
+            throw std::runtime_error("shared_lock: try_lock_for: recursive lock");
+
+        return m_owns = m_mutex_ptr->try_lock_shared_for(rel_time);
+    }
+
+    template<typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration>& abs_time) {
+        if(!m_mutex_ptr)
+            throw std::runtime_error("shared_lock: try_lock_until: not owning any mutex");
+        if(m_owns)
+            throw std::runtime_error("shared_lock: try_lock_until: recursive lock");
+
+        return m_owns = m_mutex_ptr->try_lock_shared_until(abs_time);
+    }
+
+    void unlock() {
+        if(!m_owns)
+            throw std::runtime_error("shared_lock: unlock: not owning lock to unlock it");
+        else if(m_mutex_ptr) {
+            m_mutex_ptr->unlock_shared();
+            m_owns = false;
+        }
+    }
+
+    mutex_type*
+    release() {
+        mutex_type* ret = m_mutex_ptr;
+        m_mutex_ptr = nullptr;
+        m_owns = false;
+        return ret;
+    }
+
+    bool
+    owns_lock() const
+    { return m_owns; }
+
+    explicit
+    operator bool() const
+    { return owns_lock(); }
+
+    mutex_type*
+    mutex() const
+    { return m_mutex_ptr; }
+
+private:
+    mutex_type* m_mutex_ptr;
+    bool m_owns;
+
+}; // class shared_lock
+
+} // namespace concurrency
+
+#endif
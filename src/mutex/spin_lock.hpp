@@ -0,0 +1,132 @@
+#ifndef SPIN_LOCK_H
+#define SPIN_LOCK_H
+
+#include <atomic>
+
+#include <sched.h>
+
+#include "futex.h"
+
+namespace concurrency {
+
+/*
+ * Backoff policies of spinning locks. Policy object lives for one acquisition,
+ * pause() is called after every failed attempt.
+ */
+
+/*retry at once*/
+struct backoff_none {
+    void pause() {}
+}; // struct backoff_none
+
+/*single pause instruction between attempts, keeps sibling hyperthread going*/
+struct backoff_pause {
+    void pause()
+    { util::cpu_relax(); }
+}; // struct backoff_pause
+
+/*
+ * Doubles number of pause instructions after every failed attempt.
+ * When limit is reached, gives up cpu instead: lock holder may be preempted,
+ * and spinning then only takes time slice from it.
+ */
+struct backoff_exponential {
+    backoff_exponential(): m_spins(1) {}
+
+    void pause() {
+        if(m_spins > max_spins) {
+            sched_yield();
+            return;
+        }
+        for(int i = 0; i < m_spins; ++i)
+            util::cpu_relax();
+        m_spins *= 2;
+    }
+
+private:
+    static const int max_spins = 1024;
+
+    int m_spins;
+}; // struct backoff_exponential
+
+/*
+ * User-space locks below never enter kernel, so they suit critical sections of
+ * few nanoseconds. They satisfy lock/try_lock/unlock surface of mutex,
+ * so they can be used with lock_guard and unique_lock.
+ * Waiters burn cpu, so threads must not outnumber cores.
+ */
+
+/*Test-and-test-and-set lock: waiters spin on cached copy, and write only when lock looks free*/
+template<typename Backoff = backoff_exponential>
+class ttas_lock {
+
+public:
+    ttas_lock(): m_locked(false) {}
+
+    ttas_lock(const ttas_lock& other) = delete;
+    ttas_lock& operator=(const ttas_lock& other) = delete;
+
+    void lock() {
+        Backoff backoff;
+        while(m_locked.exchange(true, std::memory_order_acquire))
+            do
+                backoff.pause();
+            while(m_locked.load(std::memory_order_relaxed));
+    }
+
+    bool try_lock() {
+        return !m_locked.load(std::memory_order_relaxed)
+            && !m_locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock()
+    { m_locked.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> m_locked;
+
+}; // class ttas_lock
+
+/*Ticket lock: FIFO fair, waiters spin on one shared counter*/
+template<typename Backoff = backoff_exponential>
+class ticket_lock {
+
+public:
+    ticket_lock(): m_next_ticket(0), m_now_serving(0) {}
+
+    ticket_lock(const ticket_lock& other) = delete;
+    ticket_lock& operator=(const ticket_lock& other) = delete;
+
+    void lock() {
+        const unsigned ticket = m_next_ticket.fetch_add(1, std::memory_order_relaxed);
+
+        Backoff backoff;
+        while(m_now_serving.load(std::memory_order_acquire) != ticket)
+            backoff.pause();
+    }
+
+    bool try_lock() {
+        unsigned serving = m_now_serving.load(std::memory_order_acquire);
+        /*take ticket only if it would be served right away*/
+        return m_next_ticket.compare_exchange_strong(
+            serving, serving + 1,
+            std::memory_order_acquire, std::memory_order_relaxed
+        );
+    }
+
+    void unlock() {
+        /*only holder writes m_now_serving*/
+        const unsigned serving = m_now_serving.load(std::memory_order_relaxed);
+        m_now_serving.store(serving + 1, std::memory_order_release);
+    }
+
+private:
+    std::atomic<unsigned> m_next_ticket;
+    /*polled by waiters, kept apart from ticket dispenser*/
+    alignas(64) std::atomic<unsigned> m_now_serving;
+
+}; // class ticket_lock
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,495 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <sched.h>
+
+#include "mutex.hpp"
+#include "condition_variable.hpp"
+#include "timespec.h"
+
+namespace concurrency {
+
+enum class channel_status {
+    success,
+    empty,      /*nothing to receive now*/
+    full,       /*no room to send now*/
+    closed,     /*send: channel is closed; receive: channel is closed and drained*/
+    timeout
+};
+
+/*
+ * Bounded multi-producer/multi-consumer channel.
+ * Storage is Vyukov's array queue: every cell carries sequence number, which tells
+ * whether cell is free for position of producer or holds element for position of consumer,
+ * so single CAS on enqueue/dequeue position claims cell and no lock is taken.
+ * Blocking operations retry in place and fall back to condition_variable only when
+ * channel stays full/empty; waiters are counted, so non-blocking side never locks
+ * mutex while nobody sleeps.
+ * close() forbids further sends and wakes all waiters, elements already sent can still be received.
+ * Claimed cell must be filled, so element is built in place only when this cannot throw;
+ * otherwise it is copied aside first and moved in after claim.
+ */
+template<typename T>
+class channel {
+
+    static_assert(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value,
+        "channel: element type must be nothrow movable");
+
+public:
+    typedef T value_type;
+
+    /*capacity is rounded up to power of two (at least 2)*/
+    explicit
+    channel(std::size_t capacity):
+        m_enqueue_word(0),
+        m_dequeue_pos(0),
+        m_mask(round_up_pow2(capacity) - 1),
+        m_cells(nullptr),
+        m_send_waiters(0),
+        m_recv_waiters(0)
+    {
+        if(capacity == 0)
+            throw std::invalid_argument("channel: zero capacity");
+
+        m_cells = new cell[m_mask + 1];
+        for(std::size_t i = 0; i <= m_mask; ++i)
+            m_cells[i].m_seq.store(i, std::memory_order_relaxed);
+    }
+
+    channel(const channel& other) = delete;
+    channel& operator=(const channel& other) = delete;
+
+    ~channel() {
+        const std::size_t enqueue_pos = m_enqueue_word.load(std::memory_order_relaxed) >> 1;
+        for(std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed); pos != enqueue_pos; ++pos)
+            m_cells[pos & m_mask].value()->~T();
+        delete[] m_cells;
+    }
+
+    std::size_t
+    capacity() const
+    { return m_mask + 1; }
+
+    /*elements sent, but not yet received; approximate under concurrent use*/
+    std::size_t size() const {
+        const std::size_t dequeue_pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        const std::size_t enqueue_pos = m_enqueue_word.load(std::memory_order_relaxed) >> 1;
+        return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+    }
+
+    bool
+    closed() const
+    { return m_enqueue_word.load(std::memory_order_acquire) & closed_bit; }
+
+    /*further sends fail, blocked senders and receivers are woken*/
+    void close() {
+        m_enqueue_word.fetch_or(closed_bit, std::memory_order_acq_rel);
+
+        lock_guard<mutex> locker(m_wait_mutex);
+        m_not_full.notify_all();
+        m_not_empty.notify_all();
+    }
+
+    /*success, full or closed; val is moved from only on success*/
+    channel_status try_send(const value_type& val)
+    { return sent(send_raw(val)); }
+
+    channel_status try_send(value_type&& val)
+    { return sent(send_raw(std::move(val))); }
+
+    /*success, empty or closed*/
+    channel_status try_receive(value_type& val)
+    { return received(receive_raw(val)); }
+
+    /*success or closed*/
+    channel_status send(const value_type& val)
+    { return send_wait(val, no_deadline()); }
+
+    channel_status send(value_type&& val)
+    { return send_wait(std::move(val), no_deadline()); }
+
+    /*success, closed or timeout*/
+    template<typename V, typename Rep, typename Period>
+    channel_status send_for(V&& val, const std::chrono::duration<Rep, Period>& rel_time)
+    { return send_until(std::forward<V>(val), util::deadline_after(rel_time)); }
+
+    template<typename V, typename Clock, typename Duration>
+    channel_status send_until(V&& val, const std::chrono::time_point<Clock, Duration>& abs_time)
+    { return send_wait(std::forward<V>(val), &abs_time); }
+
+    /*success or closed (once channel is closed and drained)*/
+    channel_status receive(value_type& val)
+    { return receive_wait(val, no_deadline()); }
+
+    /*success, closed or timeout*/
+    template<typename Rep, typename Period>
+    channel_status receive_for(value_type& val, const std::chrono::duration<Rep, Period>& rel_time)
+    { return receive_until(val, util::deadline_after(rel_time)); }
+
+    template<typename Clock, typename Duration>
+    channel_status receive_until(value_type& val, const std::chrono::time_point<Clock, Duration>& abs_time)
+    { return receive_wait(val, &abs_time); }
+
+    /*
+     * Bulk operations claim run of cells with single CAS.
+     * try_ variants move as many elements as possible at once, returning their number.
+     */
+    template<typename InputIt>
+    std::size_t try_send_bulk(InputIt first, std::size_t count) {
+        std::size_t sent_count = 0;
+        const channel_status status = send_bulk_raw(first, count, sent_count);
+        sent(status, sent_count);
+        return sent_count;
+    }
+
+    template<typename OutputIt>
+    std::size_t try_receive_bulk(OutputIt out, std::size_t max_count) {
+        std::size_t received_count = 0;
+        const channel_status status = receive_bulk_raw(out, max_count, received_count);
+        received(status, received_count);
+        return received_count;
+    }
+
+    /*waits until all count elements are sent, fewer are sent only if channel gets closed*/
+    template<typename InputIt>
+    std::size_t send_bulk(InputIt first, std::size_t count) {
+        std::size_t total = 0;
+        while(total != count) {
+            std::size_t sent_count = 0;
+            const channel_status status = wait_until(
+                [this, &first, count, total, &sent_count] () {
+                    return send_bulk_raw(first, count - total, sent_count);
+                },
+                m_not_full, m_send_waiters, no_deadline()
+            );
+            sent(status, sent_count);
+            if(status != channel_status::success)
+                break;
+            std::advance(first, sent_count);
+            total += sent_count;
+        }
+        return total;
+    }
+
+    /*waits for at least one element, returns zero once channel is closed and drained*/
+    template<typename OutputIt>
+    std::size_t receive_bulk(OutputIt out, std::size_t max_count) {
+        if(max_count == 0)
+            return 0;
+
+        std::size_t received_count = 0;
+        const channel_status status = wait_until(
+            [this, &out, max_count, &received_count] () {
+                return receive_bulk_raw(out, max_count, received_count);
+            },
+            m_not_empty, m_recv_waiters, no_deadline()
+        );
+        received(status, received_count);
+        return received_count;
+    }
+
+private:
+    struct cell {
+        std::atomic<std::size_t> m_seq;
+        alignas(T) unsigned char m_bytes[sizeof(T)];
+
+        T* value()
+        { return std::launder(reinterpret_cast<T*>(m_bytes)); }
+    };
+
+    /*enqueue position is kept shifted, so that close and claim of cell are ordered by one word*/
+    static const std::size_t closed_bit = 1;
+    static const int yield_attempts = 4;
+
+    static const std::chrono::steady_clock::time_point*
+    no_deadline()
+    { return nullptr; }
+
+    static std::size_t round_up_pow2(std::size_t capacity) {
+        std::size_t pow2 = 2;
+        while(pow2 < capacity)
+            pow2 <<= 1;
+        return pow2;
+    }
+
+    /*abs_time is null for untimed wait*/
+    template<typename V, typename Clock, typename Duration>
+    channel_status send_wait(V&& val, const std::chrono::time_point<Clock, Duration>* abs_time) {
+        /*copy which may throw is made once, before waiting*/
+        if constexpr(!std::is_nothrow_constructible<T, V&&>::value) {
+            T staged(std::forward<V>(val));
+            return send_wait(std::move(staged), abs_time);
+        }
+        return sent(wait_until(
+            [this, &val] () { return send_raw(std::forward<V>(val)); },
+            m_not_full, m_send_waiters, abs_time
+        ));
+    }
+
+    template<typename Clock, typename Duration>
+    channel_status receive_wait(value_type& val, const std::chrono::time_point<Clock, Duration>* abs_time) {
+        return received(wait_until(
+            [this, &val] () { return receive_raw(val); },
+            m_not_empty, m_recv_waiters, abs_time
+        ));
+    }
+
+    template<typename V>
+    channel_status send_raw(V&& val) {
+        if constexpr(!std::is_nothrow_constructible<T, V&&>::value) {
+            T staged(std::forward<V>(val));
+            return send_raw(std::move(staged));
+        }
+
+        std::size_t word = m_enqueue_word.load(std::memory_order_relaxed);
+        for(;;) {
+            if(word & closed_bit)
+                return channel_status::closed;
+
+            const std::size_t pos = word >> 1;
+            cell& c = m_cells[pos & m_mask];
+            const std::size_t seq = c.m_seq.load(std::memory_order_acquire);
+            const std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq - pos);
+
+            if(dif == 0) {
+                if(m_enqueue_word.compare_exchange_weak(word, word + 2, std::memory_order_relaxed)) {
+                    new (c.value()) T(std::forward<V>(val));
+                    c.m_seq.store(pos + 1, std::memory_order_release);
+                    return channel_status::success;
+                }
+            } else if(dif < 0) {
+                /*cell still holds element of previous lap*/
+                return channel_status::full;
+            } else {
+                word = m_enqueue_word.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    channel_status receive_raw(value_type& val) {
+        std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        for(;;) {
+            cell& c = m_cells[pos & m_mask];
+            const std::size_t seq = c.m_seq.load(std::memory_order_acquire);
+            const std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+
+            if(dif == 0) {
+                if(m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    val = std::move(*c.value());
+                    c.value()->~T();
+                    c.m_seq.store(pos + m_mask + 1, std::memory_order_release);
+                    return channel_status::success;
+                }
+            } else if(dif < 0) {
+                return empty_or_closed(pos);
+            } else {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<typename InputIt>
+    channel_status send_bulk_raw(InputIt first, std::size_t count, std::size_t& sent_count) {
+        sent_count = 0;
+        if(count == 0)
+            return channel_status::success;
+
+        /*throwing copies are sent one by one, each made before its cell is claimed*/
+        if constexpr(!std::is_nothrow_constructible<T, decltype(*first)>::value) {
+            T staged(*first);
+            return send_bulk_raw(std::make_move_iterator(&staged), 1, sent_count);
+        }
+
+        std::size_t word = m_enqueue_word.load(std::memory_order_relaxed);
+        for(;;) {
+            if(word & closed_bit)
+                return channel_status::closed;
+
+            const std::size_t pos = word >> 1;
+            const std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(
+                m_cells[pos & m_mask].m_seq.load(std::memory_order_acquire) - pos
+            );
+            if(dif < 0)
+                return channel_status::full;
+            if(dif > 0) {
+                word = m_enqueue_word.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            /*run of free cells following first one*/
+            std::size_t run = 1;
+            while(run < count && run <= m_mask
+                && m_cells[(pos + run) & m_mask].m_seq.load(std::memory_order_acquire) == pos + run)
+                ++run;
+
+            if(!m_enqueue_word.compare_exchange_weak(word, word + 2 * run, std::memory_order_relaxed))
+                continue;
+
+            for(std::size_t i = 0; i < run; ++i, ++first) {
+                cell& c = m_cells[(pos + i) & m_mask];
+                new (c.value()) T(*first);
+                c.m_seq.store(pos + i + 1, std::memory_order_release);
+            }
+            sent_count = run;
+            return channel_status::success;
+        }
+    }
+
+    template<typename OutputIt>
+    channel_status receive_bulk_raw(OutputIt& out, std::size_t max_count, std::size_t& received_count) {
+        received_count = 0;
+        if(max_count == 0)
+            return channel_status::success;
+
+        std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        for(;;) {
+            const std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(
+                m_cells[pos & m_mask].m_seq.load(std::memory_order_acquire) - (pos + 1)
+            );
+            if(dif < 0)
+                return empty_or_closed(pos);
+            if(dif > 0) {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            /*run of filled cells following first one*/
+            std::size_t run = 1;
+            while(run < max_count && run <= m_mask
+                && m_cells[(pos + run) & m_mask].m_seq.load(std::memory_order_acquire) == pos + run + 1)
+                ++run;
+
+            if(!m_dequeue_pos.compare_exchange_weak(pos, pos + run, std::memory_order_relaxed))
+                continue;
+
+            for(std::size_t i = 0; i < run; ++i, ++out) {
+                cell& c = m_cells[(pos + i) & m_mask];
+                *out = std::move(*c.value());
+                c.value()->~T();
+                c.m_seq.store(pos + i + m_mask + 1, std::memory_order_release);
+            }
+            received_count = run;
+            return channel_status::success;
+        }
+    }
+
+    /*
+     * Closed channel is drained once every claimed cell was received; cell claimed by
+     * sender, which has not yet written it, still counts as pending element.
+     */
+    channel_status empty_or_closed(std::size_t dequeue_pos) const {
+        const std::size_t word = m_enqueue_word.load(std::memory_order_acquire);
+        if((word & closed_bit) && (word >> 1) == dequeue_pos)
+            return channel_status::closed;
+        return channel_status::empty;
+    }
+
+    /*
+     * Retries attempt under mutex, sleeping on cond between retries.
+     * Waiter count is raised before retry, publisher stores cell before checking count,
+     * and full fences on both sides make sure one of them sees the other.
+     */
+    template<typename Attempt, typename Clock, typename Duration>
+    channel_status wait_until(
+        Attempt attempt,
+        condition_variable& cond,
+        std::atomic<int>& waiters,
+        const std::chrono::time_point<Clock, Duration>* abs_time
+    ) {
+        channel_status status = attempt();
+        /*other side may be preempted in the middle of operation, giving it cpu is cheaper than sleeping*/
+        for(int i = 0; would_block(status) && i < yield_attempts; ++i) {
+            sched_yield();
+            status = attempt();
+        }
+        if(!would_block(status))
+            return status;
+
+        unique_lock<mutex> locker(m_wait_mutex);
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        try {
+            while(would_block(status = attempt())) {
+                if(!abs_time) {
+                    cond.wait(locker);
+                } else if(cond.wait_until(locker, *abs_time) == cv_status::timeout) {
+                    status = attempt();
+                    if(would_block(status))
+                        status = channel_status::timeout;
+                    break;
+                }
+            }
+        } catch(...) {
+            /*copy of element threw, nothing was claimed*/
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return status;
+    }
+
+    static bool would_block(channel_status status)
+    { return status == channel_status::empty || status == channel_status::full; }
+
+    /*
+     * Wakes receivers after successful send.
+     * Receivers woken by close() go back to sleep while some cell is claimed, but not filled;
+     * every one of them waits for sender filling it, as that may be the last element.
+     */
+    channel_status sent(channel_status status, std::size_t count = 1) {
+        if(status == channel_status::success && count != 0)
+            wake(m_not_empty, m_recv_waiters, count != 1 || closed());
+        return status;
+    }
+
+    /*wakes senders after successful receive, and receivers if it may have drained closed channel*/
+    channel_status received(channel_status status, std::size_t count = 1) {
+        if(status == channel_status::success && count != 0) {
+            wake(m_not_full, m_send_waiters, count != 1);
+            if(closed())
+                wake(m_not_empty, m_recv_waiters, true);
+        }
+        return status;
+    }
+
+    void wake(condition_variable& cond, std::atomic<int>& waiters, bool all) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(waiters.load(std::memory_order_relaxed) == 0)
+            return;
+
+        lock_guard<mutex> locker(m_wait_mutex);
+        if(all)
+            cond.notify_all();
+        else
+            cond.notify_one();
+    }
+
+    /*producers and consumers contend on different positions, keep them apart*/
+    alignas(64) std::atomic<std::size_t> m_enqueue_word;
+    alignas(64) std::atomic<std::size_t> m_dequeue_pos;
+    alignas(64) const std::size_t m_mask;
+    cell* m_cells;
+
+    /*threads sleeping (or about to) in blocking operations*/
+    alignas(64) std::atomic<int> m_send_waiters;
+    std::atomic<int> m_recv_waiters;
+    mutex m_wait_mutex;
+    condition_variable m_not_full;
+    condition_variable m_not_empty;
+
+}; // class channel
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef LOCK_FREE_QUEUE_H
+#define LOCK_FREE_QUEUE_H
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "reclaim.hpp"
+
+namespace concurrency {
+
+/*
+ * Unbounded lock-free FIFO queue of any number of producers and consumers (Michael-Scott queue).
+ * Head always points to dummy node, value of queue front lives in its successor;
+ * dequeuing moves value out and successor becomes new dummy, old one is reclaimed by chosen scheme.
+ */
+template<typename T, reclamation Reclaim = reclamation::hazard_pointers>
+class lock_free_queue {
+
+public:
+    typedef T value_type;
+
+    lock_free_queue() {
+        node* dummy = new node;
+        m_head.store(dummy, std::memory_order_relaxed);
+        m_tail.store(dummy, std::memory_order_relaxed);
+    }
+
+    lock_free_queue(const lock_free_queue& other) = delete;
+    lock_free_queue& operator=(const lock_free_queue& other) = delete;
+
+    /*no other thread may use queue any more*/
+    ~lock_free_queue() {
+        node* dummy = m_head.load(std::memory_order_relaxed);
+        node* front = dummy->m_next.load(std::memory_order_relaxed);
+        delete dummy;
+        while(front) {
+            node* next = front->m_next.load(std::memory_order_relaxed);
+            front->value()->~T();
+            delete front;
+            front = next;
+        }
+    }
+
+    void push(const value_type& val)
+    { emplace(val); }
+
+    void push(value_type&& val)
+    { emplace(std::move(val)); }
+
+    template<typename ...Args>
+    void emplace(Args&& ...args) {
+        node* last = new node;
+        try {
+            new (&last->m_storage) T(std::forward<Args>(args)...);
+        }
+        catch(...) {
+            delete last;
+            throw;
+        }
+
+        if(Reclaim == reclamation::hazard_pointers) {
+            hazard_pointer hazard;
+            link_last(last, hazard);
+        }
+        else {
+            epoch_guard guard;
+            link_last(last, guard);
+        }
+    }
+
+    /*false if queue is empty*/
+    bool try_pop(value_type& val) {
+        if(Reclaim == reclamation::hazard_pointers)
+            return pop_protected(val);
+        return pop_in_epoch(val);
+    }
+
+    /*approximate while others push or pop*/
+    bool empty() const {
+        if(Reclaim == reclamation::hazard_pointers) {
+            hazard_pointer hazard;
+            node* dummy = hazard.protect(m_head);
+            return dummy->m_next.load(std::memory_order_acquire) == nullptr;
+        }
+        epoch_guard guard;
+        return m_head.load(std::memory_order_acquire)->m_next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct node {
+        node(): m_next(nullptr) {}
+
+        T* value() noexcept
+        { return reinterpret_cast<T*>(&m_storage); }
+
+        /*constructed in all nodes but dummy*/
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;
+        std::atomic<node*> m_next;
+    }; // struct node
+
+    /*
+     * Tail may lag one node behind, whoever sees that swings it forward;
+     * node is linked once its predecessor's m_next CAS succeeds.
+     */
+    void link_last(node* last, hazard_pointer& hazard) {
+        for(;;) {
+            node* tail = hazard.protect(m_tail);
+            node* next = tail->m_next.load(std::memory_order_acquire);
+            if(next) {
+                m_tail.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+            if(tail->m_next.compare_exchange_weak(next, last, std::memory_order_release, std::memory_order_relaxed)) {
+                m_tail.compare_exchange_strong(tail, last, std::memory_order_release, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+    void link_last(node* last, epoch_guard&) {
+        for(;;) {
+            node* tail = m_tail.load(std::memory_order_acquire);
+            node* next = tail->m_next.load(std::memory_order_acquire);
+            if(next) {
+                m_tail.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+            if(tail->m_next.compare_exchange_weak(next, last, std::memory_order_release, std::memory_order_relaxed)) {
+                m_tail.compare_exchange_strong(tail, last, std::memory_order_release, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+    /*
+     * Successor is read under protection of dummy and protected itself before head
+     * is re-checked: while head still holds dummy, successor can not have been retired.
+     */
+    bool pop_protected(value_type& val) {
+        hazard_pointer hazard_head;
+        hazard_pointer hazard_next;
+        for(;;) {
+            node* dummy = hazard_head.protect(m_head);
+            node* next = dummy->m_next.load(std::memory_order_acquire);
+            if(!next)
+                return false;
+            hazard_next.reset_protection(next);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(m_head.load(std::memory_order_acquire) != dummy)
+                continue;
+
+            if(try_advance_head(dummy, next)) {
+                val = std::move(*next->value());
+                next->value()->~T();
+                hazard_head.reset_protection();
+                hazard_next.reset_protection();
+                hazard_retire(dummy);
+                return true;
+            }
+        }
+    }
+
+    bool pop_in_epoch(value_type& val) {
+        epoch_guard guard;
+        for(;;) {
+            node* dummy = m_head.load(std::memory_order_acquire);
+            node* next = dummy->m_next.load(std::memory_order_acquire);
+            if(!next)
+                return false;
+
+            if(try_advance_head(dummy, next)) {
+                val = std::move(*next->value());
+                next->value()->~T();
+                epoch_retire(dummy);
+                return true;
+            }
+        }
+    }
+
+    /*tail must not be left pointing to dummy about to be retired*/
+    bool try_advance_head(node* dummy, node* next) {
+        node* tail = m_tail.load(std::memory_order_acquire);
+        if(tail == dummy)
+            m_tail.compare_exchange_strong(tail, next, std::memory_order_release, std::memory_order_relaxed);
+        return m_head.compare_exchange_strong(dummy, next, std::memory_order_acq_rel, std::memory_order_relaxed);
+    }
+
+    alignas(64) std::atomic<node*> m_head;
+    alignas(64) std::atomic<node*> m_tail;
+
+}; // class lock_free_queue
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef LOCK_FREE_STACK_H
+#define LOCK_FREE_STACK_H
+
+#include <atomic>
+#include <utility>
+
+#include "reclaim.hpp"
+
+namespace concurrency {
+
+/*
+ * Unbounded lock-free LIFO stack of any number of threads (Treiber stack).
+ * Every push allocates node, popped nodes are reclaimed by chosen scheme,
+ * which also rules out ABA on head: node can not be reused while popper may still see it.
+ */
+template<typename T, reclamation Reclaim = reclamation::hazard_pointers>
+class lock_free_stack {
+
+public:
+    typedef T value_type;
+
+    lock_free_stack(): m_head(nullptr) {}
+
+    lock_free_stack(const lock_free_stack& other) = delete;
+    lock_free_stack& operator=(const lock_free_stack& other) = delete;
+
+    /*no other thread may use stack any more*/
+    ~lock_free_stack() {
+        node* top = m_head.load(std::memory_order_relaxed);
+        while(top) {
+            node* next = top->m_next;
+            delete top;
+            top = next;
+        }
+    }
+
+    void push(const value_type& val)
+    { emplace(val); }
+
+    void push(value_type&& val)
+    { emplace(std::move(val)); }
+
+    template<typename ...Args>
+    void emplace(Args&& ...args) {
+        node* top = new node(std::forward<Args>(args)...);
+        top->m_next = m_head.load(std::memory_order_relaxed);
+        while(!m_head.compare_exchange_weak(
+            top->m_next, top,
+            std::memory_order_release, std::memory_order_relaxed
+        ))
+            ;
+    }
+
+    /*false if stack is empty*/
+    bool try_pop(value_type& val) {
+        if(Reclaim == reclamation::hazard_pointers)
+            return pop_protected(val);
+        return pop_in_epoch(val);
+    }
+
+    /*approximate while others push or pop*/
+    bool empty() const
+    { return m_head.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    struct node {
+        template<typename ...Args>
+        explicit node(Args&& ...args): m_value(std::forward<Args>(args)...), m_next(nullptr) {}
+
+        T m_value;
+        node* m_next;
+    }; // struct node
+
+    /*
+     * Winner of head CAS owns node, so value is moved out after CAS;
+     * losers only read m_next of node they still protect.
+     */
+    bool pop_protected(value_type& val) {
+        hazard_pointer hazard;
+        for(;;) {
+            node* top = hazard.protect(m_head);
+            if(!top)
+                return false;
+
+            if(m_head.compare_exchange_strong(
+                top, top->m_next,
+                std::memory_order_acquire, std::memory_order_relaxed
+            )) {
+                val = std::move(top->m_value);
+                hazard.reset_protection();
+                hazard_retire(top);
+                return true;
+            }
+        }
+    }
+
+    bool pop_in_epoch(value_type& val) {
+        epoch_guard guard;
+        node* top = m_head.load(std::memory_order_acquire);
+        while(top && !m_head.compare_exchange_weak(
+            top, top->m_next,
+            std::memory_order_acquire, std::memory_order_acquire
+        ))
+            ;
+        if(!top)
+            return false;
+
+        val = std::move(top->m_value);
+        epoch_retire(top);
+        return true;
+    }
+
+    alignas(64) std::atomic<node*> m_head;
+
+}; // class lock_free_stack
+
+} // namespace concurrency
+
+#endif
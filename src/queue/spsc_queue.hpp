@@ -0,0 +1,310 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#include <sched.h>
+
+#include "mutex.hpp"
+#include "condition_variable.hpp"
+#include "futex.h"
+
+namespace concurrency {
+
+enum class spsc_mode {
+    polling,    /*push/pop spin, then yield cpu, until there is room/element*/
+    blocking    /*push/pop park on condition_variable when queue stays full/empty*/
+};
+
+/*
+ * Bounded lock-free queue of one producer thread and one consumer thread.
+ * Producer owns tail, consumer owns head, each keeps cached copy of index of other side
+ * and rereads it only when queue looks full/empty, so in steady state sides do not
+ * touch cache lines of each other except for slots themselves.
+ * Bulk operations publish whole batch with single index store.
+ * Slots are stored inline, so large queues should not live on stack.
+ * In blocking mode every publication additionally checks for sleeping side (one full fence),
+ * so polling mode is cheaper when both sides stay busy.
+ */
+template<typename T, std::size_t Capacity, spsc_mode Mode = spsc_mode::polling>
+class spsc_queue {
+
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+        "spsc_queue capacity must be power of two");
+
+public:
+    typedef T value_type;
+
+    spsc_queue():
+        m_tail(0), m_head_cache(0),
+        m_head(0), m_tail_cache(0),
+        m_sleepers(0)
+    {}
+
+    spsc_queue(const spsc_queue& other) = delete;
+    spsc_queue& operator=(const spsc_queue& other) = delete;
+
+    ~spsc_queue() {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        for(std::size_t head = m_head.load(std::memory_order_relaxed); head != tail; ++head)
+            slot_at(head)->~T();
+    }
+
+    static constexpr std::size_t
+    capacity()
+    { return Capacity; }
+
+    /*producer only*/
+    template<typename ...Args>
+    bool try_emplace(Args&& ...args) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if(!has_room(tail))
+            return false;
+
+        new (slot_at(tail)) T(std::forward<Args>(args)...);
+        publish_tail(tail + 1);
+        return true;
+    }
+
+    bool try_push(const value_type& val)
+    { return try_emplace(val); }
+
+    bool try_push(value_type&& val)
+    { return try_emplace(std::move(val)); }
+
+    /*
+     * producer only, pushes as many of count elements as fit, returns number pushed;
+     * if copy of element throws, nothing is pushed
+     */
+    template<typename InputIt>
+    std::size_t try_push_bulk(InputIt first, std::size_t count) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if(count == 0 || !has_room(tail))
+            return 0;
+
+        /*stale copy would cut batch short*/
+        if(Capacity - (tail - m_head_cache) < count)
+            m_head_cache = m_head.load(std::memory_order_acquire);
+        const std::size_t room = Capacity - (tail - m_head_cache);
+        if(count > room)
+            count = room;
+        std::size_t constructed = 0;
+        try {
+            for(; constructed < count; ++constructed, ++first)
+                new (slot_at(tail + constructed)) T(*first);
+        } catch(...) {
+            /*batch is not published yet, consumer has not seen any of it*/
+            while(constructed != 0)
+                slot_at(tail + --constructed)->~T();
+            throw;
+        }
+        publish_tail(tail + count);
+        return count;
+    }
+
+    /*consumer only*/
+    bool try_pop(value_type& val) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if(!has_elements(head))
+            return false;
+
+        T* slot = slot_at(head);
+        val = std::move(*slot);
+        slot->~T();
+        publish_head(head + 1);
+        return true;
+    }
+
+    /*
+     * consumer only, pops up to max_count elements into out, returns number popped;
+     * if move of element throws, elements before it stay popped
+     */
+    template<typename OutputIt>
+    std::size_t try_pop_bulk(OutputIt out, std::size_t max_count) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if(!has_elements(head))
+            return 0;
+
+        if(m_tail_cache - head < max_count)
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+        std::size_t count = m_tail_cache - head;
+        if(count > max_count)
+            count = max_count;
+        for(std::size_t i = 0; i < count; ++i, ++out) {
+            T* slot = slot_at(head + i);
+            try {
+                *out = std::move(*slot);
+            } catch(...) {
+                publish_head(head + i);
+                throw;
+            }
+            slot->~T();
+        }
+        publish_head(head + count);
+        return count;
+    }
+
+    /*producer only, waits for room*/
+    void push(const value_type& val)
+    { emplace(val); }
+
+    void push(value_type&& val)
+    { emplace(std::move(val)); }
+
+    template<typename ...Args>
+    void emplace(Args&& ...args) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        wait_until([this, tail] () { return has_room(tail); });
+
+        new (slot_at(tail)) T(std::forward<Args>(args)...);
+        publish_tail(tail + 1);
+    }
+
+    /*producer only, waits until all count elements are pushed*/
+    template<typename InputIt>
+    void push_bulk(InputIt first, std::size_t count) {
+        while(count != 0) {
+            const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            wait_until([this, tail] () { return has_room(tail); });
+
+            const std::size_t pushed = try_push_bulk(first, count);
+            std::advance(first, pushed);
+            count -= pushed;
+        }
+    }
+
+    /*consumer only, waits for element*/
+    void pop(value_type& val) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        wait_until([this, head] () { return has_elements(head); });
+
+        try_pop(val);
+    }
+
+    /*consumer only, waits for at least one element, returns number popped*/
+    template<typename OutputIt>
+    std::size_t pop_bulk(OutputIt out, std::size_t max_count) {
+        if(max_count == 0)
+            return 0;
+
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        wait_until([this, head] () { return has_elements(head); });
+
+        return try_pop_bulk(out, max_count);
+    }
+
+    /*approximate unless called by one of sides while other is idle*/
+    std::size_t size() const {
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    bool empty() const
+    { return size() == 0; }
+
+private:
+    struct slot_storage {
+        alignas(T) unsigned char m_bytes[sizeof(T)];
+    };
+
+    static const int spin_attempts = 128;
+    static const int yield_attempts = 16;
+
+    T* slot_at(std::size_t idx)
+    { return std::launder(reinterpret_cast<T*>(m_slots[idx & (Capacity - 1)].m_bytes)); }
+
+    /*producer side: rereads head only when cached copy says queue is full*/
+    bool has_room(std::size_t tail) {
+        if(tail - m_head_cache != Capacity)
+            return true;
+        m_head_cache = m_head.load(std::memory_order_acquire);
+        return tail - m_head_cache != Capacity;
+    }
+
+    /*consumer side: rereads tail only when cached copy says queue is empty*/
+    bool has_elements(std::size_t head) {
+        if(head != m_tail_cache)
+            return true;
+        m_tail_cache = m_tail.load(std::memory_order_acquire);
+        return head != m_tail_cache;
+    }
+
+    void publish_tail(std::size_t tail) {
+        m_tail.store(tail, std::memory_order_release);
+        wake_other_side();
+    }
+
+    void publish_head(std::size_t head) {
+        m_head.store(head, std::memory_order_release);
+        wake_other_side();
+    }
+
+    /*
+     * Publisher and sleeper both store, fence, then load what other one stored,
+     * so either publisher sees sleeper or sleeper sees published index.
+     */
+    void wake_other_side() {
+        if(Mode != spsc_mode::blocking)
+            return;
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(m_sleepers.load(std::memory_order_relaxed) == 0)
+            return;
+
+        /*sleeper checks its condition under mutex, notification can not slip in between*/
+        lock_guard<mutex> locker(m_wait_mutex);
+        m_wait_cond.notify_all();
+    }
+
+    template<typename Pred>
+    void wait_until(Pred ready) {
+        for(int i = 0; i < spin_attempts; ++i) {
+            if(ready())
+                return;
+            util::cpu_relax();
+        }
+
+        /*other side may be preempted, giving it cpu is cheaper than sleeping*/
+        for(int i = 0; Mode != spsc_mode::blocking || i < yield_attempts; ++i) {
+            if(ready())
+                return;
+            sched_yield();
+        }
+
+        /*
+         * Woken side may still wait for mutex while other one goes to sleep,
+         * so both can be here at once: sleepers are counted and both are woken.
+         */
+        unique_lock<mutex> locker(m_wait_mutex);
+        m_sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while(!ready())
+            m_wait_cond.wait(locker);
+        m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /*written by producer, read by consumer when its copy runs out*/
+    alignas(64) std::atomic<std::size_t> m_tail;
+    std::size_t m_head_cache;
+
+    /*written by consumer, read by producer when its copy runs out*/
+    alignas(64) std::atomic<std::size_t> m_head;
+    std::size_t m_tail_cache;
+
+    /*used only in blocking mode*/
+    alignas(64) std::atomic<int> m_sleepers;
+    mutex m_wait_mutex;
+    condition_variable m_wait_cond;
+
+    alignas(64) slot_storage m_slots[Capacity];
+
+}; // class spsc_queue
+
+} // namespace concurrency
+
+#endif
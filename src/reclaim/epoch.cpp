@@ -0,0 +1,159 @@
+#include "epoch.hpp"
+
+#include <algorithm>
+
+#include "thread.hpp"
+
+namespace concurrency {
+
+namespace detail {
+
+namespace {
+
+/*starts at 1, so that 0 in record always means "outside"*/
+std::atomic<std::uint64_t> s_epoch(1);
+
+/*records are only pushed, advancing thread walks list without synchronization with owners*/
+std::atomic<epoch_record*> s_records(nullptr);
+
+orphan_stack s_orphans;
+
+const std::size_t collect_batch = 64;
+
+struct epoch_thread_data {
+    epoch_thread_data(): m_record(nullptr) {}
+
+    epoch_record* m_record;
+    retire_list m_retired; /*in order of retirement, so epochs do not decrease*/
+}; // struct epoch_thread_data
+
+thread_local epoch_thread_data* t_data = nullptr;
+
+epoch_record* acquire_record() {
+    for(epoch_record* record = s_records.load(std::memory_order_acquire); record; record = record->m_next) {
+        bool in_use = false;
+        if(!record->m_in_use.load(std::memory_order_relaxed) &&
+            record->m_in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire))
+            return record;
+    }
+
+    epoch_record* record = new epoch_record();
+    record->m_in_use.store(true, std::memory_order_relaxed);
+    record->m_next = s_records.load(std::memory_order_relaxed);
+    while(!s_records.compare_exchange_weak(
+        record->m_next, record,
+        std::memory_order_release, std::memory_order_relaxed
+    ))
+        ;
+    return record;
+}
+
+/*epoch moves on only when every thread inside critical region has announced current one*/
+std::uint64_t try_advance() {
+    std::uint64_t epoch = s_epoch.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    for(epoch_record* record = s_records.load(std::memory_order_acquire); record; record = record->m_next) {
+        const std::uint64_t announced = record->m_epoch.load(std::memory_order_acquire);
+        if((announced & 1) && (announced >> 1) != epoch)
+            return epoch;
+    }
+
+    if(s_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel))
+        return epoch + 1;
+    return epoch;
+}
+
+/*
+ * Reader of object retired in epoch e has announced e or e - 1 (retirement races with its entry),
+ * once epoch is e + 2 all such readers have left.
+ */
+void reclaim_expired(retire_list& retired, std::uint64_t epoch) {
+    std::size_t expired = 0;
+    while(expired < retired.size() && retired[expired].m_epoch + 2 <= epoch)
+        ++expired;
+    if(expired == 0)
+        return;
+
+    /*deleters may retire more objects, so expired ones are moved out first*/
+    retire_list reclaimed(retired.begin(), retired.begin() + expired);
+    retired.erase(retired.begin(), retired.begin() + expired);
+    for(std::size_t i = 0; i < reclaimed.size(); ++i)
+        reclaimed[i].m_reclaim(reclaimed[i].m_ptr);
+}
+
+/*orphans are merged keeping list ordered by epoch*/
+void adopt_orphans(retire_list& retired) {
+    retire_list orphans;
+    s_orphans.take_all(orphans);
+    if(orphans.empty())
+        return;
+
+    orphans.insert(orphans.end(), retired.begin(), retired.end());
+    std::stable_sort(orphans.begin(), orphans.end(), [] (const retired_ptr& lhs, const retired_ptr& rhs) {
+        return lhs.m_epoch < rhs.m_epoch;
+    });
+    retired.swap(orphans);
+}
+
+void on_thread_exit(void* arg) {
+    epoch_thread_data* data = static_cast<epoch_thread_data*>(arg);
+
+    reclaim_expired(data->m_retired, try_advance());
+    s_orphans.push(std::move(data->m_retired));
+
+    data->m_record->m_epoch.store(0, std::memory_order_release);
+    data->m_record->m_in_use.store(false, std::memory_order_release);
+
+    t_data = nullptr;
+    delete data;
+}
+
+epoch_thread_data& this_thread_data() {
+    if(!t_data) {
+        epoch_thread_data* data = new epoch_thread_data();
+        data->m_record = acquire_record();
+        t_data = data;
+        this_thread::at_exit(on_thread_exit, data);
+    }
+    return *t_data;
+}
+
+} // namespace
+
+epoch_record* this_thread_epoch_record()
+{ return this_thread_data().m_record; }
+
+void enter_epoch(epoch_record* record) {
+    std::uint64_t epoch = s_epoch.load(std::memory_order_relaxed);
+    for(;;) {
+        record->m_epoch.store((epoch << 1) | 1, std::memory_order_relaxed);
+        /*announcement is visible before any pointer of structure is read*/
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        const std::uint64_t current = s_epoch.load(std::memory_order_relaxed);
+        if(current == epoch)
+            return;
+        epoch = current;
+    }
+}
+
+void epoch_retire(void* ptr, reclaim_routine reclaim) {
+    epoch_thread_data& data = this_thread_data();
+    data.m_retired.push_back(retired_ptr{ptr, reclaim, s_epoch.load(std::memory_order_acquire)});
+
+    if(data.m_retired.size() % collect_batch == 0) {
+        adopt_orphans(data.m_retired);
+        reclaim_expired(data.m_retired, try_advance());
+    }
+}
+
+} // namespace detail
+
+void epoch_collect() {
+    detail::epoch_thread_data& data = detail::this_thread_data();
+    detail::adopt_orphans(data.m_retired);
+    detail::reclaim_expired(data.m_retired, detail::try_advance());
+}
+
+} // namespace concurrency
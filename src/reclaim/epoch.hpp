@@ -0,0 +1,85 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "retire_list.hpp"
+
+namespace concurrency {
+
+namespace detail {
+
+/*announcement of one thread, reused by later threads once owner exits*/
+struct alignas(64) epoch_record {
+    epoch_record(): m_epoch(0), m_in_use(false), m_nesting(0), m_next(nullptr) {}
+
+    /*(epoch << 1) | 1 while owner is inside critical region, 0 outside*/
+    std::atomic<std::uint64_t> m_epoch;
+    std::atomic<bool> m_in_use;
+    unsigned m_nesting; /*owner only*/
+    epoch_record* m_next;
+}; // struct epoch_record
+
+epoch_record*
+this_thread_epoch_record();
+
+void
+enter_epoch(epoch_record* record);
+
+void
+epoch_retire(void* ptr, reclaim_routine reclaim);
+
+} // namespace detail
+
+/*
+ * Critical region of epoch-based reclamation: objects reachable when region is entered
+ * are not freed by epoch_retire() until it is exited. Regions nest.
+ * Cheaper than hazard pointers for traversals (two stores and fence per region,
+ * nothing per node), but thread stalled inside region delays all reclamation.
+ */
+class epoch_guard {
+
+public:
+    epoch_guard():
+        m_record(detail::this_thread_epoch_record())
+    {
+        if(m_record->m_nesting++ == 0)
+            detail::enter_epoch(m_record);
+    }
+
+    epoch_guard(const epoch_guard& other) = delete;
+    epoch_guard& operator=(const epoch_guard& other) = delete;
+
+    ~epoch_guard() {
+        if(--m_record->m_nesting == 0)
+            m_record->m_epoch.store(0, std::memory_order_release);
+    }
+
+private:
+    detail::epoch_record* m_record;
+
+}; // class epoch_guard
+
+/*
+ * Reclaims ptr with Deleter after every thread has left critical regions
+ * it could have seen ptr in. ptr must already be unreachable for new readers.
+ * Retired objects are batched per thread; every batch tries to advance global epoch
+ * and frees objects retired two epochs ago.
+ */
+template<typename T, typename Deleter = std::default_delete<T> >
+void epoch_retire(T* ptr) {
+    detail::epoch_retire(const_cast<void*>(static_cast<const void*>(ptr)), &detail::reclaim_with<T, Deleter>);
+}
+
+/*
+ * Tries to advance epoch and frees what became safe (retired by calling thread or exited threads).
+ * Must be called outside of critical region; objects retired right before need two successful calls.
+ */
+void
+epoch_collect();
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,133 @@
+#include "hazard_pointer.hpp"
+
+#include <algorithm>
+
+#include "thread.hpp"
+
+namespace concurrency {
+
+namespace detail {
+
+namespace {
+
+/*records are only pushed, scan walks list without synchronization with owners*/
+std::atomic<hazard_record*> s_records(nullptr);
+std::atomic<std::size_t> s_records_count(0);
+
+orphan_stack s_orphans;
+
+const std::size_t min_scan_threshold = 64;
+const std::size_t cached_records_max = 8;
+
+/*per-thread state, created on first use and dropped by thread exit routine*/
+struct hazard_thread_data {
+    hazard_thread_data(): m_cached_count(0) {}
+
+    retire_list m_retired;
+    hazard_record* m_cached[cached_records_max];
+    std::size_t m_cached_count;
+}; // struct hazard_thread_data
+
+thread_local hazard_thread_data* t_data = nullptr;
+
+void reclaim_unprotected(retire_list& retired) {
+    /*pairs with fence of try_protect: either scan sees slot or protector sees object removed*/
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::vector<const void*> hazards;
+    hazards.reserve(s_records_count.load(std::memory_order_relaxed));
+    for(hazard_record* record = s_records.load(std::memory_order_acquire); record; record = record->m_next)
+        if(const void* ptr = record->m_ptr.load(std::memory_order_acquire))
+            hazards.push_back(ptr);
+    std::sort(hazards.begin(), hazards.end());
+
+    /*deleters may retire more objects, so list is swapped out while it is processed*/
+    retire_list candidates;
+    candidates.swap(retired);
+    for(std::size_t i = 0; i < candidates.size(); ++i) {
+        if(std::binary_search(hazards.begin(), hazards.end(), candidates[i].m_ptr))
+            retired.push_back(candidates[i]);
+        else
+            candidates[i].m_reclaim(candidates[i].m_ptr);
+    }
+}
+
+void on_thread_exit(void* arg) {
+    hazard_thread_data* data = static_cast<hazard_thread_data*>(arg);
+
+    for(std::size_t i = 0; i < data->m_cached_count; ++i)
+        data->m_cached[i]->m_active.store(false, std::memory_order_release);
+    data->m_cached_count = 0;
+
+    reclaim_unprotected(data->m_retired);
+    s_orphans.push(std::move(data->m_retired));
+
+    t_data = nullptr;
+    delete data;
+}
+
+hazard_thread_data& this_thread_data() {
+    if(!t_data) {
+        t_data = new hazard_thread_data();
+        this_thread::at_exit(on_thread_exit, t_data);
+    }
+    return *t_data;
+}
+
+} // namespace
+
+hazard_record* acquire_hazard_record() {
+    hazard_thread_data& data = this_thread_data();
+    if(data.m_cached_count != 0)
+        return data.m_cached[--data.m_cached_count];
+
+    for(hazard_record* record = s_records.load(std::memory_order_acquire); record; record = record->m_next) {
+        bool active = false;
+        if(!record->m_active.load(std::memory_order_relaxed) &&
+            record->m_active.compare_exchange_strong(active, true, std::memory_order_acquire))
+            return record;
+    }
+
+    hazard_record* record = new hazard_record();
+    record->m_active.store(true, std::memory_order_relaxed);
+    record->m_next = s_records.load(std::memory_order_relaxed);
+    while(!s_records.compare_exchange_weak(
+        record->m_next, record,
+        std::memory_order_release, std::memory_order_relaxed
+    ))
+        ;
+    s_records_count.fetch_add(1, std::memory_order_relaxed);
+    return record;
+}
+
+void release_hazard_record(hazard_record* record) {
+    record->m_ptr.store(nullptr, std::memory_order_release);
+
+    hazard_thread_data& data = this_thread_data();
+    if(data.m_cached_count != cached_records_max)
+        data.m_cached[data.m_cached_count++] = record;
+    else
+        record->m_active.store(false, std::memory_order_release);
+}
+
+void hazard_retire(void* ptr, reclaim_routine reclaim) {
+    hazard_thread_data& data = this_thread_data();
+    data.m_retired.push_back(retired_ptr{ptr, reclaim, 0});
+
+    /*scan costs O(slots), so it is done once per that many retirements*/
+    const std::size_t threshold = std::max(min_scan_threshold, 2 * s_records_count.load(std::memory_order_relaxed));
+    if(data.m_retired.size() >= threshold) {
+        s_orphans.take_all(data.m_retired);
+        reclaim_unprotected(data.m_retired);
+    }
+}
+
+} // namespace detail
+
+void hazard_scan() {
+    detail::hazard_thread_data& data = detail::this_thread_data();
+    detail::s_orphans.take_all(data.m_retired);
+    detail::reclaim_unprotected(data.m_retired);
+}
+
+} // namespace concurrency
@@ -0,0 +1,109 @@
+#ifndef HAZARD_POINTER_H
+#define HAZARD_POINTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "retire_list.hpp"
+
+namespace concurrency {
+
+namespace detail {
+
+/*published pointer of one hazard_pointer, records are reused but never freed*/
+struct alignas(64) hazard_record {
+    hazard_record(): m_ptr(nullptr), m_active(false), m_next(nullptr) {}
+
+    std::atomic<const void*> m_ptr;
+    std::atomic<bool> m_active;
+    hazard_record* m_next;
+}; // struct hazard_record
+
+hazard_record*
+acquire_hazard_record();
+
+void
+release_hazard_record(hazard_record* record);
+
+/*adds object to retire list of calling thread, scans list when it grows past threshold*/
+void
+hazard_retire(void* ptr, reclaim_routine reclaim);
+
+} // namespace detail
+
+/*
+ * Owner of one hazard slot: object it protects is not freed by hazard_retire()
+ * until protection is reset. Slots are kept in global list and never freed;
+ * each thread caches few released slots, so hazard_pointer can be created per operation.
+ */
+class hazard_pointer {
+
+public:
+    hazard_pointer():
+        m_record(detail::acquire_hazard_record())
+    {}
+
+    hazard_pointer(const hazard_pointer& other) = delete;
+    hazard_pointer& operator=(const hazard_pointer& other) = delete;
+
+    ~hazard_pointer()
+    { detail::release_hazard_record(m_record); }
+
+    /*
+     * Loads src and protects loaded pointer, retrying until src still holds it after
+     * protection is published: from then on object can not be reclaimed.
+     */
+    template<typename T>
+    T* protect(const std::atomic<T*>& src) {
+        T* ptr = src.load(std::memory_order_relaxed);
+        while(!try_protect(ptr, src))
+            ;
+        return ptr;
+    }
+
+    /*false - src changed, ptr is updated to its new value and nothing is protected*/
+    template<typename T>
+    bool try_protect(T*& ptr, const std::atomic<T*>& src) {
+        T* published = ptr;
+        reset_protection(published);
+        /*scan reads slots after fence of its own, one of two sees store of other*/
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        ptr = src.load(std::memory_order_acquire);
+        if(ptr == published)
+            return true;
+        reset_protection();
+        return false;
+    }
+
+    /*protects pointer known to be alive, e.g. already protected by other slot*/
+    template<typename T>
+    void reset_protection(const T* ptr) noexcept
+    { m_record->m_ptr.store(ptr, std::memory_order_release); }
+
+    void reset_protection() noexcept
+    { m_record->m_ptr.store(nullptr, std::memory_order_release); }
+
+private:
+    detail::hazard_record* m_record;
+
+}; // class hazard_pointer
+
+/*
+ * Reclaims ptr with Deleter once no hazard_pointer protects it.
+ * ptr must already be unreachable for threads which did not protect it.
+ * Retired objects are batched per thread, list is scanned when it reaches
+ * twice number of hazard slots; at thread exit leftovers go to shared list.
+ */
+template<typename T, typename Deleter = std::default_delete<T> >
+void hazard_retire(T* ptr) {
+    detail::hazard_retire(const_cast<void*>(static_cast<const void*>(ptr)), &detail::reclaim_with<T, Deleter>);
+}
+
+/*reclaims every retired object (of calling thread and of exited threads) which is not protected*/
+void
+hazard_scan();
+
+} // namespace concurrency
+
+#endif
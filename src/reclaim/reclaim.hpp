@@ -0,0 +1,17 @@
+#ifndef RECLAIM_H
+#define RECLAIM_H
+
+#include "hazard_pointer.hpp"
+#include "epoch.hpp"
+
+namespace concurrency {
+
+/*safe memory reclamation scheme of lock-free structure*/
+enum class reclamation {
+    hazard_pointers,    /*bounded garbage, protection fence per node*/
+    epoch               /*fence per operation, garbage grows while any reader stalls*/
+};
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef RETIRE_LIST_H
+#define RETIRE_LIST_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace concurrency::detail {
+
+typedef void (*reclaim_routine)(void*);
+
+template<typename T, typename Deleter>
+void reclaim_with(void* ptr)
+{ Deleter()(static_cast<T*>(ptr)); }
+
+/*object waiting for reclamation*/
+struct retired_ptr {
+    void* m_ptr;
+    reclaim_routine m_reclaim;
+    std::uint64_t m_epoch; /*epoch of retirement, used by epoch-based reclamation only*/
+}; // struct retired_ptr
+
+typedef std::vector<retired_ptr> retire_list;
+
+/*
+ * Retired objects left by exited threads, adopted by next thread which collects.
+ * Batches are only pushed and taken all at once, so plain Treiber stack is enough.
+ */
+class orphan_stack {
+
+public:
+    orphan_stack(): m_head(nullptr) {}
+
+    void push(retire_list&& retired) {
+        if(retired.empty())
+            return;
+
+        batch* node = new batch{std::move(retired), m_head.load(std::memory_order_relaxed)};
+        while(!m_head.compare_exchange_weak(
+            node->m_next, node,
+            std::memory_order_release, std::memory_order_relaxed
+        ))
+            ;
+    }
+
+    /*appends all orphans to retired*/
+    void take_all(retire_list& retired) {
+        if(!m_head.load(std::memory_order_relaxed))
+            return;
+
+        batch* node = m_head.exchange(nullptr, std::memory_order_acquire);
+        while(node) {
+            retired.insert(retired.end(), node->m_retired.begin(), node->m_retired.end());
+            batch* next = node->m_next;
+            delete node;
+            node = next;
+        }
+    }
+
+private:
+    struct batch {
+        retire_list m_retired;
+        batch* m_next;
+    }; // struct batch
+
+    std::atomic<batch*> m_head;
+
+}; // class orphan_stack
+
+} // namespace concurrency::detail
+
+#endif
@@ -0,0 +1,48 @@
+#include "semaphore.hpp"
+
+#include <cerrno>
+
+namespace concurrency::detail {
+
+static const int max_spin_count = 100;
+
+semaphore_base::semaphore_base(std::ptrdiff_t desired, std::ptrdiff_t max):
+    m_count(0), m_waiters(0)
+{
+    if(desired < 0 || desired > max)
+        throw std::invalid_argument("semaphore: initial count is out of [0, max] range");
+    m_count.store(static_cast<int>(desired), std::memory_order_relaxed);
+}
+
+void semaphore_base::acquire_slow() {
+    /*spin for a while, permit is likely to be released soon*/
+    for(int spins = 0; spins < max_spin_count; ++spins) {
+        if(m_count.load(std::memory_order_relaxed) > 0 && try_acquire())
+            return;
+        util::cpu_relax();
+    }
+
+    m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    /*kernel puts thread to sleep only if there are still no permits*/
+    while(!try_acquire())
+        util::futex_wait(&m_count, 0);
+    m_waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool semaphore_base::try_acquire_until_monotonic(const timespec& abs_time) {
+    bool acquired = false;
+
+    m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    while(!(acquired = try_acquire())) {
+        if(util::futex_wait_until(&m_count, 0, abs_time) == -1 && errno == ETIMEDOUT) {
+            /*permit may have been released right at deadline*/
+            acquired = try_acquire();
+            break;
+        }
+    }
+    m_waiters.fetch_sub(1, std::memory_order_relaxed);
+
+    return acquired;
+}
+
+} // namespace concurrency::detail
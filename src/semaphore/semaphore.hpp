@@ -0,0 +1,117 @@
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <stdexcept>
+
+#include "futex.h"
+#include "timespec.h"
+
+namespace concurrency {
+
+namespace detail {
+
+/*
+ * Permit counter kept in single 32-bit futex word.
+ * acquire/release are single atomic operations while permits are available,
+ * kernel is entered only when thread has to sleep or there are sleepers to wake up.
+ */
+class semaphore_base {
+
+public:
+    semaphore_base(const semaphore_base& other) = delete;
+    semaphore_base& operator=(const semaphore_base& other) = delete;
+
+    void acquire() {
+        if(!try_acquire())
+            acquire_slow();
+    }
+
+    bool try_acquire() {
+        int count = m_count.load(std::memory_order_relaxed);
+        while(count > 0)
+            if(m_count.compare_exchange_weak(
+                count, count - 1,
+                std::memory_order_acquire, std::memory_order_relaxed
+            ))
+                return true;
+        return false;
+    }
+
+protected:
+    semaphore_base(std::ptrdiff_t desired, std::ptrdiff_t max);
+
+    /*throws std::invalid_argument, if update is negative or counter would exceed max*/
+    void release(std::ptrdiff_t update, std::ptrdiff_t max) {
+        if(update < 0)
+            throw std::invalid_argument("semaphore: release: negative update");
+
+        int count = m_count.load(std::memory_order_relaxed);
+        do {
+            if(update > max - count)
+                throw std::invalid_argument("semaphore: release: counter would exceed max");
+        } while(!m_count.compare_exchange_weak(
+            count, count + static_cast<int>(update),
+            std::memory_order_seq_cst, std::memory_order_relaxed
+        ));
+        /*count increment and waiters load pair with waiters increment and futex check in acquire_slow*/
+        if(update > 0 && m_waiters.load(std::memory_order_seq_cst) != 0)
+            util::futex_wake(&m_count, static_cast<int>(update));
+    }
+
+    /*abs_time is measured against CLOCK_MONOTONIC*/
+    bool try_acquire_until_monotonic(const timespec& abs_time);
+
+private:
+    void acquire_slow();
+
+    std::atomic<int> m_count;
+    /*threads sleeping (or about to) on m_count*/
+    std::atomic<int> m_waiters;
+
+}; // class semaphore_base
+
+} // namespace detail
+
+template<std::ptrdiff_t LeastMax = INT_MAX>
+class counting_semaphore: public detail::semaphore_base {
+    static_assert(LeastMax >= 0 && LeastMax <= INT_MAX,
+        "counter must fit into 32-bit futex word");
+
+public:
+    explicit
+    counting_semaphore(std::ptrdiff_t desired):
+        detail::semaphore_base(desired, LeastMax)
+    {}
+
+    counting_semaphore(const counting_semaphore& other) = delete;
+    counting_semaphore& operator=(const counting_semaphore& other) = delete;
+
+    static constexpr std::ptrdiff_t
+    max()
+    { return LeastMax; }
+
+    /*throws std::invalid_argument, if update is negative or counter would exceed max() afterwards*/
+    void release(std::ptrdiff_t update = 1)
+    { detail::semaphore_base::release(update, LeastMax); }
+
+    template<typename Rep, typename Period>
+    bool try_acquire_for(const std::chrono::duration<Rep, Period>& rel_time)
+    { return try_acquire_until(util::deadline_after(rel_time)); }
+
+    template<typename Clock, typename Duration>
+    bool try_acquire_until(const std::chrono::time_point<Clock, Duration>& abs_time) {
+        if(try_acquire())
+            return true;
+        return try_acquire_until_monotonic(util::to_monotonic_timespec(abs_time));
+    }
+}; // class counting_semaphore
+
+typedef counting_semaphore<1> binary_semaphore;
+
+} // namespace concurrency
+
+#endif
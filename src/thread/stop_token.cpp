@@ -0,0 +1,101 @@
+#include "stop_token.hpp"
+
+#include <sched.h>
+
+#include "futex.h"
+
+namespace concurrency::detail {
+
+void stop_state::lock() {
+    while(m_locked.exchange(true, std::memory_order_acquire))
+        while(m_locked.load(std::memory_order_relaxed))
+            util::cpu_relax();
+}
+
+bool stop_state::request_stop() {
+    lock();
+    if(m_requested.load(std::memory_order_relaxed)) {
+        unlock();
+        return false;
+    }
+    m_requested.store(true, std::memory_order_release);
+    m_requester = pthread_self();
+
+    /*callbacks are invoked without holding lock, so they may register or deregister others*/
+    while(m_head) {
+        stop_callback_node* node = m_head;
+        m_head = node->m_next;
+        if(m_head)
+            m_head->m_prev = nullptr;
+        node->m_next = nullptr;
+        m_running = node;
+
+        bool destroyed = false;
+        node->m_destroyed = &destroyed;
+        unlock();
+
+        node->m_invoke(node);
+
+        if(!destroyed) {
+            node->m_destroyed = nullptr;
+            node->m_done.store(true, std::memory_order_release);
+        }
+
+        lock();
+        m_running = nullptr;
+    }
+
+    unlock();
+    return true;
+}
+
+bool stop_state::add_callback(stop_callback_node* node) {
+    lock();
+    if(m_requested.load(std::memory_order_relaxed)) {
+        unlock();
+        node->m_invoke(node);
+        return false;
+    }
+
+    node->m_next = m_head;
+    if(m_head)
+        m_head->m_prev = node;
+    m_head = node;
+
+    unlock();
+    return true;
+}
+
+void stop_state::remove_callback(stop_callback_node* node) {
+    lock();
+    if(node == m_head || node->m_prev) { /*not invoked yet, just unlink*/
+        if(node->m_prev)
+            node->m_prev->m_next = node->m_next;
+        else
+            m_head = node->m_next;
+        if(node->m_next)
+            node->m_next->m_prev = node->m_prev;
+        unlock();
+        return;
+    }
+
+    const bool running = (m_running == node);
+    const bool requested_by_self = pthread_equal(m_requester, pthread_self());
+    unlock();
+
+    if(!running)
+        return;
+
+    if(requested_by_self) {
+        /*callback destroys itself from within its invocation*/
+        if(node->m_destroyed)
+            *node->m_destroyed = true;
+        return;
+    }
+
+    /*invocation on other thread must finish before callback object is gone*/
+    while(!node->m_done.load(std::memory_order_acquire))
+        sched_yield();
+}
+
+} // namespace concurrency::detail
@@ -0,0 +1,276 @@
+#ifndef STOP_TOKEN_H
+#define STOP_TOKEN_H
+
+#include <atomic>
+#include <utility>
+
+#include <pthread.h>
+
+namespace concurrency {
+
+class stop_token;
+class stop_source;
+
+struct nostopstate_t {};
+constexpr nostopstate_t nostopstate { };
+
+namespace detail {
+
+/*node of intrusive list of registered callbacks*/
+struct stop_callback_node {
+    typedef void (*invoke_type)(stop_callback_node*);
+
+    explicit stop_callback_node(invoke_type invoke):
+        m_invoke(invoke), m_prev(nullptr), m_next(nullptr),
+        m_destroyed(nullptr), m_done(false)
+    {}
+
+    invoke_type m_invoke;
+    stop_callback_node* m_prev;
+    stop_callback_node* m_next;
+    /*set by callback destroying itself from within its own invocation*/
+    bool* m_destroyed;
+    /*invocation by request_stop finished*/
+    std::atomic<bool> m_done;
+};
+
+/*
+ * State shared by stop_source, stop_token and stop_callback.
+ * Callback list is guarded by spin lock, it is held only for list manipulation.
+ */
+class stop_state {
+
+public:
+    stop_state():
+        m_refs(1), m_sources(1), m_requested(false), m_locked(false),
+        m_head(nullptr), m_running(nullptr), m_requester()
+    {}
+
+    void add_ref()
+    { m_refs.fetch_add(1, std::memory_order_relaxed); }
+
+    void release_ref() {
+        if(m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    void add_source()
+    { m_sources.fetch_add(1, std::memory_order_relaxed); }
+
+    void release_source()
+    { m_sources.fetch_sub(1, std::memory_order_acq_rel); }
+
+    bool stop_requested() const
+    { return m_requested.load(std::memory_order_acquire); }
+
+    bool stop_possible() const
+    { return stop_requested() || m_sources.load(std::memory_order_acquire) > 0; }
+
+    /*returns false if stop was already requested*/
+    bool request_stop();
+
+    /*returns false if stop was already requested (callback is invoked in place)*/
+    bool add_callback(stop_callback_node* node);
+
+    /*blocks while callback is being invoked by other thread*/
+    void remove_callback(stop_callback_node* node);
+
+private:
+    void lock();
+    void unlock()
+    { m_locked.store(false, std::memory_order_release); }
+
+    std::atomic<unsigned int> m_refs;
+    std::atomic<unsigned int> m_sources;
+    std::atomic<bool> m_requested;
+    std::atomic<bool> m_locked;
+
+    stop_callback_node* m_head;
+    stop_callback_node* m_running;
+    pthread_t m_requester;
+
+}; // class stop_state
+
+} // namespace detail
+
+class stop_token {
+
+public:
+    stop_token(): m_state(nullptr) {}
+
+    stop_token(const stop_token& other): m_state(other.m_state) {
+        if(m_state)
+            m_state->add_ref();
+    }
+
+    stop_token(stop_token&& other): m_state(other.m_state)
+    { other.m_state = nullptr; }
+
+    ~stop_token() {
+        if(m_state)
+            m_state->release_ref();
+    }
+
+    stop_token& operator=(const stop_token& other) {
+        stop_token(other).swap(*this);
+        return *this;
+    }
+
+    stop_token& operator=(stop_token&& other) {
+        stop_token(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(stop_token& other) {
+        using std::swap;
+        swap(m_state, other.m_state);
+    }
+
+    bool
+    stop_requested() const
+    { return m_state && m_state->stop_requested(); }
+
+    /*stop was requested or can still be requested by some stop_source*/
+    bool
+    stop_possible() const
+    { return m_state && m_state->stop_possible(); }
+
+    friend void swap(stop_token& lhs, stop_token& rhs)
+    { lhs.swap(rhs); }
+
+    friend bool operator==(const stop_token& lhs, const stop_token& rhs)
+    { return lhs.m_state == rhs.m_state; }
+
+    friend bool operator!=(const stop_token& lhs, const stop_token& rhs)
+    { return lhs.m_state != rhs.m_state; }
+
+private:
+    friend class stop_source;
+    template<typename Callback> friend class stop_callback;
+
+    explicit stop_token(detail::stop_state* state): m_state(state) {
+        if(m_state)
+            m_state->add_ref();
+    }
+
+    detail::stop_state* m_state;
+
+}; // class stop_token
+
+class stop_source {
+
+public:
+    stop_source(): m_state(new detail::stop_state()) {}
+
+    explicit
+    stop_source(nostopstate_t): m_state(nullptr) {}
+
+    stop_source(const stop_source& other): m_state(other.m_state) {
+        if(m_state) {
+            m_state->add_ref();
+            m_state->add_source();
+        }
+    }
+
+    stop_source(stop_source&& other): m_state(other.m_state)
+    { other.m_state = nullptr; }
+
+    ~stop_source() {
+        if(m_state) {
+            m_state->release_source();
+            m_state->release_ref();
+        }
+    }
+
+    stop_source& operator=(const stop_source& other) {
+        stop_source(other).swap(*this);
+        return *this;
+    }
+
+    stop_source& operator=(stop_source&& other) {
+        stop_source(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(stop_source& other) {
+        using std::swap;
+        swap(m_state, other.m_state);
+    }
+
+    /*invokes registered callbacks on calling thread, returns false if stop was already requested*/
+    bool
+    request_stop()
+    { return m_state && m_state->request_stop(); }
+
+    bool
+    stop_requested() const
+    { return m_state && m_state->stop_requested(); }
+
+    bool
+    stop_possible() const
+    { return m_state != nullptr; }
+
+    stop_token
+    get_token() const
+    { return stop_token(m_state); }
+
+    friend void swap(stop_source& lhs, stop_source& rhs)
+    { lhs.swap(rhs); }
+
+    friend bool operator==(const stop_source& lhs, const stop_source& rhs)
+    { return lhs.m_state == rhs.m_state; }
+
+    friend bool operator!=(const stop_source& lhs, const stop_source& rhs)
+    { return lhs.m_state != rhs.m_state; }
+
+private:
+    detail::stop_state* m_state;
+
+}; // class stop_source
+
+/*
+ * Invokes callback once stop is requested on token's state.
+ * If stop was already requested, callback is invoked in constructor.
+ * Destructor waits for callback if it is running on other thread.
+ */
+template<typename Callback>
+class stop_callback: private detail::stop_callback_node {
+
+public:
+    typedef Callback callback_type;
+
+    template<typename C>
+    explicit
+    stop_callback(const stop_token& token, C&& callb):
+        detail::stop_callback_node(invoke_callback),
+        m_callback(std::forward<C>(callb)),
+        m_state(nullptr)
+    {
+        if(token.m_state && token.m_state->add_callback(this)) {
+            m_state = token.m_state;
+            m_state->add_ref();
+        }
+    }
+
+    stop_callback(const stop_callback& other) = delete;
+    stop_callback& operator=(const stop_callback& other) = delete;
+
+    ~stop_callback() {
+        if(m_state) {
+            m_state->remove_callback(this);
+            m_state->release_ref();
+        }
+    }
+
+private:
+    static void invoke_callback(detail::stop_callback_node* node)
+    { static_cast<stop_callback*>(node)->m_callback(); }
+
+    callback_type m_callback;
+    detail::stop_state* m_state;
+
+}; // class stop_callback
+
+} // namespace concurrency
+
+#endif
@@ -2,28 +2,67 @@
 #include "thread.hpp"
 #include <pthread.h>
 
+#include "trace.hpp"
+
 #include <assert.h>
 #include <stdexcept>
+#include <vector>
 
 namespace concurrency {
 
-struct start_routine_args {
-    func::function<void()> m_func;
+namespace {
+
+struct exit_routine {
+    void (*m_routine)(void*);
+    void* m_arg;
+}; // struct exit_routine
+
+typedef std::vector<exit_routine> exit_routines;
+
+} // namespace
+
+extern "C" {
+
+/*destructor of exit key; routines may register new ones, those run in next round*/
+static void _run_exit_routines(void* list) {
+    exit_routines* routines = static_cast<exit_routines*>(list);
+    for(std::size_t i = routines->size(); i-- > 0; )
+        (*routines)[i].m_routine((*routines)[i].m_arg);
+    delete routines;
+}
+
+} // extern "C"
+
+static pthread_key_t create_exit_key() {
+    pthread_key_t key;
+    if(pthread_key_create(&key, _run_exit_routines) != 0)
+        throw std::runtime_error("this_thread::at_exit: could not create thread-specific key");
+    return key;
+}
+
+static pthread_key_t exit_key() {
+    static const pthread_key_t key = create_exit_key();
+    return key;
+}
 
-    start_routine_args(
-        const func::function<void()>& func
-    ):
-        m_func(func)
-    {}
-};
+static void run_exit_routines_of_current_thread() {
+    const pthread_key_t key = exit_key();
+    while(void* list = pthread_getspecific(key)) {
+        pthread_setspecific(key, nullptr);
+        _run_exit_routines(list);
+    }
+}
 
 extern "C" {
 
 static void _cleanup_thread_routine(void* arg) {
-    // release allocated memory for arguments
-    /* How to release memory allocated by user within thread (?) */
-    start_routine_args* routine_args = reinterpret_cast<start_routine_args*>(arg);
-    delete routine_args;
+    detail::thread_start_base* start = reinterpret_cast<detail::thread_start_base*>(arg);
+    /*trace buffer of thread is recycled by one of exit routines*/
+    CONCURRENCY_TRACE(thread_exit, start);
+    run_exit_routines_of_current_thread();
+
+    // release callable and arguments owned by thread
+    start->m_destroy(start);
 }
 
 static void* _start_routine(void* arg) {
@@ -31,9 +70,14 @@ static void* _start_routine(void* arg) {
     
     pthread_cleanup_push(_cleanup_thread_routine, arg);
 
-    start_routine_args* routine_args = reinterpret_cast<start_routine_args*>(arg);
-    
-    (routine_args->m_func)();
+    detail::thread_start_base* start = reinterpret_cast<detail::thread_start_base*>(arg);
+
+    /*name is only a debugging aid, failure to set it is not an error*/
+    if(start->m_name[0] != '\0')
+        pthread_setname_np(pthread_self(), start->m_name);
+    CONCURRENCY_TRACE(thread_start, start);
+
+    start->m_run(start);
 
     pthread_cleanup_pop(1);
 
@@ -59,6 +103,9 @@ static std::string make_pthread_err_msg(std::string prefix, int err_num) {
         case EAGAIN:
             err_msg += "could not allocate resources to create thread";
             break;
+        case EPERM:
+            err_msg += "no permission to set scheduling policy and parameters";
+            break;
         default:
             err_msg += "error code: " + std::to_string(err_num);
             break;
@@ -67,54 +114,116 @@ static std::string make_pthread_err_msg(std::string prefix, int err_num) {
     return err_msg;
 }
 
-void thread::create_thread(void_func& func_obj) {
-    int err_num;
-    pthread_attr_t attr;
-    err_num = pthread_attr_init(&attr);
+static void apply_attributes(pthread_attr_t* native_attr, const thread::attributes& attr) {
+    int err_num = 0;
 
-    if(err_num != 0) {
-        std::string err_msg = make_pthread_err_msg("create_thread: pthread_attr_init error: ", err_num);
-        throw std::runtime_error(err_msg);
+    if(attr.stack_size() != 0) {
+        err_num = pthread_attr_setstacksize(native_attr, attr.stack_size());
+        if(err_num != 0) {
+            std::string err_msg = make_pthread_err_msg("create_thread: pthread_attr_setstacksize error: ", err_num);
+            throw std::runtime_error(err_msg);
+        }
+    }
+
+    if(attr.has_guard_size()) {
+        err_num = pthread_attr_setguardsize(native_attr, attr.guard_size());
+        if(err_num != 0) {
+            std::string err_msg = make_pthread_err_msg("create_thread: pthread_attr_setguardsize error: ", err_num);
+            throw std::runtime_error(err_msg);
+        }
+    }
+
+    if(attr.has_affinity()) {
+        err_num = pthread_attr_setaffinity_np(native_attr, sizeof(cpu_set_t), &attr.cpu_set());
+        if(err_num != 0) {
+            std::string err_msg = make_pthread_err_msg("create_thread: pthread_attr_setaffinity_np error: ", err_num);
+            throw std::runtime_error(err_msg);
+        }
+    }
+
+    if(attr.has_sched_policy()) {
+        /*without explicit sched, policy of creating thread is inherited and attributes are ignored*/
+        err_num = pthread_attr_setinheritsched(native_attr, PTHREAD_EXPLICIT_SCHED);
+        if(err_num != 0) {
+            std::string err_msg = make_pthread_err_msg("create_thread: pthread_attr_setinheritsched error: ", err_num);
+            throw std::runtime_error(err_msg);
+        }
+
+        err_num = pthread_attr_setschedpolicy(native_attr, attr.sched_policy());
+        if(err_num != 0) {
+            std::string err_msg = make_pthread_err_msg("create_thread: pthread_attr_setschedpolicy error: ", err_num);
+            throw std::runtime_error(err_msg);
+        }
+
+        sched_param param = sched_param();
+        param.sched_priority = attr.sched_priority();
+        err_num = pthread_attr_setschedparam(native_attr, &param);
+        if(err_num != 0) {
+            std::string err_msg = make_pthread_err_msg("create_thread: pthread_attr_setschedparam error: ", err_num);
+            throw std::runtime_error(err_msg);
+        }
+    }
+}
+
+void thread::create_thread(detail::thread_start_base* start, const attributes& attr) {
+    int err_num;
+    pthread_attr_t native_attr;
+    /*default attributes: let pthread_create use its defaults instead of copying attribute object*/
+    pthread_attr_t* native_attr_ptr = NULL;
+
+    if(attr.has_native_attributes()) {
+        err_num = pthread_attr_init(&native_attr);
+
+        if(err_num != 0) {
+            start->m_destroy(start);
+            std::string err_msg = make_pthread_err_msg("create_thread: pthread_attr_init error: ", err_num);
+            throw std::runtime_error(err_msg);
+        }
+
+        try {
+            apply_attributes(&native_attr, attr);
+        } catch(...) {
+            start->m_destroy(start);
+            pthread_attr_destroy(&native_attr);
+            throw;
+        }
+        native_attr_ptr = &native_attr;
     }
 
-    // create heap allocated arguments
-    start_routine_args* args = new start_routine_args(func_obj);
+    /*length is checked by attributes::name*/
+    attr.name().copy(start->m_name, sizeof(start->m_name) - 1);
+    start->m_name[attr.name().size()] = '\0';
 
     m_is_joinable = 1;
-    err_num = pthread_create(&m_thread_id, &attr,
+    /*recorded before child can record its start*/
+    CONCURRENCY_TRACE(thread_create, start);
+    err_num = pthread_create(&m_thread_id, native_attr_ptr,
         _start_routine,
-        reinterpret_cast<void *>(args)
+        reinterpret_cast<void *>(start)
     );
 
+    /*thread owns start block from now on (if it was created), attribute object is no longer needed*/
+    if(native_attr_ptr)
+        pthread_attr_destroy(native_attr_ptr);
+
     if(err_num != 0) {
         // revet thread invocation
         m_is_joinable = 0;
 
         // release allocated resources
-        delete args;
+        start->m_destroy(start);
 
         std::string err_msg = make_pthread_err_msg("create_thread: pthread_create: ", err_num);
         throw std::runtime_error(err_msg);
     }
-
-    err_num = pthread_attr_destroy(&attr);
-    if(err_num != 0) {
-        // revert thread invocation (cancel it)
-        pthread_cancel(m_thread_id);
-        m_is_joinable = 0;
-
-        // release allocated resources
-        delete args;
-
-        std::string err_msg = make_pthread_err_msg("create_thread: pthread_attr_destroy error: ", err_num);
-        throw std::runtime_error(err_msg);
-    }
 }
 
 void
 thread::join() {
     int err_num = 0;
+    CONCURRENCY_TRACE(join_wait, this);
     err_num = pthread_join(m_thread_id, NULL);
+    CONCURRENCY_TRACE(join_done, this);
 
     if (err_num != 0) {
         std::string err_msg = make_pthread_err_msg("thread::join: pthread_join: ", err_num);
@@ -149,6 +258,17 @@ thread::native_handle_type get_native_id() {
     return pthread_self();
 }
 
+void at_exit(void (*routine)(void*), void* arg) {
+    const pthread_key_t key = exit_key();
+
+    exit_routines* routines = static_cast<exit_routines*>(pthread_getspecific(key));
+    if(!routines) {
+        routines = new exit_routines();
+        pthread_setspecific(key, routines);
+    }
+    routines->push_back(exit_routine{routine, arg});
+}
+
 }; // namespace this_thread
 
 } // namespace concurrency
\ No newline at end of file
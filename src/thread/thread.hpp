@@ -2,36 +2,189 @@
 #define THREAD_H
 
 #include <iostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include <stdexcept>
 
-#include "function.hpp"
+#include "stop_token.hpp"
 
 #include <pthread.h>
+#include <sched.h>
 
 namespace concurrency {
 
+namespace detail {
+
+/*
+ * Heap block handed over to new thread: callable, arguments and thread name in single allocation.
+ * Dispatch goes through plain function pointers set by concrete thread_start.
+ */
+struct thread_start_base {
+    typedef void (*routine_type)(thread_start_base*);
+
+    thread_start_base(routine_type run, routine_type destroy):
+        m_run(run), m_destroy(destroy)
+    { m_name[0] = '\0'; }
+
+    routine_type m_run;
+    routine_type m_destroy;
+    /*set by thread itself, empty - keep inherited one*/
+    char m_name[16];
+};
+
+template<typename Callable, typename ...Args>
+struct thread_start: thread_start_base {
+
+    template<typename C, typename ...A>
+    explicit thread_start(C&& callb, A&& ...args):
+        thread_start_base(run, destroy),
+        m_callable(std::forward<C>(callb)),
+        m_args(std::forward<A>(args)...)
+    {}
+
+    /*callable and arguments are owned by thread, so they are passed as rvalues*/
+    static void run(thread_start_base* base) {
+        thread_start* self = static_cast<thread_start*>(base);
+        self->invoke(std::index_sequence_for<Args...>());
+    }
+
+    static void destroy(thread_start_base* base)
+    { delete static_cast<thread_start*>(base); }
+
+    template<std::size_t ...Idx>
+    void invoke(std::index_sequence<Idx...>)
+    { std::move(m_callable)(std::move(std::get<Idx>(m_args))...); }
+
+    Callable m_callable;
+    std::tuple<Args...> m_args;
+};
+
+} // namespace detail
+
 class thread {
 
 public:
     typedef pthread_t native_handle_type;
 
+    /*
+     * Creation attributes of thread, built by chaining setters:
+     * thread::attributes().stack_size(64 * 1024).cpu(3).name("worker")
+     * Unset attributes keep pthread defaults.
+     */
+    class attributes {
+
+    public:
+        attributes():
+            m_stack_size(0), m_guard_size(0), m_has_guard_size(false),
+            m_has_affinity(false), m_name(),
+            m_sched_policy(SCHED_OTHER), m_sched_priority(0), m_has_sched(false)
+        { CPU_ZERO(&m_cpu_set); }
+
+        /*bytes, at least PTHREAD_STACK_MIN*/
+        attributes& stack_size(std::size_t bytes)
+        { m_stack_size = bytes; return *this; }
+
+        /*bytes of guard area below stack, 0 disables it*/
+        attributes& guard_size(std::size_t bytes)
+        { m_guard_size = bytes; m_has_guard_size = true; return *this; }
+
+        /*add cpu to affinity mask, thread runs only on cpus added*/
+        attributes& cpu(int cpu_idx) {
+            if(cpu_idx < 0 || cpu_idx >= CPU_SETSIZE)
+                throw std::invalid_argument("thread::attributes::cpu: cpu index out of range");
+            CPU_SET(cpu_idx, &m_cpu_set);
+            m_has_affinity = true;
+            return *this;
+        }
+
+        attributes& cpu_set(const cpu_set_t& cpus)
+        { m_cpu_set = cpus; m_has_affinity = true; return *this; }
+
+        /*at most 15 characters (limit of pthread_setname_np)*/
+        attributes& name(const std::string& thread_name) {
+            if(thread_name.size() > 15)
+                throw std::invalid_argument("thread::attributes::name: name is longer than 15 characters");
+            m_name = thread_name;
+            return *this;
+        }
+
+        /*SCHED_FIFO or SCHED_RR with priority, or SCHED_OTHER with 0 (requires privileges for real-time policies)*/
+        attributes& sched_policy(int policy, int priority) {
+            m_sched_policy = policy;
+            m_sched_priority = priority;
+            m_has_sched = true;
+            return *this;
+        }
+
+        std::size_t stack_size() const { return m_stack_size; }
+        std::size_t guard_size() const { return m_guard_size; }
+        bool has_guard_size() const { return m_has_guard_size; }
+        bool has_affinity() const { return m_has_affinity; }
+        const cpu_set_t& cpu_set() const { return m_cpu_set; }
+        const std::string& name() const { return m_name; }
+        int sched_policy() const { return m_sched_policy; }
+        int sched_priority() const { return m_sched_priority; }
+        bool has_sched_policy() const { return m_has_sched; }
+
+        /*whether pthread_attr_t has to be built (name is set by thread itself)*/
+        bool has_native_attributes() const
+        { return m_stack_size != 0 || m_has_guard_size || m_has_affinity || m_has_sched; }
+
+    private:
+        std::size_t m_stack_size; /*0 - default*/
+        std::size_t m_guard_size;
+        bool m_has_guard_size;
+
+        cpu_set_t m_cpu_set;
+        bool m_has_affinity;
+
+        std::string m_name; /*empty - inherit*/
+
+        int m_sched_policy;
+        int m_sched_priority;
+        bool m_has_sched;
+
+    }; // class attributes
+
     thread(): m_is_joinable(0), m_thread_id() {}
     
-    template<typename Callable, typename ...Args>
+    /*callable and arguments are decay-copied (moved from rvalues) once, into block owned by new thread*/
+    template<
+        typename Callable, typename ...Args,
+        typename = typename std::enable_if<
+            !std::is_same<typename std::decay<Callable>::type, thread>::value &&
+            !std::is_same<typename std::decay<Callable>::type, attributes>::value
+        >::type
+    >
     explicit
-    thread(Callable callb, Args ...args) 
-    :   
+    thread(Callable&& callb, Args&& ...args)
+    :
         m_is_joinable(0)
     {
-        // arguments must be invocable after conversion to rvalues (no lvalue references)
-        auto lambda_func = [=] () -> void { callb(args...); };
+        create_thread(
+            make_start(std::forward<Callable>(callb), std::forward<Args>(args)...),
+            attributes()
+        );
+    }
 
-        void_func func(lambda_func);
-        create_thread(func);
+    template<typename Callable, typename ...Args>
+    explicit
+    thread(const attributes& attr, Callable&& callb, Args&& ...args)
+    :
+        m_is_joinable(0)
+    {
+        create_thread(
+            make_start(std::forward<Callable>(callb), std::forward<Args>(args)...),
+            attr
+        );
     }
 
     thread(const thread& other) = delete;
     
-    thread(thread&& other)
+    thread(thread&& other): m_thread_id(), m_is_joinable(0)
     { swap(other); };
 
     /* TODO: Add move assignment so as to assign empty thread objects */
@@ -79,24 +232,93 @@ public:
     { lhs.swap(rhs); }
 
 private:
-    typedef func::function<void()> void_func;
+    template<typename Callable, typename ...Args>
+    static detail::thread_start_base* make_start(Callable&& callb, Args&& ...args) {
+        return new detail::thread_start<
+            typename std::decay<Callable>::type,
+            typename std::decay<Args>::type...
+        >(std::forward<Callable>(callb), std::forward<Args>(args)...);
+    }
 
     native_handle_type m_thread_id;
     int m_is_joinable;
 
-    void create_thread(void_func& func_obj);
+    /*takes ownership of start block, releases it on failure*/
+    void create_thread(detail::thread_start_base* start, const attributes& attr);
 
 }; // class thread
 
+namespace detail {
+
+/*whether callb(token, args...) is well-formed, with decay-copied arguments passed as rvalues*/
+template<typename Callable, typename ...Args>
+struct accepts_stop_token {
+private:
+    template<typename C>
+    static auto test(int) -> decltype(
+        (void) std::declval<C>()(std::declval<stop_token>(), std::declval<Args>()...),
+        std::true_type()
+    );
+
+    template<typename C>
+    static std::false_type test(...);
+
+public:
+    typedef decltype(test<Callable>(0)) type;
+    static constexpr bool value = type::value;
+};
+
+} // namespace detail
+
+/*
+ * Joining thread with cooperative cancellation.
+ * Callable taking stop_token as first argument receives token of jthread's stop_source.
+ * Destructor requests stop before joining.
+ */
 class jthread {
 
 public:
-    jthread(): m_thread() {}
+    jthread(): m_stop_source(nostopstate), m_thread() {}
+
+    template<
+        typename Callable, typename ...Args,
+        typename = typename std::enable_if<
+            !std::is_same<typename std::decay<Callable>::type, jthread>::value &&
+            !std::is_same<typename std::decay<Callable>::type, thread::attributes>::value
+        >::type
+    >
+    explicit
+    jthread(Callable&& cb, Args&& ...args):
+        m_stop_source(),
+        m_thread(
+            start_thread(
+                thread::attributes(),
+                typename detail::accepts_stop_token<
+                    typename std::decay<Callable>::type,
+                    typename std::decay<Args>::type...
+                >::type(),
+                std::forward<Callable>(cb), std::forward<Args>(args)...
+            )
+        )
+    {}
 
     template<typename Callable, typename ...Args>
-    jthread(Callable cb, Args ...args): m_thread(cb, args...) {}
-
-    jthread(jthread&& other): m_thread() {
+    explicit
+    jthread(const thread::attributes& attr, Callable&& cb, Args&& ...args):
+        m_stop_source(),
+        m_thread(
+            start_thread(
+                attr,
+                typename detail::accepts_stop_token<
+                    typename std::decay<Callable>::type,
+                    typename std::decay<Args>::type...
+                >::type(),
+                std::forward<Callable>(cb), std::forward<Args>(args)...
+            )
+        )
+    {}
+
+    jthread(jthread&& other): m_stop_source(nostopstate), m_thread() {
         swap(other);
     }
 
@@ -104,6 +326,7 @@ public:
 
     ~jthread() {
         if(m_thread.joinable()) {
+            m_stop_source.request_stop();
             m_thread.join();
         }
     }
@@ -117,6 +340,7 @@ public:
 
     void swap(jthread& other) { 
         using std::swap;
+        swap(m_stop_source, other.m_stop_source);
         swap(m_thread, other.m_thread);
     }
 
@@ -142,12 +366,38 @@ public:
         return m_thread.get_id();
     }
 
+    stop_source
+    get_stop_source()
+    { return m_stop_source; }
+
+    stop_token
+    get_stop_token() const
+    { return m_stop_source.get_token(); }
+
+    bool
+    request_stop()
+    { return m_stop_source.request_stop(); }
+
     friend void swap(jthread& lhs, jthread& rhs)
     { lhs.swap(rhs); }
 
 private:
+    template<typename Callable, typename ...Args>
+    thread start_thread(
+        const thread::attributes& attr, std::true_type, Callable&& cb, Args&& ...args
+    ) {
+        return thread(
+            attr, std::forward<Callable>(cb), m_stop_source.get_token(), std::forward<Args>(args)...
+        );
+    }
+
+    template<typename Callable, typename ...Args>
+    static thread start_thread(
+        const thread::attributes& attr, std::false_type, Callable&& cb, Args&& ...args
+    ) { return thread(attr, std::forward<Callable>(cb), std::forward<Args>(args)...); }
+
+    stop_source m_stop_source;
     thread m_thread;
-    /* TODO: Add stop source support */
 
 }; // class jthread
 
@@ -156,6 +406,13 @@ namespace this_thread {
 
 thread::native_handle_type get_native_id();
 
+/*
+ * Registers routine(arg) to run when calling thread exits, in reverse order of registration.
+ * Library threads run routines as part of their cleanup, other threads from pthread key destructor;
+ * routines are not run for thread which ends process (e.g. returning from main).
+ */
+void at_exit(void (*routine)(void*), void* arg);
+
 }; // namespace this_thread
 
 } // namespace concurrency
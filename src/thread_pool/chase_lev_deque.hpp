@@ -0,0 +1,164 @@
+#ifndef CHASE_LEV_DEQUE_H
+#define CHASE_LEV_DEQUE_H
+
+#include <atomic>
+#include <vector>
+#include <type_traits>
+
+namespace concurrency {
+
+/*
+ * Lock-free work-stealing deque (Chase, Lev 2005; memory orders from Le et al. 2013).
+ * Owner thread pushes and pops at the bottom, any other thread steals from the top.
+ * Ring buffer grows on overflow, retired buffers are kept until destruction,
+ * since thieves may still be reading from them.
+ * Element type must be trivially copyable (intended for pointers).
+ */
+template<typename T>
+class chase_lev_deque {
+
+    static_assert(std::is_trivially_copyable<T>::value,
+        "chase_lev_deque element must be trivially copyable");
+
+public:
+    typedef T value_type;
+
+    explicit
+    chase_lev_deque(long capacity = 64):
+        m_top(0),
+        m_bottom(0),
+        m_buffer(new buffer(round_up_pow2(capacity)))
+    {}
+
+    chase_lev_deque(const chase_lev_deque& other) = delete;
+    chase_lev_deque& operator=(const chase_lev_deque& other) = delete;
+
+    ~chase_lev_deque() {
+        delete m_buffer.load(std::memory_order_relaxed);
+        for(std::size_t i = 0; i < m_retired.size(); ++i)
+            delete m_retired[i];
+    }
+
+    /*owner only*/
+    void push(value_type val) {
+        const long bottom = m_bottom.load(std::memory_order_relaxed);
+        const long top = m_top.load(std::memory_order_acquire);
+        buffer* buf = m_buffer.load(std::memory_order_relaxed);
+
+        if(bottom - top > buf->m_mask)
+            buf = grow(buf, top, bottom);
+
+        buf->put(bottom, val);
+        /*release store instead of release fence: same cost, visible to race detectors*/
+        m_bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    /*owner only, LIFO end*/
+    bool pop(value_type& val) {
+        const long bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        buffer* buf = m_buffer.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long top = m_top.load(std::memory_order_relaxed);
+
+        if(top > bottom) { /*empty*/
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        val = buf->get(bottom);
+        if(top == bottom) { /*last element, race against thieves*/
+            const bool won = m_top.compare_exchange_strong(
+                top, top + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed
+            );
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+
+        return true;
+    }
+
+    /*any thread, FIFO end. Fails if deque is empty or steal lost race*/
+    bool steal(value_type& val) {
+        long top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const long bottom = m_bottom.load(std::memory_order_acquire);
+
+        if(top >= bottom)
+            return false;
+
+        buffer* buf = m_buffer.load(std::memory_order_acquire);
+        value_type stolen = buf->get(top);
+        if(!m_top.compare_exchange_strong(
+            top, top + 1,
+            std::memory_order_seq_cst, std::memory_order_relaxed
+        ))
+            return false;
+
+        val = stolen;
+        return true;
+    }
+
+    /*approximate, exact only when called by owner with no concurrent thieves*/
+    long size() const {
+        const long bottom = m_bottom.load(std::memory_order_relaxed);
+        const long top = m_top.load(std::memory_order_relaxed);
+        return bottom > top ? bottom - top : 0;
+    }
+
+    bool empty() const
+    { return size() == 0; }
+
+private:
+    struct buffer {
+        explicit buffer(long capacity):
+            m_mask(capacity - 1),
+            m_slots(new std::atomic<value_type>[capacity])
+        {}
+
+        ~buffer()
+        { delete[] m_slots; }
+
+        buffer(const buffer& other) = delete;
+        buffer& operator=(const buffer& other) = delete;
+
+        void put(long idx, value_type val)
+        { m_slots[idx & m_mask].store(val, std::memory_order_relaxed); }
+
+        value_type get(long idx) const
+        { return m_slots[idx & m_mask].load(std::memory_order_relaxed); }
+
+        const long m_mask;
+        std::atomic<value_type>* const m_slots;
+    };
+
+    static long round_up_pow2(long capacity) {
+        long pow2 = 1;
+        while(pow2 < capacity)
+            pow2 <<= 1;
+        return pow2;
+    }
+
+    buffer* grow(buffer* old_buf, long top, long bottom) {
+        buffer* new_buf = new buffer((old_buf->m_mask + 1) * 2);
+        for(long idx = top; idx < bottom; ++idx)
+            new_buf->put(idx, old_buf->get(idx));
+
+        m_retired.push_back(old_buf);
+        m_buffer.store(new_buf, std::memory_order_release);
+        return new_buf;
+    }
+
+    /*top and bottom are written by different sides, keep them on separate cache lines*/
+    alignas(64) std::atomic<long> m_top;
+    alignas(64) std::atomic<long> m_bottom;
+    alignas(64) std::atomic<buffer*> m_buffer;
+    /*touched by owner only*/
+    std::vector<buffer*> m_retired;
+
+}; // class chase_lev_deque
+
+} // namespace concurrency
+
+#endif
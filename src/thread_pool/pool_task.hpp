@@ -0,0 +1,69 @@
+#ifndef POOL_TASK_H
+#define POOL_TASK_H
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace concurrency::detail {
+
+/*
+ * Task queued in pool, type-erased by function pointers (as thread_start is).
+ * Owner runs it once and destroys it afterwards.
+ */
+struct pool_task {
+    typedef void (*routine_type)(pool_task*);
+
+    pool_task(routine_type run, routine_type destroy):
+        m_run(run), m_destroy(destroy)
+    {}
+
+    void run()
+    { m_run(this); }
+
+    void destroy()
+    { m_destroy(this); }
+
+    routine_type m_run;
+    routine_type m_destroy;
+};
+
+template<typename Callable, typename ...Args>
+struct bound_task: pool_task {
+
+    template<typename C, typename ...A>
+    explicit bound_task(C&& callb, A&& ...args):
+        pool_task(run, destroy),
+        m_callable(std::forward<C>(callb)),
+        m_args(std::forward<A>(args)...)
+    {}
+
+    /*callable and arguments are owned by task, so they are passed as rvalues*/
+    static void run(pool_task* base) {
+        bound_task* self = static_cast<bound_task*>(base);
+        self->invoke(std::index_sequence_for<Args...>());
+    }
+
+    static void destroy(pool_task* base)
+    { delete static_cast<bound_task*>(base); }
+
+    template<std::size_t ...Idx>
+    void invoke(std::index_sequence<Idx...>)
+    { std::move(m_callable)(std::move(std::get<Idx>(m_args))...); }
+
+    Callable m_callable;
+    std::tuple<Args...> m_args;
+};
+
+/*callable and arguments are decay-copied (moved from rvalues), so move-only ones are accepted*/
+template<typename Callable, typename ...Args>
+pool_task* make_pool_task(Callable&& callb, Args&& ...args) {
+    return new bound_task<std::decay_t<Callable>, std::decay_t<Args>...>(
+        std::forward<Callable>(callb), std::forward<Args>(args)...
+    );
+}
+
+} // namespace concurrency::detail
+
+#endif
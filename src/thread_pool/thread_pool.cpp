@@ -0,0 +1,104 @@
+#include "thread_pool.hpp"
+
+#include <utility>
+
+namespace concurrency {
+
+/*pool, whose worker is calling thread (nullptr for non-worker threads)*/
+static thread_local thread_pool* t_current_pool = nullptr;
+
+thread_pool::thread_pool(unsigned int threads_num):
+    m_active(0),
+    m_stopping(false)
+{
+    if(threads_num == 0)
+        throw std::invalid_argument("thread_pool::thread_pool: number of threads must be positive");
+
+    m_workers.reserve(threads_num);
+    try {
+        for(unsigned int i = 0; i < threads_num; ++i)
+            m_workers.push_back(thread(worker_routine, this));
+    } catch(...) {
+        /*do not leave already started workers unjoined*/
+        shutdown();
+        throw;
+    }
+}
+
+thread_pool::~thread_pool() {
+    shutdown();
+}
+
+void thread_pool::push_task(detail::pool_task* task) {
+    {
+        lock_guard<mutex> locker(m_mutex);
+        /*tasks running during drain may still submit continuations*/
+        if(m_stopping && t_current_pool != this) {
+            task->destroy();
+            throw std::runtime_error("thread_pool::submit: pool is shut down");
+        }
+
+        try {
+            m_tasks.push_back(task);
+        } catch(...) {
+            task->destroy();
+            throw;
+        }
+    }
+    /*notify outside of lock, so woken worker does not block on mutex right away*/
+    m_task_cv.notify_one();
+}
+
+void thread_pool::wait_idle() {
+    unique_lock<mutex> locker(m_mutex);
+    m_idle_cv.wait(
+        locker,
+        [this] () { return m_tasks.empty() && m_active == 0; }
+    );
+}
+
+void thread_pool::shutdown() {
+    {
+        lock_guard<mutex> locker(m_mutex);
+        if(m_stopping && m_workers.empty())
+            return;
+        m_stopping = true;
+    }
+    m_task_cv.notify_all();
+
+    for(unsigned int i = 0; i < m_workers.size(); ++i)
+        if(m_workers[i].joinable())
+            m_workers[i].join();
+    m_workers.clear();
+}
+
+void thread_pool::worker_routine(thread_pool* pool) {
+    t_current_pool = pool;
+
+    unique_lock<mutex> locker(pool->m_mutex);
+    for(;;) {
+        pool->m_task_cv.wait(
+            locker,
+            [pool] () { return !pool->m_tasks.empty() || pool->m_stopping; }
+        );
+
+        /*queue is drained before workers leave*/
+        if(pool->m_tasks.empty())
+            return;
+
+        detail::pool_task* task = pool->m_tasks.front();
+        pool->m_tasks.pop_front();
+        ++pool->m_active;
+
+        locker.unlock();
+        task->run();
+        task->destroy();
+        locker.lock();
+
+        --pool->m_active;
+        if(pool->m_tasks.empty() && pool->m_active == 0)
+            pool->m_idle_cv.notify_all();
+    }
+}
+
+} // namespace concurrency
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <deque>
+#include <vector>
+#include <stdexcept>
+
+#include "thread.hpp"
+#include "mutex.hpp"
+#include "condition_variable.hpp"
+#include "pool_task.hpp"
+
+namespace concurrency {
+
+/*
+ * Executor with fixed number of long-lived worker threads.
+ * Tasks are kept in single FIFO queue, workers sleep on condition variable while it is empty.
+ * Exception escaping a task terminates program, as it does for thread.
+ */
+class thread_pool {
+
+public:
+    explicit
+    thread_pool(unsigned int threads_num);
+
+    thread_pool(const thread_pool& other) = delete;
+    thread_pool& operator=(const thread_pool& other) = delete;
+
+    /*finishes all submitted tasks before destruction*/
+    ~thread_pool();
+
+    /*
+     * Callable and arguments are decay-copied into task (moved, if passed as rvalues)
+     * and passed to callable as rvalues, so move-only ones are accepted.
+     * Use std::ref for arguments which have to stay references.
+     */
+    template<typename Callable, typename ...Args>
+    void submit(Callable&& callb, Args&& ...args)
+    { push_task(detail::make_pool_task(std::forward<Callable>(callb), std::forward<Args>(args)...)); }
+
+    /*block until queue is empty and no task is running*/
+    void
+    wait_idle();
+
+    /*
+     * stop accepting tasks from outside of pool, run remaining ones and join workers.
+     * Tasks already in pool may still submit new ones, they are run before workers exit.
+     */
+    void
+    shutdown();
+
+    unsigned int
+    size() const
+    { return m_workers.size(); }
+
+private:
+    static void worker_routine(thread_pool* pool);
+
+    /*takes ownership of task, destroys it if pool does not accept it*/
+    void push_task(detail::pool_task* task);
+
+    std::deque<detail::pool_task*> m_tasks;
+    /*number of tasks being executed right now*/
+    unsigned int m_active;
+    bool m_stopping;
+
+    mutex m_mutex;
+    condition_variable m_task_cv; /*task was pushed or pool is stopping*/
+    condition_variable m_idle_cv; /*queue got drained*/
+
+    std::vector<thread> m_workers;
+
+}; // class thread_pool
+
+} // namespace concurrency
+
+#endif
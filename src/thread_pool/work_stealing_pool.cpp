@@ -0,0 +1,232 @@
+#include "work_stealing_pool.hpp"
+
+#include <sched.h>
+
+namespace concurrency {
+
+/*worker of which pool is calling thread (nullptr for non-worker threads)*/
+static thread_local void* t_current_worker = nullptr;
+
+/*consecutive failed steal rounds before worker parks*/
+static const int idle_rounds_before_park = 64;
+
+work_stealing_pool::worker_data::worker_data(work_stealing_pool* pool, unsigned int index):
+    m_deque(),
+    m_pool(pool),
+    m_index(index),
+    m_rng(index * 2654435761u + 1)
+{}
+
+work_stealing_pool::work_stealing_pool(unsigned int threads_num):
+    m_pending(0),
+    m_unfinished(0),
+    m_sleeping(0),
+    m_exiting(false),
+    m_stopping(false)
+{
+    if(threads_num == 0)
+        throw std::invalid_argument("work_stealing_pool::work_stealing_pool: number of threads must be positive");
+
+    /*all deques exist before any worker starts stealing*/
+    m_worker_data.reserve(threads_num);
+    for(unsigned int i = 0; i < threads_num; ++i)
+        m_worker_data.push_back(new worker_data(this, i));
+
+    m_workers.reserve(threads_num);
+    try {
+        for(unsigned int i = 0; i < threads_num; ++i)
+            m_workers.push_back(thread(worker_routine, m_worker_data[i]));
+    } catch(...) {
+        /*do not leave already started workers unjoined*/
+        shutdown();
+        for(unsigned int i = 0; i < m_worker_data.size(); ++i)
+            delete m_worker_data[i];
+        throw;
+    }
+}
+
+work_stealing_pool::~work_stealing_pool() {
+    shutdown();
+    for(unsigned int i = 0; i < m_worker_data.size(); ++i)
+        delete m_worker_data[i];
+}
+
+int work_stealing_pool::current_worker_index() const {
+    worker_data* self = static_cast<worker_data*>(t_current_worker);
+    if(self && self->m_pool == this)
+        return self->m_index;
+    return -1;
+}
+
+bool work_stealing_pool::local_queue_empty() const {
+    worker_data* self = static_cast<worker_data*>(t_current_worker);
+    if(self && self->m_pool == this)
+        return self->m_deque.empty();
+    return m_pending.load(std::memory_order_relaxed) <= 0;
+}
+
+void work_stealing_pool::push_task(task_type* task) {
+    worker_data* self = static_cast<worker_data*>(t_current_worker);
+
+    if(self && self->m_pool == this) {
+        /*spawned from inside a task: local deque, no locking*/
+        /*counted before thieves can see it, the spawning task keeps counter above zero meanwhile*/
+        m_unfinished.fetch_add(1, std::memory_order_relaxed);
+        try {
+            self->m_deque.push(task);
+        } catch(...) {
+            m_unfinished.fetch_sub(1, std::memory_order_relaxed);
+            task->destroy();
+            throw;
+        }
+    } else {
+        lock_guard<mutex> locker(m_mutex);
+        if(m_stopping) {
+            task->destroy();
+            throw std::runtime_error("work_stealing_pool::submit: pool is shut down");
+        }
+        try {
+            m_injected.push_back(task);
+        } catch(...) {
+            task->destroy();
+            throw;
+        }
+        m_unfinished.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /*pairs with worker publishing m_sleeping before rechecking m_pending (both seq_cst)*/
+    m_pending.fetch_add(1, std::memory_order_seq_cst);
+    if(m_sleeping.load(std::memory_order_seq_cst) > 0) {
+        lock_guard<mutex> locker(m_mutex);
+        m_work_cv.notify_one();
+    }
+}
+
+work_stealing_pool::task_type* work_stealing_pool::find_task(worker_data* self) {
+    task_type* task = nullptr;
+
+    if(self && self->m_deque.pop(task))
+        return task;
+
+    if(m_pending.load(std::memory_order_relaxed) <= 0)
+        return nullptr;
+
+    {
+        lock_guard<mutex> locker(m_mutex);
+        if(!m_injected.empty()) {
+            task = m_injected.front();
+            m_injected.pop_front();
+            return task;
+        }
+    }
+
+    /*steal round: start from random victim, visit everyone once*/
+    const unsigned int workers_num = m_worker_data.size();
+    unsigned int start = 0;
+    if(self) {
+        self->m_rng ^= self->m_rng << 13;
+        self->m_rng ^= self->m_rng >> 17;
+        self->m_rng ^= self->m_rng << 5;
+        start = self->m_rng % workers_num;
+    }
+
+    for(unsigned int i = 0; i < workers_num; ++i) {
+        worker_data* victim = m_worker_data[(start + i) % workers_num];
+        if(victim != self && victim->m_deque.steal(task))
+            return task;
+    }
+
+    return nullptr;
+}
+
+void work_stealing_pool::run_task(task_type* task) {
+    m_pending.fetch_sub(1, std::memory_order_relaxed);
+    task->run();
+    task->destroy();
+
+    if(m_unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        lock_guard<mutex> locker(m_mutex);
+        m_idle_cv.notify_all();
+    }
+}
+
+bool work_stealing_pool::run_one() {
+    worker_data* self = static_cast<worker_data*>(t_current_worker);
+    if(self && self->m_pool != this)
+        self = nullptr;
+
+    task_type* task = find_task(self);
+    if(!task)
+        return false;
+
+    run_task(task);
+    return true;
+}
+
+void work_stealing_pool::wait_idle() {
+    unique_lock<mutex> locker(m_mutex);
+    m_idle_cv.wait(
+        locker,
+        [this] () { return m_unfinished.load(std::memory_order_acquire) == 0; }
+    );
+}
+
+void work_stealing_pool::shutdown() {
+    {
+        lock_guard<mutex> locker(m_mutex);
+        if(m_exiting.load(std::memory_order_relaxed) && m_workers.empty())
+            return;
+        m_stopping = true;
+    }
+
+    wait_idle();
+
+    {
+        lock_guard<mutex> locker(m_mutex);
+        m_exiting.store(true, std::memory_order_relaxed);
+    }
+    m_work_cv.notify_all();
+
+    for(unsigned int i = 0; i < m_workers.size(); ++i)
+        if(m_workers[i].joinable())
+            m_workers[i].join();
+    m_workers.clear();
+}
+
+void work_stealing_pool::worker_routine(worker_data* data) {
+    t_current_worker = data;
+    work_stealing_pool* pool = data->m_pool;
+
+    int idle_rounds = 0;
+    while(!pool->m_exiting.load(std::memory_order_relaxed)) {
+        task_type* task = pool->find_task(data);
+        if(task) {
+            idle_rounds = 0;
+            pool->run_task(task);
+            continue;
+        }
+
+        if(++idle_rounds < idle_rounds_before_park) {
+            if(idle_rounds % 16 == 0)
+                sched_yield();
+            else
+                util::cpu_relax();
+            continue;
+        }
+
+        /*park until work appears*/
+        idle_rounds = 0;
+        unique_lock<mutex> locker(pool->m_mutex);
+        pool->m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+        pool->m_work_cv.wait(
+            locker,
+            [pool] () {
+                return pool->m_pending.load(std::memory_order_seq_cst) > 0 ||
+                    pool->m_exiting.load(std::memory_order_relaxed);
+            }
+        );
+        pool->m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace concurrency
@@ -0,0 +1,120 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <stdexcept>
+
+#include "thread.hpp"
+#include "mutex.hpp"
+#include "condition_variable.hpp"
+#include "chase_lev_deque.hpp"
+#include "pool_task.hpp"
+#include "futex.h"
+
+namespace concurrency {
+
+/*
+ * Executor where every worker owns Chase-Lev deque of tasks.
+ * Tasks submitted from worker go to its own deque (LIFO for owner, stealable from the top),
+ * tasks submitted from outside go to shared injection queue.
+ * Idle workers steal from random victims and park on condition variable when there is no work.
+ * Exception escaping a task terminates program, as it does for thread.
+ */
+class work_stealing_pool {
+
+public:
+    explicit
+    work_stealing_pool(unsigned int threads_num);
+
+    work_stealing_pool(const work_stealing_pool& other) = delete;
+    work_stealing_pool& operator=(const work_stealing_pool& other) = delete;
+
+    /*finishes all submitted tasks before destruction*/
+    ~work_stealing_pool();
+
+    /*callable and arguments are decay-copied and passed as rvalues, as in thread_pool::submit*/
+    template<typename Callable, typename ...Args>
+    void submit(Callable&& callb, Args&& ...args)
+    { push_task(detail::make_pool_task(std::forward<Callable>(callb), std::forward<Args>(args)...)); }
+
+    /*
+     * Run pool's tasks on calling thread until stop_waiting() returns true.
+     * Lets task wait for tasks it has forked without blocking worker.
+     */
+    template<typename Predicate>
+    void run_until(Predicate stop_waiting) {
+        while(!stop_waiting())
+            if(!run_one())
+                util::cpu_relax();
+    }
+
+    /*block until all submitted tasks (and tasks spawned by them) are finished*/
+    void
+    wait_idle();
+
+    /*
+     * stop accepting tasks from outside of pool, run remaining ones and join workers.
+     * Tasks already in pool may still submit new ones, they are run before workers exit.
+     */
+    void
+    shutdown();
+
+    unsigned int
+    size() const
+    { return m_workers.size(); }
+
+    /*index of calling worker in this pool, -1 if caller is not its worker*/
+    int
+    current_worker_index() const;
+
+    /*
+     * True if calling worker's own deque holds no tasks (for other threads: no task waits anywhere),
+     * i.e. tasks it forked were already taken by others. Lets algorithms fork only on demand.
+     */
+    bool
+    local_queue_empty() const;
+
+private:
+    typedef detail::pool_task task_type;
+
+    struct worker_data {
+        worker_data(work_stealing_pool* pool, unsigned int index);
+
+        chase_lev_deque<task_type*> m_deque;
+        work_stealing_pool* const m_pool;
+        const unsigned int m_index;
+        /*state of xorshift generator choosing victims*/
+        unsigned int m_rng;
+    };
+
+    static void worker_routine(worker_data* data);
+
+    void push_task(task_type* task);
+    task_type* find_task(worker_data* self);
+    bool run_one();
+    void run_task(task_type* task);
+
+    /*tasks sitting in queues (not yet taken by anyone)*/
+    alignas(64) std::atomic<long> m_pending;
+    /*tasks submitted and not finished yet*/
+    alignas(64) std::atomic<long> m_unfinished;
+    std::atomic<int> m_sleeping;
+    std::atomic<bool> m_exiting;
+    bool m_stopping;
+
+    /*guards injection queue, parking and stop flags*/
+    mutex m_mutex;
+    condition_variable m_work_cv; /*work appeared or pool is exiting*/
+    condition_variable m_idle_cv; /*all tasks finished*/
+    std::deque<task_type*> m_injected;
+
+    std::vector<worker_data*> m_worker_data;
+    std::vector<thread> m_workers;
+
+}; // class work_stealing_pool
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,366 @@
+#include "timer_service.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace concurrency {
+
+namespace {
+
+/*states of timer_node, guarded by mutex of service*/
+enum timer_state {
+    timer_idle = 0,       /*new, fired (one-shot) or cancelled*/
+    timer_in_wheel,
+    timer_in_heap,
+    timer_cancelled_in_heap /*waits in heap until it is purged or reaches the wheel*/
+};
+
+const std::uint64_t no_event = std::numeric_limits<std::uint64_t>::max();
+
+/*
+ * Longest single sleep of dispatcher. It is bounded in time rather than in ticks:
+ * long ticks times many of them would overflow nanoseconds of wakeup time.
+ */
+const std::chrono::hours max_sleep(24);
+
+struct later_deadline {
+    bool operator()(const detail::timer_node* lhs, const detail::timer_node* rhs) const
+    { return lhs->m_deadline > rhs->m_deadline; }
+};
+
+} // namespace
+
+bool timer_handle::cancel() {
+    if(!m_node)
+        return false;
+    return m_node->m_service->cancel(m_node);
+}
+
+timer_service::timer_service(std::chrono::nanoseconds resolution):
+    timer_service(resolution, nullptr, nullptr)
+{}
+
+timer_service::timer_service(std::chrono::nanoseconds resolution, void* executor, submit_routine submit):
+    m_resolution(resolution),
+    m_start(clock::now()),
+    m_executor(executor),
+    m_submit(submit),
+    m_now(0),
+    m_wakeup(0),
+    m_armed(0),
+    m_stopping(false),
+    m_heap_cancelled(0)
+{
+    if(resolution <= resolution.zero())
+        throw std::invalid_argument("timer_service::timer_service: resolution must be positive");
+
+    for(int level = 0; level < wheel_levels; ++level) {
+        std::fill(m_slots[level], m_slots[level] + wheel_slots, nullptr);
+        m_occupied[level] = 0;
+    }
+
+    /*wheel is ready before dispatcher looks at it*/
+    m_dispatcher = thread(dispatcher_routine, this);
+}
+
+timer_service::~timer_service() {
+    {
+        lock_guard<mutex> locker(m_mutex);
+        m_stopping = true;
+        m_wakeup_cv.notify_one();
+    }
+    m_dispatcher.join();
+
+    /*dispatcher is gone, remaining timers never fire*/
+    for(int level = 0; level < wheel_levels; ++level)
+        for(int slot = 0; slot < wheel_slots; ++slot)
+            while(detail::timer_node* node = m_slots[level][slot]) {
+                m_slots[level][slot] = node->m_next;
+                node->m_state = timer_idle;
+                node->release();
+            }
+    for(std::size_t i = 0; i < m_heap.size(); ++i) {
+        m_heap[i]->m_state = timer_idle;
+        m_heap[i]->release();
+    }
+}
+
+std::size_t timer_service::size() const {
+    lock_guard<mutex> locker(m_mutex);
+    return m_armed;
+}
+
+timer_handle timer_service::arm(detail::timer_node* node, std::uint64_t deadline) {
+    /*reference of handle, node was created with the one of service*/
+    node->acquire();
+    timer_handle handle(node);
+
+    lock_guard<mutex> locker(m_mutex);
+    if(m_stopping) {
+        node->release();
+        throw std::runtime_error("timer_service::schedule: service is being destroyed");
+    }
+
+    /*deadline already passed: fire on next tick*/
+    node->m_deadline = std::max(deadline, m_now + 1);
+    place(node);
+    ++m_armed;
+
+    /*dispatcher sleeps past new deadline, one notification wakes it*/
+    if(node->m_deadline < m_wakeup) {
+        m_wakeup = 0;
+        m_wakeup_cv.notify_one();
+    }
+    return handle;
+}
+
+bool timer_service::cancel(detail::timer_node* node) {
+    unique_lock<mutex> locker(m_mutex);
+
+    switch(node->m_state) {
+        case timer_in_wheel:
+            unlink(node);
+            node->m_state = timer_idle;
+            node->m_cancelled.store(true, std::memory_order_relaxed);
+            --m_armed;
+            break;
+        case timer_in_heap:
+            /*heap keeps its reference until node is popped or purged*/
+            node->m_state = timer_cancelled_in_heap;
+            node->m_cancelled.store(true, std::memory_order_relaxed);
+            --m_armed;
+            if(++m_heap_cancelled > m_heap.size() / 2)
+                purge_heap();
+            return true;
+        default:
+            return false;
+    }
+
+    locker.unlock();
+    /*reference of service, callback is destroyed outside of lock*/
+    node->release();
+    return true;
+}
+
+void timer_service::place(detail::timer_node* node) {
+    /*
+     * Level is the highest 6-bit group in which deadline differs from current tick,
+     * so slot index at that level is ahead of the current one and is reached without wrapping.
+     */
+    const std::uint64_t differ = node->m_deadline ^ m_now;
+    const int level = (63 - __builtin_clzll(differ)) / slot_bits;
+
+    if(level >= wheel_levels) {
+        node->m_state = timer_in_heap;
+        m_heap.push_back(node);
+        std::push_heap(m_heap.begin(), m_heap.end(), later_deadline());
+        return;
+    }
+
+    const int slot = (node->m_deadline >> (level * slot_bits)) & (wheel_slots - 1);
+    detail::timer_node*& head = m_slots[level][slot];
+    node->m_prev = nullptr;
+    node->m_next = head;
+    if(head)
+        head->m_prev = node;
+    head = node;
+    m_occupied[level] |= std::uint64_t(1) << slot;
+    node->m_level = level;
+    node->m_slot = slot;
+    node->m_state = timer_in_wheel;
+}
+
+void timer_service::unlink(detail::timer_node* node) {
+    if(node->m_next)
+        node->m_next->m_prev = node->m_prev;
+
+    if(node->m_prev) {
+        node->m_prev->m_next = node->m_next;
+        return;
+    }
+
+    m_slots[node->m_level][node->m_slot] = node->m_next;
+    if(!node->m_next)
+        m_occupied[node->m_level] &= ~(std::uint64_t(1) << node->m_slot);
+}
+
+std::uint64_t timer_service::next_event_tick() const {
+    std::uint64_t next = no_event;
+
+    for(int level = 0; level < wheel_levels; ++level) {
+        const int shift = level * slot_bits;
+        const int current = (m_now >> shift) & (wheel_slots - 1);
+        if(current == wheel_slots - 1)
+            continue;
+
+        /*occupied slots are always ahead of current one*/
+        const std::uint64_t ahead = m_occupied[level] & (~std::uint64_t(0) << (current + 1));
+        if(ahead) {
+            /*tick at which slot is reached: expiry on level 0, cascade on upper levels*/
+            const int group_shift = shift + slot_bits;
+            const std::uint64_t tick =
+                ((m_now >> group_shift) << group_shift) | (std::uint64_t(__builtin_ctzll(ahead)) << shift);
+            next = std::min(next, tick);
+        }
+    }
+
+    if(!m_heap.empty()) {
+        /*far deadlines enter the wheel when it turns to their span*/
+        const int span_shift = wheel_levels * slot_bits;
+        const std::uint64_t tick = (m_heap.front()->m_deadline >> span_shift) << span_shift;
+        next = std::min(next, std::max(tick, m_now + 1));
+    }
+
+    return next;
+}
+
+void timer_service::advance_to(std::uint64_t tick, detail::timer_node*& expired) {
+    /*jump between ticks where something happens, empty slots are skipped*/
+    for(std::uint64_t next = next_event_tick(); next <= tick; next = next_event_tick()) {
+        m_now = next;
+
+        collect_heap(expired);
+        for(int level = wheel_levels - 1; level > 0; --level)
+            if((m_now & ((std::uint64_t(1) << (level * slot_bits)) - 1)) == 0)
+                cascade(level, (m_now >> (level * slot_bits)) & (wheel_slots - 1), expired);
+        cascade(0, m_now & (wheel_slots - 1), expired);
+    }
+
+    m_now = std::max(m_now, tick);
+}
+
+void timer_service::cascade(int level, int slot, detail::timer_node*& expired) {
+    detail::timer_node* node = m_slots[level][slot];
+    m_slots[level][slot] = nullptr;
+    m_occupied[level] &= ~(std::uint64_t(1) << slot);
+
+    while(node) {
+        detail::timer_node* next = node->m_next;
+        if(node->m_deadline <= m_now) {
+            node->m_state = timer_idle;
+            node->m_next = expired;
+            expired = node;
+        }
+        else
+            place(node);
+        node = next;
+    }
+}
+
+void timer_service::collect_heap(detail::timer_node*& expired) {
+    const int span_shift = wheel_levels * slot_bits;
+
+    while(!m_heap.empty() && (m_heap.front()->m_deadline >> span_shift) <= (m_now >> span_shift)) {
+        detail::timer_node* node = m_heap.front();
+        std::pop_heap(m_heap.begin(), m_heap.end(), later_deadline());
+        m_heap.pop_back();
+
+        if(node->m_state == timer_cancelled_in_heap) {
+            --m_heap_cancelled;
+            node->m_state = timer_idle;
+            node->release();
+        }
+        else if(node->m_deadline <= m_now) {
+            node->m_state = timer_idle;
+            node->m_next = expired;
+            expired = node;
+        }
+        else
+            place(node);
+    }
+}
+
+void timer_service::purge_heap() {
+    std::vector<detail::timer_node*>::iterator kept = std::partition(
+        m_heap.begin(), m_heap.end(),
+        [] (const detail::timer_node* node) { return node->m_state != timer_cancelled_in_heap; }
+    );
+    for(std::vector<detail::timer_node*>::iterator it = kept; it != m_heap.end(); ++it) {
+        (*it)->m_state = timer_idle;
+        (*it)->release();
+    }
+    m_heap.erase(kept, m_heap.end());
+    std::make_heap(m_heap.begin(), m_heap.end(), later_deadline());
+    m_heap_cancelled = 0;
+}
+
+void timer_service::run_callback(detail::timer_node* node) {
+    if(!node->m_cancelled.load(std::memory_order_relaxed)) {
+        if(node->m_period == 0)
+            node->m_callback();
+        /*periodic runs of one timer never overlap*/
+        else if(!node->m_running.exchange(true, std::memory_order_acquire)) {
+            node->m_callback();
+            node->m_running.store(false, std::memory_order_release);
+        }
+    }
+    node->release();
+}
+
+void timer_service::dispatcher_routine(timer_service* service) {
+    unique_lock<mutex> locker(service->m_mutex);
+
+    while(!service->m_stopping) {
+        const std::uint64_t current = (clock::now() - service->m_start) / service->m_resolution;
+
+        detail::timer_node* expired = nullptr;
+        service->advance_to(current, expired);
+
+        if(expired) {
+            /*re-armed periodic nodes reuse list links, so list is copied first*/
+            std::vector<detail::timer_node*> ready;
+            for(detail::timer_node* node = expired; node; node = node->m_next)
+                ready.push_back(node);
+            /*late dispatcher still hands callbacks out in order of deadlines*/
+            std::sort(ready.begin(), ready.end(),
+                [] (const detail::timer_node* lhs, const detail::timer_node* rhs) { return lhs->m_deadline < rhs->m_deadline; });
+
+            /*every expired node carries one reference into its callback run*/
+            for(std::size_t i = 0; i < ready.size(); ++i) {
+                detail::timer_node* node = ready[i];
+                if(node->m_period == 0) {
+                    --service->m_armed;
+                    continue;
+                }
+                /*re-arm periodic timer on its grid, skipping periods which are already over*/
+                const std::uint64_t missed = (service->m_now - node->m_deadline) / node->m_period + 1;
+                node->acquire();
+                node->m_deadline += missed * node->m_period;
+                service->place(node);
+            }
+
+            locker.unlock();
+            for(std::size_t i = 0; i < ready.size(); ++i) {
+                if(!service->m_submit) {
+                    run_callback(ready[i]);
+                    continue;
+                }
+                try {
+                    service->m_submit(service->m_executor, ready[i]);
+                } catch(...) {
+                    /*executor refused task (e.g. it is shut down), expiration is dropped*/
+                    ready[i]->release();
+                }
+            }
+            locker.lock();
+            continue;
+        }
+
+        const std::uint64_t next = service->next_event_tick();
+        service->m_wakeup = next;
+        if(next == no_event)
+            service->m_wakeup_cv.wait(locker);
+        else {
+            /*tick time is computed only for ticks within max_sleep, so it fits*/
+            const clock::time_point latest = clock::now() + max_sleep;
+            const std::uint64_t latest_tick = (latest - service->m_start) / service->m_resolution;
+            const clock::time_point wakeup = next <= latest_tick ?
+                service->m_start + service->m_resolution * static_cast<clock::rep>(next) : latest;
+            service->m_wakeup_cv.wait_until(locker, wakeup);
+        }
+        /*awake: new deadlines are picked up without notification*/
+        service->m_wakeup = 0;
+    }
+}
+
+} // namespace concurrency
\ No newline at end of file
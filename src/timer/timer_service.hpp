@@ -0,0 +1,263 @@
+#ifndef TIMER_SERVICE_H
+#define TIMER_SERVICE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+
+#include "function.hpp"
+
+#include "thread.hpp"
+#include "mutex.hpp"
+#include "condition_variable.hpp"
+#include "timespec.h"
+
+namespace concurrency {
+
+class timer_service;
+
+namespace detail {
+
+/*
+ * Armed timer: linked into slot of timing wheel or referenced from heap of far deadlines.
+ * Owned by references: one while armed in service, one per handle, one per callback run in flight.
+ */
+struct timer_node {
+    timer_node(timer_service* service, func::function<void()>&& callback, std::uint64_t period):
+        m_prev(nullptr), m_next(nullptr),
+        m_deadline(0), m_period(period),
+        m_level(0), m_slot(0), m_state(0),
+        m_service(service),
+        m_callback(std::move(callback)),
+        m_refs(1),
+        m_cancelled(false),
+        m_running(false)
+    {}
+
+    void acquire()
+    { m_refs.fetch_add(1, std::memory_order_relaxed); }
+
+    void release() {
+        if(m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    /*wheel slot list and deadline (in ticks), guarded by mutex of service*/
+    timer_node* m_prev;
+    timer_node* m_next;
+    std::uint64_t m_deadline;
+    /*period in ticks, 0 for one-shot timer*/
+    const std::uint64_t m_period;
+    int m_level;
+    int m_slot;
+    int m_state;
+
+    timer_service* const m_service;
+    func::function<void()> m_callback;
+    std::atomic<int> m_refs;
+    /*set by successful cancel: expiration already handed to executor does not run*/
+    std::atomic<bool> m_cancelled;
+    /*periodic callback still runs, next expiration is skipped*/
+    std::atomic<bool> m_running;
+};
+
+} // namespace detail
+
+/*
+ * Handle of scheduled timer, empty when default constructed.
+ * Copies refer to the same timer. Handle may outlive timer and service,
+ * but cancel() must not be called after service is destroyed.
+ */
+class timer_handle {
+
+public:
+    timer_handle(): m_node(nullptr) {}
+
+    timer_handle(const timer_handle& other): m_node(other.m_node) {
+        if(m_node)
+            m_node->acquire();
+    }
+
+    timer_handle(timer_handle&& other): m_node(other.m_node)
+    { other.m_node = nullptr; }
+
+    timer_handle& operator=(timer_handle other) {
+        std::swap(m_node, other.m_node);
+        return *this;
+    }
+
+    ~timer_handle() {
+        if(m_node)
+            m_node->release();
+    }
+
+    /*
+     * Disarm timer in O(1). True if it stopped timer from firing (again),
+     * false if one-shot timer has already fired or timer was cancelled before.
+     * Does not wait for callback which is already running.
+     */
+    bool cancel();
+
+    bool valid() const
+    { return m_node != nullptr; }
+
+private:
+    friend class timer_service;
+
+    explicit timer_handle(detail::timer_node* node): m_node(node) {}
+
+    detail::timer_node* m_node;
+
+}; // class timer_handle
+
+/*
+ * Timers on one dispatcher thread instead of one sleeping thread per timer.
+ * Deadlines are rounded up to ticks of given resolution and kept in hierarchical timing wheel
+ * (4 levels of 64 slots, i.e. 2^24 ticks ahead), so arming and cancelling are O(1);
+ * deadlines beyond the wheel wait in min-heap and move into wheel as it turns.
+ * Dispatcher sleeps on condition variable with CLOCK_MONOTONIC timeout until nearest non-empty slot.
+ * Expired callbacks are submitted to executor (anything with submit(callable), e.g. thread_pool),
+ * or run on dispatcher thread when service has none. Callback never runs before its deadline.
+ * Exception escaping a callback terminates program, as it does for thread.
+ */
+class timer_service {
+
+public:
+    typedef std::chrono::steady_clock clock;
+
+    /*callbacks run on dispatcher thread*/
+    explicit
+    timer_service(std::chrono::nanoseconds resolution = std::chrono::milliseconds(1));
+
+    /*callbacks are submitted to executor, which must outlive service*/
+    template<typename Executor>
+    explicit
+    timer_service(Executor& executor, std::chrono::nanoseconds resolution = std::chrono::milliseconds(1)):
+        timer_service(resolution, &executor, submit_to<Executor>)
+    {}
+
+    timer_service(const timer_service& other) = delete;
+    timer_service& operator=(const timer_service& other) = delete;
+
+    /*cancels timers which have not fired, joins dispatcher; callbacks already submitted still run*/
+    ~timer_service();
+
+    template<typename Rep, typename Period, typename Callable>
+    timer_handle schedule_after(const std::chrono::duration<Rep, Period>& delay, Callable callb)
+    { return schedule_at(util::deadline_after(delay), std::move(callb)); }
+
+    template<typename Clock, typename Duration, typename Callable>
+    timer_handle schedule_at(const std::chrono::time_point<Clock, Duration>& abs_time, Callable callb) {
+        return arm(
+            new detail::timer_node(this, func::function<void()>(std::move(callb)), 0),
+            ticks_until(abs_time)
+        );
+    }
+
+    /*
+     * Callable runs every period, first time one period from now. Deadlines do not drift;
+     * expirations missed (e.g. while previous run is still going on) are skipped.
+     */
+    template<typename Rep, typename Period, typename Callable>
+    timer_handle schedule_every(const std::chrono::duration<Rep, Period>& period, Callable callb) {
+        if(period <= period.zero())
+            throw std::invalid_argument("timer_service::schedule_every: period must be positive");
+        return arm(
+            new detail::timer_node(this, func::function<void()>(std::move(callb)), ticks_of(period)),
+            ticks_until(util::deadline_after(period))
+        );
+    }
+
+    /*timers armed and not fired or cancelled yet (periodic ones count until cancelled)*/
+    std::size_t
+    size() const;
+
+    std::chrono::nanoseconds
+    resolution() const
+    { return m_resolution; }
+
+private:
+    friend class timer_handle;
+
+    typedef void (*submit_routine)(void* executor, detail::timer_node* node);
+
+    static const int wheel_levels = 4;
+    static const int slot_bits = 6;
+    static const int wheel_slots = 1 << slot_bits;
+
+    timer_service(std::chrono::nanoseconds resolution, void* executor, submit_routine submit);
+
+    template<typename Executor>
+    static void submit_to(void* executor, detail::timer_node* node) {
+        /*reference of node is passed to task*/
+        static_cast<Executor*>(executor)->submit([node] () { run_callback(node); });
+    }
+
+    static void run_callback(detail::timer_node* node);
+
+    static void dispatcher_routine(timer_service* service);
+
+    /*first tick at or after abs_time; far time points (e.g. time_point::max()) saturate, as ticks_of does*/
+    template<typename Clock, typename Duration>
+    std::uint64_t ticks_until(const std::chrono::time_point<Clock, Duration>& abs_time) const {
+        const std::chrono::steady_clock::time_point steady_time = util::to_steady_time_point(abs_time);
+        if(steady_time <= m_start)
+            return 0;
+        return ticks_of(steady_time - m_start);
+    }
+
+    /*duration in ticks, rounded up*/
+    template<typename Rep, typename Period>
+    std::uint64_t ticks_of(const std::chrono::duration<Rep, Period>& length) const {
+        /*saturate in floating point, so that e.g. hours::max() does not overflow nanoseconds*/
+        const double ticks = std::chrono::duration<double>(length) / std::chrono::duration<double>(m_resolution);
+        if(ticks >= 1e18)
+            return std::uint64_t(1e18);
+        const std::uint64_t whole = static_cast<std::uint64_t>(ticks);
+        return whole + (whole < ticks ? 1 : 0);
+    }
+
+    timer_handle arm(detail::timer_node* node, std::uint64_t deadline);
+    bool cancel(detail::timer_node* node);
+
+    /*following functions require m_mutex*/
+    void place(detail::timer_node* node);
+    void unlink(detail::timer_node* node);
+    std::uint64_t next_event_tick() const;
+    void advance_to(std::uint64_t tick, detail::timer_node*& expired);
+    void cascade(int level, int slot, detail::timer_node*& expired);
+    void collect_heap(detail::timer_node*& expired);
+    void purge_heap();
+
+    const std::chrono::nanoseconds m_resolution;
+    const clock::time_point m_start;
+    void* const m_executor;
+    const submit_routine m_submit;
+
+    mutable mutex m_mutex;
+    condition_variable m_wakeup_cv; /*earlier deadline appeared or service is stopping*/
+
+    /*last tick processed by dispatcher*/
+    std::uint64_t m_now;
+    /*tick dispatcher sleeps until*/
+    std::uint64_t m_wakeup;
+    std::size_t m_armed;
+    bool m_stopping;
+
+    /*heads of slot lists and bitmaps of non-empty slots, per level*/
+    detail::timer_node* m_slots[wheel_levels][wheel_slots];
+    std::uint64_t m_occupied[wheel_levels];
+
+    /*min-heap by deadline, cancelled nodes are removed lazily*/
+    std::vector<detail::timer_node*> m_heap;
+    std::size_t m_heap_cancelled;
+
+    thread m_dispatcher;
+
+}; // class timer_service
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,372 @@
+#include "trace.hpp"
+
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "thread.hpp"
+
+namespace concurrency {
+
+namespace trace {
+
+#ifdef CONCURRENCY_TRACING
+
+/*
+ * Registry of buffers. Plain pthread mutex, as traced primitives would record into buffers
+ * which are being registered; it is taken only on registration, thread exit and flush.
+ */
+static pthread_mutex_t s_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+/*every buffer ever allocated, walked by flush*/
+static detail::thread_buffer* s_buffers = nullptr;
+/*buffers of exited threads, oldest first*/
+static std::deque<detail::thread_buffer*> s_exited;
+
+/*exited threads waiting for flush beyond this number lose their events to new threads*/
+static const std::size_t max_exited_buffers = 64;
+
+namespace {
+
+class registry_lock {
+
+public:
+    registry_lock()
+    { pthread_mutex_lock(&s_registry_mutex); }
+
+    ~registry_lock()
+    { pthread_mutex_unlock(&s_registry_mutex); }
+
+    registry_lock(const registry_lock& other) = delete;
+    registry_lock& operator=(const registry_lock& other) = delete;
+
+}; // class registry_lock
+
+/*requires registry mutex; flushed buffer first, then oldest one if there are too many*/
+detail::thread_buffer* take_exited_buffer() {
+    for(std::deque<detail::thread_buffer*>::iterator it = s_exited.begin(); it != s_exited.end(); ++it) {
+        detail::thread_buffer* buffer = *it;
+        if(buffer->m_flushed == buffer->m_head.load(std::memory_order_relaxed)) {
+            s_exited.erase(it);
+            return buffer;
+        }
+    }
+
+    if(s_exited.size() < max_exited_buffers)
+        return nullptr;
+
+    detail::thread_buffer* buffer = s_exited.front();
+    s_exited.pop_front();
+    /*positions go on, so that stale slots never look like new events*/
+    buffer->m_flushed = buffer->m_head.load(std::memory_order_relaxed);
+    return buffer;
+}
+
+/*exit routine of thread owning buffer, events recorded later go to new buffer*/
+void release_thread_buffer(void* arg) {
+    detail::thread_buffer*& t_buffer = *static_cast<detail::thread_buffer**>(arg);
+
+    registry_lock locker;
+    s_exited.push_back(t_buffer);
+    t_buffer = nullptr;
+}
+
+} // namespace
+
+void detail::register_thread_buffer(thread_buffer*& t_buffer) {
+    thread_buffer* buffer;
+    {
+        registry_lock locker;
+        buffer = take_exited_buffer();
+    }
+    /*value initialization zeroes slots and positions*/
+    thread_buffer* fresh = buffer ? nullptr : new thread_buffer();
+
+    {
+        registry_lock locker;
+        if(fresh) {
+            fresh->m_next = s_buffers;
+            s_buffers = fresh;
+            buffer = fresh;
+        }
+        buffer->m_tid = static_cast<int>(syscall(SYS_gettid));
+        if(pthread_getname_np(pthread_self(), buffer->m_name, sizeof(buffer->m_name)) != 0)
+            buffer->m_name[0] = '\0';
+    }
+    t_buffer = buffer;
+
+    try {
+        this_thread::at_exit(release_thread_buffer, &t_buffer);
+    } catch(...) {
+        /*buffer is just not recycled*/
+    }
+}
+
+namespace {
+
+struct event {
+    std::uint64_t time_ns;
+    const void* object;
+    event_type type;
+}; // struct event
+
+/*copies events not yet flushed, skipping those overwritten meanwhile; requires registry mutex*/
+std::vector<event> take_events(detail::thread_buffer& buffer) {
+    const std::uint64_t head = buffer.m_head.load(std::memory_order_acquire);
+    std::uint64_t pos = buffer.m_flushed;
+    if(head - pos > detail::thread_buffer::capacity)
+        pos = head - detail::thread_buffer::capacity;
+
+    std::vector<event> events;
+    events.reserve(head - pos);
+    for(; pos != head; ++pos) {
+        const detail::event_slot& slot = buffer.m_slots[pos & (detail::thread_buffer::capacity - 1)];
+        if(slot.m_seq.load(std::memory_order_acquire) != pos + 1)
+            continue;
+
+        event ev;
+        ev.time_ns = slot.m_time_ns.load(std::memory_order_relaxed);
+        ev.object = slot.m_object.load(std::memory_order_relaxed);
+        ev.type = slot.m_type.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(slot.m_seq.load(std::memory_order_relaxed) != pos + 1)
+            continue;
+        events.push_back(ev);
+    }
+
+    buffer.m_flushed = head;
+    return events;
+}
+
+const char* event_name(event_type type) {
+    switch(type) {
+        case event_type::lock_wait:     return "mutex wait";
+        case event_type::lock_acquired: return "mutex acquired";
+        case event_type::lock_timeout:  return "mutex timeout";
+        case event_type::lock_released: return "mutex released";
+        case event_type::cv_wait:       return "cv wait";
+        case event_type::cv_wake:       return "cv wake";
+        case event_type::cv_notify_one: return "cv notify_one";
+        case event_type::cv_notify_all: return "cv notify_all";
+        case event_type::thread_create: return "thread create";
+        case event_type::thread_start:  return "thread start";
+        case event_type::thread_exit:   return "thread exit";
+        case event_type::join_wait:     return "join";
+        case event_type::join_done:     return "join done";
+    }
+    return "unknown";
+}
+
+const char* event_category(event_type type) {
+    switch(type) {
+        case event_type::lock_wait:
+        case event_type::lock_acquired:
+        case event_type::lock_timeout:
+        case event_type::lock_released:
+            return "mutex";
+        case event_type::cv_wait:
+        case event_type::cv_wake:
+        case event_type::cv_notify_one:
+        case event_type::cv_notify_all:
+            return "condition_variable";
+        default:
+            return "thread";
+    }
+}
+
+const char* const hold_interval = "mutex hold";
+
+class chrome_writer {
+
+public:
+    chrome_writer(std::ostream& out): m_out(out), m_first(true), m_pid(getpid()) {}
+
+    void thread_name(int tid, const char* name) {
+        begin_event("thread_name", "__metadata", 'M', tid);
+        m_out << ",\"args\":{\"name\":\"";
+        for(const char* ch = name; *ch; ++ch) {
+            if(*ch == '"' || *ch == '\\')
+                m_out << '\\';
+            m_out << (static_cast<unsigned char>(*ch) < 0x20 ? ' ' : *ch);
+        }
+        m_out << "\"}}";
+    }
+
+    void instant(const char* name, const char* category, int tid, std::uint64_t time_ns, const void* object) {
+        begin_event(name, category, 'i', tid);
+        m_out << ",\"s\":\"t\",\"ts\":";
+        write_us(time_ns);
+        end_event(object);
+    }
+
+    void begin(const char* name, const char* category, int tid, std::uint64_t time_ns, const void* object) {
+        begin_event(name, category, 'B', tid);
+        m_out << ",\"ts\":";
+        write_us(time_ns);
+        end_event(object);
+    }
+
+    void complete(const char* name, const char* category, int tid, std::uint64_t begin_ns, std::uint64_t end_ns, const void* object) {
+        begin_event(name, category, 'X', tid);
+        m_out << ",\"ts\":";
+        write_us(begin_ns);
+        m_out << ",\"dur\":";
+        write_us(end_ns - begin_ns);
+        end_event(object);
+    }
+
+private:
+    void begin_event(const char* name, const char* category, char phase, int tid) {
+        m_out << (m_first ? "\n" : ",\n");
+        m_first = false;
+        m_out << "{\"name\":\"" << name << "\",\"cat\":\"" << category << "\",\"ph\":\"" << phase << "\""
+            << ",\"pid\":" << m_pid << ",\"tid\":" << tid;
+    }
+
+    void end_event(const void* object) {
+        m_out << ",\"args\":{\"object\":\"" << object << "\"}}";
+    }
+
+    void write_us(std::uint64_t ns) {
+        m_out << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000 << std::setfill(' ');
+    }
+
+    std::ostream& m_out;
+    bool m_first;
+    int m_pid;
+
+}; // class chrome_writer
+
+/*
+ * Pairs begin and end events of one thread into intervals:
+ * lock_wait..lock_acquired/lock_timeout, lock_acquired..lock_released,
+ * cv_wait..cv_wake and join_wait..join_done.
+ */
+class interval_builder {
+
+public:
+    interval_builder(chrome_writer& writer, int tid): m_writer(writer), m_tid(tid) {}
+
+    void add(const event& ev) {
+        switch(ev.type) {
+            case event_type::lock_wait:
+            case event_type::cv_wait:
+            case event_type::join_wait:
+                open(event_name(ev.type), ev);
+                break;
+            case event_type::lock_acquired:
+                close(event_name(event_type::lock_wait), ev, false);
+                open(hold_interval, ev);
+                break;
+            case event_type::lock_timeout:
+                close(event_name(event_type::lock_wait), ev, true);
+                break;
+            case event_type::lock_released:
+                close(hold_interval, ev, true);
+                break;
+            case event_type::cv_wake:
+                close(event_name(event_type::cv_wait), ev, true);
+                break;
+            case event_type::join_done:
+                close(event_name(event_type::join_wait), ev, true);
+                break;
+            default:
+                m_writer.instant(event_name(ev.type), event_category(ev.type), m_tid, ev.time_ns, ev.object);
+                break;
+        }
+    }
+
+    /*intervals still open, e.g. mutex held during flush*/
+    void finish() {
+        for(auto it = m_open.begin(); it != m_open.end(); ++it)
+            m_writer.begin(it->first.first, it->second.category, m_tid, it->second.begin_ns, it->first.second);
+        m_open.clear();
+    }
+
+private:
+    struct open_interval {
+        std::uint64_t begin_ns;
+        int depth; /*recursive locking: hold lasts from outermost lock*/
+        const char* category;
+    }; // struct open_interval
+
+    typedef std::pair<const char*, const void*> key_type;
+
+    void open(const char* name, const event& ev) {
+        auto res = m_open.insert(std::make_pair(key_type(name, ev.object), open_interval()));
+        if(res.second) {
+            res.first->second.begin_ns = ev.time_ns;
+            res.first->second.depth = 0;
+            res.first->second.category = event_category(ev.type);
+        }
+        ++res.first->second.depth;
+    }
+
+    /*end without begin (overwritten in ring or flushed earlier) is kept as instant, if asked*/
+    void close(const char* name, const event& ev, bool instant_if_unmatched) {
+        auto it = m_open.find(key_type(name, ev.object));
+        if(it == m_open.end()) {
+            if(instant_if_unmatched)
+                m_writer.instant(event_name(ev.type), event_category(ev.type), m_tid, ev.time_ns, ev.object);
+            return;
+        }
+        if(--it->second.depth != 0)
+            return;
+
+        m_writer.complete(name, it->second.category, m_tid, it->second.begin_ns, ev.time_ns, ev.object);
+        m_open.erase(it);
+    }
+
+    chrome_writer& m_writer;
+    int m_tid;
+    std::map<key_type, open_interval> m_open;
+
+}; // class interval_builder
+
+} // namespace
+
+#endif
+
+void flush(std::ostream& out) {
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+#ifdef CONCURRENCY_TRACING
+    chrome_writer writer(out);
+    /*concurrent flushes take disjoint events, buffers are not reused while being read*/
+    registry_lock locker;
+    for(detail::thread_buffer* buffer = s_buffers; buffer; buffer = buffer->m_next) {
+        if(buffer->m_name[0] != '\0')
+            writer.thread_name(buffer->m_tid, buffer->m_name);
+
+        std::vector<event> events = take_events(*buffer);
+        interval_builder builder(writer, buffer->m_tid);
+        for(std::size_t i = 0; i < events.size(); ++i)
+            builder.add(events[i]);
+        builder.finish();
+    }
+#endif
+
+    out << "\n]}" << std::endl;
+}
+
+void flush_to_file(const std::string& path) {
+    std::ofstream out(path.c_str());
+    if(!out)
+        throw std::runtime_error("trace::flush_to_file: can not open " + path);
+
+    flush(out);
+    if(!out)
+        throw std::runtime_error("trace::flush_to_file: can not write " + path);
+}
+
+} // namespace trace
+
+} // namespace concurrency
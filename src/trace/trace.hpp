@@ -0,0 +1,131 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include <time.h>
+
+/*
+ * Event tracing of lock waits/holds, condition variable waits and thread lifetimes,
+ * exported as Chrome trace event JSON (open with ui.perfetto.dev or chrome://tracing).
+ * Events are recorded only when library is built with CONCURRENCY_TRACING (cmake option of same name),
+ * otherwise CONCURRENCY_TRACE expands to nothing and flush writes empty trace.
+ * Every thread records into its own lock-free ring buffer, oldest events are overwritten when it is full.
+ */
+
+#ifndef CONCURRENCY_TRACE_BUFFER_EVENTS
+#define CONCURRENCY_TRACE_BUFFER_EVENTS 16384
+#endif
+
+#ifdef CONCURRENCY_TRACING
+#define CONCURRENCY_TRACE(type, object) \
+    ::concurrency::trace::record(::concurrency::trace::event_type::type, (object))
+#else
+#define CONCURRENCY_TRACE(type, object) ((void) 0)
+#endif
+
+namespace concurrency {
+
+namespace trace {
+
+enum class event_type : std::uint8_t {
+    lock_wait,      /*started to wait for mutex*/
+    lock_acquired,
+    lock_timeout,   /*timed wait for mutex gave up*/
+    lock_released,
+    cv_wait,        /*mutex is released, waiting for notification*/
+    cv_wake,
+    cv_notify_one,
+    cv_notify_all,
+    thread_create,  /*recorded by creating thread*/
+    thread_start,
+    thread_exit,
+    join_wait,
+    join_done
+}; // enum class event_type
+
+#ifdef CONCURRENCY_TRACING
+
+namespace detail {
+
+struct event_slot {
+    /*position of event in buffer plus one, zero while slot is being rewritten*/
+    std::atomic<std::uint64_t> m_seq;
+    std::atomic<std::uint64_t> m_time_ns;
+    std::atomic<const void*> m_object;
+    std::atomic<event_type> m_type;
+}; // struct event_slot
+
+/*
+ * Written only by owning thread, read by flushing thread. Every slot is guarded
+ * like seqlock, so reader drops events which were overwritten while it copied them.
+ * Buffers are never freed: buffer of exited thread is reused by new thread once its events
+ * were flushed, or, when too many exited threads wait for flush, events of oldest one are dropped.
+ */
+struct thread_buffer {
+    static const std::uint64_t capacity = CONCURRENCY_TRACE_BUFFER_EVENTS;
+    static_assert((capacity & (capacity - 1)) == 0, "trace buffer capacity must be power of two");
+
+    void record(event_type type, const void* object) {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        const std::uint64_t pos = m_head.load(std::memory_order_relaxed);
+        event_slot& slot = m_slots[pos & (capacity - 1)];
+
+        slot.m_seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.m_time_ns.store(static_cast<std::uint64_t>(now.tv_sec) * 1'000'000'000 + now.tv_nsec, std::memory_order_relaxed);
+        slot.m_object.store(object, std::memory_order_relaxed);
+        slot.m_type.store(type, std::memory_order_relaxed);
+        slot.m_seq.store(pos + 1, std::memory_order_release);
+
+        m_head.store(pos + 1, std::memory_order_release);
+    }
+
+    std::atomic<std::uint64_t> m_head;
+    /*following members are guarded by registry mutex (trace.cpp)*/
+    std::uint64_t m_flushed; /*events before this position were already flushed*/
+    int m_tid;
+    char m_name[16];
+    thread_buffer* m_next;
+    event_slot m_slots[capacity];
+}; // struct thread_buffer
+
+/*sets t_buffer of calling thread, it is reset and buffer is recycled when thread exits*/
+void register_thread_buffer(thread_buffer*& t_buffer);
+
+inline thread_buffer*
+this_thread_buffer() {
+    static thread_local thread_buffer* t_buffer = nullptr;
+    if(!t_buffer)
+        register_thread_buffer(t_buffer);
+    return t_buffer;
+}
+
+} // namespace detail
+
+inline void record(event_type type, const void* object) {
+    detail::this_thread_buffer()->record(type, object);
+}
+
+#endif
+
+/*
+ * Writes recorded events of all threads as Chrome trace JSON and drops them from buffers.
+ * Wait and hold intervals become complete ("X") events, intervals still open at flush become
+ * begin ("B") events, rest are instant events. Timestamps are CLOCK_MONOTONIC microseconds.
+ */
+void flush(std::ostream& out);
+
+/*throws std::runtime_error if file can not be written*/
+void flush_to_file(const std::string& path);
+
+} // namespace trace
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef CACHE_PADDED_H
+#define CACHE_PADDED_H
+
+#include <cstddef>
+#include <utility>
+
+namespace concurrency {
+
+/*assumed size of cache line (x86-64 and most aarch64 cores)*/
+inline constexpr std::size_t cache_line_size = 64;
+
+/*
+ * Value alone on its cache line(s): aligned to line and padded to whole lines,
+ * so that neighbours in array or struct written by other threads do not share a line with it.
+ */
+template<typename T>
+struct alignas(cache_line_size) cache_padded {
+    cache_padded(): value() {}
+
+    template<typename ...Args>
+    explicit cache_padded(Args&& ...args): value(std::forward<Args>(args)...) {}
+
+    T& operator*()
+    { return value; }
+
+    const T& operator*() const
+    { return value; }
+
+    T* operator->()
+    { return &value; }
+
+    const T* operator->() const
+    { return &value; }
+
+    T value;
+}; // struct cache_padded
+
+} // namespace concurrency
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <atomic>
+#include <climits>
+#include <ctime>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace concurrency::util {
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int),
+    "futex word must be plain 32-bit integer");
+
+/*block while *addr == expected, spurious wakeups are possible*/
+inline int futex_wait(std::atomic<int>* addr, int expected) {
+    return syscall(
+        SYS_futex, reinterpret_cast<int*>(addr),
+        FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0
+    );
+}
+
+/*
+ * block while *addr == expected, but not past abs_time measured against CLOCK_MONOTONIC;
+ * returns -1 with errno ETIMEDOUT on timeout
+ */
+inline int futex_wait_until(std::atomic<int>* addr, int expected, const timespec& abs_time) {
+    return syscall(
+        SYS_futex, reinterpret_cast<int*>(addr),
+        FUTEX_WAIT_BITSET_PRIVATE, expected, &abs_time, nullptr, FUTEX_BITSET_MATCH_ANY
+    );
+}
+
+/*wake at most count waiters blocked on addr*/
+inline int futex_wake(std::atomic<int>* addr, int count) {
+    return syscall(
+        SYS_futex, reinterpret_cast<int*>(addr),
+        FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0
+    );
+}
+
+inline int futex_wake_all(std::atomic<int>* addr)
+{ return futex_wake(addr, INT_MAX); }
+
+/*hint to cpu that caller is busy-waiting*/
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+} // namespace concurrency::util
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef TIMESPEC_H
+#define TIMESPEC_H
+
+#include <chrono>
+#include <ctime>
+
+namespace concurrency::util {
+
+/*
+ * Conversion of chrono time points to absolute CLOCK_MONOTONIC timespec,
+ * as expected by pthread_cond_timedwait (with monotonic condattr) and pthread_mutex_clocklock.
+ * std::chrono::steady_clock is CLOCK_MONOTONIC on Linux.
+ */
+template<typename Duration>
+inline timespec to_monotonic_timespec(
+    const std::chrono::time_point<std::chrono::steady_clock, Duration>& abs_time
+) {
+    /*coarse Duration (e.g. hours) near its max does not fit nanoseconds*/
+    std::chrono::nanoseconds since_epoch = std::chrono::nanoseconds::max();
+    if(std::chrono::duration<double>(abs_time.time_since_epoch()) < std::chrono::duration<double>(since_epoch))
+        since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(abs_time.time_since_epoch());
+    /*time point in the past, timeout immediately*/
+    if(since_epoch.count() < 0)
+        since_epoch = std::chrono::nanoseconds::zero();
+
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(since_epoch.count() / 1'000'000'000);
+    ts.tv_nsec = static_cast<long>(since_epoch.count() % 1'000'000'000);
+    return ts;
+}
+
+/*absolute steady_clock deadline after rel_time, saturating instead of overflowing*/
+template<typename Rep, typename Period>
+inline std::chrono::steady_clock::time_point deadline_after(
+    const std::chrono::duration<Rep, Period>& rel_time
+) {
+    typedef std::chrono::steady_clock::time_point time_point;
+    const time_point now = std::chrono::steady_clock::now();
+
+    if(rel_time <= rel_time.zero())
+        return now;
+    /*compare in floating point, so that e.g. hours::max() does not overflow nanoseconds*/
+    if(std::chrono::duration<double>(rel_time) >= std::chrono::duration<double>(time_point::max() - now))
+        return time_point::max();
+    return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(rel_time);
+}
+
+/*
+ * Time point of other clock as steady_clock one, by its offset from now.
+ * Saturates like deadline_after: offset is range-checked in floating point first,
+ * so that e.g. system_clock::time_point::max() maps to steady_clock::time_point::max().
+ */
+template<typename Clock, typename Duration>
+inline std::chrono::steady_clock::time_point to_steady_time_point(
+    const std::chrono::time_point<Clock, Duration>& abs_time
+) {
+    typedef std::chrono::steady_clock::time_point time_point;
+    const typename Clock::time_point clock_now = Clock::now();
+    const time_point now = std::chrono::steady_clock::now();
+
+    const std::chrono::duration<double> rel_time =
+        std::chrono::duration<double>(abs_time.time_since_epoch()) -
+        std::chrono::duration<double>(clock_now.time_since_epoch());
+    if(rel_time <= rel_time.zero())
+        return now;
+    if(rel_time >= std::chrono::duration<double>(time_point::max() - now))
+        return time_point::max();
+    /*
+     * Far coarse time point may not fit nanoseconds of clock_now, though offset does;
+     * such offset is taken from floating point, where nanosecond precision no longer matters.
+     */
+    if(rel_time >= std::chrono::hours(24))
+        return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(rel_time);
+    return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(abs_time - clock_now);
+}
+
+/*other clocks are mapped onto steady_clock by their offset from now*/
+template<typename Clock, typename Duration>
+inline timespec to_monotonic_timespec(
+    const std::chrono::time_point<Clock, Duration>& abs_time
+) { return to_monotonic_timespec(to_steady_time_point(abs_time)); }
+
+} // namespace concurrency::util
+
+#endif
@@ -2,23 +2,25 @@
 #define UTIL_H
 
 #include <string>
-
-#include <functional>
-#include "function.hpp"
+#include <stdexcept>
 
 namespace concurrency::util {
 
+/*
+ * Checks return value of native call, throws std::runtime_error on unexpected value.
+ * Holds only raw pointers (prefix is expected to be string literal or __FUNCTION__),
+ * so construction and successful check do not allocate.
+ * Error message is built only on failure path.
+ */
 template<typename func_retval_T>
 class try_call {
 
 public:
-    template<
-        typename Callable,
-        typename err_prefix_T
-    >
+    typedef std::string (*err_msg_gen_type)(const std::string&, func_retval_T);
+
     try_call(
-        err_prefix_T err_prefix,
-        Callable err_msg_gen
+        const char* err_prefix,
+        err_msg_gen_type err_msg_gen
     ):
         m_err_msg_gen(err_msg_gen),
         m_err_prefix(err_prefix)
@@ -27,18 +29,22 @@ public:
     func_retval_T operator()(
         func_retval_T retval,
         func_retval_T valid_val
-    ) {
-        if(retval != valid_val) {
-            std::string err_msg = m_err_msg_gen(m_err_prefix, retval);
-            throw std::runtime_error(err_msg);
-        }
+    ) const {
+        if(retval != valid_val)
+            throw_error(retval);
 
         return retval;
     }
 
 private:
-    typename func::function< std::string(std::string, func_retval_T) > m_err_msg_gen;
-    std::string m_err_prefix;
+    __attribute__((noinline, cold, noreturn))
+    void throw_error(func_retval_T retval) const {
+        std::string err_msg = m_err_msg_gen(m_err_prefix, retval);
+        throw std::runtime_error(err_msg);
+    }
+
+    err_msg_gen_type m_err_msg_gen;
+    const char* m_err_prefix;
 }; // class try_call
 
 } // namespace concurrency::util
@@ -0,0 +1,150 @@
+#include <catch2/catch_all.hpp>
+
+#include "parallel.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace concurrency {
+
+TEST_CASE("parallel_for: every index and element visited once", "[parallel]") {
+    work_stealing_pool pool(4);
+    const int size = 100'000;
+
+    std::vector<std::atomic<int> > visits(size);
+    parallel_for(pool, 0, size, [&visits] (int i) { ++visits[i]; });
+    REQUIRE(std::all_of(visits.begin(), visits.end(), [] (const std::atomic<int>& v) { return v == 1; }));
+
+    std::vector<int> values(size, 1);
+    parallel_for(pool, values.begin(), values.end(), [] (int& val) { val *= 3; });
+    REQUIRE(std::count(values.begin(), values.end(), 3) == size);
+
+    /*empty and reversed ranges do nothing*/
+    parallel_for(pool, 5, 5, [] (int) { throw std::logic_error("called"); });
+    parallel_for(pool, 5, 0, [] (int) { throw std::logic_error("called"); });
+
+    SECTION("default pool and negative indices") {
+        std::atomic<long> sum(0);
+        parallel_for(-1000, 1000, [&sum] (int i) { sum += i; });
+        REQUIRE(sum == -1000);
+    }
+
+    SECTION("exception is rethrown") {
+        REQUIRE_THROWS_AS(
+            parallel_for(pool, 0, size, [] (int i) { if(i == 777) throw std::logic_error("failed"); }),
+            std::logic_error
+        );
+    }
+
+    SECTION("called from pool task") {
+        std::atomic<long> sum(0);
+        std::atomic<bool> done(false);
+        pool.submit([&pool, &sum, &done] () {
+            parallel_for(pool, 0, 1000, [&pool, &sum] (int) {
+                parallel_for(pool, 0, 10, [&sum] (int i) { sum += i; });
+            });
+            done = true;
+        });
+        pool.run_until([&done] () { return done.load(); });
+        REQUIRE(sum == 45'000);
+    }
+}
+
+TEST_CASE("parallel_reduce: result matches sequential one", "[parallel]") {
+    work_stealing_pool pool(4);
+
+    std::vector<long> values(1'000'003);
+    std::iota(values.begin(), values.end(), 1);
+    REQUIRE(parallel_reduce(pool, values.begin(), values.end(), 5L, std::plus<long>())
+        == std::accumulate(values.begin(), values.end(), 5L));
+    REQUIRE(parallel_reduce(values.begin(), values.end(), 0L) == std::accumulate(values.begin(), values.end(), 0L));
+    REQUIRE(parallel_reduce(pool, values.begin(), values.begin(), 7L, std::plus<long>()) == 7);
+
+    /*concatenation is associative, not commutative: order of elements is kept*/
+    std::vector<std::string> words(5000);
+    for(std::size_t i = 0; i < words.size(); ++i)
+        words[i] = std::to_string(i % 10);
+    const std::string joined = parallel_reduce(pool, words.begin(), words.end(), std::string(">"),
+        [] (std::string lhs, const std::string& rhs) { return lhs + rhs; });
+    REQUIRE(joined == std::accumulate(words.begin(), words.end(), std::string(">")));
+}
+
+TEST_CASE("parallel_transform and parallel_scan: results match sequential ones", "[parallel]") {
+    work_stealing_pool pool(4);
+
+    std::vector<int> in(300'001);
+    std::iota(in.begin(), in.end(), -150'000);
+
+    std::vector<long> squares(in.size());
+    REQUIRE(parallel_transform(pool, in.begin(), in.end(), squares.begin(), [] (int val) { return long(val) * val; })
+        == squares.end());
+    for(std::size_t i = 0; i < in.size(); ++i)
+        REQUIRE(squares[i] == long(in[i]) * in[i]);
+
+    std::vector<long> expected(squares.size());
+    std::inclusive_scan(squares.begin(), squares.end(), expected.begin());
+
+    std::vector<long> scanned(squares.size());
+    REQUIRE(parallel_scan(pool, squares.begin(), squares.end(), scanned.begin(), std::plus<long>()) == scanned.end());
+    REQUIRE(scanned == expected);
+
+    /*in place, and short input*/
+    parallel_scan(squares.begin(), squares.end(), squares.begin());
+    REQUIRE(squares == expected);
+    std::vector<int> small = {3, 1, 2};
+    parallel_scan(small.begin(), small.end(), small.begin(), [] (int lhs, int rhs) { return std::max(lhs, rhs); });
+    REQUIRE(small == std::vector<int>({3, 3, 3}));
+}
+
+TEST_CASE("parallel_sort: sorts stably", "[parallel]") {
+    work_stealing_pool pool(4);
+    std::mt19937 rng(42);
+
+    for(std::size_t size : {0ul, 1ul, 1000ul, 100'000ul, 333'333ul}) {
+        /*keys repeat a lot, second member records original position*/
+        std::vector<std::pair<int, std::size_t> > values(size);
+        for(std::size_t i = 0; i < size; ++i)
+            values[i] = std::make_pair(static_cast<int>(rng() % 1000), i);
+
+        std::vector<std::pair<int, std::size_t> > expected = values;
+        std::stable_sort(expected.begin(), expected.end(),
+            [] (const std::pair<int, std::size_t>& lhs, const std::pair<int, std::size_t>& rhs) { return lhs.first < rhs.first; });
+
+        parallel_sort(pool, values.begin(), values.end(),
+            [] (const std::pair<int, std::size_t>& lhs, const std::pair<int, std::size_t>& rhs) { return lhs.first < rhs.first; });
+        REQUIRE(values == expected);
+    }
+
+    SECTION("move-only elements") {
+        std::vector<std::unique_ptr<int> > values;
+        for(int i = 0; i < 50'000; ++i)
+            values.push_back(std::make_unique<int>(static_cast<int>(rng() % 100'000)));
+        parallel_sort(values.begin(), values.end(),
+            [] (const std::unique_ptr<int>& lhs, const std::unique_ptr<int>& rhs) { return *lhs < *rhs; });
+        REQUIRE(std::is_sorted(values.begin(), values.end(),
+            [] (const std::unique_ptr<int>& lhs, const std::unique_ptr<int>& rhs) { return *lhs < *rhs; }));
+    }
+
+    SECTION("exception from comparison") {
+        std::vector<int> values(100'000);
+        std::iota(values.rbegin(), values.rend(), 0);
+        REQUIRE_THROWS_AS(
+            parallel_sort(pool, values.begin(), values.end(), [] (int lhs, int rhs) {
+                if(lhs == 4242)
+                    throw std::logic_error("failed");
+                return lhs < rhs;
+            }),
+            std::logic_error
+        );
+    }
+}
+
+} // namespace concurrency
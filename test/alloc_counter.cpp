@@ -0,0 +1,48 @@
+#include "alloc_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+/* Replacement of global allocation functions, counting allocations per thread */
+
+namespace {
+
+thread_local unsigned long allocation_count = 0;
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    ++allocation_count;
+    void* ptr = std::malloc(size ? size : 1);
+    if(!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace concurrency::test {
+
+unsigned long thread_allocation_count() {
+    return allocation_count;
+}
+
+} // namespace concurrency::test
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+namespace concurrency::test {
+
+/*number of heap allocations (global operator new) done by calling thread*/
+unsigned long thread_allocation_count();
+
+} // namespace concurrency::test
+
+#endif
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include <catch2/catch_all.hpp>
+
+#include "latch.hpp"
+#include "barrier.hpp"
+#include "thread.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace concurrency {
+
+TEST_CASE("latch: count_down and wait", "[latch]") {
+    REQUIRE_THROWS(latch(-1));
+
+    SECTION("single thread") {
+        latch done(3);
+        REQUIRE(done.try_wait() == false);
+        REQUIRE_NOTHROW(done.count_down());
+        REQUIRE_NOTHROW(done.count_down(2));
+        REQUIRE(done.try_wait() == true);
+        REQUIRE_NOTHROW(done.wait());
+        REQUIRE_THROWS(done.count_down());
+
+        latch empty(0);
+        REQUIRE(empty.try_wait() == true);
+    }
+
+    SECTION("workers ready before start") {
+        /*ready counter + ready_mutex + ready_cv of condition_var_test, as latches*/
+        const int workers_num = 4;
+        latch ready(workers_num);
+        latch start(1);
+        std::atomic<int> started(0);
+        {
+            std::vector<jthread> workers;
+            for(int i = 0; i < workers_num; ++i)
+                workers.push_back(jthread([&ready, &start, &started] () {
+                    ready.count_down();
+                    start.wait();
+                    ++started;
+                }));
+
+            ready.wait();
+            REQUIRE(started == 0);
+            start.count_down();
+        }
+        REQUIRE(started == workers_num);
+    }
+
+    SECTION("arrive_and_wait") {
+        const int threads_num = 8;
+        latch all_there(threads_num);
+        std::atomic<int> arrived(0);
+        bool everyone_arrived = true;
+        {
+            std::vector<jthread> threads;
+            for(int i = 0; i < threads_num; ++i)
+                threads.push_back(jthread([&all_there, &arrived, &everyone_arrived, threads_num] () {
+                    ++arrived;
+                    all_there.arrive_and_wait();
+                    if(arrived != threads_num)
+                        everyone_arrived = false;
+                }));
+        }
+        REQUIRE(everyone_arrived == true);
+    }
+}
+
+void barrier_phases(barrier_mode mode, int threads_num, int phases) {
+    int completions = 0;
+    std::vector<int> phase_of(threads_num, 0);
+    bool in_step = true;
+
+    /*completion runs once per phase, while every participant is blocked*/
+    barrier sync_point(threads_num, [&completions, &phase_of, &in_step] () {
+        for(std::size_t i = 0; i < phase_of.size(); ++i)
+            if(phase_of[i] != completions + 1)
+                in_step = false;
+        ++completions;
+    }, mode);
+    REQUIRE(sync_point.mode() == mode);
+
+    {
+        std::vector<jthread> threads;
+        for(int t = 0; t < threads_num; ++t)
+            threads.push_back(jthread([&sync_point, &phase_of, t, phases] () {
+                for(int phase = 0; phase < phases; ++phase) {
+                    ++phase_of[t];
+                    sync_point.arrive_and_wait();
+                }
+            }));
+    }
+
+    REQUIRE(completions == phases);
+    REQUIRE(in_step == true);
+}
+
+TEST_CASE("barrier: phases and completion function", "[barrier]") {
+    REQUIRE_THROWS(barrier(-1));
+
+    SECTION("central") {
+        barrier_phases(barrier_mode::central, 1, 10);
+        barrier_phases(barrier_mode::central, 4, 1'000);
+        barrier_phases(barrier_mode::central, 16, 200);
+    }
+
+    SECTION("combining_tree") {
+        barrier_phases(barrier_mode::combining_tree, 1, 10);
+        barrier_phases(barrier_mode::combining_tree, 4, 1'000);
+        barrier_phases(barrier_mode::combining_tree, 7, 500);
+        barrier_phases(barrier_mode::combining_tree, 37, 100);
+    }
+}
+
+TEST_CASE("barrier: arrive, wait and arrive_and_drop", "[barrier]") {
+    barrier_mode mode = GENERATE(barrier_mode::central, barrier_mode::combining_tree);
+
+    SECTION("split arrive and wait") {
+        barrier sync_point(2, mode);
+        barrier::arrival_token token = sync_point.arrive();
+        bool other_arrived = false;
+        {
+            jthread other([&sync_point, &other_arrived] () {
+                other_arrived = true;
+                sync_point.arrive_and_wait();
+            });
+            sync_point.wait(std::move(token));
+        }
+        REQUIRE(other_arrived == true);
+
+        /*single participant arriving twice completes phase*/
+        REQUIRE_NOTHROW(sync_point.wait(sync_point.arrive(2)));
+        REQUIRE_THROWS(sync_point.arrive(0));
+    }
+
+    SECTION("dropping participants") {
+        const int threads_num = 6;
+        const int phases = 100;
+        int completions = 0;
+        barrier sync_point(threads_num, [&completions] () { ++completions; }, mode);
+        {
+            std::vector<jthread> threads;
+            for(int t = 0; t < threads_num; ++t)
+                threads.push_back(jthread([&sync_point, t, phases] () {
+                    /*thread t leaves after t phases*/
+                    for(int phase = 0; phase < phases; ++phase) {
+                        if(phase == t && t % 2 == 1) {
+                            sync_point.arrive_and_drop();
+                            return;
+                        }
+                        sync_point.arrive_and_wait();
+                    }
+                }));
+        }
+        REQUIRE(completions == phases);
+    }
+}
+
+TEST_CASE("barrier: more arrivals than expected", "[barrier]") {
+    barrier sync_point(2, barrier_mode::central);
+    REQUIRE_THROWS(sync_point.arrive(3));
+
+    barrier empty_tree(0, barrier_mode::combining_tree);
+    REQUIRE_THROWS(empty_tree.arrive());
+}
+
+} // namespace concurrency
\ No newline at end of file
@@ -1,11 +1,17 @@
 #include <catch2/catch_all.hpp>
 
 #include <iostream>
+#include <chrono>
+#include <atomic>
+#include <thread>
 
 #include "condition_variable.hpp"
 
 #include "thread.hpp"
 #include "mutex.hpp"
+#include "futex_mutex.hpp"
+
+#include "alloc_counter.hpp"
 
 namespace concurrency {
 
@@ -196,4 +202,222 @@ TEST_CASE("condition_variable: creation and deletion", "[condition_variable]") {
 
 }
 
+TEST_CASE("condition_variable_any: futex_mutex handshake", "[condition_variable]") {
+    const int rounds = 1000;
+
+    int turn = 0; /*even - ping, odd - pong*/
+    futex_mutex turn_mutex;
+    condition_variable_any turn_cv;
+
+    auto pong = [&turn, &turn_mutex, &turn_cv] () {
+        for(int i = 0; i < rounds; ++i) {
+            unique_lock<futex_mutex> locker(turn_mutex);
+            turn_cv.wait(locker, [&turn] () { return turn % 2 == 1; });
+            ++turn;
+            turn_cv.notify_all();
+        }
+    };
+
+    {
+        jthread pong_worker(pong);
+
+        for(int i = 0; i < rounds; ++i) {
+            unique_lock<futex_mutex> locker(turn_mutex);
+            turn_cv.wait(locker, [&turn] () { return turn % 2 == 0; });
+            ++turn;
+            turn_cv.notify_all();
+        }
+    }
+
+    REQUIRE(turn == 2 * rounds);
+}
+
+TEST_CASE("condition_variable: notify and wait do not allocate", "[condition_variable]") {
+    const int rounds = 100;
+
+    int turn = 0; /*even - ping, odd - pong*/
+    mutex turn_mutex;
+    condition_variable turn_cv;
+
+    unsigned long pong_allocations = 0;
+
+    auto pong = [&turn, &turn_mutex, &turn_cv, &pong_allocations] () {
+        unique_lock<mutex> locker(turn_mutex);
+        const unsigned long before = test::thread_allocation_count();
+        for(int i = 0; i < rounds; ++i) {
+            turn_cv.wait(locker, [&turn] () { return turn % 2 == 1; });
+            ++turn;
+            turn_cv.notify_one();
+        }
+        pong_allocations = test::thread_allocation_count() - before;
+    };
+
+    unsigned long ping_allocations = 0;
+    {
+        jthread pong_worker(pong);
+
+        unique_lock<mutex> locker(turn_mutex);
+        const unsigned long before = test::thread_allocation_count();
+        for(int i = 0; i < rounds; ++i) {
+            ++turn;
+            turn_cv.notify_all();
+            turn_cv.wait(locker, [&turn] () { return turn % 2 == 0; });
+        }
+        ping_allocations = test::thread_allocation_count() - before;
+    }
+
+    REQUIRE(turn == 2 * rounds);
+    REQUIRE(ping_allocations == 0);
+    REQUIRE(pong_allocations == 0);
+}
+
+TEST_CASE("condition_variable: wait_for and wait_until", "[condition_variable]") {
+    using namespace std::chrono;
+
+    bool flag = false;
+    mutex flag_mutex;
+    condition_variable flag_cv;
+
+    SECTION("timeout") {
+        unique_lock<mutex> locker(flag_mutex);
+
+        steady_clock::time_point start = steady_clock::now();
+        REQUIRE(flag_cv.wait_for(locker, milliseconds(20)) == cv_status::timeout);
+        REQUIRE(steady_clock::now() - start >= milliseconds(20));
+        REQUIRE(locker.owns_lock() == true);
+
+        REQUIRE(flag_cv.wait_until(locker, steady_clock::now() + milliseconds(5)) == cv_status::timeout);
+        REQUIRE(flag_cv.wait_until(locker, system_clock::now() + milliseconds(5)) == cv_status::timeout);
+        REQUIRE(flag_cv.wait_for(locker, milliseconds(5), [&flag] () { return flag; }) == false);
+        /*deadline in the past*/
+        REQUIRE(flag_cv.wait_for(locker, milliseconds(-5)) == cv_status::timeout);
+    }
+
+    SECTION("notified before timeout") {
+        bool result = false;
+        {
+            jthread waiter([&flag, &flag_mutex, &flag_cv, &result] () {
+                unique_lock<mutex> locker(flag_mutex);
+                result = flag_cv.wait_for(locker, seconds(10), [&flag] () { return flag; });
+            });
+
+            lock_guard<mutex> locker(flag_mutex);
+            flag = true;
+            flag_cv.notify_one();
+        }
+        REQUIRE(result == true);
+    }
+
+    SECTION("far deadlines of any clock do not overflow into timeout") {
+        std::atomic<int> wakeups(0);
+        bool result = false;
+        {
+            jthread waiter([&] () {
+                unique_lock<mutex> locker(flag_mutex);
+                result = flag_cv.wait_until(locker, time_point<system_clock, seconds>::max(), [&] () {
+                    ++wakeups;
+                    return flag;
+                });
+            });
+
+            std::this_thread::sleep_for(milliseconds(20));
+            lock_guard<mutex> locker(flag_mutex);
+            flag = true;
+            flag_cv.notify_one();
+        }
+        REQUIRE(result == true);
+        /*waiter slept instead of spinning on immediate timeouts*/
+        REQUIRE(wakeups < 10);
+
+        /*coarse deadline below saturation limit, though its offset does not fit nanoseconds*/
+        bool woken = false;
+        result = false;
+        {
+            jthread waiter([&] () {
+                unique_lock<mutex> locker(flag_mutex);
+                result = flag_cv.wait_until(
+                    locker, time_point_cast<hours>(system_clock::now()) + hours(24 * 365 * 250),
+                    [&woken] () { return woken; }
+                );
+            });
+
+            std::this_thread::sleep_for(milliseconds(20));
+            lock_guard<mutex> locker(flag_mutex);
+            woken = true;
+            flag_cv.notify_one();
+        }
+        REQUIRE(result == true);
+
+        unique_lock<mutex> locker(flag_mutex);
+        REQUIRE(flag_cv.wait_until(locker, time_point<steady_clock, hours>::max(), [&flag] () { return flag; }) == true);
+    }
+}
+
+TEST_CASE("condition_variable_any: wait_for with futex_mutex", "[condition_variable]") {
+    using namespace std::chrono;
+
+    bool flag = false;
+    futex_mutex flag_mutex;
+    condition_variable_any flag_cv;
+
+    {
+        unique_lock<futex_mutex> locker(flag_mutex);
+        REQUIRE(flag_cv.wait_for(locker, milliseconds(10)) == cv_status::timeout);
+        REQUIRE(flag_cv.wait_for(locker, milliseconds(10), [&flag] () { return flag; }) == false);
+        REQUIRE(locker.owns_lock() == true);
+    }
+
+    bool result = false;
+    {
+        jthread waiter([&flag, &flag_mutex, &flag_cv, &result] () {
+            unique_lock<futex_mutex> locker(flag_mutex);
+            result = flag_cv.wait_until(locker, steady_clock::now() + seconds(10), [&flag] () { return flag; });
+        });
+
+        lock_guard<futex_mutex> locker(flag_mutex);
+        flag = true;
+        flag_cv.notify_all();
+    }
+    REQUIRE(result == true);
+}
+
+TEST_CASE("condition_variable_any: wait interrupted by stop request", "[condition_variable][stop_token]") {
+    using namespace std::chrono;
+
+    bool flag = false;
+    mutex flag_mutex;
+    condition_variable_any flag_cv;
+
+    bool result = true;
+    {
+        jthread waiter([&flag, &flag_mutex, &flag_cv, &result] (stop_token token) {
+            unique_lock<mutex> locker(flag_mutex);
+            /*nobody ever sets flag*/
+            result = flag_cv.wait(locker, token, [&flag] () { return flag; });
+        });
+    } /*jthread destructor requests stop and joins*/
+    REQUIRE(result == false);
+
+    {
+        jthread waiter([&flag, &flag_mutex, &flag_cv, &result] (stop_token token) {
+            unique_lock<mutex> locker(flag_mutex);
+            result = flag_cv.wait_for(locker, token, seconds(10), [&flag] () { return flag; });
+        });
+
+        lock_guard<mutex> locker(flag_mutex);
+        flag = true;
+        flag_cv.notify_all();
+    }
+    REQUIRE(result == true);
+
+    {
+        stop_source source;
+        unique_lock<mutex> locker(flag_mutex);
+        flag = false;
+        REQUIRE(flag_cv.wait_for(locker, source.get_token(), milliseconds(10), [&flag] () { return flag; }) == false);
+        source.request_stop();
+        REQUIRE(flag_cv.wait(locker, source.get_token(), [&flag] () { return flag; }) == false);
+    }
+}
+
 } // namespace concurrency
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include <catch2/catch_all.hpp>
+
+#include "task.hpp"
+#include "async_mutex.hpp"
+#include "async_event.hpp"
+#include "async_semaphore.hpp"
+#include "thread.hpp"
+#include "thread_pool.hpp"
+#include "work_stealing_pool.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace concurrency {
+
+/*starts spawned task on calling thread, it runs until its first suspension*/
+struct current_thread_executor {
+    template<typename Callable>
+    void submit(Callable callb)
+    { callb(); }
+}; // struct current_thread_executor
+
+static task<int> coro_value(int val)
+{ co_return val; }
+
+static task<int> coro_sum(int count) {
+    int sum = 0;
+    for(int i = 1; i <= count; ++i)
+        sum += co_await coro_value(i);
+    co_return sum;
+}
+
+static task<void> coro_fail()
+{ throw std::logic_error("failed"); co_return; }
+
+TEST_CASE("coro: task results and exceptions", "[coro]") {
+    REQUIRE(sync_wait(coro_value(5)) == 5);
+    REQUIRE(sync_wait(coro_sum(100)) == 5050);
+    REQUIRE_THROWS_AS(sync_wait(coro_fail()), std::logic_error);
+
+    /*long chain of nested awaits completes synchronously without growing stack*/
+    REQUIRE(sync_wait(coro_sum(1'000'000)) > 0);
+
+    task<int> lazy = coro_value(1);
+    REQUIRE(lazy.valid() == true);
+    task<int> moved = std::move(lazy);
+    REQUIRE(lazy.valid() == false);
+    REQUIRE(sync_wait(std::move(moved)) == 1);
+}
+
+TEST_CASE("coro: tasks scheduled on executors", "[coro]") {
+    thread_pool pool(2);
+    const thread::native_handle_type caller = this_thread::get_native_id();
+
+    auto on_pool = [&pool] () -> task<thread::native_handle_type> {
+        co_await schedule(pool);
+        co_return this_thread::get_native_id();
+    };
+    REQUIRE(sync_wait(on_pool()) != caller);
+
+    SECTION("spawn delivers result through future") {
+        work_stealing_pool stealing_pool(2);
+
+        std::vector<future<int> > results;
+        for(int i = 0; i < 100; ++i)
+            results.push_back(spawn(stealing_pool, coro_sum(i)));
+
+        int total = 0;
+        std::vector<future<int> > done = when_all(results.begin(), results.end()).get();
+        for(std::size_t i = 0; i < done.size(); ++i)
+            total += done[i].get();
+        REQUIRE(total == 166'650);
+
+        REQUIRE_THROWS_AS(spawn(stealing_pool, coro_fail()).get(), std::logic_error);
+    }
+
+    SECTION("executor refusing task") {
+        pool.shutdown();
+        REQUIRE_THROWS_AS(spawn(pool, coro_value(1)).get(), std::runtime_error);
+    }
+}
+
+TEST_CASE("coro: async_event", "[coro]") {
+    current_thread_executor executor;
+    async_event event;
+    REQUIRE(event.is_set() == false);
+
+    int resumed = 0;
+    auto waiter = [&event, &resumed] () -> task<void> {
+        co_await event;
+        ++resumed;
+    };
+
+    std::vector<future<void> > waiters;
+    for(int i = 0; i < 3; ++i)
+        waiters.push_back(spawn(executor, waiter()));
+    REQUIRE(resumed == 0);
+
+    event.set();
+    REQUIRE(resumed == 3);
+    REQUIRE(event.is_set() == true);
+
+    /*set event does not suspend*/
+    spawn(executor, waiter()).get();
+    REQUIRE(resumed == 4);
+
+    event.reset();
+    REQUIRE(event.is_set() == false);
+    future<void> last = spawn(executor, waiter());
+    REQUIRE(last.is_ready() == false);
+    {
+        jthread setter([&event] () { event.set(); });
+    }
+    REQUIRE_NOTHROW(last.get());
+    REQUIRE(resumed == 5);
+
+    REQUIRE(async_event(true).is_set() == true);
+}
+
+TEST_CASE("coro: async_mutex", "[coro]") {
+    SECTION("lock is granted in arrival order") {
+        current_thread_executor executor;
+        async_mutex mut;
+        REQUIRE(mut.try_lock() == true);
+        REQUIRE(mut.try_lock() == false);
+
+        std::vector<int> order;
+        auto locker = [&mut, &order] (int id) -> task<void> {
+            async_lock_guard guard = co_await mut.scoped_lock();
+            order.push_back(id);
+        };
+
+        std::vector<future<void> > lockers;
+        for(int i = 0; i < 4; ++i)
+            lockers.push_back(spawn(executor, locker(i)));
+        REQUIRE(order.empty());
+
+        /*every waiter runs and unlocks on this thread*/
+        mut.unlock();
+        REQUIRE(order == std::vector<int>({0, 1, 2, 3}));
+        REQUIRE(mut.try_lock() == true);
+        mut.unlock();
+    }
+
+    SECTION("long chain of handovers does not grow stack") {
+        current_thread_executor executor;
+        async_mutex mut;
+        REQUIRE(mut.try_lock() == true);
+
+        const int waiters = 10'000;
+        int entered = 0;
+        /*stack frames of resumed coroutines stay at same depth*/
+        const char* lowest = nullptr;
+        const char* highest = nullptr;
+        auto locker = [&mut, &entered, &lowest, &highest] () -> task<void> {
+            async_lock_guard guard = co_await mut.scoped_lock();
+            const char* frame = static_cast<const char*>(__builtin_frame_address(0));
+            if(!lowest || frame < lowest)
+                lowest = frame;
+            if(!highest || frame > highest)
+                highest = frame;
+            ++entered;
+        };
+
+        std::vector<future<void> > lockers;
+        lockers.reserve(waiters);
+        for(int i = 0; i < waiters; ++i)
+            lockers.push_back(spawn(executor, locker()));
+
+        /*every guard unlocks while its coroutine is being resumed by previous unlock*/
+        mut.unlock();
+        REQUIRE(entered == waiters);
+        REQUIRE(highest - lowest < 4096);
+        REQUIRE(mut.try_lock() == true);
+        mut.unlock();
+    }
+
+    SECTION("mutual exclusion of coroutines on pool") {
+        const int flows = 1000;
+        const int increments = 100;
+        work_stealing_pool pool(4);
+        async_mutex mut;
+        long counter = 0;
+
+        auto flow = [&pool, &mut, &counter] () -> task<void> {
+            for(int i = 0; i < increments; ++i) {
+                co_await mut.lock();
+                long tmp = counter;
+                /*give others chance to pile up behind lock*/
+                if(i % 10 == 0)
+                    co_await schedule(pool);
+                counter = tmp + 1;
+                mut.unlock();
+            }
+        };
+
+        std::vector<future<void> > results;
+        for(int i = 0; i < flows; ++i)
+            results.push_back(spawn(pool, flow()));
+        for(std::size_t i = 0; i < results.size(); ++i)
+            results[i].get();
+
+        REQUIRE(counter == static_cast<long>(flows) * increments);
+    }
+}
+
+TEST_CASE("coro: async_semaphore", "[coro]") {
+    REQUIRE_THROWS_AS(async_semaphore(-1), std::invalid_argument);
+
+    SECTION("permits bound number of running coroutines") {
+        current_thread_executor executor;
+        async_semaphore sem(2);
+        int running = 0;
+
+        auto user = [&sem, &running] () -> task<void> {
+            co_await sem.acquire();
+            ++running;
+        };
+
+        std::vector<future<void> > users;
+        for(int i = 0; i < 5; ++i)
+            users.push_back(spawn(executor, user()));
+        REQUIRE(running == 2);
+        REQUIRE(sem.available() == 0);
+
+        sem.release();
+        REQUIRE(running == 3);
+        sem.release(5);
+        REQUIRE(running == 5);
+        REQUIRE(sem.available() == 3);
+        REQUIRE(sem.try_acquire() == true);
+        REQUIRE(sem.available() == 2);
+    }
+
+    SECTION("coroutines on pool sharing permits") {
+        const int flows = 500;
+        work_stealing_pool pool(4);
+        async_semaphore sem(3);
+        std::atomic<int> inside(0);
+        std::atomic<int> max_inside(0);
+
+        auto flow = [&pool, &sem, &inside, &max_inside] () -> task<void> {
+            co_await sem.acquire();
+            int now = ++inside;
+            int prev = max_inside.load();
+            while(prev < now && !max_inside.compare_exchange_weak(prev, now))
+                ;
+            co_await schedule(pool);
+            --inside;
+            sem.release();
+        };
+
+        std::vector<future<void> > results;
+        for(int i = 0; i < flows; ++i)
+            results.push_back(spawn(pool, flow()));
+        for(std::size_t i = 0; i < results.size(); ++i)
+            results[i].get();
+
+        REQUIRE(max_inside.load() <= 3);
+        REQUIRE(sem.available() == 3);
+    }
+}
+
+} // namespace concurrency
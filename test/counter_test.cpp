@@ -0,0 +1,103 @@
+#include <catch2/catch_all.hpp>
+
+#include "sharded_counter.hpp"
+#include "cache_padded.hpp"
+#include "thread.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace concurrency {
+
+static_assert(alignof(cache_padded<char>) == cache_line_size, "cache_padded is aligned to cache line");
+static_assert(sizeof(cache_padded<char>) == cache_line_size, "cache_padded takes whole line");
+static_assert(sizeof(cache_padded<char[100]>) == 2 * cache_line_size, "cache_padded is padded to whole lines");
+
+TEST_CASE("cache_padded: elements of array do not share lines", "[sharded_counter]") {
+    std::vector<cache_padded<std::atomic<int> > > values(4);
+    for(std::size_t i = 0; i < values.size(); ++i) {
+        REQUIRE(reinterpret_cast<std::uintptr_t>(&*values[i]) % cache_line_size == 0);
+        REQUIRE(values[i]->load() == 0);
+    }
+
+    cache_padded<std::vector<int> > padded(3, 7);
+    REQUIRE(padded->size() == 3);
+    REQUIRE((*padded)[2] == 7);
+}
+
+TEST_CASE("sharded_counter: concurrent adds are all counted", "[sharded_counter]") {
+    const int threads_num = 8;
+    const int iterations = 100'000;
+
+    /*fewer shards than threads: shared shards stay exact*/
+    for(unsigned shards_num : {0u, 3u, 16u}) {
+        sharded_counter<long> counter(shards_num);
+        sharded_sum<double> sum(shards_num);
+        sharded_min<int> min(shards_num);
+        sharded_max<int> max(shards_num);
+        REQUIRE(counter.shards_num() >= 1);
+        REQUIRE(min.load() == std::numeric_limits<int>::max());
+        REQUIRE(max.load() == std::numeric_limits<int>::lowest());
+        {
+            std::vector<jthread> threads;
+            for(int t = 0; t < threads_num; ++t)
+                threads.emplace_back([&, t] () {
+                    for(int i = 0; i < iterations; ++i) {
+                        counter.increment();
+                        sum.add(0.5);
+                        min.update(-(t * iterations + i));
+                        max.update(t * iterations + i);
+                    }
+                    counter.add(10);
+                    counter.decrement();
+                });
+        }
+
+        REQUIRE(counter.load() == threads_num * (iterations + 9L));
+        REQUIRE(sum.load() == threads_num * iterations * 0.5);
+        REQUIRE(min.load() == -(threads_num * iterations - 1));
+        REQUIRE(max.load() == threads_num * iterations - 1);
+
+        REQUIRE(counter.reset() == threads_num * (iterations + 9L));
+        REQUIRE(counter.load() == 0);
+        REQUIRE(min.reset() == -(threads_num * iterations - 1));
+        REQUIRE(min.load() == std::numeric_limits<int>::max());
+    }
+}
+
+TEST_CASE("sharded_histogram: samples fall into buckets by upper bounds", "[sharded_counter]") {
+    REQUIRE_THROWS_AS(sharded_histogram<int>({1, 5, 5}), std::invalid_argument);
+
+    /*more buckets than counts on one cache line*/
+    std::vector<int> bounds;
+    for(int bound = 10; bound <= 200; bound += 10)
+        bounds.push_back(bound);
+    sharded_histogram<int> histogram(bounds, 4);
+    REQUIRE(histogram.buckets_num() == bounds.size() + 1);
+
+    const int threads_num = 4;
+    {
+        std::vector<jthread> threads;
+        for(int t = 0; t < threads_num; ++t)
+            threads.emplace_back([&histogram] () {
+                for(int val = 1; val <= 250; ++val)
+                    histogram.record(val);
+            });
+    }
+
+    std::vector<std::uint64_t> counts = histogram.counts();
+    REQUIRE(counts.size() == bounds.size() + 1);
+    /*(0, 10], (10, 20], ... hold ten values each, above 200 - fifty*/
+    for(std::size_t bucket = 0; bucket < bounds.size(); ++bucket)
+        REQUIRE(counts[bucket] == 10u * threads_num);
+    REQUIRE(counts.back() == 50u * threads_num);
+    REQUIRE(histogram.count() == 250u * threads_num);
+
+    REQUIRE(histogram.reset() == counts);
+    REQUIRE(histogram.count() == 0);
+}
+
+} // namespace concurrency
@@ -0,0 +1,358 @@
+#include <catch2/catch_all.hpp>
+
+#include "future.hpp"
+#include "thread.hpp"
+#include "thread_pool.hpp"
+#include "work_stealing_pool.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace concurrency {
+
+TEST_CASE("future: value and exception passed through promise", "[future]") {
+    SECTION("value set before get") {
+        promise<std::string> prom;
+        future<std::string> fut = prom.get_future();
+        REQUIRE(fut.valid() == true);
+        REQUIRE(fut.is_ready() == false);
+
+        prom.set_value("result");
+        REQUIRE(fut.is_ready() == true);
+        REQUIRE(fut.get() == "result");
+        REQUIRE(fut.valid() == false);
+        REQUIRE_THROWS_AS(fut.get(), std::runtime_error);
+    }
+
+    SECTION("value set by other thread") {
+        promise<int> prom;
+        future<int> fut = prom.get_future();
+
+        jthread producer([&prom] () {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            prom.set_value(42);
+        });
+        REQUIRE(fut.get() == 42);
+    }
+
+    SECTION("move-only value") {
+        promise<std::unique_ptr<int> > prom;
+        future<std::unique_ptr<int> > fut = prom.get_future();
+        prom.set_value(std::make_unique<int>(7));
+        REQUIRE(*fut.get() == 7);
+    }
+
+    SECTION("exception") {
+        promise<void> prom;
+        future<void> fut = prom.get_future();
+        prom.set_exception(std::make_exception_ptr(std::logic_error("failed")));
+        REQUIRE_THROWS_AS(fut.get(), std::logic_error);
+    }
+
+    SECTION("broken promise") {
+        future<int> fut;
+        {
+            promise<int> prom;
+            fut = prom.get_future();
+        }
+        REQUIRE(fut.is_ready() == true);
+        REQUIRE_THROWS_AS(fut.get(), std::runtime_error);
+    }
+
+    SECTION("misuse") {
+        promise<int> prom;
+        future<int> fut = prom.get_future();
+        REQUIRE_THROWS_AS(prom.get_future(), std::runtime_error);
+
+        prom.set_value(1);
+        REQUIRE_THROWS_AS(prom.set_value(2), std::runtime_error);
+        REQUIRE_THROWS_AS(prom.set_exception(std::make_exception_ptr(1)), std::runtime_error);
+        REQUIRE(fut.get() == 1);
+
+        promise<int> moved(std::move(prom));
+        REQUIRE_THROWS_AS(prom.set_value(3), std::runtime_error);
+        REQUIRE_THROWS_AS(future<int>().wait(), std::runtime_error);
+    }
+}
+
+TEST_CASE("future: promise may be destroyed once future is ready", "[future]") {
+    const int rounds = 2000;
+    std::atomic<promise<int>*> current(nullptr);
+    int received = 0;
+
+    jthread producer([&current, rounds] () {
+        for(int i = 0; i < rounds; ++i) {
+            promise<int>* prom;
+            while(!(prom = current.exchange(nullptr, std::memory_order_acquire)))
+                std::this_thread::yield();
+            prom->set_value(1);
+        }
+    });
+
+    for(int i = 0; i < rounds; ++i) {
+        /*producer may still be inside set_value when promise goes away*/
+        promise<int> prom;
+        future<int> fut = prom.get_future();
+        current.store(&prom, std::memory_order_release);
+        received += fut.get();
+    }
+    REQUIRE(received == rounds);
+}
+
+TEST_CASE("future: timed waits", "[future]") {
+    using namespace std::chrono;
+
+    promise<int> prom;
+    future<int> fut = prom.get_future();
+
+    REQUIRE(fut.wait_for(milliseconds(10)) == future_status::timeout);
+    REQUIRE(fut.wait_until(steady_clock::now() + milliseconds(10)) == future_status::timeout);
+    REQUIRE(fut.wait_until(system_clock::now() - milliseconds(10)) == future_status::timeout);
+
+    jthread producer([&prom] () {
+        std::this_thread::sleep_for(milliseconds(5));
+        prom.set_value(1);
+    });
+    REQUIRE(fut.wait_for(seconds(10)) == future_status::ready);
+    REQUIRE(fut.wait_for(milliseconds(0)) == future_status::ready);
+}
+
+TEST_CASE("future: get of completed future does not allocate", "[future]") {
+    promise<int> prom;
+    future<int> fut = prom.get_future();
+    prom.set_value(5);
+
+    const unsigned long before = test::thread_allocation_count();
+    const int val = fut.get();
+    REQUIRE(test::thread_allocation_count() == before);
+    REQUIRE(val == 5);
+}
+
+TEST_CASE("future: shared_future", "[future]") {
+    promise<int> prom;
+    shared_future<int> shared = prom.get_future().share();
+    shared_future<int> copy = shared;
+
+    std::vector<int> results(4, 0);
+    {
+        std::vector<jthread> readers;
+        for(std::size_t i = 0; i < results.size(); ++i)
+            readers.emplace_back([copy, &results, i] () { results[i] = copy.get(); });
+
+        prom.set_value(3);
+    }
+
+    REQUIRE(results == std::vector<int>(4, 3));
+    REQUIRE(shared.get() == 3);
+    REQUIRE(shared.valid() == true);
+}
+
+TEST_CASE("future: packaged_task", "[future]") {
+    SECTION("result and exception") {
+        packaged_task<int(int, int)> task([] (int a, int b) { return a + b; });
+        future<int> fut = task.get_future();
+        REQUIRE_THROWS_AS(task.get_future(), std::runtime_error);
+
+        jthread worker(std::move(task), 2, 3);
+        REQUIRE(fut.get() == 5);
+
+        packaged_task<void()> failing([] () { throw std::logic_error("failed"); });
+        future<void> failed = failing.get_future();
+        failing();
+        REQUIRE_THROWS_AS(failing(), std::runtime_error);
+        REQUIRE_THROWS_AS(failed.get(), std::logic_error);
+    }
+
+    SECTION("not invoked task breaks promise") {
+        future<void> fut;
+        {
+            packaged_task<void()> task([] () {});
+            fut = task.get_future();
+        }
+        REQUIRE_THROWS_AS(fut.get(), std::runtime_error);
+        REQUIRE(packaged_task<void()>().valid() == false);
+    }
+
+    SECTION("single allocation for state and callable") {
+        const unsigned long before = test::thread_allocation_count();
+        packaged_task<int()> task([] () { return 1; });
+        future<int> fut = task.get_future();
+        task();
+        REQUIRE(test::thread_allocation_count() - before == 1);
+        REQUIRE(fut.get() == 1);
+    }
+}
+
+TEST_CASE("future: then continuations", "[future]") {
+    SECTION("inline chain on completing thread") {
+        promise<int> prom;
+        future<std::string> fut = prom.get_future()
+            .then([] (future<int> prev) { return prev.get() * 2; })
+            .then([] (future<int> prev) { return std::to_string(prev.get()); });
+        REQUIRE(fut.is_ready() == false);
+
+        prom.set_value(21);
+        REQUIRE(fut.is_ready() == true);
+        REQUIRE(fut.get() == "42");
+    }
+
+    SECTION("continuation of completed future runs at once") {
+        future<int> ready = make_ready_future(1);
+        bool ran = false;
+        future<void> fut = ready.then([&ran] (future<int> prev) { ran = prev.get() == 1; });
+        REQUIRE(ready.valid() == false);
+        REQUIRE(ran == true);
+        REQUIRE_NOTHROW(fut.get());
+    }
+
+    SECTION("exception passes through chain") {
+        future<int> fut = make_exceptional_future<int>(std::make_exception_ptr(std::logic_error("failed")))
+            .then([] (future<int> prev) { return prev.get() + 1; })
+            .then([] (future<int> prev) {
+                try {
+                    return prev.get();
+                }
+                catch(const std::logic_error&) {
+                    return -1;
+                }
+            });
+        REQUIRE(fut.get() == -1);
+    }
+
+    SECTION("continuations of shared_future") {
+        promise<int> prom;
+        shared_future<int> shared = prom.get_future().share();
+        future<int> first = shared.then([] (shared_future<int> prev) { return prev.get() + 1; });
+        future<int> second = shared.then([] (shared_future<int> prev) { return prev.get() + 2; });
+
+        prom.set_value(10);
+        REQUIRE(first.get() == 11);
+        REQUIRE(second.get() == 12);
+    }
+
+    SECTION("continuations on executors") {
+        thread_pool pool(2);
+        work_stealing_pool stealing_pool(2);
+
+        promise<int> prom;
+        future<int> fut = prom.get_future()
+            .then(pool, [] (future<int> prev) { return prev.get() + 1; })
+            .then(stealing_pool, [] (future<int> prev) { return prev.get() * 10; });
+
+        prom.set_value(1);
+        REQUIRE(fut.get() == 20);
+    }
+
+    SECTION("executor refusing continuation") {
+        thread_pool pool(1);
+        pool.shutdown();
+
+        future<int> fut = make_ready_future(1).then(pool, [] (future<int> prev) { return prev.get(); });
+        REQUIRE_THROWS_AS(fut.get(), std::runtime_error);
+    }
+}
+
+TEST_CASE("future: when_all and when_any", "[future]") {
+    SECTION("when_all of range") {
+        std::vector<promise<int> > promises(5);
+        std::vector<future<int> > futures;
+        for(std::size_t i = 0; i < promises.size(); ++i)
+            futures.push_back(promises[i].get_future());
+
+        future<std::vector<future<int> > > all = when_all(futures.begin(), futures.end());
+        for(std::size_t i = 0; i < promises.size(); ++i) {
+            REQUIRE(all.is_ready() == false);
+            promises[i].set_value(static_cast<int>(i));
+        }
+
+        std::vector<future<int> > results = all.get();
+        REQUIRE(results.size() == 5);
+        for(std::size_t i = 0; i < results.size(); ++i)
+            REQUIRE(results[i].get() == static_cast<int>(i));
+
+        std::vector<future<int> > none;
+        REQUIRE(when_all(none.begin(), none.end()).get().empty());
+    }
+
+    SECTION("when_all of different futures") {
+        promise<int> prom_int;
+        promise<std::string> prom_str;
+        shared_future<void> shared = make_ready_future().share();
+
+        auto all = when_all(prom_int.get_future(), prom_str.get_future(), shared);
+        prom_str.set_value("str");
+        REQUIRE(all.is_ready() == false);
+        prom_int.set_exception(std::make_exception_ptr(std::logic_error("failed")));
+
+        auto results = all.get();
+        REQUIRE_THROWS_AS(std::get<0>(results).get(), std::logic_error);
+        REQUIRE(std::get<1>(results).get() == "str");
+        REQUIRE_NOTHROW(std::get<2>(results).get());
+        REQUIRE(shared.valid() == true);
+    }
+
+    SECTION("when_any") {
+        std::vector<promise<int> > promises(3);
+        std::vector<future<int> > futures;
+        for(std::size_t i = 0; i < promises.size(); ++i)
+            futures.push_back(promises[i].get_future());
+
+        auto any = when_any(futures.begin(), futures.end());
+        REQUIRE(any.is_ready() == false);
+        promises[1].set_value(1);
+        promises[2].set_value(2);
+
+        when_any_result<std::vector<future<int> > > result = any.get();
+        REQUIRE(result.index == 1);
+        REQUIRE(result.futures[1].get() == 1);
+        REQUIRE(result.futures[0].is_ready() == false);
+
+        /*input futures may be dropped while others are pending*/
+        result.futures.clear();
+        promises[0].set_value(0);
+
+        promise<void> pending;
+        auto mixed = when_any(pending.get_future(), make_ready_future(std::string("a")));
+        REQUIRE(mixed.is_ready() == true);
+        auto mixed_result = mixed.get();
+        REQUIRE(mixed_result.index == 1);
+        REQUIRE(std::get<1>(mixed_result.futures).get() == "a");
+
+        REQUIRE_THROWS_AS(when_any(future<int>()), std::invalid_argument);
+    }
+
+    SECTION("when_all fed by many threads") {
+        const int producers = 8;
+        std::vector<promise<int> > promises(producers);
+        std::vector<future<int> > futures;
+        for(int i = 0; i < producers; ++i)
+            futures.push_back(promises[i].get_future());
+
+        std::atomic<int> sum(0);
+        future<void> done = when_all(futures.begin(), futures.end())
+            .then([&sum] (future<std::vector<future<int> > > all) {
+                std::vector<future<int> > results = all.get();
+                for(std::size_t i = 0; i < results.size(); ++i)
+                    sum += results[i].get();
+            });
+
+        {
+            std::vector<jthread> threads;
+            for(int i = 0; i < producers; ++i)
+                threads.emplace_back([&promises, i] () { promises[i].set_value(i); });
+        }
+
+        done.get();
+        REQUIRE(sum.load() == producers * (producers - 1) / 2);
+    }
+}
+
+} // namespace concurrency
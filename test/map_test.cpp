@@ -0,0 +1,145 @@
+#include <catch2/catch_all.hpp>
+
+#include "concurrent_hash_map.hpp"
+#include "thread.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace concurrency {
+
+TEST_CASE("concurrent_hash_map: single thread operations", "[concurrent_hash_map]") {
+    REQUIRE_THROWS_AS((concurrent_hash_map<int, int>(16, 0)), std::invalid_argument);
+
+    concurrent_hash_map<std::string, std::string> map;
+    std::string val;
+    REQUIRE(map.empty());
+    REQUIRE(map.find("a", val) == false);
+
+    REQUIRE(map.insert("a", "1") == true);
+    REQUIRE(map.insert("a", "2") == false);
+    REQUIRE(map.emplace("b", 3, 'x') == true);
+    REQUIRE(map.size() == 2);
+    REQUIRE(map.find("a", val) == true);
+    REQUIRE(val == "1");
+    REQUIRE(map.find("b", val) == true);
+    REQUIRE(val == "xxx");
+    REQUIRE(map.contains("c") == false);
+
+    auto append = [] (std::string& str) { str += "+"; };
+    REQUIRE(map.upsert("a", append, "new") == false);
+    REQUIRE(map.upsert("c", append, "new") == true);
+    REQUIRE(map.find("a", val) == true);
+    REQUIRE(val == "1+");
+    REQUIRE(map.find("c", val) == true);
+    REQUIRE(val == "new");
+
+    REQUIRE(map.erase("a") == true);
+    REQUIRE(map.erase("a") == false);
+    REQUIRE(map.contains("a") == false);
+    REQUIRE(map.size() == 2);
+}
+
+TEST_CASE("concurrent_hash_map: table grows and keeps all keys", "[concurrent_hash_map]") {
+    const int keys = 100'000;
+    concurrent_hash_map<int, int> map(16);
+    const std::size_t initial_buckets = map.bucket_count();
+
+    for(int key = 0; key < keys; ++key)
+        REQUIRE(map.insert(key, -key) == true);
+    REQUIRE(map.size() == static_cast<std::size_t>(keys));
+    REQUIRE(map.bucket_count() > initial_buckets);
+
+    int val;
+    for(int key = 0; key < keys; ++key) {
+        REQUIRE(map.find(key, val) == true);
+        REQUIRE(val == -key);
+    }
+    REQUIRE(map.contains(keys) == false);
+
+    /*erased keys leave no gaps in probing of others*/
+    for(int key = 0; key < keys; key += 2)
+        REQUIRE(map.erase(key) == true);
+    for(int key = 0; key < keys; ++key)
+        REQUIRE(map.contains(key) == (key % 2 == 1));
+    REQUIRE(map.size() == static_cast<std::size_t>(keys / 2));
+}
+
+TEST_CASE("concurrent_hash_map: concurrent upserts are not lost", "[concurrent_hash_map]") {
+    const int threads_num = 8;
+    const int keys = 1000;
+    const int rounds = 20;
+
+    /*small table with few stripes, so writers collide and table grows while they run*/
+    concurrent_hash_map<int, long> map(8, 4);
+    {
+        std::vector<jthread> threads;
+        for(int t = 0; t < threads_num; ++t)
+            threads.emplace_back([&map] () {
+                for(int round = 0; round < rounds; ++round)
+                    for(int key = 0; key < keys; ++key)
+                        map.upsert(key, [] (long& count) { ++count; }, 1);
+            });
+    }
+
+    REQUIRE(map.size() == static_cast<std::size_t>(keys));
+    long val;
+    for(int key = 0; key < keys; ++key) {
+        REQUIRE(map.find(key, val) == true);
+        REQUIRE(val == threads_num * rounds);
+    }
+}
+
+TEST_CASE("concurrent_hash_map: readers during inserts, erases and growth", "[concurrent_hash_map]") {
+    const int writers = 4;
+    const int readers = 4;
+    const int per_writer = 20'000;
+    const int stable_keys = 1000;
+
+    /*stable keys are never erased, value is always twice the key*/
+    concurrent_hash_map<int, int> map(16);
+    for(int key = 0; key < stable_keys; ++key)
+        map.insert(key, 2 * key);
+
+    std::atomic<bool> done(false);
+    std::atomic<bool> stable_missing(false);
+    std::atomic<bool> wrong_value(false);
+    {
+        std::vector<jthread> reader_threads;
+        for(int r = 0; r < readers; ++r)
+            reader_threads.emplace_back([&] () {
+                int val;
+                for(int key = 0; !done; key = (key + 7) % (stable_keys + writers * per_writer)) {
+                    if(map.find(key, val)) {
+                        if(val != 2 * key)
+                            wrong_value = true;
+                    }
+                    else if(key < stable_keys)
+                        stable_missing = true;
+                }
+            });
+
+        std::vector<jthread> writer_threads;
+        for(int w = 0; w < writers; ++w)
+            writer_threads.emplace_back([&map, w] () {
+                const int first = stable_keys + w * per_writer;
+                for(int key = first; key < first + per_writer; ++key)
+                    map.insert(key, 2 * key);
+                for(int key = first; key < first + per_writer; key += 2)
+                    map.erase(key);
+            });
+        for(int w = 0; w < writers; ++w)
+            writer_threads[w].join();
+        done = true;
+    }
+
+    REQUIRE(stable_missing == false);
+    REQUIRE(wrong_value == false);
+    REQUIRE(map.size() == static_cast<std::size_t>(stable_keys + writers * per_writer / 2));
+    for(int key = stable_keys; key < stable_keys + writers * per_writer; ++key)
+        REQUIRE(map.contains(key) == ((key - stable_keys) % 2 == 1));
+}
+
+} // namespace concurrency
@@ -2,8 +2,22 @@
 
 #include "thread.hpp"
 #include "mutex.hpp"
+#include "futex_mutex.hpp"
+#include "shared_mutex.hpp"
+#include "big_reader_mutex.hpp"
+#include "spin_lock.hpp"
+#include "queue_lock.hpp"
+#include "mutex_profile.hpp"
+#include "condition_variable.hpp"
 
 #include <iostream>
+#include <sstream>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
 
 namespace concurrency {
 
@@ -15,6 +29,13 @@ void factorial_multiply(unsigned long long* val, int n, mutex* mx) {
     }
 }
 
+void futex_incrementer_func(int* var, int iterations, futex_mutex* mut) {
+    for(int i = 0; i < iterations; ++i) {
+        lock_guard<futex_mutex> locker(*mut);
+        *var += 1;
+    }
+}
+
 TEST_CASE("mutex: creation and deletion", "[mutex]") {
     mutex mx;
 
@@ -158,4 +179,678 @@ TEST_CASE("mutex: lock_guard", "[mutex]") {
     REQUIRE_NOTHROW(mut.unlock());
 }
 
+TEST_CASE("futex_mutex: creation and deletion", "[mutex][futex_mutex]") {
+    futex_mutex mx;
+
+    REQUIRE_NOTHROW(mx.lock());
+    REQUIRE(mx.try_lock() == false);
+    REQUIRE_NOTHROW(mx.unlock());
+    REQUIRE(mx.try_lock() == true);
+    REQUIRE_NOTHROW(mx.unlock());
+}
+
+TEST_CASE("futex_mutex: integration with threads", "[mutex][futex_mutex]") {
+    const int val_init = 0;
+    const int iterations = 200'000;
+    int val = val_init;
+    {
+        futex_mutex mut;
+        jthread tr1(futex_incrementer_func, &val, iterations, &mut);
+        jthread tr2(futex_incrementer_func, &val, iterations, &mut);
+        jthread tr3(futex_incrementer_func, &val, iterations, &mut);
+        jthread tr4(futex_incrementer_func, &val, iterations, &mut);
+    }
+    REQUIRE(val == val_init + 4 * iterations);
+}
+
+TEST_CASE("futex_mutex: unique_lock and lock_guard", "[mutex][futex_mutex]") {
+    futex_mutex mut;
+
+    { /*scope*/
+        unique_lock<futex_mutex> locker(mut);
+
+        REQUIRE(locker.owns_lock() == true);
+        REQUIRE(mut.try_lock() == false);
+    }
+    REQUIRE(mut.try_lock() == true);
+    REQUIRE_NOTHROW(mut.unlock());
+
+    { /*scope*/
+        unique_lock<futex_mutex> locker(mut, try_to_lock);
+
+        REQUIRE(locker.owns_lock() == true);
+    }
+
+    { /*scope*/
+        lock_guard<futex_mutex> scoped_locker(mut);
+
+        REQUIRE(mut.try_lock() == false);
+    }
+    REQUIRE(mut.try_lock() == true);
+    REQUIRE_NOTHROW(mut.unlock());
+}
+
+TEST_CASE("timed_mutex: try_lock_for and try_lock_until", "[mutex][timed_mutex]") {
+    using namespace std::chrono;
+    timed_mutex mut;
+
+    SECTION("not locked") {
+        REQUIRE(mut.try_lock_for(milliseconds(10)) == true);
+        REQUIRE(mut.try_lock() == false);
+        REQUIRE_NOTHROW(mut.unlock());
+
+        REQUIRE(mut.try_lock_until(steady_clock::now() + milliseconds(10)) == true);
+        REQUIRE_NOTHROW(mut.unlock());
+    }
+
+    SECTION("locked by other thread") {
+        bool acquired_for = true;
+        bool acquired_until = true;
+        steady_clock::duration waited;
+
+        mut.lock();
+        {
+            jthread waiter([&mut, &acquired_for, &acquired_until, &waited] () {
+                steady_clock::time_point start = steady_clock::now();
+                acquired_for = mut.try_lock_for(milliseconds(20));
+                waited = steady_clock::now() - start;
+                acquired_until = mut.try_lock_until(system_clock::now() + milliseconds(5));
+            });
+        }
+        mut.unlock();
+
+        REQUIRE(acquired_for == false);
+        REQUIRE(acquired_until == false);
+        REQUIRE(waited >= milliseconds(20));
+    }
+
+    SECTION("unique_lock") {
+        {
+            unique_lock<timed_mutex> locker(mut, milliseconds(10));
+            REQUIRE(locker.owns_lock() == true);
+        }
+
+        unique_lock<timed_mutex> locker(mut, defer_lock);
+        REQUIRE(locker.try_lock_until(steady_clock::now() + milliseconds(10)) == true);
+        REQUIRE_NOTHROW(locker.unlock());
+        REQUIRE(locker.try_lock_for(milliseconds(10)) == true);
+        REQUIRE_THROWS(locker.try_lock_for(milliseconds(10)));
+    }
+}
+
+TEST_CASE("recursive_timed_mutex: recursive timed locking", "[mutex][timed_mutex]") {
+    using namespace std::chrono;
+    recursive_timed_mutex mut;
+
+    REQUIRE(mut.try_lock_for(milliseconds(10)) == true);
+    REQUIRE(mut.try_lock_for(milliseconds(10)) == true);
+    REQUIRE(mut.try_lock() == true);
+
+    bool acquired = true;
+    {
+        jthread waiter([&mut, &acquired] () {
+            acquired = mut.try_lock_for(milliseconds(10));
+        });
+    }
+    REQUIRE(acquired == false);
+
+    REQUIRE_NOTHROW(mut.unlock());
+    REQUIRE_NOTHROW(mut.unlock());
+    REQUIRE_NOTHROW(mut.unlock());
+
+    {
+        jthread waiter([&mut, &acquired] () {
+            acquired = mut.try_lock_for(milliseconds(10));
+            if(acquired)
+                mut.unlock();
+        });
+    }
+    REQUIRE(acquired == true);
+}
+
+
+TEST_CASE("shared_mutex: shared and exclusive ownership", "[mutex][shared_mutex]") {
+    shared_mutex mut;
+
+    SECTION("readers share, writer excludes") {
+        REQUIRE_NOTHROW(mut.lock_shared());
+        REQUIRE(mut.try_lock_shared() == true);
+        REQUIRE(mut.try_lock() == false);
+        REQUIRE_NOTHROW(mut.unlock_shared());
+        REQUIRE_NOTHROW(mut.unlock_shared());
+
+        REQUIRE(mut.try_lock() == true);
+        REQUIRE(mut.try_lock_shared() == false);
+        REQUIRE_NOTHROW(mut.unlock());
+    }
+
+    SECTION("readers hold lock concurrently") {
+        const int readers_num = 4;
+        std::atomic<int> inside(0);
+        std::atomic<int> max_inside(0);
+        {
+            std::vector<jthread> readers;
+            for(int i = 0; i < readers_num; ++i)
+                readers.push_back(jthread([&mut, &inside, &max_inside, readers_num] () {
+                    shared_lock<shared_mutex> locker(mut);
+                    int now = ++inside;
+                    int prev = max_inside.load();
+                    while(prev < now && !max_inside.compare_exchange_weak(prev, now))
+                        ;
+                    /*wait for others, bounded in case readers are serialized*/
+                    for(int spins = 0; max_inside.load() < readers_num && spins < 100'000; ++spins)
+                        sched_yield();
+                    --inside;
+                }));
+        }
+        REQUIRE(max_inside.load() == readers_num);
+    }
+
+    SECTION("writers and readers") {
+        const int writers_num = 4;
+        const int amount = 10'000;
+        long value = 0;
+        bool torn = false;
+        {
+            std::vector<jthread> workers;
+            for(int i = 0; i < writers_num; ++i) {
+                workers.push_back(jthread([&mut, &value, amount] () {
+                    for(int j = 0; j < amount; ++j) {
+                        lock_guard<shared_mutex> locker(mut);
+                        value += 2;
+                    }
+                }));
+                workers.push_back(jthread([&mut, &value, &torn, amount] () {
+                    for(int j = 0; j < amount; ++j) {
+                        shared_lock<shared_mutex> locker(mut);
+                        if(value % 2 != 0)
+                            torn = true;
+                    }
+                }));
+            }
+        }
+        REQUIRE(value == 2L * writers_num * amount);
+        REQUIRE(torn == false);
+    }
+
+    SECTION("prefer_writer blocks new readers while writer waits") {
+        shared_mutex writer_first(rwlock_preference::prefer_writer);
+        std::atomic<bool> writer_waiting(false);
+        bool reader_admitted = true;
+
+        writer_first.lock_shared();
+        {
+            jthread writer([&writer_first, &writer_waiting] () {
+                writer_waiting = true;
+                writer_first.lock();
+                writer_first.unlock();
+            });
+            while(!writer_waiting)
+                sched_yield();
+            /*give writer time to block on the lock*/
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+            jthread reader([&writer_first, &reader_admitted] () {
+                reader_admitted = writer_first.try_lock_shared();
+                if(reader_admitted)
+                    writer_first.unlock_shared();
+            });
+            reader.join();
+            writer_first.unlock_shared();
+        }
+        REQUIRE(reader_admitted == false);
+    }
+
+    SECTION("prefer_reader admits new readers while writer waits") {
+        shared_mutex reader_first(rwlock_preference::prefer_reader);
+        std::atomic<bool> writer_waiting(false);
+        bool reader_admitted = false;
+
+        reader_first.lock_shared();
+        {
+            jthread writer([&reader_first, &writer_waiting] () {
+                writer_waiting = true;
+                reader_first.lock();
+                reader_first.unlock();
+            });
+            while(!writer_waiting)
+                sched_yield();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+            jthread reader([&reader_first, &reader_admitted] () {
+                reader_admitted = reader_first.try_lock_shared();
+                if(reader_admitted)
+                    reader_first.unlock_shared();
+            });
+            reader.join();
+            reader_first.unlock_shared();
+        }
+        REQUIRE(reader_admitted == true);
+    }
+}
+
+TEST_CASE("shared_mutex: shared_lock", "[mutex][shared_mutex]") {
+    shared_mutex mut;
+
+    SECTION("constructors") {
+        {
+            shared_lock<shared_mutex> locker(mut);
+            REQUIRE(locker.owns_lock() == true);
+            REQUIRE(mut.try_lock() == false);
+        }
+        {
+            shared_lock<shared_mutex> locker(mut, defer_lock);
+            REQUIRE(locker.owns_lock() == false);
+            REQUIRE_NOTHROW(locker.lock());
+            REQUIRE_THROWS(locker.lock());
+        }
+        {
+            mut.lock_shared();
+            shared_lock<shared_mutex> locker(mut, adopt_lock);
+            REQUIRE(locker.owns_lock() == true);
+        }
+        mut.lock();
+        {
+            shared_lock<shared_mutex> locker(mut, try_to_lock);
+            REQUIRE(locker.owns_lock() == false);
+        }
+        mut.unlock();
+        REQUIRE(mut.try_lock() == true);
+        mut.unlock();
+    }
+
+    SECTION("unlock and release") {
+        shared_lock<shared_mutex> locker(mut);
+        REQUIRE_NOTHROW(locker.unlock());
+        REQUIRE_THROWS(locker.unlock());
+        REQUIRE(locker.try_lock() == true);
+
+        shared_mutex* released = locker.release();
+        REQUIRE(released == &mut);
+        REQUIRE(locker.owns_lock() == false);
+        REQUIRE(locker.mutex() == nullptr);
+        REQUIRE_THROWS(locker.lock());
+        REQUIRE_NOTHROW(mut.unlock_shared());
+    }
+}
+
+TEST_CASE("shared_timed_mutex: timed shared and exclusive locking", "[mutex][shared_mutex][timed_mutex]") {
+    using namespace std::chrono;
+    shared_timed_mutex mut;
+
+    REQUIRE(mut.try_lock_shared_for(milliseconds(10)) == true);
+    REQUIRE(mut.try_lock_shared_until(steady_clock::now() + milliseconds(10)) == true);
+
+    bool acquired = true;
+    steady_clock::duration waited;
+    {
+        jthread writer([&mut, &acquired, &waited] () {
+            steady_clock::time_point start = steady_clock::now();
+            acquired = mut.try_lock_for(milliseconds(20));
+            waited = steady_clock::now() - start;
+        });
+    }
+    REQUIRE(acquired == false);
+    REQUIRE(waited >= milliseconds(20));
+
+    REQUIRE_NOTHROW(mut.unlock_shared());
+    REQUIRE_NOTHROW(mut.unlock_shared());
+
+    REQUIRE(mut.try_lock_until(system_clock::now() + milliseconds(10)) == true);
+    {
+        jthread reader([&mut, &acquired] () {
+            shared_lock<shared_timed_mutex> locker(mut, milliseconds(10));
+            acquired = locker.owns_lock();
+        });
+    }
+    REQUIRE(acquired == false);
+    REQUIRE_NOTHROW(mut.unlock());
+
+    shared_lock<shared_timed_mutex> locker(mut, defer_lock);
+    REQUIRE(locker.try_lock_for(milliseconds(10)) == true);
+    REQUIRE_THROWS(locker.try_lock_until(steady_clock::now() + milliseconds(10)));
+}
+
+
+TEST_CASE("big_reader_mutex: shared and exclusive ownership", "[mutex][big_reader_mutex]") {
+    big_reader_mutex mut(4);
+    REQUIRE(mut.slots_num() == 4);
+    REQUIRE(big_reader_mutex(3).slots_num() == 4);
+    REQUIRE(big_reader_mutex().slots_num() >= 1);
+
+    SECTION("readers share, writer excludes") {
+        REQUIRE_NOTHROW(mut.lock_shared());
+        REQUIRE(mut.try_lock_shared() == true);
+        REQUIRE(mut.try_lock() == false);
+        REQUIRE_NOTHROW(mut.unlock_shared());
+        REQUIRE_NOTHROW(mut.unlock_shared());
+
+        REQUIRE(mut.try_lock() == true);
+        REQUIRE(mut.try_lock_shared() == false);
+        REQUIRE_NOTHROW(mut.unlock());
+        REQUIRE(mut.try_lock_shared() == true);
+        REQUIRE_NOTHROW(mut.unlock_shared());
+    }
+
+    SECTION("reader on other thread blocks writer") {
+        std::atomic<bool> writer_done(false);
+
+        mut.lock_shared();
+        {
+            jthread writer([&mut, &writer_done] () {
+                unique_lock<big_reader_mutex> locker(mut);
+                writer_done = true;
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            REQUIRE(writer_done == false);
+            mut.unlock_shared();
+        }
+        REQUIRE(writer_done == true);
+    }
+
+    SECTION("writer blocks readers on other threads") {
+        std::atomic<int> readers_done(0);
+
+        mut.lock();
+        {
+            std::vector<jthread> readers;
+            for(int i = 0; i < 4; ++i)
+                readers.push_back(jthread([&mut, &readers_done] () {
+                    shared_lock<big_reader_mutex> locker(mut);
+                    ++readers_done;
+                }));
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            REQUIRE(readers_done == 0);
+            mut.unlock();
+        }
+        REQUIRE(readers_done == 4);
+    }
+
+    SECTION("writers and readers") {
+        const int writers_num = 4;
+        const int amount = 5'000;
+        long value = 0;
+        bool torn = false;
+        {
+            std::vector<jthread> workers;
+            for(int i = 0; i < writers_num; ++i) {
+                workers.push_back(jthread([&mut, &value, amount] () {
+                    for(int j = 0; j < amount; ++j) {
+                        lock_guard<big_reader_mutex> locker(mut);
+                        value += 2;
+                    }
+                }));
+                for(int r = 0; r < 2; ++r)
+                    workers.push_back(jthread([&mut, &value, &torn, amount] () {
+                        for(int j = 0; j < amount; ++j) {
+                            shared_lock<big_reader_mutex> locker(mut);
+                            if(value % 2 != 0)
+                                torn = true;
+                        }
+                    }));
+            }
+        }
+        REQUIRE(value == 2L * writers_num * amount);
+        REQUIRE(torn == false);
+    }
+}
+
+
+TEMPLATE_TEST_CASE("spin locks: lock, try_lock and unlock", "[mutex][spin_lock]",
+    ttas_lock<>, ticket_lock<>, mcs_lock<>, clh_lock<>
+) {
+    TestType mut;
+
+    REQUIRE(mut.try_lock() == true);
+    REQUIRE(mut.try_lock() == false);
+    REQUIRE_NOTHROW(mut.unlock());
+
+    {
+        lock_guard<TestType> locker(mut);
+        REQUIRE(mut.try_lock() == false);
+    }
+    {
+        unique_lock<TestType> locker(mut);
+        REQUIRE(locker.owns_lock() == true);
+        REQUIRE_NOTHROW(locker.unlock());
+        REQUIRE(locker.try_lock() == true);
+    }
+
+    bool acquired = true;
+    mut.lock();
+    {
+        jthread other([&mut, &acquired] () {
+            acquired = mut.try_lock();
+        });
+    }
+    mut.unlock();
+    REQUIRE(acquired == false);
+}
+
+TEMPLATE_TEST_CASE("spin locks: mutual exclusion", "[mutex][spin_lock]",
+    ttas_lock<>, ticket_lock<>, mcs_lock<>, clh_lock<>,
+    ttas_lock<backoff_pause>, ticket_lock<backoff_none>, mcs_lock<backoff_pause>, clh_lock<backoff_none>
+) {
+    /*few iterations: spinning waiters may take whole time slices on oversubscribed cpus*/
+    const int threads_num = 2;
+    const int amount = 200;
+    TestType mut;
+    int value = 0;
+
+    {
+        std::vector<jthread> threads;
+        for(int i = 0; i < threads_num; ++i)
+            threads.push_back(jthread([&mut, &value, amount] () {
+                for(int j = 0; j < amount; ++j) {
+                    lock_guard<TestType> locker(mut);
+                    value += 1;
+                }
+            }));
+    }
+
+    REQUIRE(value == threads_num * amount);
+}
+
+TEMPLATE_TEST_CASE("spin locks: try_lock and lock mixed across threads", "[mutex][spin_lock]",
+    mcs_lock<>, clh_lock<>
+) {
+    /*node published by try_lock is read by successor entering through lock()*/
+    const int threads_num = 4;
+    const int amount = 2000;
+    TestType mut;
+    int value = 0;
+
+    {
+        std::vector<jthread> threads;
+        for(int i = 0; i < threads_num; ++i)
+            threads.push_back(jthread([&mut, &value, amount, i] () {
+                for(int j = 0; j < amount; ++j) {
+                    if((i + j) % 2 == 0)
+                        mut.lock();
+                    else
+                        while(!mut.try_lock())
+                            util::cpu_relax();
+                    value += 1;
+                    mut.unlock();
+                }
+            }));
+    }
+
+    REQUIRE(value == threads_num * amount);
+}
+
+TEST_CASE("spin locks: clh try_lock while nodes of exited threads are freed", "[mutex][spin_lock]") {
+    /*nodes taken over by short-lived threads are freed with their pools*/
+    const int rounds = 200;
+    clh_lock<> mut;
+    std::atomic<bool> done(false);
+    int value = 0;
+    int tried = 0;
+
+    {
+        jthread trier([&mut, &done, &value, &tried] () {
+            while(!done.load()) {
+                if(mut.try_lock()) {
+                    value += 1;
+                    tried += 1;
+                    mut.unlock();
+                }
+            }
+        });
+
+        for(int i = 0; i < rounds; ++i) {
+            jthread locker([&mut, &value] () {
+                for(int j = 0; j < 10; ++j) {
+                    lock_guard<clh_lock<> > guard(mut);
+                    value += 1;
+                }
+            });
+        }
+        done = true;
+    }
+
+    REQUIRE(value == rounds * 10 + tried);
+}
+
+TEST_CASE("spin locks: nested queue locks", "[mutex][spin_lock]") {
+    /*holding several queue locks at once, released out of order*/
+    mcs_lock<> mcs_first, mcs_second;
+    clh_lock<> clh_first, clh_second;
+
+    mcs_first.lock();
+    mcs_second.lock();
+    clh_first.lock();
+    clh_second.lock();
+
+    mcs_first.unlock();
+    clh_first.unlock();
+    REQUIRE(mcs_first.try_lock() == true);
+    REQUIRE(clh_first.try_lock() == true);
+
+    mcs_second.unlock();
+    clh_second.unlock();
+    mcs_first.unlock();
+    clh_first.unlock();
+
+    std::vector<mcs_lock<>> too_many(detail::queue_node_pool<detail::mcs_node>::capacity + 1);
+    for(int i = 0; i < detail::queue_node_pool<detail::mcs_node>::capacity; ++i)
+        too_many[i].lock();
+    REQUIRE_THROWS(too_many.back().lock());
+    for(int i = 0; i < detail::queue_node_pool<detail::mcs_node>::capacity; ++i)
+        too_many[i].unlock();
+}
+
+
+#ifdef CONCURRENCY_MUTEX_PROFILING
+static mutex_stats_snapshot find_stats(const std::string& name) {
+    std::vector<mutex_stats_snapshot> snaps = mutex_registry::instance().snapshot();
+    for(std::size_t i = 0; i < snaps.size(); ++i)
+        if(snaps[i].name == name)
+            return snaps[i];
+    FAIL("no statistics of " << name);
+    return mutex_stats_snapshot();
+}
+
+TEST_CASE("mutex profiling: acquisitions, contention and hold times", "[mutex][mutex_profile]") {
+    using namespace std::chrono;
+
+    SECTION("uncontended and contended acquisitions") {
+        mutex mut;
+        mut.set_name("test.profile.contention");
+
+        for(int i = 0; i < 10; ++i) {
+            lock_guard<mutex> locker(mut);
+        }
+        REQUIRE(mut.try_lock() == true);
+        mut.unlock();
+
+        mut.lock();
+        {
+            jthread waiter([&mut] () {
+                lock_guard<mutex> locker(mut);
+            });
+            std::this_thread::sleep_for(milliseconds(20));
+            mut.unlock();
+        }
+
+        mutex_stats_snapshot stats = find_stats("test.profile.contention");
+        REQUIRE(stats.acquisitions == 13);
+        REQUIRE(stats.contended == 1);
+        REQUIRE(stats.max_wait_ns >= 10'000'000);
+        REQUIRE(stats.total_wait_ns >= stats.max_wait_ns);
+        REQUIRE(stats.total_hold_ns >= 20'000'000);
+
+        std::uint64_t holds = 0;
+        for(std::size_t i = 0; i < stats.hold_histogram.size(); ++i)
+            holds += stats.hold_histogram[i];
+        REQUIRE(holds == 13);
+        /*20 ms hold lands in [2^24, 2^25) ns bucket or above*/
+        std::uint64_t long_holds = 0;
+        for(std::size_t i = 24; i < stats.hold_histogram.size(); ++i)
+            long_holds += stats.hold_histogram[i];
+        REQUIRE(long_holds == 1);
+    }
+
+    SECTION("mutexes sharing name, recursive locking") {
+        recursive_mutex first, second;
+        first.set_name("test.profile.shared_name");
+        second.set_name("test.profile.shared_name");
+
+        first.lock();
+        first.lock();
+        first.unlock();
+        first.unlock();
+        second.lock();
+        second.unlock();
+
+        mutex_stats_snapshot stats = find_stats("test.profile.shared_name");
+        REQUIRE(stats.acquisitions == 2);
+        REQUIRE(stats.contended == 0);
+    }
+
+    SECTION("condition_variable wait is not counted as hold") {
+        mutex mut;
+        mut.set_name("test.profile.cond_var");
+        condition_variable cond_var;
+
+        unique_lock<mutex> locker(mut);
+        cond_var.wait_for(locker, milliseconds(20));
+        locker.unlock();
+
+        mutex_stats_snapshot stats = find_stats("test.profile.cond_var");
+        REQUIRE(stats.acquisitions == 1);
+        REQUIRE(stats.total_hold_ns < 10'000'000);
+    }
+
+    SECTION("dump") {
+        mutex mut;
+        mut.set_name("test.profile.\"dump\"");
+        mut.lock();
+        mut.unlock();
+
+        std::ostringstream text;
+        mutex_registry::instance().dump_text(text);
+        REQUIRE(text.str().find("test.profile.\"dump\": acquisitions 1") != std::string::npos);
+
+        std::ostringstream json;
+        mutex_registry::instance().dump_json(json);
+        REQUIRE(json.str().find("{\"name\":\"test.profile.\\\"dump\\\"\",\"acquisitions\":1,") != std::string::npos);
+
+        mutex_registry::instance().reset();
+        REQUIRE(find_stats("test.profile.\"dump\"").acquisitions == 0);
+    }
+}
+#else
+TEST_CASE("mutex profiling: disabled", "[mutex][mutex_profile]") {
+    /*no extra state, naming is no-op*/
+    REQUIRE(sizeof(mutex) == sizeof(mutex::native_handle_type));
+
+    mutex mut;
+    mut.set_name("test.profile.disabled");
+    mut.lock();
+    mut.unlock();
+    REQUIRE(mutex_registry::instance().snapshot().empty());
+}
+#endif
+
 } // namespace concurrency
\ No newline at end of file
@@ -0,0 +1,613 @@
+#include <catch2/catch_all.hpp>
+
+#include "spsc_queue.hpp"
+#include "channel.hpp"
+#include "lock_free_stack.hpp"
+#include "lock_free_queue.hpp"
+#include "thread.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace concurrency {
+
+TEST_CASE("spsc_queue: push and pop in single thread", "[spsc_queue]") {
+    spsc_queue<int, 4> queue;
+
+    REQUIRE(queue.capacity() == 4);
+    REQUIRE(queue.empty());
+
+    int val = -1;
+    REQUIRE(queue.try_pop(val) == false);
+
+    for(int i = 0; i < 4; ++i)
+        REQUIRE(queue.try_push(i) == true);
+    REQUIRE(queue.try_push(4) == false);
+    REQUIRE(queue.size() == 4);
+
+    for(int i = 0; i < 4; ++i) {
+        REQUIRE(queue.try_pop(val) == true);
+        REQUIRE(val == i);
+    }
+    REQUIRE(queue.try_pop(val) == false);
+
+    /*indices wrap around ring*/
+    for(int round = 0; round < 10; ++round) {
+        REQUIRE(queue.try_push(round) == true);
+        REQUIRE(queue.try_pop(val) == true);
+        REQUIRE(val == round);
+    }
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("spsc_queue: bulk operations", "[spsc_queue]") {
+    spsc_queue<int, 8> queue;
+    std::vector<int> in = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    REQUIRE(queue.try_push_bulk(in.begin(), 0) == 0);
+    REQUIRE(queue.try_push_bulk(in.begin(), 3) == 3);
+    /*only part which fits is pushed*/
+    REQUIRE(queue.try_push_bulk(in.begin() + 3, 7) == 5);
+    REQUIRE(queue.try_push_bulk(in.begin() + 8, 2) == 0);
+
+    std::vector<int> out(10, -1);
+    REQUIRE(queue.try_pop_bulk(out.begin(), 6) == 6);
+    REQUIRE(queue.try_pop_bulk(out.begin() + 6, 10) == 2);
+    REQUIRE(queue.try_pop_bulk(out.begin() + 8, 10) == 0);
+    for(int i = 0; i < 8; ++i)
+        REQUIRE(out[i] == i);
+
+    REQUIRE(queue.try_push_bulk(in.begin() + 8, 2) == 2);
+    REQUIRE(queue.pop_bulk(out.begin() + 8, 10) == 2);
+    REQUIRE(out == in);
+}
+
+namespace {
+
+/*copy throws if source is marked, references of shared_ptr count live copies*/
+struct marked_copy {
+    explicit marked_copy(std::shared_ptr<int> ref): m_ref(std::move(ref)), m_throws(false) {}
+
+    marked_copy(const marked_copy& other): m_ref(other.m_ref), m_throws(false) {
+        if(other.m_throws)
+            throw std::runtime_error("marked_copy");
+    }
+
+    marked_copy& operator=(const marked_copy& other) = default;
+
+    std::shared_ptr<int> m_ref;
+    bool m_throws;
+};
+
+} // namespace
+
+TEST_CASE("spsc_queue: elements are constructed and destroyed in place", "[spsc_queue]") {
+    std::shared_ptr<int> counted = std::make_shared<int>(42);
+
+    {
+        spsc_queue<std::shared_ptr<int>, 4> queue;
+        REQUIRE(queue.try_push(counted) == true);
+        REQUIRE(queue.try_emplace(counted) == true);
+        REQUIRE(counted.use_count() == 3);
+
+        std::shared_ptr<int> popped;
+        REQUIRE(queue.try_pop(popped) == true);
+        REQUIRE(*popped == 42);
+        popped.reset();
+        REQUIRE(counted.use_count() == 2);
+    }
+    /*element left in queue is destroyed with it*/
+    REQUIRE(counted.use_count() == 1);
+
+    spsc_queue<std::string, 2> queue;
+    queue.push(std::string(100, 'x'));
+    std::string str;
+    queue.pop(str);
+    REQUIRE(str == std::string(100, 'x'));
+
+    /*copy throwing in the middle of batch leaves no elements behind*/
+    {
+        std::vector<marked_copy> batch(3, marked_copy(counted));
+        batch[2].m_throws = true;
+        REQUIRE(counted.use_count() == 4);
+
+        spsc_queue<marked_copy, 4> throwing_queue;
+        REQUIRE_THROWS_AS(throwing_queue.try_push_bulk(batch.begin(), 3), std::runtime_error);
+        REQUIRE(counted.use_count() == 4);
+        REQUIRE(throwing_queue.empty());
+
+        REQUIRE(throwing_queue.try_push_bulk(batch.begin(), 2) == 2);
+        REQUIRE(counted.use_count() == 6);
+    }
+    REQUIRE(counted.use_count() == 1);
+}
+
+template<spsc_mode Mode>
+static void transfer_in_order(int items, bool bulk) {
+    std::unique_ptr<spsc_queue<int, 64, Mode>> queue(new spsc_queue<int, 64, Mode>());
+    std::vector<int> received;
+    received.reserve(items);
+
+    jthread consumer([&queue, &received, items, bulk] () {
+        int batch[16];
+        while(static_cast<int>(received.size()) < items) {
+            if(bulk) {
+                std::size_t popped = queue->pop_bulk(batch, 16);
+                received.insert(received.end(), batch, batch + popped);
+            } else {
+                int val = 0;
+                queue->pop(val);
+                received.push_back(val);
+            }
+        }
+    });
+
+    if(bulk) {
+        std::vector<int> in(items);
+        for(int i = 0; i < items; ++i)
+            in[i] = i;
+        for(int i = 0; i < items; i += 10)
+            queue->push_bulk(in.begin() + i, std::min(10, items - i));
+    } else {
+        for(int i = 0; i < items; ++i)
+            queue->push(i);
+    }
+    consumer.join();
+
+    REQUIRE(received.size() == static_cast<std::size_t>(items));
+    for(int i = 0; i < items; ++i)
+        REQUIRE(received[i] == i);
+    REQUIRE(queue->empty());
+}
+
+TEST_CASE("spsc_queue: producer and consumer threads", "[spsc_queue]") {
+    const bool bulk = GENERATE(false, true);
+
+    SECTION("polling mode") {
+        transfer_in_order<spsc_mode::polling>(100'000, bulk);
+    }
+
+    SECTION("blocking mode") {
+        transfer_in_order<spsc_mode::blocking>(100'000, bulk);
+    }
+}
+
+TEST_CASE("spsc_queue: blocking mode parks on empty and full queue", "[spsc_queue]") {
+    using namespace std::chrono;
+    spsc_queue<int, 2, spsc_mode::blocking> queue;
+
+    SECTION("consumer waits for producer") {
+        int val = -1;
+        jthread consumer([&queue, &val] () {
+            queue.pop(val);
+        });
+        std::this_thread::sleep_for(milliseconds(20));
+        REQUIRE(val == -1);
+
+        queue.push(7);
+        consumer.join();
+        REQUIRE(val == 7);
+    }
+
+    SECTION("producer waits for consumer") {
+        queue.push(1);
+        queue.push(2);
+
+        std::atomic<bool> pushed(false);
+        jthread producer([&queue, &pushed] () {
+            queue.push(3);
+            pushed = true;
+        });
+        std::this_thread::sleep_for(milliseconds(20));
+        REQUIRE(pushed == false);
+
+        int val;
+        queue.pop(val);
+        producer.join();
+        REQUIRE(pushed == true);
+        for(int expected = 2; expected <= 3; ++expected) {
+            REQUIRE(queue.try_pop(val) == true);
+            REQUIRE(val == expected);
+        }
+    }
+}
+
+TEST_CASE("channel: creation", "[channel]") {
+    REQUIRE_THROWS(channel<int>(0));
+    REQUIRE(channel<int>(1).capacity() == 2);
+    REQUIRE(channel<int>(5).capacity() == 8);
+    REQUIRE(channel<int>(64).capacity() == 64);
+}
+
+TEST_CASE("channel: non-blocking send and receive", "[channel]") {
+    channel<int> chan(4);
+    int val = -1;
+
+    REQUIRE(chan.try_receive(val) == channel_status::empty);
+    for(int i = 0; i < 4; ++i)
+        REQUIRE(chan.try_send(i) == channel_status::success);
+    REQUIRE(chan.try_send(4) == channel_status::full);
+    REQUIRE(chan.size() == 4);
+
+    for(int round = 0; round < 10; ++round) {
+        REQUIRE(chan.try_receive(val) == channel_status::success);
+        REQUIRE(val == round);
+        REQUIRE(chan.try_send(round + 4) == channel_status::success);
+    }
+}
+
+TEST_CASE("channel: close", "[channel]") {
+    using namespace std::chrono;
+    channel<std::string> chan(4);
+    std::string val;
+
+    REQUIRE(chan.try_send("first") == channel_status::success);
+    REQUIRE(chan.send("second") == channel_status::success);
+    REQUIRE(chan.closed() == false);
+    chan.close();
+    REQUIRE(chan.closed() == true);
+
+    /*sends fail, elements sent before close are still received*/
+    std::string rejected = "rejected";
+    REQUIRE(chan.try_send(std::move(rejected)) == channel_status::closed);
+    REQUIRE(rejected == "rejected");
+    REQUIRE(chan.send("third") == channel_status::closed);
+    REQUIRE(chan.send_for("third", milliseconds(1)) == channel_status::closed);
+
+    REQUIRE(chan.receive(val) == channel_status::success);
+    REQUIRE(val == "first");
+    REQUIRE(chan.try_receive(val) == channel_status::success);
+    REQUIRE(val == "second");
+    REQUIRE(chan.try_receive(val) == channel_status::closed);
+    REQUIRE(chan.receive(val) == channel_status::closed);
+    REQUIRE(chan.receive_for(val, milliseconds(1)) == channel_status::closed);
+}
+
+TEST_CASE("channel: close wakes blocked senders and receivers", "[channel]") {
+    using namespace std::chrono;
+
+    SECTION("receivers") {
+        channel<int> chan(2);
+        std::vector<channel_status> results(4, channel_status::success);
+        {
+            std::vector<jthread> receivers;
+            for(int i = 0; i < 4; ++i)
+                receivers.push_back(jthread([&chan, &results, i] () {
+                    int val = 0;
+                    results[i] = chan.receive(val);
+                }));
+            std::this_thread::sleep_for(milliseconds(20));
+            chan.close();
+        }
+        for(int i = 0; i < 4; ++i)
+            REQUIRE(results[i] == channel_status::closed);
+    }
+
+    SECTION("senders") {
+        channel<int> chan(2);
+        REQUIRE(chan.try_send(0) == channel_status::success);
+        REQUIRE(chan.try_send(1) == channel_status::success);
+
+        std::vector<channel_status> results(4, channel_status::success);
+        {
+            std::vector<jthread> senders;
+            for(int i = 0; i < 4; ++i)
+                senders.push_back(jthread([&chan, &results, i] () {
+                    results[i] = chan.send(i);
+                }));
+            std::this_thread::sleep_for(milliseconds(20));
+            chan.close();
+        }
+        for(int i = 0; i < 4; ++i)
+            REQUIRE(results[i] == channel_status::closed);
+    }
+}
+
+namespace {
+
+/*copy is slow enough for close() to come between claim and fill of cell*/
+struct slow_copy {
+    slow_copy(int val = 0) noexcept: m_val(val) {}
+
+    slow_copy(const slow_copy& other) noexcept: m_val(other.m_val)
+    { std::this_thread::sleep_for(std::chrono::milliseconds(50)); }
+
+    slow_copy& operator=(const slow_copy& other) noexcept = default;
+
+    int m_val;
+};
+
+/*copy which may throw is made before cell is claimed*/
+struct throwing_copy {
+    throwing_copy(int val = 0): m_val(val) {}
+
+    throwing_copy(const throwing_copy& other): m_val(other.m_val) {
+        if(m_val < 0)
+            throw std::runtime_error("throwing_copy");
+    }
+
+    throwing_copy(throwing_copy&& other) noexcept = default;
+    throwing_copy& operator=(const throwing_copy& other) = default;
+    throwing_copy& operator=(throwing_copy&& other) noexcept = default;
+
+    int m_val;
+};
+
+} // namespace
+
+TEST_CASE("channel: close while send is in progress", "[channel]") {
+    using namespace std::chrono;
+
+    SECTION("all receivers see last element or closed channel") {
+        channel<slow_copy> chan(2);
+        std::vector<channel_status> results(2, channel_status::timeout);
+        const steady_clock::time_point start = steady_clock::now();
+        {
+            std::vector<jthread> receivers;
+            for(int i = 0; i < 2; ++i)
+                receivers.push_back(jthread([&chan, &results, i] () {
+                    slow_copy val;
+                    results[i] = chan.receive_for(val, seconds(10));
+                }));
+            std::this_thread::sleep_for(milliseconds(10));
+
+            jthread sender([&chan] () {
+                const slow_copy val(7);
+                chan.send(val);
+            });
+            std::this_thread::sleep_for(milliseconds(20));
+            chan.close();
+        }
+        /*receiver left asleep would see closed channel only after its timeout*/
+        REQUIRE(steady_clock::now() - start < seconds(5));
+        REQUIRE(std::count(results.begin(), results.end(), channel_status::success) == 1);
+        REQUIRE(std::count(results.begin(), results.end(), channel_status::closed) == 1);
+    }
+
+    SECTION("throwing copy leaves channel usable") {
+        channel<throwing_copy> chan(2);
+        const throwing_copy bad(-1);
+        const throwing_copy good(1);
+        REQUIRE_THROWS_AS(chan.try_send(bad), std::runtime_error);
+        REQUIRE_THROWS_AS(chan.send(bad), std::runtime_error);
+        std::vector<throwing_copy> batch(2, good);
+        batch[1].m_val = -1;
+        REQUIRE_THROWS_AS(chan.send_bulk(batch.begin(), 2), std::runtime_error);
+
+        REQUIRE(chan.try_send(good) == channel_status::success);
+        throwing_copy val;
+        REQUIRE(chan.try_receive(val) == channel_status::success);
+        REQUIRE(val.m_val == 1);
+        REQUIRE(chan.try_receive(val) == channel_status::success);
+        REQUIRE(val.m_val == 1);
+        chan.close();
+        REQUIRE(chan.receive(val) == channel_status::closed);
+    }
+}
+
+TEST_CASE("channel: timed send and receive", "[channel]") {
+    using namespace std::chrono;
+    channel<int> chan(2);
+    int val = -1;
+
+    steady_clock::time_point start = steady_clock::now();
+    REQUIRE(chan.receive_for(val, milliseconds(10)) == channel_status::timeout);
+    REQUIRE(steady_clock::now() - start >= milliseconds(10));
+
+    REQUIRE(chan.send_for(1, milliseconds(10)) == channel_status::success);
+    REQUIRE(chan.send_until(2, steady_clock::now() + milliseconds(10)) == channel_status::success);
+    REQUIRE(chan.send_for(3, milliseconds(10)) == channel_status::timeout);
+
+    REQUIRE(chan.receive_until(val, steady_clock::now() + milliseconds(10)) == channel_status::success);
+    REQUIRE(val == 1);
+
+    /*blocked receiver gets element sent later*/
+    REQUIRE(chan.try_receive(val) == channel_status::success);
+    jthread sender([&chan] () {
+        std::this_thread::sleep_for(milliseconds(10));
+        chan.send(7);
+    });
+    REQUIRE(chan.receive_for(val, seconds(10)) == channel_status::success);
+    REQUIRE(val == 7);
+}
+
+TEST_CASE("channel: bulk operations", "[channel]") {
+    channel<int> chan(8);
+    std::vector<int> in(12);
+    std::iota(in.begin(), in.end(), 0);
+
+    REQUIRE(chan.try_send_bulk(in.begin(), 5) == 5);
+    /*only part which fits is sent*/
+    REQUIRE(chan.try_send_bulk(in.begin() + 5, 7) == 3);
+    REQUIRE(chan.try_send_bulk(in.begin() + 8, 4) == 0);
+
+    std::vector<int> out(12, -1);
+    REQUIRE(chan.try_receive_bulk(out.begin(), 6) == 6);
+    REQUIRE(chan.receive_bulk(out.begin() + 6, 10) == 2);
+    REQUIRE(chan.try_receive_bulk(out.begin() + 8, 10) == 0);
+
+    REQUIRE(chan.send_bulk(in.begin() + 8, 4) == 4);
+    REQUIRE(chan.try_receive_bulk(out.begin() + 8, 10) == 4);
+    REQUIRE(out == in);
+
+    chan.close();
+    REQUIRE(chan.send_bulk(in.begin(), 4) == 0);
+    REQUIRE(chan.receive_bulk(out.begin(), 4) == 0);
+}
+
+TEST_CASE("channel: many producers and consumers", "[channel]") {
+    const bool bulk = GENERATE(false, true);
+    const int producers = 4;
+    const int consumers = 4;
+    const int per_producer = 20'000;
+
+    channel<long> chan(64);
+    std::vector<long> sums(consumers, 0);
+    std::vector<long> counts(consumers, 0);
+    {
+        std::vector<jthread> receivers;
+        for(int c = 0; c < consumers; ++c)
+            receivers.push_back(jthread([&chan, &sums, &counts, c, bulk] () {
+                long batch[16];
+                for(;;) {
+                    if(bulk) {
+                        std::size_t received = chan.receive_bulk(batch, 16);
+                        if(received == 0)
+                            break;
+                        for(std::size_t i = 0; i < received; ++i)
+                            sums[c] += batch[i];
+                        counts[c] += received;
+                    } else {
+                        long val = 0;
+                        if(chan.receive(val) == channel_status::closed)
+                            break;
+                        sums[c] += val;
+                        ++counts[c];
+                    }
+                }
+            }));
+
+        std::vector<jthread> senders;
+        for(int p = 0; p < producers; ++p)
+            senders.push_back(jthread([&chan, p, bulk, per_producer] () {
+                std::vector<long> values(per_producer);
+                for(int i = 0; i < per_producer; ++i)
+                    values[i] = static_cast<long>(p) * per_producer + i;
+
+                if(bulk) {
+                    for(int i = 0; i < per_producer; i += 10)
+                        chan.send_bulk(values.begin() + i, 10);
+                } else {
+                    for(int i = 0; i < per_producer; ++i)
+                        chan.send(values[i]);
+                }
+            }));
+        for(int p = 0; p < producers; ++p)
+            senders[p].join();
+        chan.close();
+    }
+
+    const long total = static_cast<long>(producers) * per_producer;
+    REQUIRE(std::accumulate(counts.begin(), counts.end(), 0L) == total);
+    REQUIRE(std::accumulate(sums.begin(), sums.end(), 0L) == total * (total - 1) / 2);
+}
+
+TEST_CASE("lock_free_stack: push and pop in single thread", "[lock_free_stack]") {
+    lock_free_stack<std::unique_ptr<int> > stack;
+    std::unique_ptr<int> val;
+    REQUIRE(stack.empty());
+    REQUIRE(stack.try_pop(val) == false);
+
+    for(int i = 0; i < 3; ++i)
+        stack.push(std::make_unique<int>(i));
+    REQUIRE(stack.empty() == false);
+    for(int i = 2; i >= 0; --i) {
+        REQUIRE(stack.try_pop(val) == true);
+        REQUIRE(*val == i);
+    }
+    REQUIRE(stack.empty());
+
+    /*remaining elements are destroyed with stack*/
+    lock_free_stack<std::string, reclamation::epoch> strings;
+    strings.emplace(3, 'a');
+    strings.push("b");
+    std::string str;
+    REQUIRE(strings.try_pop(str) == true);
+    REQUIRE(str == "b");
+}
+
+TEST_CASE("lock_free_queue: push and pop in single thread", "[lock_free_queue]") {
+    lock_free_queue<std::unique_ptr<int> > queue;
+    std::unique_ptr<int> val;
+    REQUIRE(queue.empty());
+    REQUIRE(queue.try_pop(val) == false);
+
+    for(int i = 0; i < 3; ++i)
+        queue.push(std::make_unique<int>(i));
+    REQUIRE(queue.empty() == false);
+    for(int i = 0; i < 3; ++i) {
+        REQUIRE(queue.try_pop(val) == true);
+        REQUIRE(*val == i);
+    }
+    REQUIRE(queue.empty());
+
+    lock_free_queue<std::string, reclamation::epoch> strings;
+    strings.emplace(3, 'a');
+    strings.push("b");
+    std::string str;
+    REQUIRE(strings.try_pop(str) == true);
+    REQUIRE(str == "aaa");
+}
+
+/*every pushed value is popped exactly once, FIFO keeps order of each producer*/
+template<typename Container>
+void exchange_between_threads(bool fifo) {
+    const int producers = 4;
+    const int consumers = 4;
+    const int per_producer = 20'000;
+    const long total = static_cast<long>(producers) * per_producer;
+
+    Container container;
+    std::atomic<long> popped(0);
+    std::vector<long> sums(consumers, 0);
+    std::atomic<bool> out_of_order(false);
+    {
+        std::vector<jthread> threads;
+        for(int c = 0; c < consumers; ++c)
+            threads.push_back(jthread([&, c] () {
+                std::vector<long> last(producers, -1);
+                long val;
+                while(popped.load() < total) {
+                    if(!container.try_pop(val))
+                        continue;
+                    ++popped;
+                    sums[c] += val;
+                    const long producer = val / per_producer;
+                    if(val <= last[producer])
+                        out_of_order = true;
+                    last[producer] = val;
+                }
+            }));
+
+        for(int p = 0; p < producers; ++p)
+            threads.push_back(jthread([&container, p, per_producer] () {
+                for(int i = 0; i < per_producer; ++i)
+                    container.push(static_cast<long>(p) * per_producer + i);
+            }));
+    }
+
+    REQUIRE(popped == total);
+    REQUIRE(std::accumulate(sums.begin(), sums.end(), 0L) == total * (total - 1) / 2);
+    if(fifo)
+        REQUIRE(out_of_order == false);
+    REQUIRE(container.empty());
+}
+
+TEST_CASE("lock_free_stack: many producers and consumers", "[lock_free_stack]") {
+    SECTION("hazard pointers") {
+        exchange_between_threads<lock_free_stack<long, reclamation::hazard_pointers> >(false);
+    }
+
+    SECTION("epoch") {
+        exchange_between_threads<lock_free_stack<long, reclamation::epoch> >(false);
+    }
+}
+
+TEST_CASE("lock_free_queue: many producers and consumers", "[lock_free_queue]") {
+    SECTION("hazard pointers") {
+        exchange_between_threads<lock_free_queue<long, reclamation::hazard_pointers> >(true);
+    }
+
+    SECTION("epoch") {
+        exchange_between_threads<lock_free_queue<long, reclamation::epoch> >(true);
+    }
+}
+
+} // namespace concurrency
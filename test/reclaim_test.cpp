@@ -0,0 +1,143 @@
+#include <catch2/catch_all.hpp>
+
+#include "reclaim.hpp"
+#include "thread.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace concurrency {
+
+/*counts destroyed instances, every test resets it*/
+struct reclaimed_object {
+    static std::atomic<int> s_destroyed;
+
+    explicit reclaimed_object(int val): m_value(val) {}
+    ~reclaimed_object() {
+        m_value = -1;
+        ++s_destroyed;
+    }
+
+    int m_value;
+}; // struct reclaimed_object
+
+std::atomic<int> reclaimed_object::s_destroyed(0);
+
+TEST_CASE("hazard_pointer: protected object is not reclaimed", "[reclaim]") {
+    reclaimed_object::s_destroyed = 0;
+
+    std::atomic<reclaimed_object*> shared(new reclaimed_object(1));
+    hazard_pointer hazard;
+    reclaimed_object* protected_ptr = hazard.protect(shared);
+    REQUIRE(protected_ptr->m_value == 1);
+
+    /*unlinked and retired by other thread while still protected here*/
+    {
+        jthread remover([&shared] () {
+            hazard_retire(shared.exchange(new reclaimed_object(2)));
+            hazard_scan();
+        });
+    }
+    hazard_scan();
+    REQUIRE(reclaimed_object::s_destroyed == 0);
+    REQUIRE(protected_ptr->m_value == 1);
+
+    /*exited remover left object to shared list, scan of this thread adopts it*/
+    hazard.reset_protection();
+    hazard_scan();
+    REQUIRE(reclaimed_object::s_destroyed == 1);
+
+    SECTION("try_protect fails when source changes") {
+        reclaimed_object* stale = new reclaimed_object(3);
+        reclaimed_object* current = stale;
+        std::atomic<reclaimed_object*> other(shared.load());
+        REQUIRE(hazard.try_protect(current, other) == false);
+        REQUIRE(current == shared.load());
+        REQUIRE(hazard.try_protect(current, other) == true);
+        hazard.reset_protection();
+        delete stale;
+    }
+
+    SECTION("unprotected objects are reclaimed in batches") {
+        reclaimed_object::s_destroyed = 0;
+        for(int i = 0; i < 1000; ++i)
+            hazard_retire(new reclaimed_object(i));
+        REQUIRE(reclaimed_object::s_destroyed > 0);
+        hazard_scan();
+        REQUIRE(reclaimed_object::s_destroyed == 1000);
+    }
+
+    delete shared.load();
+}
+
+TEST_CASE("epoch_guard: object is reclaimed after readers leave", "[reclaim]") {
+    reclaimed_object::s_destroyed = 0;
+
+    std::atomic<bool> entered(false);
+    std::atomic<bool> leave(false);
+    jthread reader([&entered, &leave] () {
+        epoch_guard guard;
+        {
+            epoch_guard nested;
+        }
+        entered = true;
+        while(!leave)
+            std::this_thread::yield();
+    });
+    while(!entered)
+        std::this_thread::yield();
+
+    epoch_retire(new reclaimed_object(1));
+    for(int i = 0; i < 10; ++i)
+        epoch_collect();
+    REQUIRE(reclaimed_object::s_destroyed == 0);
+
+    leave = true;
+    reader.join();
+    epoch_collect();
+    epoch_collect();
+    REQUIRE(reclaimed_object::s_destroyed == 1);
+
+    SECTION("objects of exited thread are adopted") {
+        reclaimed_object::s_destroyed = 0;
+        {
+            jthread retirer([] () {
+                for(int i = 0; i < 10; ++i)
+                    epoch_retire(new reclaimed_object(i));
+            });
+        }
+        epoch_collect();
+        epoch_collect();
+        epoch_collect();
+        REQUIRE(reclaimed_object::s_destroyed == 10);
+    }
+
+    SECTION("many threads retiring and reading") {
+        reclaimed_object::s_destroyed = 0;
+        std::atomic<reclaimed_object*> shared(new reclaimed_object(0));
+        std::atomic<bool> reclaimed_while_read(false);
+        {
+            std::vector<jthread> threads;
+            for(int t = 0; t < 4; ++t)
+                threads.emplace_back([&shared, &reclaimed_while_read] () {
+                    for(int i = 0; i < 10000; ++i) {
+                        epoch_guard guard;
+                        reclaimed_object* seen = shared.load();
+                        if(i % 4 == 0)
+                            epoch_retire(shared.exchange(new reclaimed_object(seen->m_value + 1)));
+                        else if(seen->m_value < 0)
+                            reclaimed_while_read = true;
+                    }
+                });
+        }
+        epoch_collect();
+        epoch_collect();
+        epoch_collect();
+        REQUIRE(reclaimed_while_read == false);
+        REQUIRE(reclaimed_object::s_destroyed == 10000);
+        delete shared.load();
+    }
+}
+
+} // namespace concurrency
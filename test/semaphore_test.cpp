@@ -0,0 +1,153 @@
+#include <catch2/catch_all.hpp>
+
+#include "semaphore.hpp"
+#include "thread.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+namespace concurrency {
+
+TEST_CASE("semaphore: creation and deletion", "[semaphore]") {
+    REQUIRE_NOTHROW(counting_semaphore<10>(0));
+    REQUIRE_NOTHROW(counting_semaphore<10>(10));
+    REQUIRE_THROWS(counting_semaphore<10>(11));
+    REQUIRE_THROWS(counting_semaphore<10>(-1));
+    REQUIRE_THROWS(binary_semaphore(2));
+
+    REQUIRE(counting_semaphore<10>::max() == 10);
+    REQUIRE(binary_semaphore::max() == 1);
+}
+
+TEST_CASE("semaphore: acquire and release in single thread", "[semaphore]") {
+    counting_semaphore<4> sem(2);
+
+    REQUIRE(sem.try_acquire() == true);
+    REQUIRE_NOTHROW(sem.acquire());
+    REQUIRE(sem.try_acquire() == false);
+
+    REQUIRE_NOTHROW(sem.release(3));
+    REQUIRE(sem.try_acquire() == true);
+    REQUIRE(sem.try_acquire() == true);
+    REQUIRE(sem.try_acquire() == true);
+    REQUIRE(sem.try_acquire() == false);
+
+    REQUIRE_THROWS(sem.release(-1));
+    REQUIRE_NOTHROW(sem.release(0));
+    REQUIRE(sem.try_acquire() == false);
+
+    /*counter never exceeds max, failed release changes nothing*/
+    REQUIRE_THROWS_AS(sem.release(5), std::invalid_argument);
+    REQUIRE_NOTHROW(sem.release(4));
+    REQUIRE_THROWS_AS(sem.release(), std::invalid_argument);
+    for(int i = 0; i < 4; ++i)
+        REQUIRE(sem.try_acquire() == true);
+    REQUIRE(sem.try_acquire() == false);
+
+    binary_semaphore binary(1);
+    REQUIRE_THROWS_AS(binary.release(), std::invalid_argument);
+    REQUIRE(binary.try_acquire() == true);
+    REQUIRE(binary.try_acquire() == false);
+}
+
+TEST_CASE("semaphore: timed acquire", "[semaphore]") {
+    using namespace std::chrono;
+    binary_semaphore sem(0);
+
+    steady_clock::time_point start = steady_clock::now();
+    REQUIRE(sem.try_acquire_for(milliseconds(20)) == false);
+    REQUIRE(steady_clock::now() - start >= milliseconds(20));
+    REQUIRE(sem.try_acquire_until(system_clock::now() + milliseconds(5)) == false);
+    REQUIRE(sem.try_acquire_for(milliseconds(-5)) == false);
+
+    sem.release();
+    REQUIRE(sem.try_acquire_for(milliseconds(-5)) == true);
+
+    bool acquired = false;
+    {
+        jthread waiter([&sem, &acquired] () {
+            acquired = sem.try_acquire_for(seconds(5));
+        });
+        sem.release();
+    }
+    REQUIRE(acquired == true);
+}
+
+TEST_CASE("semaphore: handing off between threads", "[semaphore]") {
+    binary_semaphore ping(0);
+    binary_semaphore pong(0);
+    const int rounds = 10'000;
+    int turns = 0;
+
+    {
+        jthread ponger([&ping, &pong, &turns, rounds] () {
+            for(int i = 0; i < rounds; ++i) {
+                ping.acquire();
+                ++turns;
+                pong.release();
+            }
+        });
+
+        for(int i = 0; i < rounds; ++i) {
+            ping.release();
+            pong.acquire();
+            ++turns;
+        }
+    }
+    REQUIRE(turns == 2 * rounds);
+}
+
+TEST_CASE("semaphore: bounding resource pool", "[semaphore]") {
+    const int permits = 3;
+    const int threads_num = 8;
+    const int amount = 2'000;
+    counting_semaphore<permits> sem(permits);
+    std::atomic<int> inside(0);
+    std::atomic<int> max_inside(0);
+
+    {
+        std::vector<jthread> workers;
+        for(int i = 0; i < threads_num; ++i)
+            workers.push_back(jthread([&sem, &inside, &max_inside, amount] () {
+                for(int j = 0; j < amount; ++j) {
+                    sem.acquire();
+                    int now = ++inside;
+                    int prev = max_inside.load();
+                    while(prev < now && !max_inside.compare_exchange_weak(prev, now))
+                        ;
+                    --inside;
+                    sem.release();
+                }
+            }));
+    }
+
+    REQUIRE(max_inside.load() <= permits);
+    REQUIRE(max_inside.load() >= 1);
+    /*all permits are back*/
+    for(int i = 0; i < permits; ++i)
+        REQUIRE(sem.try_acquire() == true);
+    REQUIRE(sem.try_acquire() == false);
+}
+
+TEST_CASE("semaphore: release of several permits wakes several waiters", "[semaphore]") {
+    const int waiters_num = 6;
+    counting_semaphore<> sem(0);
+    std::atomic<int> acquired(0);
+
+    {
+        std::vector<jthread> waiters;
+        for(int i = 0; i < waiters_num; ++i)
+            waiters.push_back(jthread([&sem, &acquired] () {
+                sem.acquire();
+                ++acquired;
+            }));
+
+        sem.release(waiters_num);
+    }
+    REQUIRE(acquired == waiters_num);
+    REQUIRE(sem.try_acquire() == false);
+}
+
+} // namespace concurrency
\ No newline at end of file
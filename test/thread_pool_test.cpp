@@ -0,0 +1,240 @@
+#include <catch2/catch_all.hpp>
+
+#include "thread_pool.hpp"
+#include "work_stealing_pool.hpp"
+#include "chase_lev_deque.hpp"
+#include "mutex.hpp"
+#include "futex.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace concurrency {
+
+void pool_increment(int* var, mutex* var_mutex) {
+    lock_guard<mutex> locker(*var_mutex);
+    *var += 1;
+}
+
+TEST_CASE("thread_pool: creation and deletion", "[thread_pool]") {
+    REQUIRE_THROWS(thread_pool(0));
+
+    thread_pool pool(4);
+    REQUIRE(pool.size() == 4);
+    REQUIRE_NOTHROW(pool.wait_idle());
+}
+
+TEST_CASE("thread_pool: execution of submitted tasks", "[thread_pool]") {
+    const int tasks_num = 10'000;
+    int val = 0;
+    mutex val_mutex;
+
+    thread_pool pool(4);
+
+    SECTION("wait_idle") {
+        for(int i = 0; i < tasks_num; ++i)
+            pool.submit(pool_increment, &val, &val_mutex);
+        pool.wait_idle();
+
+        REQUIRE(val == tasks_num);
+
+        /*pool is reusable after draining*/
+        for(int i = 0; i < tasks_num; ++i)
+            pool.submit([&val, &val_mutex] () { pool_increment(&val, &val_mutex); });
+        pool.wait_idle();
+
+        REQUIRE(val == 2 * tasks_num);
+    }
+
+    SECTION("shutdown drains queue") {
+        for(int i = 0; i < tasks_num; ++i)
+            pool.submit(pool_increment, &val, &val_mutex);
+        pool.shutdown();
+
+        REQUIRE(val == tasks_num);
+        REQUIRE_THROWS(pool.submit(pool_increment, &val, &val_mutex));
+        REQUIRE_NOTHROW(pool.shutdown());
+    }
+}
+
+TEST_CASE("thread_pool: tasks submitted from tasks", "[thread_pool]") {
+    const int tasks_num = 1000;
+    int val = 0;
+    mutex val_mutex;
+
+    {
+        thread_pool pool(2);
+        for(int i = 0; i < tasks_num; ++i)
+            pool.submit([&pool, &val, &val_mutex] () {
+                pool.submit(pool_increment, &val, &val_mutex);
+            });
+    } /*destructor finishes all tasks*/
+
+    REQUIRE(val == tasks_num);
+}
+
+TEST_CASE("thread_pool: move-only callables and arguments", "[thread_pool]") {
+    std::atomic<int> sum(0);
+    {
+        thread_pool pool(2);
+        std::unique_ptr<int> owned(new int(5));
+        pool.submit([owned = std::move(owned), &sum] () { sum += *owned; });
+        pool.submit([&sum] (std::unique_ptr<int> arg) { sum += *arg; }, std::make_unique<int>(7));
+
+        /*lvalue argument is copied, std::ref keeps reference*/
+        int counter = 1;
+        pool.submit([&sum] (int val) { sum += val; }, counter);
+        pool.submit([] (int& val) { ++val; }, std::ref(counter));
+        pool.wait_idle();
+        REQUIRE(counter == 2);
+    }
+    REQUIRE(sum == 5 + 7 + 1);
+}
+
+TEST_CASE("chase_lev_deque: owner and thieves", "[thread_pool][work_stealing]") {
+    chase_lev_deque<long> deque(2);
+    long val = 0;
+
+    SECTION("single thread") {
+        REQUIRE(deque.pop(val) == false);
+        REQUIRE(deque.steal(val) == false);
+
+        for(long i = 0; i < 100; ++i)
+            deque.push(i); /*grows past initial capacity*/
+        REQUIRE(deque.size() == 100);
+
+        REQUIRE(deque.pop(val) == true);
+        REQUIRE(val == 99); /*owner end is LIFO*/
+        REQUIRE(deque.steal(val) == true);
+        REQUIRE(val == 0); /*thief end is FIFO*/
+        REQUIRE(deque.size() == 98);
+    }
+
+    SECTION("every element is taken exactly once") {
+        const long elements_num = 200'000;
+        const int thieves_num = 3;
+        std::vector<std::atomic<int>> taken(elements_num);
+        for(long i = 0; i < elements_num; ++i)
+            taken[i].store(0);
+        std::atomic<bool> done(false);
+
+        {
+            std::vector<jthread> thieves;
+            for(int i = 0; i < thieves_num; ++i)
+                thieves.push_back(jthread([&deque, &taken, &done] () {
+                    long stolen = 0;
+                    while(!done.load() || !deque.empty())
+                        if(deque.steal(stolen))
+                            taken[stolen].fetch_add(1);
+                }));
+
+            long popped = 0;
+            for(long i = 0; i < elements_num; ++i) {
+                deque.push(i);
+                if(i % 3 == 0 && deque.pop(popped))
+                    taken[popped].fetch_add(1);
+            }
+            while(deque.pop(popped))
+                taken[popped].fetch_add(1);
+            done.store(true);
+        }
+
+        long wrong = 0;
+        for(long i = 0; i < elements_num; ++i)
+            wrong += taken[i].load() != 1;
+        REQUIRE(wrong == 0);
+    }
+}
+
+static long fork_join_fib(work_stealing_pool* pool, int n) {
+    if(n < 2)
+        return n;
+
+    std::atomic<bool> forked_done(false);
+    long forked_result = 0;
+    pool->submit([pool, n, &forked_result, &forked_done] () {
+        forked_result = fork_join_fib(pool, n - 1);
+        forked_done.store(true, std::memory_order_release);
+    });
+
+    long result = fork_join_fib(pool, n - 2);
+    pool->run_until([&forked_done] () { return forked_done.load(std::memory_order_acquire); });
+    return result + forked_result;
+}
+
+TEST_CASE("work_stealing_pool: execution of submitted tasks", "[thread_pool][work_stealing]") {
+    const int tasks_num = 10'000;
+    std::atomic<int> val(0);
+
+    REQUIRE_THROWS(work_stealing_pool(0));
+
+    work_stealing_pool pool(4);
+    REQUIRE(pool.size() == 4);
+    REQUIRE(pool.current_worker_index() == -1);
+
+    SECTION("external tasks") {
+        for(int i = 0; i < tasks_num; ++i)
+            pool.submit([&val] () { val.fetch_add(1); });
+        pool.wait_idle();
+
+        REQUIRE(val.load() == tasks_num);
+    }
+
+    SECTION("tasks spawned from tasks are stolen") {
+        std::vector<std::atomic<int>> ran_on(pool.size());
+        for(unsigned int i = 0; i < pool.size(); ++i)
+            ran_on[i].store(0);
+
+        pool.submit([&pool, &val, &ran_on, tasks_num] () {
+            for(int i = 0; i < tasks_num; ++i)
+                pool.submit([&pool, &val, &ran_on] () {
+                    ran_on[pool.current_worker_index()].fetch_add(1);
+                    /*some work for thieves to find*/
+                    for(int spin = 0; spin < 1000; ++spin)
+                        util::cpu_relax();
+                    val.fetch_add(1);
+                });
+        });
+        pool.wait_idle();
+
+        REQUIRE(val.load() == tasks_num);
+        int workers_used = 0;
+        for(unsigned int i = 0; i < pool.size(); ++i)
+            workers_used += ran_on[i].load() > 0;
+        REQUIRE(workers_used > 1);
+    }
+
+    SECTION("recursive fork/join") {
+        long result = 0;
+        pool.submit([&pool, &result] () { result = fork_join_fib(&pool, 20); });
+        pool.wait_idle();
+
+        REQUIRE(result == 6765);
+    }
+
+    SECTION("shutdown drains queue") {
+        for(int i = 0; i < tasks_num; ++i)
+            pool.submit([&val] () { val.fetch_add(1); });
+        pool.shutdown();
+
+        REQUIRE(val.load() == tasks_num);
+        REQUIRE_THROWS(pool.submit([&val] () { val.fetch_add(1); }));
+        REQUIRE_NOTHROW(pool.shutdown());
+    }
+
+    SECTION("move-only callables and arguments") {
+        std::unique_ptr<int> owned(new int(5));
+        pool.submit([owned = std::move(owned), &val] () { val.fetch_add(*owned); });
+        pool.submit([&pool, &val] () {
+            /*spawned task goes through local deque*/
+            pool.submit([&val] (std::unique_ptr<int> arg) { val.fetch_add(*arg); }, std::make_unique<int>(7));
+        });
+        pool.wait_idle();
+
+        REQUIRE(val.load() == 5 + 7);
+    }
+}
+
+} // namespace concurrency
\ No newline at end of file
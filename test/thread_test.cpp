@@ -2,6 +2,17 @@
 
 #include "thread.hpp"
 #include "mutex.hpp"
+#include "stop_token.hpp"
+
+#include "alloc_counter.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <memory>
+
+#include <pthread.h>
+#include <sched.h>
 
 namespace concurrency {
 
@@ -142,4 +153,248 @@ TEST_CASE("this_thread: get_native_id()", "[thread]") {
 
 }
 
+void append_a(void* arg) {
+    static_cast<std::string*>(arg)->push_back('a');
+}
+
+void append_b(void* arg) {
+    static_cast<std::string*>(arg)->push_back('b');
+}
+
+TEST_CASE("this_thread: at_exit()", "[thread]") {
+    std::string order;
+    thread tr([&order] () {
+        this_thread::at_exit(append_a, &order);
+        this_thread::at_exit(append_b, &order);
+        order = "x";
+    });
+    tr.join();
+
+    /*routines run in reverse order of registration*/
+    REQUIRE(order == "xba");
+
+    SECTION("thread not created by library") {
+        order.clear();
+        pthread_t handle;
+        auto routine = [] (void* arg) -> void* {
+            this_thread::at_exit(append_a, arg);
+            return nullptr;
+        };
+        REQUIRE(pthread_create(&handle, nullptr, routine, &order) == 0);
+        pthread_join(handle, nullptr);
+        REQUIRE(order == "a");
+    }
+}
+
+void count_until_stopped(stop_token token, std::atomic<int>* counter) {
+    while(!token.stop_requested())
+        counter->fetch_add(1);
+}
+
+TEST_CASE("stop_source: request_stop and tokens", "[thread][stop_token]") {
+    stop_source source;
+    stop_token token = source.get_token();
+
+    REQUIRE(source.stop_possible() == true);
+    REQUIRE(token.stop_possible() == true);
+    REQUIRE(token.stop_requested() == false);
+    REQUIRE(token == source.get_token());
+
+    REQUIRE(source.request_stop() == true);
+    REQUIRE(source.request_stop() == false);
+    REQUIRE(token.stop_requested() == true);
+    REQUIRE(stop_token(token).stop_requested() == true);
+
+    stop_token empty_token;
+    REQUIRE(empty_token.stop_possible() == false);
+    REQUIRE(stop_source(nostopstate).stop_possible() == false);
+
+    SECTION("token outlives sources") {
+        stop_token orphan;
+        {
+            stop_source other;
+            orphan = other.get_token();
+        }
+        REQUIRE(orphan.stop_possible() == false);
+        REQUIRE(orphan.stop_requested() == false);
+    }
+}
+
+TEST_CASE("stop_callback: invocation", "[thread][stop_token]") {
+    stop_source source;
+    int calls = 0;
+    auto callback = [&calls] () { ++calls; };
+
+    {
+        stop_callback<decltype(callback)> deregistered(source.get_token(), callback);
+    }
+
+    stop_callback<decltype(callback)> registered(source.get_token(), callback);
+    REQUIRE(calls == 0);
+
+    source.request_stop();
+    REQUIRE(calls == 1);
+
+    /*stop already requested: invoked right away*/
+    stop_callback<decltype(callback)> late(source.get_token(), callback);
+    REQUIRE(calls == 2);
+
+    source.request_stop();
+    REQUIRE(calls == 2);
+}
+
+TEST_CASE("jthread: stop token support", "[thread][stop_token]") {
+    std::atomic<int> counter(0);
+
+    SECTION("destructor requests stop") {
+        {
+            jthread tr(count_until_stopped, &counter);
+            while(counter.load() == 0);
+        } /*would hang without stop request*/
+
+        REQUIRE(counter.load() > 0);
+    }
+
+    SECTION("explicit request_stop") {
+        jthread tr([] (stop_token token, std::atomic<int>* counter) {
+            while(!token.stop_requested());
+            counter->store(-1);
+        }, &counter);
+
+        REQUIRE(tr.get_stop_token().stop_possible() == true);
+        REQUIRE(tr.request_stop() == true);
+        tr.join();
+
+        REQUIRE(counter.load() == -1);
+        REQUIRE(tr.get_stop_source().stop_requested() == true);
+    }
+
+    SECTION("callable without token") {
+        int val = 0;
+        {
+            jthread tr(increment_by_1, &val);
+        }
+        REQUIRE(val == 1);
+    }
+
+    SECTION("move assignment stops previous thread") {
+        jthread tr(count_until_stopped, &counter);
+        tr = jthread(do_nothing);
+        REQUIRE(tr.joinable() == true);
+    }
+}
+
+struct observed_thread_state {
+    std::size_t stack_size;
+    std::size_t guard_size;
+    char name[16];
+    cpu_set_t cpus;
+};
+
+void observe_thread_state(observed_thread_state* state) {
+    pthread_attr_t attr;
+    pthread_getattr_np(pthread_self(), &attr);
+    pthread_attr_getstacksize(&attr, &state->stack_size);
+    pthread_attr_getguardsize(&attr, &state->guard_size);
+    pthread_attr_destroy(&attr);
+
+    pthread_getname_np(pthread_self(), state->name, sizeof(state->name));
+    pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &state->cpus);
+}
+
+TEST_CASE("thread: creation attributes", "[thread][attributes]") {
+    observed_thread_state state;
+    std::memset(&state, 0, sizeof(state));
+
+    SECTION("stack, guard and name") {
+        const std::size_t stack_size = 256 * 1024;
+        thread tr(
+            thread::attributes().stack_size(stack_size).guard_size(0).name("attr_worker"),
+            observe_thread_state, &state
+        );
+        tr.join();
+
+        REQUIRE(state.stack_size == stack_size);
+        REQUIRE(state.guard_size == 0);
+        REQUIRE(std::string(state.name) == "attr_worker");
+    }
+
+    SECTION("cpu affinity") {
+        /*pin to first cpu calling thread may run on*/
+        cpu_set_t allowed;
+        pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &allowed);
+        int first_cpu = 0;
+        while(!CPU_ISSET(first_cpu, &allowed))
+            ++first_cpu;
+
+        jthread tr(thread::attributes().cpu(first_cpu), observe_thread_state, &state);
+        tr.join();
+
+        REQUIRE(CPU_COUNT(&state.cpus) == 1);
+        REQUIRE(CPU_ISSET(first_cpu, &state.cpus));
+    }
+
+    SECTION("invalid attributes") {
+        REQUIRE_THROWS(thread::attributes().name("name longer than 15 chars"));
+        REQUIRE_THROWS(thread::attributes().cpu(-1));
+        /*stack smaller than PTHREAD_STACK_MIN*/
+        REQUIRE_THROWS(thread(thread::attributes().stack_size(1), do_nothing));
+        REQUIRE_THROWS(thread(thread::attributes().sched_policy(SCHED_FIFO, 1000), do_nothing));
+    }
+}
+
+/*counts copies made of it while being passed to thread*/
+struct copy_counter {
+    explicit copy_counter(int* copies): m_copies(copies) {}
+    copy_counter(const copy_counter& other): m_copies(other.m_copies) { ++*m_copies; }
+    copy_counter(copy_counter&& other): m_copies(other.m_copies) {}
+
+    int* m_copies;
+};
+
+void take_unique_ptr(std::unique_ptr<int> ptr, int* out) {
+    *out = *ptr;
+}
+
+TEST_CASE("thread: forwarding of callable and arguments", "[thread]") {
+    SECTION("move-only arguments and callable") {
+        int val = 0;
+        thread tr(take_unique_ptr, std::unique_ptr<int>(new int(42)), &val);
+        tr.join();
+        REQUIRE(val == 42);
+
+        std::unique_ptr<int> owned(new int(7));
+        auto move_only_callable = [owned = std::move(owned), &val] () { val = *owned; };
+        jthread jtr(std::move(move_only_callable));
+        jtr.join();
+        REQUIRE(val == 7);
+    }
+
+    SECTION("single decay-copy") {
+        int copies = 0;
+        copy_counter counter(&copies);
+
+        thread tr([] (copy_counter) {}, counter);
+        tr.join();
+        REQUIRE(copies == 1); /*lvalue is copied once into start block*/
+
+        copies = 0;
+        thread tr_moved([] (copy_counter) {}, std::move(counter));
+        tr_moved.join();
+        REQUIRE(copies == 0);
+    }
+
+    SECTION("single allocation per start") {
+        char buffer[4096] = {};
+        auto large_capture = [buffer] () { (void) buffer; };
+
+        const unsigned long before = test::thread_allocation_count();
+        thread tr(large_capture);
+        const unsigned long allocations = test::thread_allocation_count() - before;
+        tr.join();
+
+        REQUIRE(allocations == 1);
+    }
+}
+
 } // namespace concurrency
\ No newline at end of file
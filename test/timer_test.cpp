@@ -0,0 +1,204 @@
+#include <catch2/catch_all.hpp>
+
+#include "timer_service.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace concurrency {
+
+namespace {
+
+typedef std::chrono::steady_clock::time_point steady_point;
+
+template<typename Predicate>
+bool eventually(Predicate done) {
+    const steady_point give_up = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while(!done()) {
+        if(std::chrono::steady_clock::now() > give_up)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("timer_service: one-shot timers fire once, not before deadline", "[timer]") {
+    REQUIRE_THROWS_AS(timer_service(std::chrono::nanoseconds(0)), std::invalid_argument);
+
+    timer_service timers;
+    const int timers_num = 20;
+    std::vector<steady_point> deadlines(timers_num);
+    std::vector<steady_point> fired(timers_num);
+    std::atomic<int> fired_num(0);
+    std::atomic<bool> early(false);
+
+    for(int i = 0; i < timers_num; ++i) {
+        deadlines[i] = std::chrono::steady_clock::now() + std::chrono::milliseconds(5 * (timers_num - i));
+        timers.schedule_at(deadlines[i], [&, i] () {
+            if(std::chrono::steady_clock::now() < deadlines[i])
+                early = true;
+            fired[i] = std::chrono::steady_clock::now();
+            ++fired_num;
+        });
+    }
+    REQUIRE(timers.size() == static_cast<std::size_t>(timers_num));
+
+    /*deadline in the past and deadline on other clock*/
+    std::atomic<int> other(0);
+    timers.schedule_after(std::chrono::milliseconds(-5), [&other] () { ++other; });
+    timers.schedule_at(std::chrono::system_clock::now() + std::chrono::milliseconds(3), [&other] () { ++other; });
+
+    REQUIRE(eventually([&] () { return fired_num == timers_num && other == 2; }));
+    REQUIRE(early == false);
+    /*dispatcher runs callbacks in order of deadlines*/
+    for(int i = 1; i < timers_num; ++i)
+        REQUIRE(fired[i] <= fired[i - 1]);
+    REQUIRE(timers.size() == 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    REQUIRE(fired_num == timers_num);
+    REQUIRE(other == 2);
+}
+
+TEST_CASE("timer_service: cancellation", "[timer]") {
+    std::atomic<int> fired(0);
+    timer_handle survivor;
+    {
+        timer_service timers;
+        REQUIRE(timer_handle().cancel() == false);
+
+        timer_handle near = timers.schedule_after(std::chrono::milliseconds(20), [&fired] () { fired += 1; });
+        /*far deadline is kept in heap*/
+        timer_handle far = timers.schedule_after(std::chrono::hours(24 * 365), [&fired] () { fired += 100; });
+        timer_handle soon = timers.schedule_after(std::chrono::milliseconds(1), [&fired] () { fired += 10'000; });
+        survivor = timers.schedule_after(std::chrono::hours(1), [&fired] () { fired += 1'000'000; });
+        REQUIRE(timers.size() == 4);
+
+        REQUIRE(near.cancel() == true);
+        REQUIRE(near.cancel() == false);
+        REQUIRE(far.cancel() == true);
+        REQUIRE(timer_handle(far).cancel() == false);
+        REQUIRE(timers.size() == 2);
+
+        REQUIRE(eventually([&fired] () { return fired == 10'000; }));
+        REQUIRE(soon.cancel() == false);
+        REQUIRE(timers.size() == 1);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        REQUIRE(fired == 10'000);
+    }
+    /*destroyed service drops its timers, handle only keeps memory*/
+    REQUIRE(survivor.valid());
+    REQUIRE(fired == 10'000);
+}
+
+TEST_CASE("timer_service: far deadlines never fire", "[timer]") {
+    using namespace std::chrono;
+    std::atomic<int> fired(0);
+
+    /*seconds long ticks: wakeup time of far deadline would overflow nanoseconds*/
+    const nanoseconds resolution = GENERATE(nanoseconds(milliseconds(1)), nanoseconds(seconds(3)));
+    timer_service timers(resolution);
+
+    timers.schedule_at(steady_clock::time_point::max(), [&fired] () { ++fired; });
+    timers.schedule_at(time_point<system_clock, seconds>::max(), [&fired] () { ++fired; });
+    timers.schedule_after(hours::max(), [&fired] () { ++fired; });
+
+    std::this_thread::sleep_for(milliseconds(30));
+    REQUIRE(fired == 0);
+    REQUIRE(timers.size() == 3);
+}
+
+TEST_CASE("timer_service: periodic timers on executor", "[timer]") {
+    thread_pool pool(2);
+    timer_service timers(pool);
+
+    REQUIRE_THROWS_AS(timers.schedule_every(std::chrono::milliseconds(0), [] () {}), std::invalid_argument);
+
+    std::atomic<int> ticks(0);
+    timer_handle periodic = timers.schedule_every(std::chrono::milliseconds(2), [&ticks] () { ++ticks; });
+    REQUIRE(eventually([&ticks] () { return ticks >= 10; }));
+
+    /*slow callback: runs of one timer do not overlap, missed periods are skipped*/
+    std::atomic<int> running(0);
+    std::atomic<bool> overlapped(false);
+    std::atomic<int> slow_runs(0);
+    timer_handle slow = timers.schedule_every(std::chrono::milliseconds(1), [&] () {
+        if(++running > 1)
+            overlapped = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        --running;
+        ++slow_runs;
+    });
+    REQUIRE(eventually([&slow_runs] () { return slow_runs >= 5; }));
+
+    REQUIRE(periodic.cancel() == true);
+    REQUIRE(slow.cancel() == true);
+    REQUIRE(timers.size() == 0);
+    pool.wait_idle();
+
+    const int ticks_after_cancel = ticks;
+    const int slow_after_cancel = slow_runs;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(ticks == ticks_after_cancel);
+    REQUIRE(slow_runs == slow_after_cancel);
+    REQUIRE(overlapped == false);
+}
+
+TEST_CASE("timer_service: many timers armed and cancelled from several threads", "[timer]") {
+    const int threads_num = 4;
+    const int per_thread = 50'000;
+
+    std::vector<std::atomic<int> > fired(threads_num * per_thread);
+    std::atomic<bool> early(false);
+    std::atomic<int> kept(0);
+    {
+        /*nanosecond ticks: wheel spans ~16ms, so later deadlines go through heap*/
+        timer_service timers(std::chrono::nanoseconds(1));
+        std::vector<jthread> threads;
+        for(int t = 0; t < threads_num; ++t)
+            threads.emplace_back([&, t] () {
+                std::mt19937 rng(t);
+                std::vector<timer_handle> handles;
+                for(int i = 0; i < per_thread; ++i) {
+                    const int id = t * per_thread + i;
+                    const steady_point deadline =
+                        std::chrono::steady_clock::now() + std::chrono::microseconds(rng() % 100'000);
+                    handles.push_back(timers.schedule_at(deadline, [&fired, &early, id, deadline] () {
+                        if(std::chrono::steady_clock::now() < deadline)
+                            early = true;
+                        ++fired[id];
+                    }));
+                }
+                /*cancel every other timer, the ones which have not fired yet must stay silent*/
+                for(int i = 0; i < per_thread; i += 2)
+                    if(!handles[i].cancel())
+                        ++kept;
+                kept += per_thread / 2;
+            });
+        for(int t = 0; t < threads_num; ++t)
+            threads[t].join();
+
+        /*last callbacks are finished when dispatcher is joined*/
+        REQUIRE(eventually([&timers] () { return timers.size() == 0; }));
+    }
+
+    int total = 0;
+    for(int id = 0; id < threads_num * per_thread; ++id) {
+        REQUIRE(fired[id] <= 1);
+        if(id % per_thread % 2 == 1)
+            REQUIRE(fired[id] == 1);
+        total += fired[id];
+    }
+    REQUIRE(total == kept);
+    REQUIRE(early == false);
+}
+
+} // namespace concurrency
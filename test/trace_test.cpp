@@ -0,0 +1,199 @@
+#include <catch2/catch_all.hpp>
+
+#include "trace.hpp"
+#include "mutex.hpp"
+#include "condition_variable.hpp"
+#include "thread.hpp"
+
+#include <chrono>
+#include <sstream>
+#include <string>
+
+namespace concurrency {
+
+static std::string flush_to_string() {
+    std::ostringstream out;
+    trace::flush(out);
+    return out.str();
+}
+
+TEST_CASE("trace: flush writes chrome trace json", "[trace]") {
+    std::string json = flush_to_string();
+
+    REQUIRE(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") == 0);
+    REQUIRE(json.find("]}") != std::string::npos);
+}
+
+#ifdef CONCURRENCY_TRACING
+static std::size_t count_of(const std::string& str, const std::string& what) {
+    std::size_t count = 0;
+    for(std::size_t pos = str.find(what); pos != std::string::npos; pos = str.find(what, pos + 1))
+        ++count;
+    return count;
+}
+
+static std::string object_arg(const void* object) {
+    std::ostringstream out;
+    out << "\"args\":{\"object\":\"" << object << "\"}";
+    return out.str();
+}
+
+TEST_CASE("trace: events of mutex, condition_variable and thread", "[trace]") {
+    using namespace std::chrono;
+
+    /*drop events of previous tests*/
+    flush_to_string();
+
+    SECTION("wait and hold intervals of mutex") {
+        mutex mut;
+        mut.lock();
+        mut.unlock();
+        REQUIRE(mut.try_lock() == true);
+        mut.unlock();
+
+        std::string json = flush_to_string();
+        const std::string object = object_arg(static_cast<mutex_interface*>(&mut));
+        REQUIRE(count_of(json, "\"name\":\"mutex wait\",\"cat\":\"mutex\",\"ph\":\"X\"") >= 1);
+        REQUIRE(count_of(json, "\"name\":\"mutex hold\",\"cat\":\"mutex\",\"ph\":\"X\"") >= 2);
+        REQUIRE(count_of(json, object) == 3);
+
+        /*events are dropped by flush*/
+        REQUIRE(count_of(flush_to_string(), object) == 0);
+    }
+
+    SECTION("recursive hold lasts from outermost lock, held mutex stays open") {
+        recursive_mutex mut;
+        mut.lock();
+        mut.lock();
+        mut.unlock();
+
+        std::string json = flush_to_string();
+        const std::string object = object_arg(static_cast<mutex_interface*>(&mut));
+        REQUIRE(count_of(json, "\"name\":\"mutex hold\",\"cat\":\"mutex\",\"ph\":\"B\"") == 1);
+        REQUIRE(count_of(json, "\"name\":\"mutex hold\",\"cat\":\"mutex\",\"ph\":\"X\"") == 0);
+
+        mut.unlock();
+        json = flush_to_string();
+        /*begin was flushed already*/
+        REQUIRE(count_of(json, "\"name\":\"mutex released\"") == 1);
+    }
+
+    SECTION("timed out wait for mutex") {
+        timed_mutex mut;
+        bool locked = true;
+        mut.lock();
+        {
+            jthread waiter([&mut, &locked] () {
+                locked = mut.try_lock_for(milliseconds(10));
+            });
+        }
+        mut.unlock();
+        REQUIRE(locked == false);
+
+        std::string json = flush_to_string();
+        REQUIRE(count_of(json, "\"name\":\"mutex wait\",\"cat\":\"mutex\",\"ph\":\"X\"") >= 2);
+        REQUIRE(count_of(json, "\"name\":\"mutex wait\",\"cat\":\"mutex\",\"ph\":\"B\"") == 0);
+    }
+
+    SECTION("condition_variable wait releases mutex") {
+        mutex mut;
+        condition_variable cond_var;
+
+        unique_lock<mutex> locker(mut);
+        cond_var.wait_for(locker, milliseconds(5));
+        cond_var.notify_one();
+        cond_var.notify_all();
+        locker.unlock();
+
+        std::string json = flush_to_string();
+        REQUIRE(count_of(json, "\"name\":\"cv wait\",\"cat\":\"condition_variable\",\"ph\":\"X\"") == 1);
+        REQUIRE(count_of(json, "\"name\":\"cv notify_one\"") == 1);
+        REQUIRE(count_of(json, "\"name\":\"cv notify_all\"") == 1);
+        REQUIRE(count_of(json, object_arg(&cond_var)) == 3);
+        /*hold is split by wait*/
+        REQUIRE(count_of(json, "\"name\":\"mutex hold\",\"cat\":\"mutex\",\"ph\":\"X\"") == 2);
+    }
+
+    SECTION("thread lifetime and join") {
+        thread thr(thread::attributes().name("traced"), [] () {});
+        thr.join();
+
+        std::string json = flush_to_string();
+        REQUIRE(count_of(json, "\"name\":\"thread create\"") == 1);
+        REQUIRE(count_of(json, "\"name\":\"thread start\"") == 1);
+        REQUIRE(count_of(json, "\"name\":\"thread exit\"") == 1);
+        REQUIRE(count_of(json, "\"name\":\"join\",\"cat\":\"thread\",\"ph\":\"X\"") == 1);
+        REQUIRE(json.find("\"args\":{\"name\":\"traced\"}") != std::string::npos);
+    }
+
+    SECTION("buffers of exited threads keep events until flush, then are reused") {
+        {
+            thread first(thread::attributes().name("first"), [] () {});
+            first.join();
+            thread second(thread::attributes().name("second"), [] () {});
+            second.join();
+        }
+
+        /*second thread did not take events of first one over*/
+        std::string json = flush_to_string();
+        REQUIRE(json.find("\"args\":{\"name\":\"first\"}") != std::string::npos);
+        REQUIRE(json.find("\"args\":{\"name\":\"second\"}") != std::string::npos);
+        REQUIRE(count_of(json, "\"name\":\"thread exit\"") == 2);
+        const std::size_t buffers = count_of(json, "\"name\":\"thread_name\"");
+
+        thread third(thread::attributes().name("third"), [] () {});
+        third.join();
+
+        json = flush_to_string();
+        REQUIRE(json.find("\"args\":{\"name\":\"third\"}") != std::string::npos);
+        REQUIRE(count_of(json, "\"name\":\"thread start\"") == 1);
+        REQUIRE(count_of(json, "\"name\":\"thread exit\"") == 1);
+        /*flushed buffer was reused instead of new one*/
+        REQUIRE(count_of(json, "\"name\":\"thread_name\"") <= buffers);
+    }
+
+    SECTION("concurrent flushes take disjoint events") {
+        mutex mut;
+        const int locks = 100;
+        for(int i = 0; i < locks; ++i) {
+            mut.lock();
+            mut.unlock();
+        }
+
+        std::string first_json;
+        std::string second_json;
+        {
+            jthread first([&first_json] () { first_json = flush_to_string(); });
+            jthread second([&second_json] () { second_json = flush_to_string(); });
+        }
+        /*wait and hold interval per lock, each written by one flush only*/
+        const std::string object = object_arg(static_cast<mutex_interface*>(&mut));
+        REQUIRE(count_of(first_json, object) + count_of(second_json, object) == 2 * locks);
+    }
+
+    SECTION("full ring keeps newest events") {
+        mutex mut;
+        const int locks = trace::detail::thread_buffer::capacity;
+        for(int i = 0; i < locks; ++i) {
+            mut.lock();
+            mut.unlock();
+        }
+
+        std::string json = flush_to_string();
+        /*three events per lock, oldest ones are overwritten*/
+        const std::size_t holds = count_of(json, "\"name\":\"mutex hold\"");
+        REQUIRE(holds >= locks / 3);
+        REQUIRE(holds <= locks / 3 + 1);
+    }
+}
+#else
+TEST_CASE("trace: nothing is recorded when disabled", "[trace]") {
+    mutex mut;
+    mut.lock();
+    mut.unlock();
+
+    REQUIRE(flush_to_string().find("\"ph\"") == std::string::npos);
+}
+#endif
+
+} // namespace concurrency